@@ -0,0 +1,289 @@
+/***********************************************************************
+ * Header:
+ *    BENCH HASH
+ * Summary:
+ *    Performance benchmarks for hash, side by side with std::unordered_set
+ ************************************************************************/
+
+#pragma once
+
+#include "hash.h"
+#include "benchmark.h"
+
+#include <unordered_set>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <algorithm>
+
+class BenchHash : public Benchmark
+{
+public:
+   void run()
+   {
+      reset();
+      workload = describeWorkload();
+
+      // Standard operations
+      bench_operations<custom::unordered_set<std::size_t>, std::size_t>("custom::unordered_set", "size_t");
+      bench_operations<std::unordered_set<std::size_t>,    std::size_t>("std::unordered_set",    "size_t");
+      bench_operations<custom::unordered_set<std::string>, std::string>("custom::unordered_set", "string");
+      bench_operations<std::unordered_set<std::string>,    std::string>("std::unordered_set",    "string");
+
+      // Insert
+      bench_insertParallel_scaling(options().numKeys);
+
+      // Remove
+      bench_clearAsync(options().numKeys);
+
+      // Parallel
+      bench_parallelReduce_scaling(options().numKeys);
+
+      report("Hash");
+   }
+
+   /***************************************
+    * STANDARD OPERATIONS
+    ***************************************/
+
+   // lookups per case, cycling through the keys for small sets
+   enum { NUM_LOOKUPS = 10000 };
+
+   // the key distribution and read mix from the command line, for the results
+   static std::string describeWorkload()
+   {
+      const KeyOptions & keys = options().keys;
+      std::ostringstream out;
+      out << KeyGenerator::name(keys.distribution);
+      if (keys.distribution == KEYS_ZIPF)
+         out << "(" << keys.theta << ")";
+      out << "/r" << options().readPercent;
+      return out.str();
+   }
+
+   // one case's keys: the ones in the set, ones that are not, and
+   // which of the first to look up in what order
+   template <class Key>
+   struct Workload
+   {
+      Workload(size_t size)
+      {
+         KeyGenerator generator(options().keys, size);
+         keys   = generator.keys<Key>(0, size);
+         misses = generator.keys<Key>(size, size + NUM_LOOKUPS);
+         for (size_t i = 0; i < NUM_LOOKUPS; i++)
+         {
+            lookups.push_back(generator.next());
+            reads.push_back(generator.percent() < options().readPercent);
+         }
+      }
+      std::vector<Key>    keys;     // everything inserted, in insertion order
+      std::vector<Key>    misses;   // never inserted
+      std::vector<size_t> lookups;  // indices into keys
+      std::vector<char>   reads;    // is this lookup a find or a write?
+   };
+
+   // insert, find-hit, find-miss, iterate, mixed, erase and clear one set of each size
+   template <class Set, class Key>
+   void bench_operations(const char * container, const char * key)
+   {
+      for (size_t size : sizes())
+      {  // setup
+         Workload<Key> workload(size);
+         const std::vector<Key> & keys = workload.keys;
+         size_t numLookups = NUM_LOOKUPS;
+         size_t numErase   = std::min(size, (size_t)NUM_LOOKUPS);
+         Set s;
+
+         // insert: this also builds the set for everything else
+         double ns = 0.0;
+         double numBytes = bytes([&]()
+         {
+            ns = time([&]()
+            {
+               for (auto & k : keys)
+                  s.insert(k);
+            });
+         });
+         if (selected("insert"))
+            record("insert", container, key, size, 1, ns, size, numBytes / (double)size);
+
+         // find every key we know is there
+         if (selected("find_hit"))
+         {
+            size_t found = 0;
+            ns = time([&]()
+            {
+               for (size_t i = 0; i < numLookups; i++)
+                  found += (s.find(keys[workload.lookups[i]]) != s.end());
+            });
+            sink() = found;
+            record("find_hit", container, key, size, 1, ns, numLookups);
+         }
+
+         // find keys we know are not there
+         if (selected("find_miss"))
+         {
+            size_t found = 0;
+            ns = time([&]()
+            {
+               for (size_t i = 0; i < numLookups; i++)
+                  found += (s.find(workload.misses[i]) != s.end());
+            });
+            sink() = found;
+            record("find_miss", container, key, size, 1, ns, numLookups);
+         }
+
+         // visit every element once
+         if (selected("iterate"))
+         {
+            size_t sum = 0;
+            ns = time([&]()
+            {
+               for (auto it = s.begin(); it != s.end(); ++it)
+                  sum += weigh(*it);
+            });
+            sink() = sum;
+            record("iterate", container, key, size, 1, ns, size);
+         }
+
+         // finds and writes in the proportion asked for. A write removes
+         // the key if it is there and puts it back if it is not
+         if (selected("mixed"))
+         {
+            size_t found = 0;
+            ns = time([&]()
+            {
+               for (size_t i = 0; i < numLookups; i++)
+               {
+                  const Key & k = keys[workload.lookups[i]];
+                  if (workload.reads[i])
+                     found += (s.find(k) != s.end());
+                  else if (!s.insert(k).second)
+                     s.erase(k);
+               }
+            });
+            sink() = found;
+            record("mixed", container, key, size, 1, ns, numLookups);
+         }
+
+         // remove some of the keys, one at a time
+         if (selected("erase"))
+         {
+            ns = time([&]()
+            {
+               for (size_t i = 0; i < numErase; i++)
+                  s.erase(keys[i]);
+            });
+            record("erase", container, key, size, 1, ns, numErase);
+         }
+
+         // free whatever is left
+         size_t numLeft = s.size();
+         ns = time([&]() { s.clear(); });
+         if (selected("clear"))
+            record("clear", container, key, size, 1, ns, numLeft);
+      }  // teardown
+   }
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // build one set from the same distinct keys with 1 through 32 threads
+   void bench_insertParallel_scaling(size_t numKeys)
+   {
+      if (!selected("insert_parallel"))
+         return;
+
+      // setup
+      std::vector<std::size_t> keys = KeyGenerator(options().keys, numKeys).keys<std::size_t>(0, numKeys);
+
+      for (size_t numThreads : threadCounts())
+      {
+         custom::thread_pool pool(numThreads);
+         custom::unordered_set<std::size_t> us;
+         // exercise
+         double ns = time([&]()
+         {
+            us.insert_parallel(keys.begin(), keys.end(), numThreads, pool);
+         });
+         // verify
+         if (us.size() != numKeys)
+            std::cerr << "\tinsert_parallel lost keys with "
+                      << numThreads << " threads\n";
+         record("insert_parallel", "custom::unordered_set", "size_t",
+                numKeys, numThreads, ns, numKeys);
+      }
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    ***************************************/
+
+   // how long until clear_async() returns and until the pool is done freeing
+   void bench_clearAsync(size_t numKeys)
+   {
+      if (!selected("clear_async"))
+         return;
+
+      // setup
+      std::vector<std::size_t> keys = KeyGenerator(options().keys, numKeys).keys<std::size_t>(0, numKeys);
+
+      for (size_t numThreads : threadCounts())
+      {
+         custom::unordered_set<std::size_t> us;
+         us.insert_parallel(keys.begin(), keys.end(), 10);
+         double nsReturn = 0.0;
+         // exercise
+         double nsTotal = time([&]()
+         {
+            custom::thread_pool pool(numThreads);
+            nsReturn = time([&]() { us.clear_async(pool); });
+         });  // destroying the pool waits for the reclaim
+         record("clear_async_return", "custom::unordered_set", "size_t",
+                numKeys, numThreads, nsReturn, numKeys);
+         record("clear_async_total",  "custom::unordered_set", "size_t",
+                numKeys, numThreads, nsTotal, numKeys);
+      }
+   }  // teardown
+
+   /***************************************
+    * PARALLEL
+    ***************************************/
+
+   // sum every element with 1 through 32 threads
+   void bench_parallelReduce_scaling(size_t numKeys)
+   {
+      if (!selected("parallel_reduce"))
+         return;
+
+      // setup
+      std::vector<std::size_t> keys = KeyGenerator(options().keys, numKeys).keys<std::size_t>(0, numKeys);
+      custom::unordered_set<std::size_t> us;
+      us.insert_parallel(keys.begin(), keys.end(), 10);
+      std::size_t expected = 0;
+      for (std::size_t k : keys)
+         expected += k;
+
+      for (size_t numThreads : threadCounts())
+      {
+         custom::thread_pool pool(numThreads);
+         std::size_t sum = 0;
+         // exercise
+         double ns = time([&]()
+         {
+            sum = us.parallel_reduce(std::size_t(0),
+                                     [](std::size_t& t) { return t; },
+                                     [](std::size_t a, std::size_t b) { return a + b; },
+                                     numThreads, pool);
+         });
+         // verify
+         if (sum != expected)
+            std::cerr << "\tparallel_reduce got the wrong sum with "
+                      << numThreads << " threads\n";
+         record("parallel_reduce", "custom::unordered_set", "size_t",
+                numKeys, numThreads, ns, numKeys);
+      }
+   }  // teardown
+};
@@ -0,0 +1,215 @@
+/***********************************************************************
+ * Header:
+ *    BENCH LIST
+ * Summary:
+ *    Performance benchmarks for list, side by side with std::list.
+ *    Run with --max-size up to 10000000 to see compact() pay off
+ ************************************************************************/
+
+#pragma once
+
+#include "list.h"
+#include "benchmark.h"
+
+#include <list>
+#include <random>
+#include <string>
+#include <vector>
+
+class BenchList : public Benchmark
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Standard operations
+      bench_operations<custom::list<std::size_t>, std::size_t>("custom::list", "size_t");
+      bench_operations<std::list<std::size_t>,    std::size_t>("std::list",    "size_t");
+      bench_operations<custom::list<std::string>, std::string>("custom::list", "string");
+      bench_operations<std::list<std::string>,    std::string>("std::list",    "string");
+
+      // Locality
+      bench_compact<std::size_t>("size_t");
+      bench_compact<std::string>("string");
+
+      report("List");
+   }
+
+   /***************************************
+    * STANDARD OPERATIONS
+    ***************************************/
+
+   // push_back, insert_range, iterate, copy_assign, sort, insert and erase one list of each size
+   template <class List, class Key>
+   void bench_operations(const char * container, const char * key)
+   {
+      for (size_t size : sizes())
+      {  // setup
+         std::vector<Key> keys = makeKeys<Key>(0, size, false);
+         List l;
+
+         // push_back: this also builds the list for everything else
+         double ns = 0.0;
+         double numBytes = bytes([&]()
+         {
+            ns = time([&]()
+            {
+               for (auto & k : keys)
+                  l.push_back(k);
+            });
+         });
+         if (selected("push_back"))
+            record("push_back", container, key, size, 1, ns, size, numBytes / (double)size);
+
+         // the same elements as one range
+         if (selected("insert_range"))
+         {
+            List ranged;
+            numBytes = bytes([&]()
+            {
+               ns = time([&]()
+               {
+                  ranged.insert(ranged.end(), keys.begin(), keys.end());
+               });
+            });
+            record("insert_range", container, key, size, 1, ns, size, numBytes / (double)size);
+         }
+
+         // visit every element once
+         if (selected("iterate"))
+         {
+            size_t sum = 0;
+            ns = time([&]()
+            {
+               for (auto it = l.begin(); it != l.end(); ++it)
+                  sum += weigh(*it);
+            });
+            sink() = sum;
+            record("iterate", container, key, size, 1, ns, size);
+         }
+
+         // copy over a list of the same size, which should reuse every node
+         if (selected("copy_assign"))
+         {
+            List copy(l);
+            ns = time([&]()
+            {
+               copy = l;
+            });
+            record("copy_assign", container, key, size, 1, ns, size);
+         }
+
+         // sort a scrambled list in place
+         if (selected("sort"))
+         {
+            std::vector<Key> scrambled = makeKeys<Key>(0, size);
+            List unsorted(scrambled.begin(), scrambled.end());
+            ns = time([&]()
+            {
+               unsorted.sort();
+            });
+            record("sort", container, key, size, 1, ns, size);
+         }
+
+         // insert one element after the first, once per element
+         if (selected("insert"))
+         {
+            ns = time([&]()
+            {
+               auto it = l.begin();
+               ++it;
+               for (auto & k : keys)
+                  it = l.insert(it, k);
+            });
+            record("insert", container, key, size, 1, ns, size);
+         }
+
+         // erase everything after the first element, one at a time
+         if (selected("erase"))
+         {
+            size_t numErase = l.size() - 1;
+            ns = time([&]()
+            {
+               auto it = l.begin();
+               ++it;
+               while (it != l.end())
+                  it = l.erase(it);
+            });
+            record("erase", container, key, size, 1, ns, numErase);
+         }
+      }  // teardown
+   }
+
+   /***************************************
+    * LOCALITY
+    ***************************************/
+
+   // walk a list churned by random inserts and erases until its nodes are
+   // scattered, compact it, and walk it again
+   template <class Key>
+   void bench_compact(const char * key)
+   {
+      for (size_t size : sizes())
+      {  // setup
+         std::vector<Key> keys = makeKeys<Key>(0, size, false);
+         custom::list<Key> l;
+         std::vector<typename custom::list<Key>::iterator> its;
+         its.reserve(size);
+         for (auto & k : keys)
+         {
+            l.push_back(k);
+            its.push_back(l.rbegin());
+         }
+
+         // erase one element anywhere and insert it again anywhere else, so
+         // list order and address order part ways. Not timed
+         std::mt19937_64 random(size);
+         for (size_t i = 0; i < 2 * size; i++)
+         {
+            size_t iErase = random() % size;
+            size_t iBefore = random() % size;
+            Key k = *its[iErase];
+            l.erase(its[iErase]);
+            if (iBefore == iErase)
+               its[iErase] = l.insert(l.end(), k);
+            else
+               its[iErase] = l.insert(its[iBefore], k);
+         }
+         its.clear();
+
+         // visit every element of the scattered list
+         double ns = 0.0;
+         size_t sum = 0;
+         if (selected("iterate_fragmented"))
+         {
+            ns = time([&]()
+            {
+               for (auto it = l.begin(); it != l.end(); ++it)
+                  sum += weigh(*it);
+            });
+            record("iterate_fragmented", "custom::list", key, size, 1, ns, size);
+         }
+
+         // move every node into one block
+         ns = time([&]()
+         {
+            l.compact();
+         });
+         if (selected("compact"))
+            record("compact", "custom::list", key, size, 1, ns, size);
+
+         // and visit them again
+         if (selected("iterate_compacted"))
+         {
+            ns = time([&]()
+            {
+               for (auto it = l.begin(); it != l.end(); ++it)
+                  sum += weigh(*it);
+            });
+            record("iterate_compacted", "custom::list", key, size, 1, ns, size);
+         }
+         sink() = sum;
+      }  // teardown
+   }
+};
@@ -0,0 +1,134 @@
+/***********************************************************************
+ * Header:
+ *    BENCH LOCK FREE LIST
+ * Summary:
+ *    Performance benchmarks for lock_free_list, side by side with a
+ *    sorted list behind a mutex
+ ************************************************************************/
+
+#pragma once
+
+#include "lockFreeList.h"
+#include "list.h"
+#include "benchmark.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class BenchLockFreeList : public Benchmark
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Contention: searches with a few inserts and erases
+      bench_readMostly_lockFree<custom::epoch_reclaimer>("custom::lock_free_list", options().numKeys);
+      bench_readMostly_lockFree<custom::deferred_reclaimer>("custom::lock_free_list<deferred>", options().numKeys);
+      bench_readMostly_mutex(options().numKeys);
+
+      report("LockFreeList");
+   }
+
+   /***************************************
+    * CONTENTION
+    ***************************************/
+
+   // a list walk is O(n), so the keys come from a range short enough
+   // that the time goes to contention rather than to walking
+   enum { NUM_RANGE = 256 };
+
+   // numThreads threads share numOperations between them: readPercent of
+   // them contains(), the rest split between insert() and erase(), on a
+   // set that starts with every other key in the range
+   template <class Reclaimer>
+   void bench_readMostly_lockFree(const char * container, size_t numOperations)
+   {
+      if (!selected("read_mostly"))
+         return;
+      for (size_t numThreads : threadCounts())
+      {  // setup
+         custom::lock_free_list<std::size_t, std::less<std::size_t>, Reclaimer> l;
+         for (size_t key = 0; key < NUM_RANGE; key += 2)
+            l.insert(key);
+         std::atomic<size_t> numFound(0);
+         // exercise
+         double ns = time([&]()
+         {
+            runWorkers(numThreads, numOperations, [&](size_t key, int op)
+            {
+               if (op == 0)
+                  numFound.fetch_add(l.contains(key) ? 1 : 0, std::memory_order_relaxed);
+               else if (op == 1)
+                  l.insert(key);
+               else
+                  l.erase(key);
+            });
+         });
+         sink() = numFound.load();
+         record("read_mostly", container, "size_t", numOperations, numThreads, ns, numOperations);
+      }  // teardown
+   }
+
+   // the same on a custom::list kept sorted, every operation under one lock
+   void bench_readMostly_mutex(size_t numOperations)
+   {
+      if (!selected("read_mostly"))
+         return;
+      for (size_t numThreads : threadCounts())
+      {  // setup
+         std::mutex m;
+         custom::list<std::size_t> l;
+         for (size_t key = 0; key < NUM_RANGE; key += 2)
+            l.push_back(key);
+         std::atomic<size_t> numFound(0);
+         // exercise
+         double ns = time([&]()
+         {
+            runWorkers(numThreads, numOperations, [&](size_t key, int op)
+            {
+               std::lock_guard<std::mutex> lock(m);
+               auto it = l.begin();
+               while (it != l.end() && *it < key)
+                  ++it;
+               bool found = (it != l.end() && *it == key);
+               if (op == 0)
+                  numFound.fetch_add(found ? 1 : 0, std::memory_order_relaxed);
+               else if (op == 1 && !found)
+                  l.insert(it, key);
+               else if (op == 2 && found)
+                  l.erase(it);
+            });
+         });
+         sink() = numFound.load();
+         record("read_mostly", "std::mutex + custom::list", "size_t", numOperations, numThreads, ns, numOperations);
+      }  // teardown
+   }
+
+   // numThreads threads calling f(key, op) for their share of
+   // numOperations, op being 0 to search, 1 to insert and 2 to erase.
+   // Each thread draws its own keys so they do not share a generator
+   template <class Function>
+   static void runWorkers(size_t numThreads, size_t numOperations, Function f)
+   {
+      size_t readPercent = options().readPercent;
+      std::vector<std::thread> workers;
+      for (size_t iThread = 0; iThread < numThreads; iThread++)
+         workers.push_back(std::thread([=]()
+         {
+            std::uint32_t seed = 2654435761u * (std::uint32_t)(iThread + 1);
+            for (size_t i = numOperations * iThread / numThreads;
+                 i < numOperations * (iThread + 1) / numThreads; i++)
+            {
+               seed = seed * 1103515245 + 12345;
+               size_t key = (seed >> 8) % NUM_RANGE;
+               size_t percent = (seed >> 20) % 100;
+               f(key, percent < readPercent ? 0 : (percent & 1) + 1);
+            }
+         }));
+      for (auto & worker : workers)
+         worker.join();
+   }
+};
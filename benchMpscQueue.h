@@ -0,0 +1,121 @@
+/***********************************************************************
+ * Header:
+ *    BENCH MPSC QUEUE
+ * Summary:
+ *    Performance benchmarks for mpsc_queue, side by side with a list
+ *    behind a mutex
+ ************************************************************************/
+
+#pragma once
+
+#include "mpscQueue.h"
+#include "list.h"
+#include "benchmark.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class BenchMpscQueue : public Benchmark
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Contention: many producers, one consumer
+      bench_produce_lockFree(options().numKeys);
+      bench_produce_mutex(options().numKeys);
+
+      report("MpscQueue");
+   }
+
+   /***************************************
+    * CONTENTION
+    ***************************************/
+
+   // numThreads producers share numPushes between them while this thread
+   // takes everything they push, a batch at a time, until it has it all
+   void bench_produce_lockFree(size_t numPushes)
+   {
+      if (!selected("produce"))
+         return;
+      for (size_t numThreads : threadCounts())
+      {  // setup
+         custom::mpsc_queue<std::size_t> q;
+         size_t sum = 0;
+         // exercise
+         double ns = time([&]()
+         {
+            std::vector<std::thread> producers = startProducers(numThreads, numPushes,
+               [&q](size_t i) { q.push(i); });
+            for (size_t numPopped = 0; numPopped < numPushes; )
+            {
+               custom::list<std::size_t> batch;
+               numPopped += q.pop_all(batch);
+               for (auto it = batch.begin(); it != batch.end(); ++it)
+                  sum += *it;
+            }
+            for (auto & producer : producers)
+               producer.join();
+         });
+         sink() = sum;
+         record("produce", "custom::mpsc_queue", "size_t", numPushes, numThreads, ns, numPushes);
+      }  // teardown
+   }
+
+   // the same with push_back under a lock, and the consumer splicing
+   // everything out under the same lock
+   void bench_produce_mutex(size_t numPushes)
+   {
+      if (!selected("produce"))
+         return;
+      for (size_t numThreads : threadCounts())
+      {  // setup
+         std::mutex m;
+         custom::list<std::size_t> shared;
+         size_t sum = 0;
+         // exercise
+         double ns = time([&]()
+         {
+            std::vector<std::thread> producers = startProducers(numThreads, numPushes,
+               [&m, &shared](size_t i)
+               {
+                  std::lock_guard<std::mutex> lock(m);
+                  shared.push_back(i);
+               });
+            for (size_t numPopped = 0; numPopped < numPushes; )
+            {
+               custom::list<std::size_t> batch;
+               {
+                  std::lock_guard<std::mutex> lock(m);
+                  batch.splice(batch.end(), shared);
+               }
+               numPopped += batch.size();
+               for (auto it = batch.begin(); it != batch.end(); ++it)
+                  sum += *it;
+            }
+            for (auto & producer : producers)
+               producer.join();
+         });
+         sink() = sum;
+         record("produce", "std::mutex + custom::list", "size_t", numPushes, numThreads, ns, numPushes);
+      }  // teardown
+   }
+
+   // numThreads threads calling push(i) for their share of [0, numPushes)
+   template <class Push>
+   static std::vector<std::thread> startProducers(size_t numThreads, size_t numPushes, Push push)
+   {
+      std::vector<std::thread> producers;
+      for (size_t iThread = 0; iThread < numThreads; iThread++)
+         producers.push_back(std::thread([=]()
+         {
+            for (size_t i = numPushes * iThread / numThreads;
+                 i < numPushes * (iThread + 1) / numThreads; i++)
+               push(i);
+         }));
+      return producers;
+   }
+};
@@ -0,0 +1,186 @@
+/***********************************************************************
+ * Header:
+ *    BENCH RECLAIM
+ * Summary:
+ *    Performance benchmarks for the reclaimers: what a guard costs,
+ *    and how long a retired node waits to be freed while readers
+ *    keep coming
+ ************************************************************************/
+
+#pragma once
+
+#include "reclaim.h"
+#include "benchmark.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class BenchReclaim : public Benchmark
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Guards: entering and leaving, with nothing inside
+      bench_guard<custom::epoch_reclaimer>("custom::epoch_reclaimer", options().numKeys);
+      bench_guard<custom::deferred_reclaimer>("custom::deferred_reclaimer", options().numKeys);
+      bench_guard_mutex(options().numKeys);
+
+      // Latency: from retire() to the node being freed
+      bench_reclaimLatency<custom::epoch_reclaimer>("custom::epoch_reclaimer", options().numKeys);
+      bench_reclaimLatency<custom::deferred_reclaimer>("custom::deferred_reclaimer", options().numKeys);
+
+      report("Reclaim");
+   }
+
+   /***************************************
+    * GUARDS
+    ***************************************/
+
+   // numThreads threads share numGuards guards on one reclaimer
+   template <class Reclaimer>
+   void bench_guard(const char * container, size_t numGuards)
+   {
+      if (!selected("guard"))
+         return;
+      for (size_t numThreads : threadCounts())
+      {  // setup
+         Reclaimer r;
+         // exercise
+         double ns = time([&]()
+         {
+            runThreads(numThreads, numGuards, [&r](size_t)
+            {
+               typename Reclaimer::guard g(r);
+            });
+         });
+         record("guard", container, "-", numGuards, numThreads, ns, numGuards);
+      }  // teardown
+   }
+
+   // the lock a reader would take without a reclaimer
+   void bench_guard_mutex(size_t numGuards)
+   {
+      if (!selected("guard"))
+         return;
+      for (size_t numThreads : threadCounts())
+      {  // setup
+         std::mutex m;
+         // exercise
+         double ns = time([&]()
+         {
+            runThreads(numThreads, numGuards, [&m](size_t)
+            {
+               std::lock_guard<std::mutex> lock(m);
+            });
+         });
+         record("guard", "std::mutex", "-", numGuards, numThreads, ns, numGuards);
+      }  // teardown
+   }
+
+   /***************************************
+    * LATENCY
+    ***************************************/
+
+   // a node that knows when it was retired, and adds to the totals when
+   // it is finally freed
+   struct Stamped : public custom::reclaimable
+   {
+      Stamped(size_t value) : reclaimable(&destroy), value(value), retired(0) {}
+      static void destroy(custom::reclaimable * p)
+      {
+         Stamped * pStamped = static_cast<Stamped *>(p);
+         totalWait() += now() - pStamped->retired;
+         numWaiting()--;
+         delete pStamped;
+      }
+      static long long now()
+      {
+         return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+      }
+      static std::atomic<long long> & totalWait()  { static std::atomic<long long> n(0); return n; }
+      static std::atomic<long long> & numWaiting() { static std::atomic<long long> n(0); return n; }
+
+      size_t value;
+      long long retired;
+   };
+
+   // read-heavy: numThreads - 1 readers follow a shared pointer under a
+   // guard while one writer replaces it numRetires times, retiring the old
+   // one. The writer counts as a thread, so thr:1 has no readers at all.
+   // Reported per node is the time from retire() to free; B/elem is the
+   // most garbage waiting at any one time, in bytes per node retired
+   template <class Reclaimer>
+   void bench_reclaimLatency(const char * container, size_t numRetires)
+   {
+      if (!selected("reclaim_latency"))
+         return;
+      for (size_t numThreads : threadCounts())
+      {  // setup
+         Stamped::totalWait() = 0;
+         Stamped::numWaiting() = 0;
+         long long mostWaiting = 0;
+         size_t sum = 0;
+         {
+            Reclaimer r;
+            std::atomic<Stamped *> pShared(new Stamped(0));
+            std::atomic<bool> done(false);
+            // exercise
+            std::vector<std::thread> readers;
+            for (size_t iThread = 1; iThread < numThreads; iThread++)
+               readers.push_back(std::thread([&]()
+               {
+                  size_t local = 0;
+                  while (!done.load(std::memory_order_relaxed))
+                  {
+                     typename Reclaimer::guard g(r);
+                     local += pShared.load(std::memory_order_acquire)->value;
+                  }
+                  sink() = local;
+               }));
+            time([&]()
+            {
+               for (size_t i = 1; i <= numRetires; i++)
+               {
+                  typename Reclaimer::guard g(r);
+                  Stamped * pOld = pShared.exchange(new Stamped(i), std::memory_order_acq_rel);
+                  long long numWaiting = ++Stamped::numWaiting();
+                  if (numWaiting > mostWaiting)
+                     mostWaiting = numWaiting;
+                  pOld->retired = Stamped::now();
+                  sum += pOld->value;
+                  r.retire(pOld);
+               }
+            });
+            done = true;
+            for (auto & reader : readers)
+               reader.join();
+            delete pShared.load();
+         }  // the reclaimer frees whatever is left
+         sink() = sum;
+         record("reclaim_latency", container, "size_t", numRetires, numThreads,
+                (double)Stamped::totalWait().load(), numRetires,
+                (double)(mostWaiting * (long long)sizeof(Stamped)) / (double)numRetires);
+      }  // teardown
+   }
+
+   // numThreads threads calling f(i) for their share of [0, num)
+   template <class Function>
+   static void runThreads(size_t numThreads, size_t num, Function f)
+   {
+      std::vector<std::thread> threads;
+      for (size_t iThread = 0; iThread < numThreads; iThread++)
+         threads.push_back(std::thread([=]()
+         {
+            for (size_t i = num * iThread / numThreads; i < num * (iThread + 1) / numThreads; i++)
+               f(i);
+         }));
+      for (auto & thread : threads)
+         thread.join();
+   }
+};
@@ -0,0 +1,158 @@
+/***********************************************************************
+ * Header:
+ *    BENCH THREAD POOL
+ * Summary:
+ *    Performance benchmarks for the thread pool
+ ************************************************************************/
+
+#pragma once
+
+#include "threadPool.h"
+#include "hash.h"
+#include "benchmark.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+class BenchThreadPool : public Benchmark
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Execute
+      bench_submit_overhead(options().numKeys);
+      bench_parallelFor_overhead(options().numKeys);
+
+      // Load balance
+      bench_skewedBuckets_static(options().numKeys);
+      bench_skewedBuckets_stealing(options().numKeys);
+
+      report("ThreadPool");
+   }
+
+   /***************************************
+    * EXECUTE
+    ***************************************/
+
+   // queue numTasks empty tasks and wait for them all to run
+   void bench_submit_overhead(size_t numTasks)
+   {
+      if (!selected("submit"))
+         return;
+      for (size_t numThreads : threadCounts())
+      {  // setup
+         custom::thread_pool pool(numThreads);
+         std::atomic<size_t> count(0);
+         // exercise
+         double ns = time([&]()
+         {
+            for (size_t i = 0; i < numTasks; i++)
+               pool.submit([&]() { count++; });
+            while (count.load() != numTasks)
+               std::this_thread::yield();
+         });
+         record("submit", "custom::thread_pool", "task", numTasks, numThreads, ns, numTasks);
+      }  // teardown
+   }
+
+   // split numTasks indices into single-index chunks
+   void bench_parallelFor_overhead(size_t numTasks)
+   {
+      if (!selected("parallel_for"))
+         return;
+      for (size_t numThreads : threadCounts())
+      {  // setup
+         custom::thread_pool pool(numThreads);
+         std::atomic<size_t> count(0);
+         // exercise
+         double ns = time([&]()
+         {
+            pool.parallel_for(0, numTasks, 1, [&](size_t, size_t) { count++; });
+         });
+         record("parallel_for", "custom::thread_pool", "task", numTasks, numThreads, ns, numTasks);
+      }  // teardown
+   }
+
+   /***************************************
+    * LOAD BALANCE
+    ***************************************/
+
+   // a set where bucket 0 holds 90% of the elements
+   static void setupSkewedSet(custom::unordered_set<std::size_t> & us, size_t numKeys)
+   {
+      std::vector<std::size_t> keys(numKeys);
+      for (size_t i = 0; i < numKeys; i++)
+         keys[i] = (i % 10 == 0 ? i : i * 10);
+      us.insert_parallel(keys.begin(), keys.end(), 10);
+   }
+
+   // some work proportional to the size of the bucket
+   static size_t visitBucket(custom::unordered_set<std::size_t> & us, size_t iBucket)
+   {
+      size_t sum = 0;
+      for (auto it = us.begin(iBucket); it != us.end(iBucket); ++it)
+         for (int i = 0; i < 64; i++)
+            sum += (*it >> (i % 7)) ^ i;
+      return sum;
+   }
+
+   // each thread gets an equal number of buckets, whatever their size
+   void bench_skewedBuckets_static(size_t numKeys)
+   {
+      if (!selected("skewed_static"))
+         return;
+
+      // setup
+      custom::unordered_set<std::size_t> us;
+      setupSkewedSet(us, numKeys);
+      for (size_t numThreads : threadCounts())
+      {
+         std::atomic<size_t> sum(0);
+         size_t numSlices = (numThreads < us.bucket_count() ? numThreads : us.bucket_count());
+         // exercise
+         double ns = time([&]()
+         {
+            std::vector<std::thread> threads;
+            for (size_t iSlice = 0; iSlice < numSlices; iSlice++)
+               threads.push_back(std::thread([&, iSlice]()
+               {
+                  for (size_t iBucket = us.bucket_count() * iSlice / numSlices;
+                       iBucket < us.bucket_count() * (iSlice + 1) / numSlices; iBucket++)
+                     sum += visitBucket(us, iBucket);
+               }));
+            for (auto & thread : threads)
+               thread.join();
+         });
+         record("skewed_static", "std::thread", "size_t", numKeys, numThreads, ns, numKeys);
+      }
+   }  // teardown
+
+   // every bucket is its own task, so idle workers steal the rest
+   void bench_skewedBuckets_stealing(size_t numKeys)
+   {
+      if (!selected("skewed_stealing"))
+         return;
+
+      // setup
+      custom::unordered_set<std::size_t> us;
+      setupSkewedSet(us, numKeys);
+      for (size_t numThreads : threadCounts())
+      {
+         custom::thread_pool pool(numThreads);
+         std::atomic<size_t> sum(0);
+         // exercise
+         double ns = time([&]()
+         {
+            pool.parallel_for(0, us.bucket_count(), 1, [&](size_t iBegin, size_t iEnd)
+            {
+               for (size_t iBucket = iBegin; iBucket < iEnd; iBucket++)
+                  sum += visitBucket(us, iBucket);
+            });
+         });
+         record("skewed_stealing", "custom::thread_pool", "size_t", numKeys, numThreads, ns, numKeys);
+      }
+   }  // teardown
+};
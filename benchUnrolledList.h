@@ -0,0 +1,104 @@
+/***********************************************************************
+ * Header:
+ *    BENCH UNROLLED LIST
+ * Summary:
+ *    Performance benchmarks for unrolled_list and index_list, side by
+ *    side with list.
+ *    Run with --max-size up to 100000000 to see past the caches
+ ************************************************************************/
+
+#pragma once
+
+#include "unrolledList.h"
+#include "indexList.h"
+#include "list.h"
+#include "benchmark.h"
+
+#include <algorithm>
+#include <vector>
+
+class BenchUnrolledList : public Benchmark
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Append-heavy, scanned often
+      bench_operations<custom::list<std::size_t>>                ("custom::list");
+      bench_operations<custom::unrolled_list<std::size_t>>       ("custom::unrolled_list<256>");
+      bench_operations<custom::unrolled_list<std::size_t, 1024>> ("custom::unrolled_list<1024>");
+      bench_operations<custom::index_list<std::size_t>>          ("custom::index_list");
+
+      report("UnrolledList");
+   }
+
+   /***************************************
+    * OPERATIONS
+    ***************************************/
+
+   // push_back, iterate, insert_middle and erase_middle one list of each size
+   template <class List>
+   void bench_operations(const char * container)
+   {
+      for (size_t size : sizes())
+      {  // setup
+         List l;
+
+         // push_back: this also builds the list for everything else
+         double ns = 0.0;
+         double numBytes = bytes([&]()
+         {
+            ns = time([&]()
+            {
+               for (size_t i = 0; i < size; i++)
+                  l.push_back(i);
+            });
+         });
+         if (selected("push_back"))
+            record("push_back", container, "size_t", size, 1, ns, size, numBytes / (double)size);
+
+         // visit every element once
+         if (selected("iterate"))
+         {
+            size_t sum = 0;
+            ns = time([&]()
+            {
+               for (auto it = l.begin(); it != l.end(); ++it)
+                  sum += *it;
+            });
+            sink() = sum;
+            record("iterate", container, "size_t", size, 1, ns, size);
+         }
+
+         // walking to the middle is not timed, only the inserts there
+         size_t numChanges = std::min(size, (size_t)100000);
+         auto it = l.begin();
+         for (size_t i = 0; i < size / 2; i++)
+            ++it;
+
+         // insert in front of the same element over and over
+         if (selected("insert_middle"))
+         {
+            ns = time([&]()
+            {
+               for (size_t i = 0; i < numChanges; i++)
+                  it = l.insert(it, i);
+            });
+            record("insert_middle", container, "size_t", size, 1, ns, numChanges);
+         }
+
+         // and take them back out
+         if (selected("erase_middle"))
+         {
+            numChanges = std::min(numChanges, l.size() / 2);
+            ns = time([&]()
+            {
+               for (size_t i = 0; i < numChanges; i++)
+                  it = l.erase(it);
+            });
+            record("erase_middle", container, "size_t", size, 1, ns, numChanges);
+         }
+      }  // teardown
+   }
+};
@@ -0,0 +1,253 @@
+/***********************************************************************
+ * Program:
+ *    Benchmark
+ * Summary:
+ *    Driver to measure the performance of hash.h and list.h against
+ *    their std:: equivalents. Build it with "make benchmark".
+ *    Usage:
+ *       benchmark [--min-size N] [--max-size N] [--keys N]
+ *                 [--threads N] [--filter NAME] [--json FILE]
+ *                 [--dist NAME] [--theta X] [--seed N] [--read PERCENT]
+ *                 [--no-counters] [--repeat N] [--min-time SECONDS]
+ *                 [--baseline FILE] [--tolerance PERCENT]
+ *    With --baseline, exits with 1 when a case regressed against
+ *    the results an earlier --json saved in FILE.
+ ************************************************************************/
+
+#include "benchHash.h"       // for the hash benchmarks
+#include "benchList.h"       // for the list benchmarks
+#include "benchUnrolledList.h" // for the unrolled list benchmarks
+#include "benchThreadPool.h" // for the thread pool benchmarks
+#include "benchMpscQueue.h"  // for the mpsc queue benchmarks
+#include "benchLockFreeList.h" // for the lock free list benchmarks
+#include "benchReclaim.h"    // for the reclaimer benchmarks
+#include "regression.h"      // for RegressionGate
+
+#include <algorithm>         // for std::max and std::min
+#include <cassert>           // for assert
+#include <chrono>            // for std::chrono::steady_clock
+#include <cstddef>           // for std::max_align_t
+#include <cstdint>           // for std::uintptr_t
+#include <cstdlib>           // for std::malloc
+#include <cstring>           // for std::strcmp and std::memcpy
+#include <fstream>           // for std::ofstream
+#include <new>               // for std::bad_alloc
+#include <random>            // for std::mt19937
+#include <vector>            // for std::vector
+
+/**********************************************************************
+ * OPERATOR NEW and DELETE
+ * Count every byte so the benchmarks can report bytes per element.
+ * The size hides in front of the block so delete knows how much
+ * is going away.
+ ***********************************************************************/
+static const size_t HEADER = alignof(max_align_t);
+
+void * operator new(size_t size)
+{
+   char * p = static_cast<char *>(std::malloc(size + HEADER));
+   if (!p)
+      throw std::bad_alloc();
+   std::memcpy(p, &size, sizeof(size));
+   Allocations::bytesLive() += size;
+   Allocations::numAlloc()++;
+   return p + HEADER;
+}
+
+void operator delete(void * p) noexcept
+{
+   if (!p)
+      return;
+   // step back through an integer: the compiler only sees the block
+   // it handed out, so it takes the header for out of bounds
+   char * pBlock = reinterpret_cast<char *>(reinterpret_cast<std::uintptr_t>(p) - HEADER);
+   size_t size;
+   std::memcpy(&size, pBlock, sizeof(size));
+   Allocations::bytesLive() -= size;
+   std::free(pBlock);
+}
+
+void * operator new[](size_t size)              { return operator new(size); }
+void   operator delete[](void * p) noexcept     { operator delete(p);        }
+void   operator delete(void * p, size_t) noexcept   { operator delete(p);    }
+void   operator delete[](void * p, size_t) noexcept { operator delete(p);    }
+
+/**********************************************************************
+ * MAIN
+ * Read the options and run every benchmark
+ ***********************************************************************/
+int main(int argc, char ** argv)
+{
+   BenchmarkOptions & options = Benchmark::options();
+   const char * jsonPath = nullptr;
+   const char * baselinePath = nullptr;
+   RegressionOptions regression;
+   size_t repeat = 1;
+   double minTime = 0.0;
+
+   for (int i = 1; i < argc; i++)
+   {
+      bool hasValue = (i + 1 < argc);
+      if      (!std::strcmp(argv[i], "--min-size") && hasValue)
+         options.minSize = std::strtoull(argv[++i], nullptr, 10);
+      else if (!std::strcmp(argv[i], "--max-size") && hasValue)
+         options.maxSize = std::strtoull(argv[++i], nullptr, 10);
+      else if (!std::strcmp(argv[i], "--keys") && hasValue)
+         options.numKeys = std::strtoull(argv[++i], nullptr, 10);
+      else if (!std::strcmp(argv[i], "--threads") && hasValue)
+         options.maxThreads = std::strtoull(argv[++i], nullptr, 10);
+      else if (!std::strcmp(argv[i], "--filter") && hasValue)
+         options.filter = argv[++i];
+      else if (!std::strcmp(argv[i], "--json") && hasValue)
+         jsonPath = argv[++i];
+      else if (!std::strcmp(argv[i], "--dist") && hasValue &&
+               KeyGenerator::parse(argv[i + 1], options.keys.distribution))
+         i++;
+      else if (!std::strcmp(argv[i], "--theta") && hasValue)
+         options.keys.theta = std::strtod(argv[++i], nullptr);
+      else if (!std::strcmp(argv[i], "--seed") && hasValue)
+         options.keys.seed = std::strtoull(argv[++i], nullptr, 10);
+      else if (!std::strcmp(argv[i], "--read") && hasValue)
+         options.readPercent = (unsigned)std::strtoul(argv[++i], nullptr, 10);
+      else if (!std::strcmp(argv[i], "--no-counters"))
+         options.counters = false;
+      else if (!std::strcmp(argv[i], "--repeat") && hasValue)
+         repeat = std::strtoull(argv[++i], nullptr, 10);
+      else if (!std::strcmp(argv[i], "--min-time") && hasValue)
+         minTime = std::strtod(argv[++i], nullptr);
+      else if (!std::strcmp(argv[i], "--baseline") && hasValue)
+         baselinePath = argv[++i];
+      else if (!std::strcmp(argv[i], "--tolerance") && hasValue)
+         regression.tolerance = std::strtod(argv[++i], nullptr) / 100.0;
+      else
+      {
+         std::cerr << "Usage: " << argv[0]
+                   << " [--min-size N] [--max-size N] [--keys N]"
+                   << " [--threads N] [--filter NAME] [--json FILE]\n"
+                   << "                 [--dist NAME] [--theta X] [--seed N] [--read PERCENT]\n"
+                   << "                 [--no-counters] [--repeat N] [--min-time SECONDS]\n"
+                   << "                 [--baseline FILE] [--tolerance PERCENT]\n"
+                   << "Sizes are powers of ten from 10 up to 100000000. Every bucket\n"
+                   << "of custom::unordered_set is a list, so its sizes past 100000\n"
+                   << "take a very long time.\n"
+                   << "The hash benchmarks draw their keys from --dist, one of uniform,\n"
+                   << "zipf, sequential, strided, clustered or colliding, and the mixed\n"
+                   << "case makes --read percent of its operations finds.\n"
+                   << "On Linux, cycles, instructions, branch misses and L1D, LLC\n"
+                   << "and dTLB misses per operation are reported when the kernel\n"
+                   << "allows it. --no-counters turns them off.\n"
+                   << "--repeat runs everything N times and keeps the median of each\n"
+                   << "case, ignoring outliers. --min-time keeps repeating until that\n"
+                   << "many seconds have passed. --baseline compares that against the\n"
+                   << "--json of an earlier run and fails when a case is more than\n"
+                   << "--tolerance percent (default 10) plus noise slower, or makes\n"
+                   << "more allocations per operation. The time of the std::\n"
+                   << "containers never fails: they measure how much slower the machine\n"
+                   << "is, which the limits allow for.\n";
+         return 1;
+      }
+   }
+
+   // only the first run is reported as it goes. However short a case
+   // is, --min-time gives it as many runs as fit
+   if (repeat == 0)
+      repeat = 1;
+   auto start = std::chrono::steady_clock::now();
+   auto seconds = [&start]()
+   {
+      return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+   };
+   // the runs after the first keep only their times and allocations, in
+   // room set aside after the first run. Were every result kept whole,
+   // the heap would creep upward run after run, and where the heap puts
+   // things can be worth 2x to a case
+   size_t numCases = 0;
+   std::vector<double> samples;   // ns then allocs, of every case of every later run
+   size_t run;
+   for (run = 0; run < repeat || seconds() < minTime; run++)
+   {
+      if (run == 1)
+      {
+         std::cerr << "Repeating";
+         if (repeat > 1)
+            std::cerr << " " << repeat - 1 << " more time" << (repeat > 2 ? "s" : "");
+         if (minTime > 0.0)
+            std::cerr << (repeat > 1 ? " and" : "") << " until " << minTime << " seconds have passed";
+         std::cerr << "\n";
+         options.quiet = true;
+      }
+
+      // a layout can still favor or hurt a case for the whole process.
+      // Shift it a different way every run, so the runs of a case see
+      // many layouts and their median does not depend on this process
+      std::vector<char> shift((size_t)std::mt19937(run)() % 65536);
+
+      BenchList().run();
+      BenchUnrolledList().run();
+      BenchHash().run();
+      BenchThreadPool().run();
+      BenchMpscQueue().run();
+      BenchLockFreeList().run();
+      BenchReclaim().run();
+
+      if (run == 0)
+      {
+         numCases = Benchmark::all().size();
+         double numRuns = std::max((double)repeat, minTime / std::max(seconds(), 1e-3) + 2.0);
+         samples.reserve(2 * numCases * (size_t)std::min(numRuns, 1000.0));
+      }
+      else
+      {
+         assert(Benchmark::all().size() == 2 * numCases);
+         for (size_t i = numCases; i < Benchmark::all().size(); i++)
+         {
+            samples.push_back(Benchmark::all()[i].ns);
+            samples.push_back(Benchmark::all()[i].allocs);
+         }
+         Benchmark::all().resize(numCases);
+      }
+   }
+
+   // every run whole again, so they can be summarized
+   if (run > 1)
+   {
+      std::vector<Benchmark::Result> results(Benchmark::all());
+      for (size_t i = 0; i < samples.size(); i += 2)
+      {
+         results.push_back(Benchmark::all()[(i / 2) % numCases]);
+         results.back().ns     = samples[i];
+         results.back().allocs = samples[i + 1];
+      }
+      Benchmark::all() = summarize(results);
+   }
+
+   // "-" means standard out
+   if (jsonPath && !std::strcmp(jsonPath, "-"))
+      std::cout << Benchmark::json();
+   else if (jsonPath)
+      std::ofstream(jsonPath) << Benchmark::json();
+
+   // compare against the baseline
+   if (baselinePath)
+   {
+      std::ifstream in(baselinePath);
+      if (!in)
+      {
+         std::cerr << "ERROR: cannot read the baseline " << baselinePath << "\n";
+         return 2;
+      }
+      RegressionGate gate(regression);
+      try
+      {
+         gate.read(in);
+      }
+      catch (const char * error)
+      {
+         std::cerr << error << " (" << baselinePath << ")\n";
+         return 2;
+      }
+      return gate.compare(Benchmark::all(), std::cerr) ? 0 : 1;
+   }
+
+   return 0;
+}
@@ -0,0 +1,341 @@
+/***********************************************************************
+ * Header:
+ *    BENCHMARK
+ * Summary:
+ *    The base class to all the benchmark classes. Much like UnitTest,
+ *    each benchmark records its results as it runs and reports them
+ *    all at the end. Every result is also kept for the JSON dump.
+ ************************************************************************/
+
+#pragma once
+
+#include <iostream>  // for std::cerr
+#include <iomanip>   // for std::setw
+#include <sstream>   // for std::ostringstream
+#include <string>    // for std::string
+#include <vector>    // for std::vector
+#include <chrono>    // for std::chrono::steady_clock
+#include <atomic>    // for std::atomic
+#include <random>    // for std::mt19937_64
+#include <algorithm> // for std::shuffle
+#include "keyGenerator.h" // for KeyOptions
+#include "perfCounters.h" // for PerfCounters
+
+/*************************************************************
+ * ALLOCATIONS
+ * The driver replaces the global operator new and delete so
+ * a benchmark can see how much memory a container asks for
+ *************************************************************/
+struct Allocations
+{
+   static std::atomic<size_t> & bytesLive() { static std::atomic<size_t> n(0); return n; }
+   static std::atomic<size_t> & numAlloc()  { static std::atomic<size_t> n(0); return n; }
+};
+
+/*************************************************************
+ * BENCHMARK OPTIONS
+ * What the command line asked for
+ *************************************************************/
+struct BenchmarkOptions
+{
+   BenchmarkOptions()
+      : minSize(10), maxSize(100000), numKeys(100000), maxThreads(32),
+        readPercent(90), counters(true), quiet(false) {}
+
+   size_t minSize;      // smallest container
+   size_t maxSize;      // largest container, up to 100M
+   size_t numKeys;      // keys in the parallel benchmarks
+   size_t maxThreads;   // largest thread count to try
+   std::string filter;  // only run cases whose name contains this
+   KeyOptions keys;     // which keys the hash benchmarks use
+   unsigned readPercent;// finds, out of every 100 operations, in the mixed cases
+   bool counters;       // read the hardware performance counters, if we can
+   bool quiet;          // record the results without reporting them
+};
+
+class Benchmark
+{
+public:
+   Benchmark() { reset(); }
+
+   // a result is one timed run of one case
+   struct Result
+   {
+      std::string suite;       // which benchmark class
+      std::string name;        // which operation
+      std::string container;   // custom::list, std::list, ...
+      std::string key;         // the element type
+      std::string workload;    // key distribution and read mix, if they apply
+      size_t      size;        // elements in the container
+      size_t      numThreads;  // threads doing the work
+      size_t      numOps;      // operations timed
+      double      ns;          // total time
+      double      bytes;       // bytes per element, or zero if not measured
+      PerfReading perf;        // hardware counters for all numOps, if available
+      double      allocs  = 0.0;  // calls to new during all numOps
+      double      nsMad   = 0.0;  // median absolute deviation of ns over the runs
+      double      allocsMad = 0.0; // and of allocs, which threads make wander
+      size_t      numRuns = 1;    // runs summarized into this one
+   };
+
+   // everything every benchmark has recorded
+   static std::vector<Result> & all()
+   {
+      static std::vector<Result> results;
+      return results;
+   }
+
+   // what the command line asked for
+   static BenchmarkOptions & options()
+   {
+      static BenchmarkOptions options;
+      return options;
+   }
+
+   /*************************************************************
+    * JSON
+    * Every result as one array of objects
+    *************************************************************/
+   static std::string json()
+   {
+      std::ostringstream out;
+      out << "[\n";
+      for (size_t i = 0; i < all().size(); i++)
+      {
+         const Result & result = all()[i];
+         out << "  {\"suite\":\""     << result.suite
+             << "\",\"name\":\""      << result.name
+             << "\",\"container\":\"" << result.container
+             << "\",\"key\":\""       << result.key
+             << "\",\"workload\":\""  << result.workload
+             << "\",\"size\":"        << result.size
+             << ",\"threads\":"       << result.numThreads
+             << ",\"ops\":"           << result.numOps
+             << ",\"ns_per_op\":"     << result.ns / (double)result.numOps
+             << ",\"bytes_per_element\":" << result.bytes
+             << ",\"allocs_per_op\":" << result.allocs / (double)result.numOps
+             << ",\"mad_ns_per_op\":" << result.nsMad / (double)result.numOps
+             << ",\"mad_allocs_per_op\":" << result.allocsMad / (double)result.numOps
+             << ",\"runs\":"         << result.numRuns;
+         for (int event = 0; event < PERF_NUM_EVENTS; event++)
+            if (result.perf.valid[event])
+               out << ",\"" << PerfCounters::name(event) << "_per_op\":"
+                   << result.perf.count[event] / (double)result.numOps;
+         out << "}" << (i + 1 < all().size() ? ",\n" : "\n");
+      }
+      out << "]\n";
+      return out.str();
+   }
+
+private:
+   std::vector<Result> results;
+
+protected:
+   std::string workload;    // copied into every result recorded from now on
+
+   /*************************************************************
+    * RESET
+    * Forget all the results
+    *************************************************************/
+   void reset()
+   {
+      results.clear();
+      workload.clear();
+   }
+
+   /*************************************************************
+    * SELECTED
+    * Should this case run at all?
+    *************************************************************/
+   static bool selected(const char * name)
+   {
+      return options().filter.empty() ||
+             std::string(name).find(options().filter) != std::string::npos;
+   }
+
+   /*************************************************************
+    * SIZES
+    * Every power of ten between the smallest and largest size
+    *************************************************************/
+   static std::vector<size_t> sizes()
+   {
+      std::vector<size_t> sizes;
+      for (size_t size = 10; size <= options().maxSize; size *= 10)
+         if (size >= options().minSize)
+            sizes.push_back(size);
+      return sizes;
+   }
+
+   /*************************************************************
+    * THREAD COUNTS
+    * Powers of two up to the most threads we may use
+    *************************************************************/
+   static std::vector<size_t> threadCounts()
+   {
+      std::vector<size_t> counts;
+      for (size_t numThreads = 1; numThreads <= options().maxThreads; numThreads *= 2)
+         counts.push_back(numThreads);
+      return counts;
+   }
+
+   /*************************************************************
+    * MAKE KEYS
+    * The keys [begin, end) as integers or as strings, optionally
+    * in a repeatable random order
+    *************************************************************/
+   static void makeKey(size_t i, std::size_t & key) { key = i; }
+   static void makeKey(size_t i, std::string & key) { key = "key:" + std::to_string(i); }
+   template <class Key>
+   static std::vector<Key> makeKeys(size_t begin, size_t end, bool shuffle = true)
+   {
+      std::vector<Key> keys(end - begin);
+      for (size_t i = begin; i < end; i++)
+         makeKey(i, keys[i - begin]);
+      if (shuffle)
+         std::shuffle(keys.begin(), keys.end(), std::mt19937_64(end));
+      return keys;
+   }
+
+   // something the optimizer cannot see through
+   static size_t weigh(std::size_t key)         { return key;        }
+   static size_t weigh(const std::string & key) { return key.size(); }
+   static volatile size_t & sink() { static volatile size_t sink = 0; return sink; }
+
+   /*************************************************************
+    * PERF
+    * The hardware counters, opened the first time they are wanted.
+    * The reading is from the outermost time() to finish
+    *************************************************************/
+   static PerfCounters & perf()
+   {
+      static PerfCounters counters;
+      static bool warned = false;
+      if (!counters.available() && !warned)
+      {
+         std::cerr << "Hardware counters unavailable (" << counters.error()
+                   << "), reporting time only\n";
+         warned = true;
+      }
+      return counters;
+   }
+   static PerfReading & lastReading() { static PerfReading reading; return reading; }
+   static size_t & lastAllocs()       { static size_t allocs = 0;   return allocs;  }
+   static int & timeDepth()           { static int depth = 0;       return depth;   }
+
+   /*************************************************************
+    * TIME
+    * Run the passed function once and return how long it took
+    * in nanoseconds. The hardware counters and the allocation
+    * count run alongside
+    *************************************************************/
+   template <class Function>
+   static double time(Function function)
+   {
+      bool outermost = (timeDepth()++ == 0);
+      bool count = (outermost && options().counters && perf().available());
+      if (count)
+         perf().start();
+      size_t numAlloc = Allocations::numAlloc();
+      auto start = std::chrono::steady_clock::now();
+      function();
+      auto finish = std::chrono::steady_clock::now();
+      if (outermost)
+         lastAllocs() = Allocations::numAlloc() - numAlloc;
+      if (count)
+         lastReading() = perf().stop();
+      timeDepth()--;
+      return std::chrono::duration<double, std::nano>(finish - start).count();
+   }
+
+   /*************************************************************
+    * BYTES
+    * Run the passed function once and return how many more bytes
+    * are allocated afterwards than before
+    *************************************************************/
+   template <class Function>
+   static double bytes(Function function)
+   {
+      size_t before = Allocations::bytesLive();
+      function();
+      size_t after = Allocations::bytesLive();
+      return (double)after - (double)before;
+   }
+
+   /*************************************************************
+    * RECORD
+    * Remember one result so it can be reported later, along with
+    * the counters and allocations from the most recent time()
+    *************************************************************/
+   void record(const char * name, const char * container, const char * key,
+               size_t size, size_t numThreads, double ns, size_t numOps,
+               double bytesPerElement = 0.0)
+   {
+      Result result;
+      result.name       = name;
+      result.container  = container;
+      result.key        = key;
+      result.workload   = workload;
+      result.size       = size;
+      result.numThreads = numThreads;
+      result.numOps     = (numOps ? numOps : 1);
+      result.ns         = ns;
+      result.bytes      = bytesPerElement;
+      result.perf       = lastReading();
+      result.allocs     = (double)lastAllocs();
+      results.push_back(result);
+      lastReading() = PerfReading();
+      lastAllocs()  = 0;
+   }
+
+   // column headings for the hardware counters
+   static const char * shortName(int event)
+   {
+      static const char * names[PERF_NUM_EVENTS] = { "cyc", "ins", "brmiss", "L1D", "LLC", "dTLB" };
+      return names[event];
+   }
+
+   /*************************************************************
+    * REPORT
+    * Keep every result for the JSON, then display them along with
+    * the speedup relative to the single threaded run of the same case
+    *************************************************************/
+   void report(const char * suite)
+   {
+      for (auto & result : results)
+      {
+         all().push_back(result);
+         all().back().suite = suite;
+      }
+      if (options().quiet)
+         return;
+
+      std::cerr << suite << ":\n";
+      std::cerr.setf(std::ios::fixed | std::ios::showpoint);
+      std::cerr.precision(2);
+      for (auto & result : results)
+      {
+         double nsSerial = result.ns;
+         for (auto & serial : results)
+            if (serial.name == result.name && serial.container == result.container &&
+                serial.key == result.key && serial.size == result.size &&
+                serial.numThreads == 1)
+               nsSerial = serial.ns;
+
+         std::cerr << "\t" << std::setw(20) << std::left << result.name
+                   << " "        << std::setw(20) << result.container
+                   << " "        << std::setw(7)  << result.key
+                   << (result.workload.empty() ? "" : " ") << std::setw(result.workload.empty() ? 0 : 16) << result.workload
+                   << " size:"   << std::setw(10) << result.size
+                   << " thr:"    << std::setw(3)  << result.numThreads
+                   << " ns/op:"  << std::setw(12) << result.ns / (double)result.numOps
+                   << " B/elem:" << std::setw(8)  << result.bytes
+                   << " allocs/op:" << std::setw(6) << result.allocs / (double)result.numOps
+                   << " speedup:" << nsSerial / result.ns;
+         for (int event = 0; event < PERF_NUM_EVENTS; event++)
+            if (result.perf.valid[event])
+               std::cerr << " " << shortName(event) << "/op:"
+                         << result.perf.count[event] / (double)result.numOps;
+         std::cerr << "\n";
+      }
+   }
+};
@@ -0,0 +1,491 @@
+/***********************************************************************
+ * Header:
+ *    FORWARD LIST
+ * Summary:
+ *    A singly linked list, just like std::forward_list. Each node
+ *    carries one pointer instead of two, and there is no tail to
+ *    keep up to date, so everything is done after a position
+ *    rather than in front of it. before_begin() is the position
+ *    in front of the first element.
+ *
+ *    This will contain the class definition of:
+ *        forward_list           : A class that represents a singly linked list
+ *        forward_list::iterator : An iterator through a forward list
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>     // for ASSERT
+#include <cstddef>     // for size_t
+#include <initializer_list> // for std::initializer_list
+#include <utility>     // for std::move and std::forward
+
+namespace custom
+{
+
+/**************************************************
+ * FORWARD LIST
+ * Just like std::forward_list, but it knows its size
+ **************************************************/
+template <typename T>
+class forward_list
+{
+public:
+   //
+   // Construct
+   //
+
+   forward_list() : numElements(0) { head.pNext = nullptr; }
+   forward_list(const forward_list & rhs);
+   forward_list(forward_list && rhs);
+   forward_list(const std::initializer_list<T> & il);
+   template <class Iterator>
+   forward_list(Iterator first, Iterator last);
+  ~forward_list()
+   {
+      clear();
+   }
+
+   //
+   // Assign
+   //
+
+   forward_list & operator = (const forward_list & rhs);
+   forward_list & operator = (forward_list && rhs);
+   forward_list & operator = (const std::initializer_list<T> & il);
+   void swap(forward_list & rhs);
+
+   //
+   // Iterator
+   //
+
+   class iterator;
+   iterator before_begin() { return iterator(&head);       }
+   iterator begin()        { return iterator(head.pNext);  }
+   iterator end()          { return iterator(nullptr);     }
+
+   //
+   // Access
+   //
+
+   T & front();
+
+   //
+   // Insert
+   //
+
+   void push_front(const T &  data) { emplace_after(before_begin(), data);            }
+   void push_front(      T && data) { emplace_after(before_begin(), std::move(data)); }
+   template <class ... Args>
+   void emplace_front(Args && ... args) { emplace_after(before_begin(), std::forward<Args>(args)...); }
+   iterator insert_after(iterator it, const T &  data) { return emplace_after(it, data);            }
+   iterator insert_after(iterator it,       T && data) { return emplace_after(it, std::move(data)); }
+   template <class ... Args>
+   iterator emplace_after(iterator it, Args && ... args);
+
+   //
+   // Remove
+   //
+
+   void pop_front();
+   void clear();
+   iterator erase_after(iterator it);
+   iterator erase_after(iterator first, iterator last);
+
+   //
+   // Operations: these relink the nodes we have, never new or copy one
+   //
+
+   void splice_after(iterator pos, forward_list & rhs);
+   void splice_after(iterator pos, forward_list & rhs, iterator it);
+   void splice_after(iterator pos, forward_list & rhs, iterator first, iterator last);
+
+   //
+   // Status
+   //
+
+   bool empty()  const { return numElements == 0; }
+   size_t size() const { return numElements; }
+   static size_t node_size();   // bytes per element
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   // the link alone, which is all before_begin() needs
+   struct Link
+   {
+      Link * pNext;
+   };
+   // a link with an element
+   struct Node : public Link
+   {
+      template <class ... Args>
+      Node(Args && ... args) : data(std::forward<Args>(args)...) { this->pNext = nullptr; }
+      T data;
+   };
+
+   // member variables
+   size_t numElements; // number of elements
+   Link head;          // head.pNext is the first node
+
+   // move the nodes after pBefore up to and including pLast in after pPos
+   void transfer(Link * pPos, forward_list & rhs, Link * pBefore, Link * pLast, size_t num);
+};
+
+/*************************************************
+ * FORWARD LIST ITERATOR
+ * A link, which is a node everywhere but before_begin()
+ *************************************************/
+template <typename T>
+class forward_list <T> :: iterator
+{
+   friend class forward_list <T>;
+public:
+   // constructors, destructors, and assignment operator
+   iterator() : p(nullptr) {}
+   iterator(Link * p) : p(p) {}
+
+   // equals, not equals operator
+   bool operator == (const iterator & rhs) const { return rhs.p == p; }
+   bool operator != (const iterator & rhs) const { return rhs.p != p; }
+
+   // dereference operator, fetch a node
+   T & operator * ()
+   {
+      if (p)
+         return static_cast<Node *>(p)->data;
+      else
+         throw "ERROR: Trying to dereference a nullptr pointer";
+   }
+
+   // prefix increment
+   iterator & operator ++ ()
+   {
+      if (p)
+         p = p->pNext;
+      return *this;
+   }
+
+   // postfix increment
+   iterator operator ++ (int postfix)
+   {
+      iterator old(*this);
+      if (p)
+         p = p->pNext;
+      return old;
+   }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   Link * p;
+};
+
+/*****************************************
+ * FORWARD LIST :: NODE SIZE
+ * what one element costs on the heap
+ ****************************************/
+template <typename T>
+size_t forward_list <T> :: node_size()
+{
+   return sizeof(Node);
+}
+
+/*****************************************
+ * FORWARD LIST :: COPY constructors
+ * Build the copy from the front, always appending
+ * after the last node made
+ ****************************************/
+template <typename T>
+forward_list <T> :: forward_list(const forward_list & rhs)
+   : forward_list()
+{
+   try
+   {
+      iterator itLast = before_begin();
+      for (Link * p = rhs.head.pNext; p; p = p->pNext)
+         itLast = insert_after(itLast, static_cast<Node *>(p)->data);
+   }
+   catch (...)
+   {
+      clear();
+      throw;
+   }
+}
+
+template <typename T>
+forward_list <T> :: forward_list(const std::initializer_list<T> & il)
+   : forward_list(il.begin(), il.end())
+{
+}
+
+template <typename T>
+template <class Iterator>
+forward_list <T> :: forward_list(Iterator first, Iterator last)
+   : forward_list()
+{
+   try
+   {
+      iterator itLast = before_begin();
+      for (; first != last; ++first)
+         itLast = insert_after(itLast, *first);
+   }
+   catch (...)
+   {
+      clear();
+      throw;
+   }
+}
+
+/*****************************************
+ * FORWARD LIST :: MOVE constructor
+ * Take the nodes of rhs
+ ****************************************/
+template <typename T>
+forward_list <T> :: forward_list(forward_list && rhs)
+   : numElements(rhs.numElements)
+{
+   head.pNext = rhs.head.pNext;
+   rhs.head.pNext = nullptr;
+   rhs.numElements = 0;
+}
+
+/*****************************************
+ * FORWARD LIST :: ASSIGNMENT
+ * Copies are made to the side first, so a throwing copy leaves
+ * this list as it was
+ ****************************************/
+template <typename T>
+forward_list <T> & forward_list <T> :: operator = (const forward_list & rhs)
+{
+   if (this != &rhs)
+   {
+      forward_list copy(rhs);
+      swap(copy);
+   }
+   return *this;
+}
+
+template <typename T>
+forward_list <T> & forward_list <T> :: operator = (forward_list && rhs)
+{
+   if (this != &rhs)
+   {
+      clear();
+      swap(rhs);
+   }
+   return *this;
+}
+
+template <typename T>
+forward_list <T> & forward_list <T> :: operator = (const std::initializer_list<T> & il)
+{
+   forward_list copy(il);
+   swap(copy);
+   return *this;
+}
+
+/*****************************************
+ * FORWARD LIST :: SWAP
+ ****************************************/
+template <typename T>
+void forward_list <T> :: swap(forward_list & rhs)
+{
+   std::swap(numElements, rhs.numElements);
+   std::swap(head.pNext, rhs.head.pNext);
+}
+
+template <typename T>
+void swap(forward_list <T> & lhs, forward_list <T> & rhs)
+{
+   lhs.swap(rhs);
+}
+
+/*****************************************
+ * FORWARD LIST :: FRONT
+ ****************************************/
+template <typename T>
+T & forward_list <T> :: front()
+{
+   if (empty())
+      throw "ERROR: unable to access data from an empty list";
+   return static_cast<Node *>(head.pNext)->data;
+}
+
+/******************************************
+ * FORWARD LIST :: EMPLACE AFTER
+ * build an item right after it
+ *     INPUT  : the position to go after, which may be before_begin()
+ *              whatever T's constructor takes
+ *     OUTPUT : iterator to the new item
+ *     COST   : O(1)
+ ******************************************/
+template <typename T>
+template <class ... Args>
+typename forward_list <T> :: iterator
+forward_list <T> :: emplace_after(iterator it, Args && ... args)
+{
+   assert(it.p != nullptr);
+
+   Node * pNew;
+   try
+   {
+      pNew = new Node(std::forward<Args>(args)...);
+   }
+   catch (...)
+   {
+      throw "ERROR: unable to allocate a new node for a forward list";
+   }
+
+   pNew->pNext = it.p->pNext;
+   it.p->pNext = pNew;
+   numElements++;
+   return iterator(pNew);
+}
+
+/******************************************
+ * FORWARD LIST :: ERASE AFTER
+ * remove the item after it
+ *     INPUT  : the position in front of the one to erase
+ *     OUTPUT : iterator to the item after the erased one
+ *     COST   : O(1)
+ ******************************************/
+template <typename T>
+typename forward_list <T> :: iterator forward_list <T> :: erase_after(iterator it)
+{
+   if (it.p == nullptr || it.p->pNext == nullptr)
+      return end();
+
+   Node * pErase = static_cast<Node *>(it.p->pNext);
+   it.p->pNext = pErase->pNext;
+   delete pErase;
+   numElements--;
+   return iterator(it.p->pNext);
+}
+
+/******************************************
+ * FORWARD LIST :: ERASE AFTER
+ * remove every item between first and last, exclusive
+ *     OUTPUT : last
+ *     COST   : O(last - first)
+ ******************************************/
+template <typename T>
+typename forward_list <T> :: iterator forward_list <T> :: erase_after(iterator first, iterator last)
+{
+   while (first.p && first.p->pNext != last.p)
+      erase_after(first);
+   return last;
+}
+
+/******************************************
+ * FORWARD LIST :: POP FRONT
+ * nothing happens to an empty list
+ ******************************************/
+template <typename T>
+void forward_list <T> :: pop_front()
+{
+   erase_after(before_begin());
+}
+
+/******************************************
+ * FORWARD LIST :: CLEAR
+ ******************************************/
+template <typename T>
+void forward_list <T> :: clear()
+{
+   while (head.pNext)
+   {
+      Node * pErase = static_cast<Node *>(head.pNext);
+      head.pNext = pErase->pNext;
+      delete pErase;
+   }
+   numElements = 0;
+}
+
+/******************************************
+ * FORWARD LIST :: SPLICE AFTER
+ * move every node of rhs in after pos
+ *     OUTPUT : rhs is empty
+ *     COST   : O(size of rhs) to find its last node
+ ******************************************/
+template <typename T>
+void forward_list <T> :: splice_after(iterator pos, forward_list & rhs)
+{
+   if (&rhs == this || rhs.empty())
+      return;
+
+   Link * pLast = rhs.head.pNext;
+   while (pLast->pNext)
+      pLast = pLast->pNext;
+   transfer(pos.p, rhs, &rhs.head, pLast, rhs.numElements);
+}
+
+/******************************************
+ * FORWARD LIST :: SPLICE AFTER
+ * move the one node after it in rhs in after pos. rhs
+ * may be this list
+ *     COST   : O(1)
+ ******************************************/
+template <typename T>
+void forward_list <T> :: splice_after(iterator pos, forward_list & rhs, iterator it)
+{
+   assert(it.p != nullptr);
+
+   // nothing there, or already right there
+   Link * pMove = it.p->pNext;
+   if (pMove == nullptr || pos.p == it.p || pos.p == pMove)
+      return;
+   transfer(pos.p, rhs, it.p, pMove, 1);
+}
+
+/******************************************
+ * FORWARD LIST :: SPLICE AFTER
+ * move the nodes between first and last, exclusive, of
+ * rhs in after pos. rhs may be this list as long as pos
+ * is not one of them
+ *     COST   : O(last - first) to find the last one moved
+ ******************************************/
+template <typename T>
+void forward_list <T> :: splice_after(iterator pos, forward_list & rhs,
+                                      iterator first, iterator last)
+{
+   assert(first.p != nullptr);
+   if (first.p->pNext == last.p || pos.p == first.p)
+      return;
+
+   size_t num = 1;
+   Link * pLast = first.p->pNext;
+   for (; pLast->pNext != last.p; pLast = pLast->pNext)
+      num++;
+   transfer(pos.p, rhs, first.p, pLast, num);
+}
+
+/******************************************
+ * FORWARD LIST :: TRANSFER
+ * unhook the nodes after pBefore through pLast from rhs
+ * and hook them in after pPos. Within one list num is
+ * ignored since the size does not change
+ ******************************************/
+template <typename T>
+void forward_list <T> :: transfer(Link * pPos, forward_list & rhs,
+                                  Link * pBefore, Link * pLast, size_t num)
+{
+   assert(pPos != nullptr && pBefore != nullptr && pLast != nullptr);
+
+   Link * pFirst = pBefore->pNext;
+   pBefore->pNext = pLast->pNext;
+   pLast->pNext = pPos->pNext;
+   pPos->pNext = pFirst;
+
+   if (&rhs != this)
+   {
+      rhs.numElements -= num;
+      numElements += num;
+   }
+}
+
+} // namespace custom
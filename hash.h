@@ -13,6 +13,7 @@
  *    This will contain the class definition of:
  *        unordered_set           : A class that represents a hash
  *        unordered_set::iterator : An interator through hash
+ *        unordered_set::range    : A view of some of the buckets
  * Author
  *    <your names here>
  ************************************************************************/
@@ -20,9 +21,18 @@
 #pragma once
 
 #include "list.h"     // because this->buckets[0] is a list
+#include "pair.h"     // for custom::pair returned by insert
+#include "threadPool.h" // for thread_pool::global()
+#include "hashStats.h"  // for hash_stats
+#include "trace.h"      // for trace_recorder
+#include "latencyHistogram.h" // for INSTRUMENT
 #include <memory>     // for std::allocator
 #include <functional> // for std::hash
 #include <cmath>      // for std::ceil
+#include <vector>     // for std::vector
+#include <iterator>   // for std::distance
+#include <algorithm>  // for std::stable_sort
+#include <utility>    // for std::pair
 
 namespace custom
 {
@@ -34,6 +44,8 @@ namespace custom
     class unordered_set
     {
     public:
+        typedef T value_type;
+
         //
         // Construct
         //
@@ -53,6 +65,7 @@ namespace custom
         }
         template <class Iterator>
         unordered_set(Iterator first, Iterator last)
+            : buckets(), numElements(0)
         {
             for(first; first != last; first++)
             {
@@ -73,8 +86,9 @@ namespace custom
         unordered_set& operator=(unordered_set&& rhs)
         {
             for (int i = 0; i < 10; i++)
-                buckets[i] = rhs.buckets[i];
-            numElements = (std::move(rhs.numElements));
+                buckets[i] = std::move(rhs.buckets[i]);
+            numElements = rhs.numElements;
+            rhs.numElements = 0;
             return *this;
         }
         unordered_set& operator=(const std::initializer_list<T>& il)
@@ -83,15 +97,10 @@ namespace custom
         }
         void swap(unordered_set& rhs)
         {
-            custom::list<T> tempBuckets[10];
+            // trade the buckets' pointers, never their nodes
             for (int i = 0; i < 10; i++)
-                tempBuckets[i] = buckets[i];
-            for (int j = 0; j < 10; j++)
-                buckets[j] = rhs.buckets[j];
-            for (int k = 0; k < 10; k++)
-                rhs.buckets[k] = tempBuckets[k];
+                custom::swap(buckets[i], rhs.buckets[i]);
 
-            // this isn't as streamlined as using list, but list is rather constraining
             size_t temp = numElements;
             numElements = rhs.numElements;
             rhs.numElements = temp;
@@ -111,7 +120,7 @@ namespace custom
                     return iterator(buckets + i, buckets + 10, buckets[i].begin());
                 }
             }
-            return iterator();
+            return end();
         }
         iterator end()//all buckets
         {
@@ -125,13 +134,19 @@ namespace custom
         {
             return local_iterator(buckets[iBucket].end());
         }
+        class range;
+        range bucket_range(size_t iBucketBegin, size_t iBucketEnd)//some buckets
+        {
+            return range(this, iBucketBegin, iBucketEnd);
+        }
 
         //
         // Access
         //
-        size_t bucket(const T& t) //returns index of bucket containing T
+        size_t bucket(const T& t) const //returns index of bucket containing T
         {
-            return numElements = t;
+            HASH_COUNT(numHash);
+            return std::hash<T>()(t) % bucket_count();
         }
         iterator find(const T& t);
 
@@ -140,6 +155,10 @@ namespace custom
         //
         custom::pair<iterator, bool> insert(const T& t);
         void insert(const std::initializer_list<T>& il);
+        template <class RandomIterator>
+        void insert_parallel(RandomIterator first, RandomIterator last,
+                             size_t numThreads,
+                             thread_pool& pool = thread_pool::global());
 
 
         // 
@@ -147,12 +166,18 @@ namespace custom
         //
         void clear() noexcept
         {
+            INSTRUMENT(INSTRUMENT_UNORDERED_SET, INSTRUMENT_CLEAR);
+#ifdef HASH_TRACE
+            if (pTrace)
+                pTrace->record(TRACE_CLEAR, 0);
+#endif // HASH_TRACE
             for (int i = 0; i < 10; i++)
             {
                 buckets[i].clear();
             }
             numElements = 0;
         }
+        void clear_async(thread_pool& pool = thread_pool::global());
         iterator erase(const T& t);
 
         //
@@ -179,6 +204,25 @@ namespace custom
         {
             return buckets[i].size();
         }
+        hash_stats stats() const;
+#ifdef HASH_TRACE
+        void trace(trace_recorder* pTrace) // start recording, or stop with nullptr
+        {
+            this->pTrace = pTrace;
+        }
+#endif // HASH_TRACE
+
+        //
+        // Parallel
+        //
+        template <class Function>
+        void parallel_for_each(Function function,
+                               size_t numThreads = thread_pool::global().size(),
+                               thread_pool& pool = thread_pool::global());
+        template <class U, class Map, class Combine>
+        U parallel_reduce(U init, Map map, Combine combine,
+                          size_t numThreads = thread_pool::global().size(),
+                          thread_pool& pool = thread_pool::global());
 
 
 #ifdef DEBUG // make this visible to the unit tests
@@ -189,6 +233,12 @@ namespace custom
 
         custom::list<T> buckets[10];   // exactly 10 buckets
         size_t numElements;                // number of elements in the Hash
+#ifdef HASH_COUNTERS
+        mutable hash_counters counters;    // work done by find(), for stats()
+#endif // HASH_COUNTERS
+#ifdef HASH_TRACE
+        trace_recorder* pTrace = nullptr;  // where operations are recorded, if anywhere
+#endif // HASH_TRACE
     };
 
 
@@ -255,16 +305,14 @@ namespace custom
         iterator& operator ++ ();
         iterator operator ++ (int postfix)
         {
-            if (itList++ == nullptr)
-            {
-                if (pBucket != pBucketEnd)
-                {
-                    pBucket++;
-                }
-            }
-            return *this;
+            iterator itReturn = *this;
+            ++(*this);
+            return itReturn;
         }
 
+        // erase() needs to know which bucket we are in
+        friend class unordered_set<T>;
+
 #ifdef DEBUG // make this visible to the unit tests
     public:
 #else
@@ -353,6 +401,129 @@ namespace custom
     };
 
 
+    /************************************************
+     * UNORDERED SET RANGE
+     * A view of the buckets [begin_bucket, end_bucket) so the
+     * work can be split up and handed to different threads
+     ************************************************/
+    template <typename T>
+    class unordered_set <T> ::range
+    {
+    public:
+        // 
+        // Construct
+        //
+        range()
+            : pSet(nullptr), iBucketBegin(0), iBucketEnd(0)
+        {
+        }
+        range(unordered_set* pSet, size_t iBucketBegin, size_t iBucketEnd)
+            : pSet(pSet), iBucketBegin(iBucketBegin), iBucketEnd(iBucketEnd)
+        {
+        }
+
+        // 
+        // Access
+        //
+        size_t begin_bucket() const { return iBucketBegin; }
+        size_t end_bucket()   const { return iBucketEnd;   }
+        local_iterator begin(size_t iBucket) { return pSet->begin(iBucket); }
+        local_iterator end(size_t iBucket)   { return pSet->end(iBucket);   }
+
+        //
+        // Status
+        //
+        size_t bucket_count() const { return iBucketEnd - iBucketBegin; }
+        bool empty() const          { return iBucketBegin == iBucketEnd; }
+        bool is_divisible() const   { return bucket_count() > 1;         }
+
+        //
+        // Split: hand back the second half, keeping the first
+        //
+        range split()
+        {
+            size_t iBucketMiddle = iBucketBegin + bucket_count() / 2;
+            range rhs(pSet, iBucketMiddle, iBucketEnd);
+            iBucketEnd = iBucketMiddle;
+            return rhs;
+        }
+
+        //
+        // Visit every element in these buckets
+        //
+        template <class Function>
+        void for_each(Function function)
+        {
+            for (size_t iBucket = iBucketBegin; iBucket < iBucketEnd; iBucket++)
+                for (local_iterator it = begin(iBucket); it != end(iBucket); ++it)
+                    function(*it);
+        }
+
+#ifdef DEBUG // make this visible to the unit tests
+    public:
+#else
+    private:
+#endif
+        unordered_set* pSet;  // the set we are viewing
+        size_t iBucketBegin;  // first bucket in the view
+        size_t iBucketEnd;    // one past the last bucket in the view
+    };
+
+    /*****************************************
+     * UNORDERED SET :: PARALLEL FOR EACH
+     * Call function(t) on every element. The buckets are split into
+     * one range per thread, so function must be safe to call
+     * concurrently on different elements
+     ****************************************/
+    template <typename T>
+    template <class Function>
+    void unordered_set<T>::parallel_for_each(Function function, size_t numThreads,
+                                             thread_pool& pool)
+    {
+        parallel_reduce(0, [&](T& t) { function(t); return 0; },
+                           [](int, int) { return 0; },
+                        numThreads, pool);
+    }
+
+    /*****************************************
+     * UNORDERED SET :: PARALLEL REDUCE
+     * Fold every element into a single value: the buckets are split into
+     * numThreads ranges for the pool, each bucket is folded starting
+     * from init, then the partial results are combined in bucket order.
+     * Therefore combine must be associative and init must be its identity
+     ****************************************/
+    template <typename T>
+    template <class U, class Map, class Combine>
+    U unordered_set<T>::parallel_reduce(U init, Map map, Combine combine, size_t numThreads,
+                                        thread_pool& pool)
+    {
+        size_t numBuckets = bucket_count();
+        if (numThreads == 0)
+            numThreads = 1;
+        if (numThreads > numBuckets)
+            numThreads = numBuckets;
+
+        // one partial result per bucket so they can be combined in order.
+        // They are wrapped so std::vector<bool> cannot pack them into shared words
+        struct Partial { U value; };
+        std::vector<Partial> partial(numBuckets, Partial{init});
+        pool.parallel_for(0, numBuckets, (numBuckets + numThreads - 1) / numThreads,
+            [&](size_t iBucketBegin, size_t iBucketEnd)
+            {
+                for (size_t iBucket = iBucketBegin; iBucket < iBucketEnd; iBucket++)
+                {
+                    U value = init;
+                    bucket_range(iBucket, iBucket + 1).for_each([&](T& t) { value = combine(value, map(t)); });
+                    partial[iBucket].value = value;
+                }
+            });
+
+        U value = init;
+        for (auto& part : partial)
+            value = combine(value, part.value);
+        return value;
+    }
+
     /*****************************************
      * UNORDERED SET :: ERASE
      * Remove one element from the unordered set
@@ -360,7 +531,72 @@ namespace custom
     template <typename T>
     typename unordered_set <T> ::iterator unordered_set<T>::erase(const T& t)
     {
-        return iterator();
+        INSTRUMENT(INSTRUMENT_UNORDERED_SET, INSTRUMENT_ERASE);
+        HASH_TRACE_OP(TRACE_ERASE, t);
+
+        // nothing to do if it is not here. This does not call find()
+        // so a trace does not see a find for every erase
+        size_t iBucket = bucket(t);
+        auto itList = buckets[iBucket].begin();
+        while (itList != buckets[iBucket].end() && !(*itList == t))
+            ++itList;
+        if (itList == buckets[iBucket].end())
+            return end();
+        iterator itErase(buckets + iBucket, buckets + 10, itList);
+
+        // remember what comes next before the node goes away
+        iterator itReturn = itErase;
+        ++itReturn;
+
+        itErase.pBucket->erase(itErase.itList);
+        numElements--;
+        return itReturn;
+    }
+
+    /*****************************************
+     * UNORDERED SET :: CLEAR ASYNC
+     * Empty the set without waiting for the nodes to be freed. The
+     * buckets are swapped into storage handed to the pool in O(1), and
+     * the pool frees them one bucket per task. Destroying the pool waits
+     * for the reclaim to finish. The elements are destroyed on the pool's
+     * threads, so ~T must be safe to run there. It is timed and traced
+     * as one clear, like clear()
+     ****************************************/
+    template <typename T>
+    void unordered_set<T>::clear_async(thread_pool& pool)
+    {
+        INSTRUMENT(INSTRUMENT_UNORDERED_SET, INSTRUMENT_CLEAR);
+#ifdef HASH_TRACE
+        if (pTrace)
+            pTrace->record(TRACE_CLEAR, 0);
+#endif // HASH_TRACE
+        custom::list<T>* pReclaim;
+        try
+        {
+            pReclaim = new custom::list<T>[10];
+        }
+        catch (...)
+        {
+            // no room to defer the work, so do it now
+            for (int i = 0; i < 10; i++)
+                buckets[i].clear();
+            numElements = 0;
+            return;
+        }
+
+        for (int i = 0; i < 10; i++)
+            custom::swap(pReclaim[i], buckets[i]);
+        numElements = 0;
+
+        pool.submit([pReclaim, &pool]()
+        {
+            pool.parallel_for(0, 10, 1, [pReclaim](size_t iBegin, size_t iEnd)
+            {
+                for (size_t i = iBegin; i < iEnd; i++)
+                    pReclaim[i].clear();
+            });
+            delete [] pReclaim;
+        });
     }
 
     /*****************************************
@@ -370,11 +606,146 @@ namespace custom
     template <typename T>
     custom::pair<typename custom::unordered_set<T>::iterator, bool> unordered_set<T>::insert(const T& t)
     {
-        return custom::pair<custom::unordered_set<T>::iterator, bool>(iterator(), true);
+        INSTRUMENT(INSTRUMENT_UNORDERED_SET, INSTRUMENT_INSERT);
+        HASH_TRACE_OP(TRACE_INSERT, t);
+
+        // if it is already here, hand back the one we have
+        size_t iBucket = bucket(t);
+        for (auto it = buckets[iBucket].begin(); it != buckets[iBucket].end(); ++it)
+            if (*it == t)
+                return custom::pair<iterator, bool>(iterator(buckets + iBucket, buckets + 10, it), false);
+
+        // otherwise it goes on the end of its bucket
+        buckets[iBucket].push_back(t);
+        numElements++;
+        return custom::pair<iterator, bool>(iterator(buckets + iBucket, buckets + 10, buckets[iBucket].rbegin()), true);
     }
     template <typename T>
     void unordered_set<T>::insert(const std::initializer_list<T>& il)
     {
+        for (auto it = il.begin(); it != il.end(); ++it)
+            insert(*it);
+    }
+
+    /*****************************************
+     * UNORDERED SET :: INSERT PARALLEL
+     * Bulk load a range of elements on a thread pool. This
+     * happens in two passes:
+     *    1. The input is cut into numThreads pieces. Each piece is hashed
+     *       and sorted by bucket into a staging area only it writes to
+     *    2. Each bucket is filled by one task from every piece's staging
+     *       area, so idle workers steal the remaining buckets. What is
+     *       staged for a bucket is sorted by hash, so finding duplicates
+     *       only compares elements with the same hash
+     * Since no two tasks ever touch the same bucket, no locks are needed.
+     * The input must stay alive until we return: we stage pointers, not copies.
+     * If an element cannot be copied, the buckets keep what they got so far
+     ****************************************/
+    template <typename T>
+    template <class RandomIterator>
+    void unordered_set<T>::insert_parallel(RandomIterator first, RandomIterator last,
+                                           size_t numThreads, thread_pool& pool)
+    {
+        size_t num = std::distance(first, last);
+        if (num == 0)
+            return;
+#ifdef HASH_TRACE
+        for (RandomIterator it = first; pTrace && it != last; ++it)
+            HASH_TRACE_OP(TRACE_INSERT, *it);
+#endif // HASH_TRACE
+        if (numThreads == 0)
+            numThreads = 1;
+        if (numThreads > num)
+            numThreads = num;
+
+        // staging[iPiece * bucket_count() + iBucket] is written only by the
+        // task handling that piece of the input. Every element is staged
+        // with its hash so pass 2 need not hash it again
+        typedef std::pair<size_t, const T*> Staged;
+        size_t numBuckets = bucket_count();
+        std::vector<std::vector<Staged>> staging(numThreads * numBuckets);
+
+        // pass 1: partition the input by bucket
+        pool.parallel_for(0, numThreads, 1, [&](size_t iPieceBegin, size_t iPieceEnd)
+        {
+            for (size_t iPiece = iPieceBegin; iPiece < iPieceEnd; iPiece++)
+                for (size_t i = num * iPiece / numThreads; i < num * (iPiece + 1) / numThreads; i++)
+                {
+                    const T& t = *(first + i);
+                    HASH_COUNT(numHash);
+                    size_t hash = std::hash<T>()(t);
+                    staging[iPiece * numBuckets + hash % numBuckets].push_back(Staged(hash, &t));
+                }
+        });
+
+        // pass 2: each bucket is filled by exactly one task
+        try
+        {
+            pool.parallel_for(0, numBuckets, 1, [&](size_t iBucketBegin, size_t iBucketEnd)
+            {
+                for (size_t iBucket = iBucketBegin; iBucket < iBucketEnd; iBucket++)
+                {
+                    // what the bucket already has, then what is staged for it
+                    // in input order
+                    std::vector<Staged> candidates;
+                    for (auto it = buckets[iBucket].begin(); it != buckets[iBucket].end(); ++it)
+                    {
+                        HASH_COUNT(numHash);
+                        candidates.push_back(Staged(std::hash<T>()(*it), &*it));
+                    }
+                    size_t numOld = candidates.size();
+                    for (size_t iPiece = 0; iPiece < numThreads; iPiece++)
+                        candidates.insert(candidates.end(),
+                                          staging[iPiece * numBuckets + iBucket].begin(),
+                                          staging[iPiece * numBuckets + iBucket].end());
+                    if (candidates.size() == numOld)
+                        continue;
+
+                    // sorted by hash, a duplicate can only be in the run with
+                    // the same hash. The sort is stable, so what was already
+                    // here and then what came first in the input is kept
+                    std::vector<size_t> order(candidates.size());
+                    for (size_t i = 0; i < order.size(); i++)
+                        order[i] = i;
+                    std::stable_sort(order.begin(), order.end(), [&candidates](size_t lhs, size_t rhs)
+                    {
+                        return candidates[lhs].first < candidates[rhs].first;
+                    });
+                    std::vector<bool> keep(candidates.size(), false);
+                    for (size_t iRun = 0, iEnd = 0; iRun < order.size(); iRun = iEnd)
+                    {
+                        while (iEnd < order.size() &&
+                               candidates[order[iEnd]].first == candidates[order[iRun]].first)
+                            iEnd++;
+                        for (size_t i = iRun; i < iEnd; i++)
+                        {
+                            bool found = false;
+                            for (size_t j = iRun; !found && j < i; j++)
+                                found = keep[order[j]] &&
+                                        *candidates[order[j]].second == *candidates[order[i]].second;
+                            keep[order[i]] = !found;
+                        }
+                    }
+
+                    for (size_t i = numOld; i < candidates.size(); i++)
+                        if (keep[i])
+                            buckets[iBucket].push_back(*candidates[i].second);
+                }
+            });
+        }
+        catch (...)
+        {
+            // whatever the buckets got before the throw is in the set
+            numElements = 0;
+            for (size_t iBucket = 0; iBucket < numBuckets; iBucket++)
+                numElements += buckets[iBucket].size();
+            throw;
+        }
+
+        // each task only touched its own buckets, so count them afterwards
+        numElements = 0;
+        for (size_t iBucket = 0; iBucket < numBuckets; iBucket++)
+            numElements += buckets[iBucket].size();
     }
 
     /*****************************************
@@ -384,7 +755,55 @@ namespace custom
     template <typename T>
     typename unordered_set <T> ::iterator unordered_set<T>::find(const T& t)
     {
-        return iterator();
+        INSTRUMENT(INSTRUMENT_UNORDERED_SET, INSTRUMENT_FIND);
+        HASH_COUNT(numFind);
+        HASH_TRACE_OP(TRACE_FIND, t);
+        size_t iBucket = bucket(t);
+        for (auto it = buckets[iBucket].begin(); it != buckets[iBucket].end(); ++it)
+        {
+            HASH_COUNT(numEquals);
+            if (*it == t)
+                return iterator(buckets + iBucket, buckets + 10, it);
+        }
+        return end();
+    }
+
+    /*****************************************
+     * UNORDERED SET :: STATS
+     * Walk the buckets once to describe the shape of the hash
+     ****************************************/
+    template <typename T>
+    hash_stats unordered_set<T>::stats() const
+    {
+        hash_stats stats = {};
+        stats.numElements = numElements;
+        stats.numBuckets  = bucket_count();
+        stats.loadFactor  = (double)numElements / (double)bucket_count();
+
+        size_t numEmpty = 0;
+        for (size_t i = 0; i < bucket_count(); i++)
+        {
+            size_t size = bucket_size(i);
+            if (size > stats.maxChain)
+                stats.maxChain = size;
+            if (size == 0)
+                numEmpty++;
+            stats.histogram[size < hash_stats::NUM_HISTOGRAM - 1 ? size : hash_stats::NUM_HISTOGRAM - 1]++;
+        }
+        stats.meanChain        = (numEmpty == bucket_count() ? 0.0 :
+                                  (double)numElements / (double)(bucket_count() - numEmpty));
+        stats.emptyBucketRatio = (double)numEmpty / (double)bucket_count();
+        stats.bytesBuckets     = sizeof(buckets);
+        stats.bytesNodes       = numElements * custom::list<T>::node_size();
+        stats.numRehash        = 0; // the ten buckets are never rebuilt
+
+#ifdef HASH_COUNTERS
+        stats.hasCounters = true;
+        stats.numFind     = counters.numFind;
+        stats.numEquals   = counters.numEquals;
+        stats.numHash     = counters.numHash;
+#endif // HASH_COUNTERS
+        return stats;
     }
 
     /*****************************************
@@ -394,13 +813,16 @@ namespace custom
     template <typename T>
     typename unordered_set <T> ::iterator& unordered_set<T>::iterator::operator ++ ()
     {
-        if (itList.p != nullptr)
-        {
-            itList++;
-        }
-        if (itList.p == nullptr && (pBucket != pBucketEnd))
+        // the next element in this bucket
+        if (pBucket != pBucketEnd)
+            ++itList;
+
+        // past the end of this bucket, so find the next one with something in it
+        while (pBucket != pBucketEnd && itList == pBucket->end())
         {
             pBucket++;
+            if (pBucket != pBucketEnd)
+                itList = pBucket->begin();
         }
         return *this;
     }
@@ -412,7 +834,6 @@ namespace custom
     template <typename T>
     void swap(unordered_set<T>& lhs, unordered_set<T>& rhs)
     {
-        std::swap(lhs.numElements, rhs.numElements);
-        std::swap(lhs.buckets, rhs.buckets);
+        lhs.swap(rhs);
     }
 }
@@ -0,0 +1,149 @@
+/***********************************************************************
+ * Header:
+ *    HASH STATS
+ * Summary:
+ *    What an unordered_set looks like on the inside, so a bad hash
+ *    function can be spotted without writing a loop over bucket_size()
+ *
+ *    This will contain the class definition of:
+ *        hash_stats    : A snapshot returned by unordered_set::stats()
+ *        hash_counters : Per-operation counters, only when HASH_COUNTERS
+ *                        is defined
+ ************************************************************************/
+
+#pragma once
+
+#include <atomic>     // for std::atomic
+#include <sstream>    // for std::ostringstream
+#include <string>     // for std::string
+
+namespace custom
+{
+
+/************************************************
+ * HASH COUNTERS
+ * Counts the work done by find(). These are atomic so
+ * insert_parallel() can count too; copying a set does not copy them
+ ************************************************/
+struct hash_counters
+{
+   hash_counters() : numFind(0), numEquals(0), numHash(0) {}
+   hash_counters(const hash_counters &) : hash_counters() {}
+   hash_counters & operator = (const hash_counters &) { return *this; }
+
+   std::atomic<size_t> numFind;   // calls to find()
+   std::atomic<size_t> numEquals; // T::operator== calls made by find(), one per node visited
+   std::atomic<size_t> numHash;   // std::hash<T> calls, from anywhere
+};
+
+#ifdef HASH_COUNTERS
+#define HASH_COUNT(counter) (counters.counter.fetch_add(1, std::memory_order_relaxed))
+#else
+#define HASH_COUNT(counter)
+#endif // HASH_COUNTERS
+
+/************************************************
+ * HASH STATS
+ * A snapshot of the shape of an unordered set
+ ************************************************/
+struct hash_stats
+{
+   enum { NUM_HISTOGRAM = 17 }; // chains of 0..15, then 16 or more
+
+   size_t numElements;          // size()
+   size_t numBuckets;           // bucket_count()
+   double loadFactor;           // elements per bucket
+   size_t maxChain;             // the longest bucket
+   double meanChain;            // mean length of the non-empty buckets
+   double emptyBucketRatio;     // fraction of buckets with nothing in them
+   size_t histogram[NUM_HISTOGRAM]; // number of buckets of each length
+   size_t bytesBuckets;         // the bucket array itself
+   size_t bytesNodes;           // every node hanging off the buckets
+   size_t numRehash;            // times the bucket array was rebuilt
+
+   // only filled in when HASH_COUNTERS is defined
+   bool   hasCounters;
+   size_t numFind;
+   size_t numEquals;
+   size_t numHash;
+};
+
+/*****************************************************
+ * TO JSON
+ * One object, histogram as an array
+ ****************************************************/
+inline std::string to_json(const hash_stats & stats)
+{
+   std::ostringstream out;
+   out << "{\"elements\":"           << stats.numElements
+       << ",\"buckets\":"            << stats.numBuckets
+       << ",\"load_factor\":"        << stats.loadFactor
+       << ",\"max_chain\":"          << stats.maxChain
+       << ",\"mean_chain\":"         << stats.meanChain
+       << ",\"empty_bucket_ratio\":" << stats.emptyBucketRatio
+       << ",\"histogram\":[";
+   for (int i = 0; i < hash_stats::NUM_HISTOGRAM; i++)
+      out << (i ? "," : "") << stats.histogram[i];
+   out << "],\"bytes_buckets\":"     << stats.bytesBuckets
+       << ",\"bytes_nodes\":"        << stats.bytesNodes
+       << ",\"rehash_count\":"       << stats.numRehash;
+   if (stats.hasCounters)
+      out << ",\"finds\":"           << stats.numFind
+          << ",\"equals\":"          << stats.numEquals
+          << ",\"hashes\":"          << stats.numHash;
+   out << "}";
+   return out.str();
+}
+
+/*****************************************************
+ * TO PROMETHEUS
+ * The text exposition format, every metric starting with prefix.
+ * The chain lengths become a cumulative histogram
+ ****************************************************/
+inline std::string to_prometheus(const hash_stats & stats,
+                                 const std::string & prefix = "custom_unordered_set")
+{
+   std::ostringstream out;
+   auto gauge = [&](const char * name, double value)
+   {
+      out << "# TYPE " << prefix << "_" << name << " gauge\n"
+          << prefix << "_" << name << " " << value << "\n";
+   };
+   auto counter = [&](const char * name, size_t value)
+   {
+      out << "# TYPE " << prefix << "_" << name << " counter\n"
+          << prefix << "_" << name << " " << value << "\n";
+   };
+
+   gauge("elements",           (double)stats.numElements);
+   gauge("buckets",            (double)stats.numBuckets);
+   gauge("load_factor",        stats.loadFactor);
+   gauge("max_chain",          (double)stats.maxChain);
+   gauge("mean_chain",         stats.meanChain);
+   gauge("empty_bucket_ratio", stats.emptyBucketRatio);
+   gauge("bytes_buckets",      (double)stats.bytesBuckets);
+   gauge("bytes_nodes",        (double)stats.bytesNodes);
+   counter("rehash_total",     stats.numRehash);
+
+   out << "# TYPE " << prefix << "_chain_length histogram\n";
+   size_t cumulative = 0;
+   for (int i = 0; i < hash_stats::NUM_HISTOGRAM - 1; i++)
+   {
+      cumulative += stats.histogram[i];
+      out << prefix << "_chain_length_bucket{le=\"" << i << "\"} " << cumulative << "\n";
+   }
+   cumulative += stats.histogram[hash_stats::NUM_HISTOGRAM - 1];
+   out << prefix << "_chain_length_bucket{le=\"+Inf\"} " << cumulative << "\n"
+       << prefix << "_chain_length_sum "   << stats.numElements << "\n"
+       << prefix << "_chain_length_count " << stats.numBuckets  << "\n";
+
+   if (stats.hasCounters)
+   {
+      counter("finds_total",  stats.numFind);
+      counter("equals_total", stats.numEquals);
+      counter("hashes_total", stats.numHash);
+   }
+   return out.str();
+}
+
+}; // namespace custom
@@ -0,0 +1,674 @@
+/***********************************************************************
+ * Header:
+ *    INDEX LIST
+ * Summary:
+ *    A doubly linked list whose nodes all live in one growable array
+ *    and link to each other by 32-bit index rather than by pointer.
+ *    On a 64-bit machine that halves what the links cost, keeps the
+ *    nodes near each other, and, since nothing points into the
+ *    array, lets it be moved or written out with one memcpy when T
+ *    is trivially copyable.
+ *
+ *    Erased nodes go on a free list, threaded through their own next
+ *    index, and are handed out again before the array grows. The
+ *    array never shrinks until the list is destroyed. Since an
+ *    iterator is an index, growing does not invalidate iterators;
+ *    only erasing the element itself does.
+ *
+ *    This will contain the class definition of:
+ *        index_list           : A class that represents an index list
+ *        index_list::iterator : An iterator through an index list
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>     // for ASSERT
+#include <cstddef>     // for size_t
+#include <cstdint>     // for std::uint32_t
+#include <cstring>     // for std::memcpy
+#include <initializer_list> // for std::initializer_list
+#include <limits>      // for std::numeric_limits
+#include <new>         // for placement new
+#include <type_traits> // for std::aligned_storage and std::is_trivially_copyable
+#include <utility>     // for std::move, std::move_if_noexcept and std::forward
+
+namespace custom
+{
+
+/**************************************************
+ * INDEX LIST
+ * Like std::list, with every node in one array
+ **************************************************/
+template <typename T, typename Index = std::uint32_t>
+class index_list
+{
+public:
+   //
+   // Construct
+   //
+
+   index_list() : numElements(0), numSlots(0), numCapacity(0), slots(nullptr),
+                  iHead(NIL), iTail(NIL), iFree(NIL) {}
+   index_list(const index_list & rhs);
+   index_list(index_list && rhs);
+   index_list(const std::initializer_list<T> & il);
+   template <class Iterator>
+   index_list(Iterator first, Iterator last);
+  ~index_list()
+   {
+      clear();
+      delete [] slots;
+   }
+
+   //
+   // Assign
+   //
+
+   index_list & operator = (const index_list & rhs);
+   index_list & operator = (index_list && rhs);
+   index_list & operator = (const std::initializer_list<T> & il);
+   void swap(index_list & rhs);
+
+   //
+   // Iterator
+   //
+
+   class iterator;
+   iterator begin() { return iterator(this, iHead); }
+   iterator end()   { return iterator(this, NIL);   }
+
+   //
+   // Access
+   //
+
+   T & front();
+   T & back();
+
+   //
+   // Insert
+   //
+
+   void push_front(const T &  data) { emplace(begin(), data);            }
+   void push_front(      T && data) { emplace(begin(), std::move(data)); }
+   void push_back (const T &  data) { emplace(end(),   data);            }
+   void push_back (      T && data) { emplace(end(),   std::move(data)); }
+   iterator insert(iterator it, const T &  data) { return emplace(it, data);            }
+   iterator insert(iterator it,       T && data) { return emplace(it, std::move(data)); }
+   template <class ... Args>
+   void emplace_front(Args && ... args) { emplace(begin(), std::forward<Args>(args)...); }
+   template <class ... Args>
+   void emplace_back (Args && ... args) { emplace(end(),   std::forward<Args>(args)...); }
+   template <class ... Args>
+   iterator emplace(iterator it, Args && ... args);
+
+   //
+   // Remove
+   //
+
+   void pop_back();
+   void pop_front();
+   void clear();
+   iterator erase(const iterator & it);
+
+   //
+   // Status
+   //
+
+   bool empty()  const { return numElements == 0; }
+   size_t size() const { return numElements; }
+   size_t capacity() const { return numCapacity; }
+   void reserve(size_t num);
+
+   // bytes per element, links included
+   struct Slot;
+   static size_t node_size() { return sizeof(Slot); }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   // the index that means "no node": the end, or the end of the free list
+   static constexpr Index NIL = std::numeric_limits<Index>::max();
+
+   // member variables
+   size_t numElements;  // number of elements
+   size_t numSlots;     // slots [0, numSlots) have been handed out at least once
+   size_t numCapacity;  // slots allocated
+   Slot * slots;        // every node
+   Index iHead;         // the first node
+   Index iTail;         // the last node
+   Index iFree;         // the most recently erased slot, which links to the next
+
+   Index acquire();                       // a slot from the free list or the array
+   void release(Index i);                 // onto the free list
+   size_t grown() const;                  // how big the array is to be next
+   static Slot * allocate(size_t num);
+   void grow(size_t num);                 // reallocate the array, keeping every index
+   void relocate(Slot * pDest, std::true_type  trivial);
+   void relocate(Slot * pDest, std::false_type trivial);
+   void copyFrom(const index_list & rhs, std::true_type  trivial);
+   void copyFrom(const index_list & rhs, std::false_type trivial);
+};
+
+template <typename T, typename Index>
+constexpr Index index_list <T, Index> :: NIL;
+
+/*************************************************
+ * SLOT
+ * One node: the element, when there is one, and
+ * the indices of its neighbors
+ *************************************************/
+template <typename T, typename Index>
+struct index_list <T, Index> :: Slot
+{
+   T & data() { return *reinterpret_cast<T *>(&storage); }
+   const T & data() const { return *reinterpret_cast<const T *>(&storage); }
+
+   typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+   Index iNext;   // the next node, or the next free slot
+   Index iPrev;   // the previous node
+};
+
+/*************************************************
+ * INDEX LIST ITERATOR
+ * The list and a slot in it. end() is NIL
+ *************************************************/
+template <typename T, typename Index>
+class index_list <T, Index> :: iterator
+{
+   friend class index_list <T, Index>;
+public:
+   // constructors, destructors, and assignment operator
+   iterator() : pList(nullptr), i(NIL) {}
+   iterator(index_list * pList, Index i) : pList(pList), i(i) {}
+
+   // equals, not equals operator
+   bool operator == (const iterator & rhs) const { return i == rhs.i; }
+   bool operator != (const iterator & rhs) const { return i != rhs.i; }
+
+   // dereference operator, fetch an element
+   T & operator * ()
+   {
+      if (pList && i != NIL)
+         return pList->slots[i].data();
+      else
+         throw "ERROR: Trying to dereference a nullptr pointer";
+   }
+
+   // prefix increment
+   iterator & operator ++ ()
+   {
+      if (i != NIL)
+         i = pList->slots[i].iNext;
+      return *this;
+   }
+
+   // postfix increment
+   iterator operator ++ (int postfix)
+   {
+      iterator old(*this);
+      ++(*this);
+      return old;
+   }
+
+   // prefix decrement: from the end goes to the last node
+   iterator & operator -- ()
+   {
+      if (pList)
+         i = (i == NIL ? pList->iTail : pList->slots[i].iPrev);
+      return *this;
+   }
+
+   // postfix decrement
+   iterator operator -- (int postfix)
+   {
+      iterator old(*this);
+      --(*this);
+      return old;
+   }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   index_list * pList;
+   Index i;
+};
+
+/*****************************************
+ * INDEX LIST :: COPY constructors
+ * A copy keeps every index, so the free list
+ * comes along too
+ ****************************************/
+template <typename T, typename Index>
+index_list <T, Index> :: index_list(const index_list & rhs)
+   : index_list()
+{
+   if (rhs.numSlots == 0)
+      return;
+   grow(rhs.numSlots);
+   copyFrom(rhs, typename std::is_trivially_copyable<T>::type());
+}
+
+template <typename T, typename Index>
+index_list <T, Index> :: index_list(const std::initializer_list<T> & il)
+   : index_list(il.begin(), il.end())
+{
+}
+
+template <typename T, typename Index>
+template <class Iterator>
+index_list <T, Index> :: index_list(Iterator first, Iterator last)
+   : index_list()
+{
+   for (; first != last; ++first)
+      push_back(*first);
+}
+
+/*****************************************
+ * INDEX LIST :: MOVE constructor
+ * Take the array of rhs
+ ****************************************/
+template <typename T, typename Index>
+index_list <T, Index> :: index_list(index_list && rhs)
+   : index_list()
+{
+   swap(rhs);
+}
+
+/*****************************************
+ * INDEX LIST :: ASSIGNMENT
+ * Copies are made to the side first, so a throwing copy leaves
+ * this list as it was
+ ****************************************/
+template <typename T, typename Index>
+index_list <T, Index> & index_list <T, Index> :: operator = (const index_list & rhs)
+{
+   if (this != &rhs)
+   {
+      index_list copy(rhs);
+      swap(copy);
+   }
+   return *this;
+}
+
+template <typename T, typename Index>
+index_list <T, Index> & index_list <T, Index> :: operator = (index_list && rhs)
+{
+   if (this != &rhs)
+   {
+      index_list empty;
+      swap(empty);
+      swap(rhs);
+   }
+   return *this;
+}
+
+template <typename T, typename Index>
+index_list <T, Index> & index_list <T, Index> :: operator = (const std::initializer_list<T> & il)
+{
+   index_list copy(il);
+   swap(copy);
+   return *this;
+}
+
+/*****************************************
+ * INDEX LIST :: SWAP
+ ****************************************/
+template <typename T, typename Index>
+void index_list <T, Index> :: swap(index_list & rhs)
+{
+   std::swap(numElements, rhs.numElements);
+   std::swap(numSlots,    rhs.numSlots);
+   std::swap(numCapacity, rhs.numCapacity);
+   std::swap(slots,       rhs.slots);
+   std::swap(iHead,       rhs.iHead);
+   std::swap(iTail,       rhs.iTail);
+   std::swap(iFree,       rhs.iFree);
+}
+
+template <typename T, typename Index>
+void swap(index_list <T, Index> & lhs, index_list <T, Index> & rhs)
+{
+   lhs.swap(rhs);
+}
+
+/*****************************************
+ * INDEX LIST :: FRONT and BACK
+ ****************************************/
+template <typename T, typename Index>
+T & index_list <T, Index> :: front()
+{
+   if (empty())
+      throw "ERROR: unable to access data from an empty list";
+   return slots[iHead].data();
+}
+
+template <typename T, typename Index>
+T & index_list <T, Index> :: back()
+{
+   if (empty())
+      throw "ERROR: unable to access data from an empty list";
+   return slots[iTail].data();
+}
+
+/******************************************
+ * INDEX LIST :: EMPLACE
+ * build an item in front of it
+ *     INPUT  : an iterator to the location where it is to be inserted
+ *              whatever T's constructor takes
+ *     OUTPUT : iterator to the new item
+ *     COST   : O(1), amortized over the array doubling
+ ******************************************/
+template <typename T, typename Index>
+template <class ... Args>
+typename index_list <T, Index> :: iterator
+index_list <T, Index> :: emplace(iterator it, Args && ... args)
+{
+   Index iNew;
+   if (iFree == NIL && numSlots == numCapacity)
+   {
+      // the arguments may be in the old array, so build the new element
+      // before the others move out of it
+      size_t numGrow = grown();
+      Slot * pNew = allocate(numGrow);
+      iNew = (Index)numSlots;
+      try
+      {
+         new (&pNew[iNew].storage) T(std::forward<Args>(args)...);
+      }
+      catch (...)
+      {
+         delete [] pNew;
+         throw;
+      }
+      try
+      {
+         relocate(pNew, typename std::is_trivially_copyable<T>::type());
+      }
+      catch (...)
+      {
+         pNew[iNew].data().~T();
+         delete [] pNew;
+         throw;
+      }
+      delete [] slots;
+      slots = pNew;
+      numCapacity = numGrow;
+      numSlots++;
+   }
+   else
+   {
+      iNew = acquire();
+      try
+      {
+         new (&slots[iNew].storage) T(std::forward<Args>(args)...);
+      }
+      catch (...)
+      {
+         release(iNew);
+         throw;
+      }
+   }
+
+   Index iBefore = (it.i == NIL ? iTail : slots[it.i].iPrev);
+   slots[iNew].iPrev = iBefore;
+   slots[iNew].iNext = it.i;
+   if (iBefore != NIL)
+      slots[iBefore].iNext = iNew;
+   else
+      iHead = iNew;
+   if (it.i != NIL)
+      slots[it.i].iPrev = iNew;
+   else
+      iTail = iNew;
+
+   numElements++;
+   return iterator(this, iNew);
+}
+
+/******************************************
+ * INDEX LIST :: ERASE
+ * remove the item at it and put its slot on the free list
+ *     INPUT  : the item to erase
+ *     OUTPUT : iterator to the item after it
+ *     COST   : O(1)
+ ******************************************/
+template <typename T, typename Index>
+typename index_list <T, Index> :: iterator index_list <T, Index> :: erase(const iterator & it)
+{
+   if (it.i == NIL)
+      return end();
+
+   Slot & slot = slots[it.i];
+   Index iNext = slot.iNext;
+   if (slot.iPrev != NIL)
+      slots[slot.iPrev].iNext = slot.iNext;
+   else
+      iHead = slot.iNext;
+   if (slot.iNext != NIL)
+      slots[slot.iNext].iPrev = slot.iPrev;
+   else
+      iTail = slot.iPrev;
+
+   slot.data().~T();
+   release(it.i);
+   numElements--;
+   return iterator(this, iNext);
+}
+
+/******************************************
+ * INDEX LIST :: POP BACK and POP FRONT
+ * nothing happens to an empty list
+ ******************************************/
+template <typename T, typename Index>
+void index_list <T, Index> :: pop_back()
+{
+   if (!empty())
+      erase(iterator(this, iTail));
+}
+
+template <typename T, typename Index>
+void index_list <T, Index> :: pop_front()
+{
+   if (!empty())
+      erase(begin());
+}
+
+/******************************************
+ * INDEX LIST :: CLEAR
+ * destroy every element but keep the array for reuse
+ ******************************************/
+template <typename T, typename Index>
+void index_list <T, Index> :: clear()
+{
+   for (Index i = iHead; i != NIL; i = slots[i].iNext)
+      slots[i].data().~T();
+   numElements = 0;
+   numSlots = 0;
+   iHead = iTail = iFree = NIL;
+}
+
+/******************************************
+ * INDEX LIST :: RESERVE
+ * make room for num elements without growing again
+ ******************************************/
+template <typename T, typename Index>
+void index_list <T, Index> :: reserve(size_t num)
+{
+   if (num > numCapacity)
+      grow(num);
+}
+
+/******************************************
+ * INDEX LIST :: ACQUIRE
+ * the most recently freed slot, else the next never-used
+ * one. There must be one or the other
+ ******************************************/
+template <typename T, typename Index>
+Index index_list <T, Index> :: acquire()
+{
+   if (iFree != NIL)
+   {
+      Index i = iFree;
+      iFree = slots[i].iNext;
+      return i;
+   }
+   assert(numSlots < numCapacity);
+   return (Index)numSlots++;
+}
+
+/******************************************
+ * INDEX LIST :: RELEASE
+ * slot i is empty now; it is the next to be reused
+ ******************************************/
+template <typename T, typename Index>
+void index_list <T, Index> :: release(Index i)
+{
+   slots[i].iNext = iFree;
+   iFree = i;
+}
+
+/******************************************
+ * INDEX LIST :: GROWN
+ * double the array, but never so far that NIL is a slot
+ ******************************************/
+template <typename T, typename Index>
+size_t index_list <T, Index> :: grown() const
+{
+   size_t numMax = (size_t)NIL;
+   if (numCapacity >= numMax)
+      throw "ERROR: unable to allocate a new node for an index list";
+   size_t numGrow = (numCapacity ? 2 * numCapacity : 16);
+   return (numGrow < numMax ? numGrow : numMax);
+}
+
+/******************************************
+ * INDEX LIST :: ALLOCATE
+ * an array of num empty slots
+ ******************************************/
+template <typename T, typename Index>
+typename index_list <T, Index> :: Slot * index_list <T, Index> :: allocate(size_t num)
+{
+   try
+   {
+      return new Slot[num];
+   }
+   catch (...)
+   {
+      throw "ERROR: unable to allocate a new node for an index list";
+   }
+}
+
+/******************************************
+ * INDEX LIST :: GROW
+ * a bigger array with every slot at the same index
+ ******************************************/
+template <typename T, typename Index>
+void index_list <T, Index> :: grow(size_t num)
+{
+   assert(num >= numSlots);
+   if (num > (size_t)NIL)
+      throw "ERROR: unable to allocate a new node for an index list";
+   Slot * pNew = allocate(num);
+   try
+   {
+      relocate(pNew, typename std::is_trivially_copyable<T>::type());
+   }
+   catch (...)
+   {
+      delete [] pNew;
+      throw;
+   }
+   delete [] slots;
+   slots = pNew;
+   numCapacity = num;
+}
+
+/******************************************
+ * INDEX LIST :: RELOCATE
+ * move every slot into pDest. When T is trivially
+ * copyable the whole array is one memcpy; otherwise the
+ * links are copied and each element moved, or copied
+ * when its move may throw. On a throw, what was made in
+ * pDest is destroyed and this is left as it was
+ ******************************************/
+template <typename T, typename Index>
+void index_list <T, Index> :: relocate(Slot * pDest, std::true_type)
+{
+   if (numSlots)
+      std::memcpy(static_cast<void *>(pDest), slots, numSlots * sizeof(Slot));
+}
+
+template <typename T, typename Index>
+void index_list <T, Index> :: relocate(Slot * pDest, std::false_type)
+{
+   for (size_t i = 0; i < numSlots; i++)
+   {
+      pDest[i].iNext = slots[i].iNext;
+      pDest[i].iPrev = slots[i].iPrev;
+   }
+   for (Index i = iHead; i != NIL; i = slots[i].iNext)
+   {
+      try
+      {
+         new (&pDest[i].storage) T(std::move_if_noexcept(slots[i].data()));
+      }
+      catch (...)
+      {
+         for (Index j = iHead; j != i; j = slots[j].iNext)
+            pDest[j].data().~T();
+         throw;
+      }
+   }
+   for (Index i = iHead; i != NIL; i = slots[i].iNext)
+      slots[i].data().~T();
+}
+
+/******************************************
+ * INDEX LIST :: COPY FROM
+ * make this, which has room, a slot for slot copy of rhs
+ ******************************************/
+template <typename T, typename Index>
+void index_list <T, Index> :: copyFrom(const index_list & rhs, std::true_type)
+{
+   std::memcpy(static_cast<void *>(slots), rhs.slots, rhs.numSlots * sizeof(Slot));
+   numElements = rhs.numElements;
+   numSlots    = rhs.numSlots;
+   iHead       = rhs.iHead;
+   iTail       = rhs.iTail;
+   iFree       = rhs.iFree;
+}
+
+template <typename T, typename Index>
+void index_list <T, Index> :: copyFrom(const index_list & rhs, std::false_type)
+{
+   // on a throw, destroy what was made and leave this empty
+   for (Index i = rhs.iHead; i != NIL; i = rhs.slots[i].iNext)
+   {
+      try
+      {
+         new (&slots[i].storage) T(rhs.slots[i].data());
+      }
+      catch (...)
+      {
+         for (Index j = rhs.iHead; j != i; j = rhs.slots[j].iNext)
+            slots[j].data().~T();
+         throw;
+      }
+   }
+   for (size_t i = 0; i < rhs.numSlots; i++)
+   {
+      slots[i].iNext = rhs.slots[i].iNext;
+      slots[i].iPrev = rhs.slots[i].iPrev;
+   }
+   numElements = rhs.numElements;
+   numSlots    = rhs.numSlots;
+   iHead       = rhs.iHead;
+   iTail       = rhs.iTail;
+   iFree       = rhs.iFree;
+}
+
+} // namespace custom
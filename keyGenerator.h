@@ -0,0 +1,298 @@
+/***********************************************************************
+ * Header:
+ *    KEY GENERATOR
+ * Summary:
+ *    The keys a benchmark puts in a container and the order it asks
+ *    for them. Everything comes from a seed, so two runs with the
+ *    same options see exactly the same keys in the same order.
+ *
+ *    Distributions:
+ *        uniform    : scattered keys, every one equally likely
+ *        zipf       : scattered keys, a few of them very popular
+ *        sequential : 0, 1, 2, ... asked for in order
+ *        strided    : 0, stride, 2*stride, ... asked for in order
+ *        clustered  : runs of consecutive keys scattered about
+ *        colliding  : keys that all hash to the same bucket
+ ************************************************************************/
+
+#pragma once
+
+#include <cmath>      // for std::pow
+#include <cstdint>    // for std::uint64_t
+#include <cstring>    // for std::strcmp
+#include <functional> // for std::hash
+#include <random>     // for std::mt19937_64
+#include <string>     // for std::string
+#include <vector>     // for std::vector
+
+/*************************************************************
+ * KEY DISTRIBUTION
+ *************************************************************/
+enum KeyDistribution
+{
+   KEYS_UNIFORM,
+   KEYS_ZIPF,
+   KEYS_SEQUENTIAL,
+   KEYS_STRIDED,
+   KEYS_CLUSTERED,
+   KEYS_COLLIDING,
+   KEYS_NUM
+};
+
+/*************************************************************
+ * KEY OPTIONS
+ * Everything that decides what the keys are
+ *************************************************************/
+struct KeyOptions
+{
+   KeyOptions()
+      : distribution(KEYS_UNIFORM), seed(1), theta(0.99), stride(10),
+        clusterSize(64), modulus(10), minLength(8), maxLength(32) {}
+
+   KeyDistribution distribution;
+   std::uint64_t seed;     // the same seed gives the same keys
+   double theta;           // zipf skew: 0 is uniform, near 1 is very skewed
+   size_t stride;          // distance between strided keys
+   size_t clusterSize;     // consecutive keys in one cluster, at most 65536
+   size_t modulus;         // colliding keys share std::hash % modulus
+   size_t minLength;       // shortest string key
+   size_t maxLength;       // longest string key
+};
+
+/*************************************************************
+ * KEY GENERATOR
+ * The key with index i is key<Key>(i). Keys with different
+ * indices are always different, so [0, n) can fill a container
+ * and [n, n + m) are sure to miss. next() picks the index of
+ * the next key to look up from [0, n)
+ *************************************************************/
+class KeyGenerator
+{
+public:
+   KeyGenerator(const KeyOptions & options, size_t numKeys)
+      : options(options), numKeys(numKeys ? numKeys : 1), iNext(0),
+        random(mix(options.seed)), zetaN(0.0), alpha(0.0), eta(0.0)
+   {
+      if (this->options.clusterSize == 0 || this->options.clusterSize > 65536)
+         this->options.clusterSize = 64;
+      if (this->options.modulus == 0)
+         this->options.modulus = 1;
+      if (this->options.maxLength < this->options.minLength)
+         this->options.maxLength = this->options.minLength;
+      if (options.distribution == KEYS_ZIPF)
+         setupZipf();
+   }
+
+   /*************************************************************
+    * NAME and PARSE
+    * The command line spelling of each distribution
+    *************************************************************/
+   static const char * name(KeyDistribution distribution)
+   {
+      static const char * names[KEYS_NUM] =
+         { "uniform", "zipf", "sequential", "strided", "clustered", "colliding" };
+      return (distribution < KEYS_NUM ? names[distribution] : "unknown");
+   }
+   static bool parse(const char * text, KeyDistribution & distribution)
+   {
+      for (int i = 0; i < KEYS_NUM; i++)
+         if (!std::strcmp(text, name(static_cast<KeyDistribution>(i))))
+         {
+            distribution = static_cast<KeyDistribution>(i);
+            return true;
+         }
+      return false;
+   }
+
+   /*************************************************************
+    * KEYS
+    * The keys with indices [begin, end), in index order
+    *************************************************************/
+   template <class Key>
+   std::vector<Key> keys(size_t begin, size_t end)
+   {
+      std::vector<Key> keys(end - begin);
+      for (size_t i = begin; i < end; i++)
+         keys[i - begin] = key<Key>(i);
+      return keys;
+   }
+
+   template <class Key>
+   Key key(size_t i)
+   {
+      Key k;
+      makeKey(i, k);
+      return k;
+   }
+
+   /*************************************************************
+    * NEXT
+    * The index of the next key to look up
+    *************************************************************/
+   size_t next()
+   {
+      switch (options.distribution)
+      {
+         case KEYS_SEQUENTIAL:
+         case KEYS_STRIDED:
+            return iNext++ % numKeys;
+         case KEYS_ZIPF:
+            return nextZipf();
+         default:
+            return std::uniform_int_distribution<size_t>(0, numKeys - 1)(random);
+      }
+   }
+
+   // a number in [0, 100) from the same stream, for read/write mixes
+   unsigned percent()
+   {
+      return std::uniform_int_distribution<unsigned>(0, 99)(random);
+   }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   /*************************************************************
+    * MIX
+    * SplitMix64: a bijection, so different inputs always give
+    * different outputs, and every bit depends on every other
+    *************************************************************/
+   static std::uint64_t mix(std::uint64_t x)
+   {
+      x += 0x9e3779b97f4a7c15ULL;
+      x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+      return x ^ (x >> 31);
+   }
+
+   /*************************************************************
+    * VALUE
+    * The integer behind key i
+    *************************************************************/
+   std::uint64_t value(size_t i) const
+   {
+      switch (options.distribution)
+      {
+         case KEYS_SEQUENTIAL:
+            return i;
+         case KEYS_STRIDED:
+            return (std::uint64_t)i * options.stride;
+         case KEYS_CLUSTERED:
+         {
+            // a random 48 bit base for each cluster, then consecutive
+            std::uint64_t iCluster = i / options.clusterSize;
+            return (mix(options.seed ^ mix(iCluster)) & ~0xffffULL) + i % options.clusterSize;
+         }
+         default:
+            return mix(mix(options.seed) + i);
+      }
+   }
+
+   /*************************************************************
+    * MAKE KEY
+    * Integer keys are the value itself. String keys start with the
+    * value in hex, low digit first, so they are distinct too, then
+    * are padded out to a length between minLength and maxLength
+    *************************************************************/
+   void makeKey(size_t i, std::size_t & key)
+   {
+      if (options.distribution == KEYS_COLLIDING)
+         key = colliding<std::size_t>(i);
+      else
+         key = static_cast<std::size_t>(value(i));
+   }
+   void makeKey(size_t i, std::string & key)
+   {
+      if (options.distribution == KEYS_COLLIDING)
+         key = colliding<std::string>(i);
+      else
+         key = toString(value(i));
+   }
+   std::string toString(std::uint64_t v) const
+   {
+      static const char hex[] = "0123456789abcdef";
+      std::string s;
+      for (std::uint64_t digits = v; s.empty() || digits; digits >>= 4)
+         s += hex[digits & 0xf];
+      s += ':';
+
+      std::uint64_t filler = mix(v ^ options.seed);
+      size_t length = options.minLength +
+                      (size_t)(filler % (options.maxLength - options.minLength + 1));
+      while (s.size() < length)
+      {
+         s += (char)('a' + filler % 26);
+         filler = mix(filler);
+      }
+      return s;
+   }
+
+   /*************************************************************
+    * COLLIDING
+    * The i'th candidate whose std::hash is a multiple of modulus.
+    * With ten buckets that is every tenth candidate or so, which is
+    * cheap enough to find them all by trying each in turn
+    *************************************************************/
+   template <class Key>
+   Key colliding(size_t i)
+   {
+      std::vector<Key> & found = collisions(Key());
+      Key candidate;
+      while (found.size() <= i)
+      {
+         candidateKey(iCandidate(Key())++, candidate);
+         if (std::hash<Key>()(candidate) % options.modulus == 0)
+            found.push_back(candidate);
+      }
+      return found[i];
+   }
+   void candidateKey(std::uint64_t j, std::size_t & key) const { key = static_cast<std::size_t>(j); }
+   void candidateKey(std::uint64_t j, std::string & key) const { key = toString(j); }
+   std::vector<std::size_t> & collisions(std::size_t)        { return collisionsInt;    }
+   std::vector<std::string> & collisions(const std::string &) { return collisionsString; }
+   std::uint64_t & iCandidate(std::size_t)        { return iCandidateInt;    }
+   std::uint64_t & iCandidate(const std::string &) { return iCandidateString; }
+
+   /*************************************************************
+    * ZIPF
+    * Gray et al., "Quickly Generating Billion-Record Synthetic
+    * Databases": index 0 is the most popular, then 1, and so on
+    *************************************************************/
+   void setupZipf()
+   {
+      double theta = options.theta;
+      if (theta <= 0.0 || theta >= 1.0)
+         theta = options.theta = 0.99;
+      for (size_t i = 1; i <= numKeys; i++)
+         zetaN += 1.0 / std::pow((double)i, theta);
+      double zeta2 = 1.0 + 1.0 / std::pow(2.0, theta);
+      alpha = 1.0 / (1.0 - theta);
+      eta   = (1.0 - std::pow(2.0 / (double)numKeys, 1.0 - theta)) /
+              (1.0 - zeta2 / zetaN);
+   }
+   size_t nextZipf()
+   {
+      double u  = std::uniform_real_distribution<double>(0.0, 1.0)(random);
+      double uz = u * zetaN;
+      if (uz < 1.0)
+         return 0;
+      if (uz < 1.0 + std::pow(0.5, options.theta))
+         return (numKeys > 1 ? 1 : 0);
+      size_t i = (size_t)((double)numKeys * std::pow(eta * u - eta + 1.0, alpha));
+      return (i < numKeys ? i : numKeys - 1);
+   }
+
+   KeyOptions options;
+   size_t numKeys;                       // next() picks from [0, numKeys)
+   size_t iNext;                         // for the sequential orders
+   std::mt19937_64 random;               // for everything else
+   double zetaN;                         // zipf constants
+   double alpha;
+   double eta;
+   std::vector<std::size_t> collisionsInt;    // colliding keys found so far
+   std::vector<std::string> collisionsString;
+   std::uint64_t iCandidateInt    = 0;        // next candidate to try
+   std::uint64_t iCandidateString = 0;
+};
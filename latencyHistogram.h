@@ -0,0 +1,347 @@
+/***********************************************************************
+ * Header:
+ *    LATENCY HISTOGRAM
+ * Summary:
+ *    How long container operations take, kept in the high dynamic
+ *    range layout: every latency from a nanosecond to eighteen minutes
+ *    is held to within 1.6% in a fixed array of counters, so a rare
+ *    slow operation shows up in the tail instead of vanishing into
+ *    the mean.
+ *
+ *    This will contain the class definition of:
+ *        latency_histogram : Lock-free counts of latencies
+ *        latency_policy    : Times insert, find, erase and clear in
+ *                            list and unordered_set
+ *
+ *    The containers only time themselves when CUSTOM_INSTRUMENTATION
+ *    names a policy, for example
+ *        -DCUSTOM_INSTRUMENTATION=custom::latency_policy
+ *    Otherwise the INSTRUMENT() lines expand to nothing.
+ ************************************************************************/
+
+#pragma once
+
+#include <atomic>     // for std::atomic
+#include <chrono>     // for std::chrono::steady_clock
+#include <cstdint>    // for std::uint64_t
+#include <sstream>    // for std::ostringstream
+#include <string>     // for std::string
+
+namespace custom
+{
+
+/************************************************
+ * LATENCY HISTOGRAM
+ * Values below 128 each get their own counter. Above that, each
+ * power of two is split into 64 equal counters. Recording is a
+ * handful of relaxed atomic adds, so any number of threads may
+ * record into the same histogram
+ ************************************************/
+class latency_histogram
+{
+public:
+   enum
+   {
+      SUB_BUCKET_BITS = 7,                         // 128 exact values to start
+      SUB_BUCKETS     = 1 << SUB_BUCKET_BITS,
+      HALF_BUCKETS    = SUB_BUCKETS / 2,           // counters per power of two
+      MAX_BITS        = 40,                        // values up to 2^40 ns
+      NUM_COUNTS      = SUB_BUCKETS + (MAX_BITS - SUB_BUCKET_BITS) * HALF_BUCKETS
+   };
+
+   latency_histogram() { reset(); }
+   latency_histogram(const latency_histogram & rhs) { reset(); merge(rhs); }
+   latency_histogram & operator = (const latency_histogram & rhs)
+   {
+      if (this != &rhs)
+      {
+         reset();
+         merge(rhs);
+      }
+      return *this;
+   }
+
+   //
+   // Record
+   //
+
+   void record(std::uint64_t ns)
+   {
+      counts[index(ns)].fetch_add(1, std::memory_order_relaxed);
+      total.fetch_add(1, std::memory_order_relaxed);
+      sum.fetch_add(ns, std::memory_order_relaxed);
+      raise(nsMax, ns);
+      lower(nsMin, ns);
+   }
+   void merge(const latency_histogram & rhs);
+   void reset();
+
+   //
+   // Status
+   //
+
+   std::uint64_t count() const { return total.load(std::memory_order_relaxed); }
+   std::uint64_t max()   const { return nsMax.load(std::memory_order_relaxed); }
+   std::uint64_t min()   const { return count() ? nsMin.load(std::memory_order_relaxed) : 0; }
+   double mean() const { return count() ? (double)sum.load(std::memory_order_relaxed) / (double)count() : 0.0; }
+   std::uint64_t percentile(double p) const;
+
+   std::string to_text(const std::string & name) const;
+   std::string to_json() const;
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   static size_t index(std::uint64_t ns);
+   static std::uint64_t highest(size_t i);
+
+   // lock-free max and min
+   static void raise(std::atomic<std::uint64_t> & value, std::uint64_t ns)
+   {
+      std::uint64_t old = value.load(std::memory_order_relaxed);
+      while (ns > old && !value.compare_exchange_weak(old, ns, std::memory_order_relaxed))
+         ;
+   }
+   static void lower(std::atomic<std::uint64_t> & value, std::uint64_t ns)
+   {
+      std::uint64_t old = value.load(std::memory_order_relaxed);
+      while (ns < old && !value.compare_exchange_weak(old, ns, std::memory_order_relaxed))
+         ;
+   }
+
+   std::atomic<std::uint64_t> counts[NUM_COUNTS];  // how many of each latency
+   std::atomic<std::uint64_t> total;               // everything recorded
+   std::atomic<std::uint64_t> sum;                 // for the mean
+   std::atomic<std::uint64_t> nsMax;               // exact, not rounded
+   std::atomic<std::uint64_t> nsMin;
+};
+
+/*****************************************
+ * LATENCY HISTOGRAM :: INDEX
+ * Which counter a latency goes in
+ ****************************************/
+inline size_t latency_histogram::index(std::uint64_t ns)
+{
+   if (ns < SUB_BUCKETS)
+      return (size_t)ns;
+   if (ns >> MAX_BITS)
+      ns = (std::uint64_t(1) << MAX_BITS) - 1;
+
+   int log = 63;
+   while (!(ns >> log))
+      log--;
+
+   // log picks the power of two, the six bits below the top one the counter
+   int shift = log - (SUB_BUCKET_BITS - 1);
+   return SUB_BUCKETS + (size_t)(shift - 1) * HALF_BUCKETS +
+          (size_t)((ns >> shift) - HALF_BUCKETS);
+}
+
+/*****************************************
+ * LATENCY HISTOGRAM :: HIGHEST
+ * The largest latency that goes in a counter
+ ****************************************/
+inline std::uint64_t latency_histogram::highest(size_t i)
+{
+   if (i < SUB_BUCKETS)
+      return i;
+   int shift = (int)((i - SUB_BUCKETS) / HALF_BUCKETS) + 1;
+   std::uint64_t step = (i - SUB_BUCKETS) % HALF_BUCKETS;
+   return ((HALF_BUCKETS + step + 1) << shift) - 1;
+}
+
+/*****************************************
+ * LATENCY HISTOGRAM :: MERGE
+ * Add another histogram's counts to ours, typically one kept by
+ * another thread. The other may still be recording
+ ****************************************/
+inline void latency_histogram::merge(const latency_histogram & rhs)
+{
+   for (size_t i = 0; i < NUM_COUNTS; i++)
+   {
+      std::uint64_t n = rhs.counts[i].load(std::memory_order_relaxed);
+      if (n)
+         counts[i].fetch_add(n, std::memory_order_relaxed);
+   }
+   std::uint64_t n = rhs.total.load(std::memory_order_relaxed);
+   total.fetch_add(n, std::memory_order_relaxed);
+   sum.fetch_add(rhs.sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+   if (n)
+   {
+      raise(nsMax, rhs.nsMax.load(std::memory_order_relaxed));
+      lower(nsMin, rhs.nsMin.load(std::memory_order_relaxed));
+   }
+}
+
+/*****************************************
+ * LATENCY HISTOGRAM :: RESET
+ * Forget everything. Not safe while another thread records
+ ****************************************/
+inline void latency_histogram::reset()
+{
+   for (size_t i = 0; i < NUM_COUNTS; i++)
+      counts[i].store(0, std::memory_order_relaxed);
+   total.store(0, std::memory_order_relaxed);
+   sum.store(0, std::memory_order_relaxed);
+   nsMax.store(0, std::memory_order_relaxed);
+   nsMin.store(~std::uint64_t(0), std::memory_order_relaxed);
+}
+
+/*****************************************
+ * LATENCY HISTOGRAM :: PERCENTILE
+ * The latency that fraction p of the operations did not exceed,
+ * rounded up to the top of its counter but never past the max
+ ****************************************/
+inline std::uint64_t latency_histogram::percentile(double p) const
+{
+   std::uint64_t n = count();
+   if (n == 0)
+      return 0;
+   std::uint64_t rank = (std::uint64_t)(p * (double)n + 0.5);
+   if (rank < 1)
+      rank = 1;
+
+   std::uint64_t seen = 0;
+   for (size_t i = 0; i < NUM_COUNTS; i++)
+   {
+      seen += counts[i].load(std::memory_order_relaxed);
+      if (seen >= rank)
+         return highest(i) < max() ? highest(i) : max();
+   }
+   return max();
+}
+
+/*****************************************
+ * LATENCY HISTOGRAM :: TO TEXT
+ * One line, in nanoseconds
+ ****************************************/
+inline std::string latency_histogram::to_text(const std::string & name) const
+{
+   std::ostringstream out;
+   out.setf(std::ios::fixed);
+   out.precision(1);
+   out << name
+       << " count:" << count()
+       << " mean:"  << mean()
+       << " p50:"   << percentile(0.50)
+       << " p99:"   << percentile(0.99)
+       << " p99.9:" << percentile(0.999)
+       << " max:"   << max() << " ns";
+   return out.str();
+}
+
+/*****************************************
+ * LATENCY HISTOGRAM :: TO JSON
+ * One object, in nanoseconds
+ ****************************************/
+inline std::string latency_histogram::to_json() const
+{
+   std::ostringstream out;
+   out << "{\"count\":" << count()
+       << ",\"mean\":"  << mean()
+       << ",\"min\":"   << min()
+       << ",\"p50\":"   << percentile(0.50)
+       << ",\"p90\":"   << percentile(0.90)
+       << ",\"p99\":"   << percentile(0.99)
+       << ",\"p999\":"  << percentile(0.999)
+       << ",\"max\":"   << max() << "}";
+   return out.str();
+}
+
+/************************************************
+ * INSTRUMENT
+ * Which container, and which of its operations
+ ************************************************/
+enum instrument_container { INSTRUMENT_LIST, INSTRUMENT_UNORDERED_SET, INSTRUMENT_NUM_CONTAINERS };
+enum instrument_op { INSTRUMENT_INSERT, INSTRUMENT_FIND, INSTRUMENT_ERASE, INSTRUMENT_CLEAR,
+                     INSTRUMENT_NUM_OPS };
+
+/************************************************
+ * LATENCY POLICY
+ * An instrumentation policy is anything with a scope class whose
+ * constructor takes the container and operation: it lives for the
+ * length of the call. This one keeps one histogram for each
+ * operation of each kind of container, shared by every thread
+ ************************************************/
+struct latency_policy
+{
+   static latency_histogram & histogram(instrument_container container, instrument_op op)
+   {
+      static latency_histogram histograms[INSTRUMENT_NUM_CONTAINERS][INSTRUMENT_NUM_OPS];
+      return histograms[container][op];
+   }
+
+   static void reset()
+   {
+      for (int container = 0; container < INSTRUMENT_NUM_CONTAINERS; container++)
+         for (int op = 0; op < INSTRUMENT_NUM_OPS; op++)
+            histogram((instrument_container)container, (instrument_op)op).reset();
+   }
+
+   // every histogram that has something in it
+   static std::string to_text()
+   {
+      std::string text;
+      for (int container = 0; container < INSTRUMENT_NUM_CONTAINERS; container++)
+         for (int op = 0; op < INSTRUMENT_NUM_OPS; op++)
+         {
+            const latency_histogram & h = histogram((instrument_container)container, (instrument_op)op);
+            if (h.count())
+               text += h.to_text(std::string(name((instrument_container)container)) + "::" +
+                                 name((instrument_op)op)) + "\n";
+         }
+      return text;
+   }
+   static std::string to_json()
+   {
+      std::string json = "{";
+      for (int container = 0; container < INSTRUMENT_NUM_CONTAINERS; container++)
+      {
+         json += std::string(container ? "," : "") + "\"" +
+                 name((instrument_container)container) + "\":{";
+         for (int op = 0; op < INSTRUMENT_NUM_OPS; op++)
+            json += std::string(op ? "," : "") + "\"" + name((instrument_op)op) + "\":" +
+                    histogram((instrument_container)container, (instrument_op)op).to_json();
+         json += "}";
+      }
+      return json + "}";
+   }
+
+   static const char * name(instrument_container container)
+   {
+      return (container == INSTRUMENT_LIST ? "list" : "unordered_set");
+   }
+   static const char * name(instrument_op op)
+   {
+      static const char * names[INSTRUMENT_NUM_OPS] = { "insert", "find", "erase", "clear" };
+      return names[op];
+   }
+
+   // times one call
+   class scope
+   {
+   public:
+      scope(instrument_container container, instrument_op op)
+         : h(histogram(container, op)), start(std::chrono::steady_clock::now()) {}
+     ~scope()
+      {
+         h.record((std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  std::chrono::steady_clock::now() - start).count());
+      }
+   private:
+      latency_histogram & h;
+      std::chrono::steady_clock::time_point start;
+   };
+};
+
+}; // namespace custom
+
+// the containers time their own operations with this
+#ifdef CUSTOM_INSTRUMENTATION
+#define INSTRUMENT(container, op) \
+   CUSTOM_INSTRUMENTATION::scope instrumentScope(custom::container, custom::op)
+#else
+#define INSTRUMENT(container, op)
+#endif // CUSTOM_INSTRUMENTATION
@@ -19,14 +19,25 @@
  ************************************************************************/
 
 #pragma once
+#include <algorithm>   // for std::find
+#include <atomic>      // for std::atomic
 #include <cassert>     // for ASSERT
+#include <functional>  // for std::less
 #include <iostream>    // for nullptr
+#include <iterator>    // for std::iterator_traits and std::distance
 #include <new>         // std::bad_alloc
 #include <memory>      // for std::allocator
+#include <utility>     // for std::forward
+#include <vector>      // for std::vector
+#include "latencyHistogram.h" // for INSTRUMENT
 
 namespace custom
 {
 
+// builds its chains out of our nodes
+template <typename T>
+class mpsc_queue;
+
 /**************************************************
  * LIST
  * Just like std::list
@@ -86,6 +97,25 @@ public:
    void push_back (      T&& data);
    iterator insert(iterator it, const T& data);
    iterator insert(iterator it, T&& data);
+   template <class ... Args>
+   void emplace_front(Args&& ... args) { emplace(begin(), std::forward<Args>(args)...); }
+   template <class ... Args>
+   void emplace_back (Args&& ... args) { emplace(end(),   std::forward<Args>(args)...); }
+   template <class ... Args>
+   iterator emplace(iterator it, Args&& ... args);
+
+   // a whole range at once: from forward iterators every node comes from
+   // one allocation. Either all of it goes in or, on a throw, none of it
+   template <class Iterator,
+             class Category = typename std::iterator_traits<Iterator>::iterator_category>
+   iterator insert(iterator it, Iterator first, Iterator last)
+   {
+      return insertRange(it, first, last, Category());
+   }
+   template <class Iterator,
+             class Category = typename std::iterator_traits<Iterator>::iterator_category>
+   void assign(Iterator first, Iterator last);
+   void append(list <T> && rhs) { splice(end(), rhs); }
 
    //
    // Remove
@@ -96,12 +126,42 @@ public:
    void clear();
    iterator erase(const iterator& it);
 
+   //
+   // Operations: these relink the nodes we have, never new or copy one
+   //
+
+   void splice(iterator pos, list <T> & rhs);
+   void splice(iterator pos, list <T> & rhs, iterator it);
+   void splice(iterator pos, list <T> & rhs, iterator first, iterator last);
+   void merge(list <T> & rhs) { merge(rhs, std::less<T>()); }
+   template <class Compare>
+   void merge(list <T> & rhs, Compare comp);
+   void sort() { sort(std::less<T>()); }
+   template <class Compare>
+   void sort(Compare comp);
+
+   //
+   // Locality
+   //
+
+   // move every element, in order, into one new block of nodes.
+   // This invalidates every iterator into the list
+   void compact();
+
    //
    // Status
    //
 
    bool empty()  const { return size() == 0; }
    size_t size() const { return numElements; }
+   static size_t node_size() { return sizeof(Node); } // bytes per element
+
+   // the stand-alone swap trades our pointers
+   template <class U>
+   friend void swap(list <U> & lhs, list <U> & rhs);
+
+   // the queue hands over whole chains of our nodes
+   friend class mpsc_queue <T>;
 
 
 #ifdef DEBUG // make this visible to the unit tests
@@ -112,10 +172,62 @@ private:
    // nested linked list class
    class Node;
 
+   // nodes laid out together by compact() or a range insert
+   struct Block;
+
+   // every block our nodes may be in, by address
+   typedef std::vector<Block *> BlockTable;
+
    // member variables
    size_t numElements; // number of elements
    Node * pHead;       // pointer to the beginning of the list
    Node * pTail;       // pointer to the ending of the list
+   BlockTable * pBlocks; // our blocks, nullptr until we first have one
+
+   // insert a range one node at a time, or all in one block when the
+   // range can be counted first
+   template <class Iterator>
+   iterator insertRange(iterator it, Iterator first, Iterator last, std::input_iterator_tag);
+   template <class Iterator>
+   iterator insertRange(iterator it, Iterator first, Iterator last, std::forward_iterator_tag);
+
+   // num nodes side by side, each built by make(pNode) and linked in order
+   template <class Make>
+   static Block * buildBlock(size_t num, Make make);
+
+   // our block table, allocated the first time it is needed
+   BlockTable & blockTable();
+
+   // how many blocks our nodes may be in
+   size_t numBlocks() const { return pBlocks ? pBlocks->size() : 0; }
+
+   // the block p is in, if any
+   typename BlockTable::iterator findBlock(const Node * p);
+
+   // start referring to pBlock. There must be room in the table
+   void insertBlock(Block * pBlock);
+
+   // delete a node, or destroy it in place when it is in a block
+   void freeNode(Node * p);
+
+   // nodes of rhs are coming over, so may be in any of its blocks
+   void adopt(list <T> & rhs);
+
+   // this list no longer refers to pBlock
+   static void releaseBlock(Block * pBlock);
+
+   // hook the chain pFirst through pLast in front of pPos
+   void linkBefore(Node * pPos, Node * pFirst, Node * pLast);
+
+   // move pFirst through pLast, num of them, out of rhs and in front of pPos
+   void transfer(Node * pPos, list <T> & rhs, Node * pFirst, Node * pLast, size_t num);
+
+   // merge two sorted chains linked only by pNext
+   template <class Compare>
+   static Node * mergeChains(Node * pLeft, Node * pRight, Compare & comp);
+
+   // point every pPrev and pTail back at the pNext chain from pHead
+   void relink();
 };
 
 /*************************************************
@@ -136,6 +248,12 @@ public:
    Node(const T &  data) : pNext(nullptr), pPrev(nullptr), data(data           ) {}
    Node(      T && data) : pNext(nullptr), pPrev(nullptr), data(std::move(data)) {}
 
+   // build the data right here from whatever its constructor takes
+   struct emplace_t {};
+   template <class ... Args>
+   Node(emplace_t, Args&& ... args)
+      : data(std::forward<Args>(args)...), pNext(nullptr), pPrev(nullptr) {}
+
    //
    // Data
    //
@@ -145,6 +263,32 @@ public:
    Node * pPrev; // pointer to previous node
 };
 
+/*************************************************
+ * BLOCK
+ * One allocation: this header followed by the nodes
+ * compact() or a range insert built in it. Nodes can be spliced from
+ * one list to another, so a block is shared by every
+ * list that took some, and freed when none of its
+ * nodes is left and no list refers to it. Lists sharing
+ * a block may be cleared on different threads, so the
+ * counts are atomic
+ *************************************************/
+template <typename T>
+struct list <T> :: Block
+{
+   // is p one of ours? std::less orders any two pointers
+   bool owns(const Node * p) const
+   {
+      return !std::less<const Node *>()(p, pBegin) &&
+              std::less<const Node *>()(p, pEnd);
+   }
+
+   Node * pBegin;    // the first node
+   Node * pEnd;      // one past the last node
+   std::atomic<size_t> numLive;   // nodes not yet freed, whatever list they are in
+   std::atomic<size_t> numLists;  // lists holding this block in their tables
+};
+
 /*************************************************
  * LIST ITERATOR
  * Iterate through a List, non-constant version
@@ -153,6 +297,13 @@ template <typename T>
 class list <T> :: iterator
 {
 public:
+   // so the standard algorithms, and our range insert, know what we are
+   typedef std::bidirectional_iterator_tag iterator_category;
+   typedef T                               value_type;
+   typedef std::ptrdiff_t                  difference_type;
+   typedef T *                             pointer;
+   typedef T &                             reference;
+
    // constructors, destructors, and assignment operator
    iterator()
       : p(nullptr)
@@ -220,10 +371,23 @@ public:
       return *this;
    }
 
-   // two friends who need to access p directly
+   // the friends who need to access p directly
    friend iterator list <T> :: insert(iterator it, const T &  data);
    friend iterator list <T> :: insert(iterator it,       T && data);
    friend iterator list <T> :: erase(const iterator & it);
+   template <class ... Args>
+   friend iterator list <T> :: emplace(iterator it, Args&& ... args);
+   friend void list <T> :: splice(iterator pos, list <T> & rhs);
+   friend void list <T> :: splice(iterator pos, list <T> & rhs, iterator it);
+   friend void list <T> :: splice(iterator pos, list <T> & rhs, iterator first, iterator last);
+   template <class Iterator>
+   friend iterator list <T> :: insertRange(iterator it, Iterator first, Iterator last,
+                                           std::input_iterator_tag);
+   template <class Iterator>
+   friend iterator list <T> :: insertRange(iterator it, Iterator first, Iterator last,
+                                           std::forward_iterator_tag);
+   friend list <T> & list <T> :: operator = (list <T> & rhs);
+   friend list <T> & list <T> :: operator = (const std::initializer_list<T> & rhs);
 
 #ifdef DEBUG // make this visible to the unit tests
 public:
@@ -240,7 +404,7 @@ private:
  ****************************************/
 template <typename T>
 list <T> ::list(size_t num, const T & t) :
-   numElements(0), pHead(nullptr), pTail(nullptr)
+   numElements(0), pHead(nullptr), pTail(nullptr), pBlocks(nullptr)
 {
    if (num)
    {
@@ -275,7 +439,7 @@ list <T> ::list(size_t num, const T & t) :
 template <typename T>
 template <class Iterator>
 list <T> ::list(Iterator first, Iterator last)
-   : numElements(0), pHead(nullptr), pTail(nullptr)
+   : numElements(0), pHead(nullptr), pTail(nullptr), pBlocks(nullptr)
 {
    for (auto it = first; it != last; ++it)
       push_back(*it);
@@ -287,7 +451,7 @@ list <T> ::list(Iterator first, Iterator last)
  ****************************************/
 template <typename T>
 list <T> ::list(const std::initializer_list<T>& il)
-   : numElements(0), pHead(nullptr), pTail(nullptr)
+   : numElements(0), pHead(nullptr), pTail(nullptr), pBlocks(nullptr)
 {
    *this = il;
 }
@@ -298,7 +462,7 @@ list <T> ::list(const std::initializer_list<T>& il)
  ****************************************/
 template <typename T>
 list <T> ::list(size_t num)
-   : numElements(0), pHead(nullptr), pTail(nullptr)
+   : numElements(0), pHead(nullptr), pTail(nullptr), pBlocks(nullptr)
 {
    if (num)
    {
@@ -331,7 +495,7 @@ list <T> ::list(size_t num)
  ****************************************/
 template <typename T>
 list <T> ::list()
-   : numElements(0), pHead(nullptr), pTail(nullptr)
+   : numElements(0), pHead(nullptr), pTail(nullptr), pBlocks(nullptr)
 {
 }
 
@@ -340,7 +504,7 @@ list <T> ::list()
  ****************************************/
 template <typename T>
 list <T> ::list(list& rhs)
-   : numElements(0), pHead(nullptr), pTail(nullptr)
+   : numElements(0), pHead(nullptr), pTail(nullptr), pBlocks(nullptr)
 {
    *this = rhs;
 }
@@ -351,9 +515,11 @@ list <T> ::list(list& rhs)
  ****************************************/
 template <typename T>
 list <T> ::list(list <T>&& rhs)
-   : numElements(rhs.numElements), pHead(rhs.pHead), pTail(rhs.pTail)
+   : numElements(rhs.numElements), pHead(rhs.pHead), pTail(rhs.pTail),
+     pBlocks(rhs.pBlocks)
 {
    rhs.pHead = rhs.pTail = nullptr;
+   rhs.pBlocks = nullptr;
    rhs.numElements = 0;
 }
 
@@ -418,7 +584,7 @@ list <T> & list <T> :: operator = (list <T> & rhs)
       for (p = itLHS.p; p; p = pNext)
       {
          pNext = p->pNext;
-         delete p;
+         freeNode(p);
          numElements--;
       }
       pTail->pNext = nullptr;
@@ -470,7 +636,7 @@ list <T>& list <T> :: operator = (const std::initializer_list<T>& rhs)
       for (p = itLHS.p; p; p = pNext)
       {
          pNext = p->pNext;
-         delete p;
+         freeNode(p);
          numElements--;
       }
       pTail->pNext = nullptr;
@@ -490,12 +656,23 @@ list <T>& list <T> :: operator = (const std::initializer_list<T>& rhs)
 template <typename T>
 void list <T> :: clear()
 {
+   INSTRUMENT(INSTRUMENT_LIST, INSTRUMENT_CLEAR);
+
    // loop through the entire list, removing everything
    list <T> :: Node * pNext;
    for (list <T> :: Node * p = pHead; p; p = pNext)
    {
       pNext = p->pNext;
-      delete p;
+      freeNode(p);
+   }
+
+   // we have no nodes left to be in a block
+   if (pBlocks)
+   {
+      for (Block * pBlock : *pBlocks)
+         releaseBlock(pBlock);
+      delete pBlocks;
+      pBlocks = nullptr;
    }
 
    // set the member variables to the cleared state
@@ -513,6 +690,7 @@ void list <T> :: clear()
 template <typename T>
 void list <T> :: push_back(const T & data)
 {
+   INSTRUMENT(INSTRUMENT_LIST, INSTRUMENT_INSERT);
    assert(numElements >= 0);
    try
    {
@@ -541,6 +719,7 @@ void list <T> :: push_back(const T & data)
 template <typename T>
 void list <T> ::push_back(T && data)
 {
+   INSTRUMENT(INSTRUMENT_LIST, INSTRUMENT_INSERT);
    assert(numElements >= 0);
    try
    {
@@ -576,6 +755,7 @@ void list <T> ::push_back(T && data)
 template <typename T>
 void list <T> :: push_front(const T & data)
 {
+   INSTRUMENT(INSTRUMENT_LIST, INSTRUMENT_INSERT);
    assert(numElements >= 0);
    try
    {
@@ -604,6 +784,7 @@ void list <T> :: push_front(const T & data)
 template <typename T>
 void list <T> ::push_front(T && data)
 {
+   INSTRUMENT(INSTRUMENT_LIST, INSTRUMENT_INSERT);
    assert(numElements >= 0);
    try
    {
@@ -647,7 +828,7 @@ void list <T> ::pop_back()
    {
       assert(pTail != nullptr);
       pTail = pTail->pPrev;
-      delete pTail->pNext;
+      freeNode(pTail->pNext);
       pTail->pNext = nullptr;
       numElements--;
    }
@@ -657,7 +838,7 @@ void list <T> ::pop_back()
       assert(pTail != nullptr);
       assert(pHead != nullptr);
       assert(pHead == pTail);
-      delete pTail;
+      freeNode(pTail);
       pHead = pTail = nullptr;
       numElements = 0;
    }
@@ -680,7 +861,7 @@ void list <T> ::pop_front()
    {
       assert(pHead != nullptr);
       pHead = pHead->pNext;
-      delete pHead->pPrev;
+      freeNode(pHead->pPrev);
       pHead->pPrev = nullptr;
       numElements--;
    }
@@ -690,7 +871,7 @@ void list <T> ::pop_front()
       assert(pTail != nullptr);
       assert(pHead != nullptr);
       assert(pHead == pTail);
-      delete pTail;
+      freeNode(pTail);
       pHead = pTail = nullptr;
       numElements = 0;
    }
@@ -740,6 +921,7 @@ T & list <T> :: back()
 template <typename T>
 typename list <T> :: iterator  list <T> :: erase(const list <T> :: iterator & it)
 {
+   INSTRUMENT(INSTRUMENT_LIST, INSTRUMENT_ERASE);
    assert(numElements >= 0);
    list <T> :: iterator itNext = end();
    
@@ -764,7 +946,7 @@ typename list <T> :: iterator  list <T> :: erase(const list <T> :: iterator & it
       pHead = pHead->pNext;
 
    // delete self and return
-   delete it.p;
+   freeNode(it.p);
    numElements--;
    return itNext;
 }
@@ -781,6 +963,8 @@ template <typename T>
 typename list <T> :: iterator list <T> :: insert(list <T> :: iterator it,
                                                  const T & data)
 {
+   INSTRUMENT(INSTRUMENT_LIST, INSTRUMENT_INSERT);
+
    // empty list case
    if (empty())
    {
@@ -844,6 +1028,8 @@ template <typename T>
 typename list <T> :: iterator list <T> :: insert(list <T> :: iterator it,
    T && data)
 {
+   INSTRUMENT(INSTRUMENT_LIST, INSTRUMENT_INSERT);
+
    // empty list case
    if (empty())
    {
@@ -903,6 +1089,609 @@ typename list <T> :: iterator list <T> :: insert(list <T> :: iterator it,
    return it;
 }
 
+/******************************************
+ * LIST :: EMPLACE
+ * build an item in place in the middle of the list. The
+ * arguments go straight to T's constructor inside the new node,
+ * so there is no temporary T to move and then destroy
+ *     INPUT  : an iterator to the location where it is to be inserted
+ *              whatever T's constructor takes
+ *     OUTPUT : iterator to the new item
+ *     COST   : O(1)
+ ******************************************/
+template <typename T>
+template <class ... Args>
+typename list <T> :: iterator list <T> :: emplace(list <T> :: iterator it,
+                                                  Args&& ... args)
+{
+   INSTRUMENT(INSTRUMENT_LIST, INSTRUMENT_INSERT);
+   assert(numElements >= 0);
+
+   list <T> :: Node * pNew;
+   try
+   {
+      pNew = new list <T> :: Node(typename list <T> :: Node :: emplace_t(),
+                                  std::forward<Args>(args)...);
+   }
+   catch (...)
+   {
+      throw "ERROR: unable to allocate a new node for a list";
+   }
+
+   // empty list case
+   if (empty())
+   {
+      assert(pTail == nullptr && pHead == nullptr);
+      pHead = pTail = pNew;
+   }
+   // end of list case
+   else if (it == end())
+   {
+      pTail->pNext = pNew;
+      pNew->pPrev = pTail;
+      pTail = pNew;
+   }
+   // otherwise we go in front of it
+   else
+   {
+      pNew->pPrev = it.p->pPrev;
+      pNew->pNext = it.p;
+      if (pNew->pPrev)
+         pNew->pPrev->pNext = pNew;
+      else
+         pHead = pNew;
+      it.p->pPrev = pNew;
+   }
+
+   numElements++;
+   return iterator(pNew);
+}
+
+/******************************************
+ * LIST :: SPLICE
+ * move every node of rhs in front of pos. No node is
+ * allocated or copied and no iterator is invalidated
+ *     INPUT  : where they go and the list they come from
+ *     OUTPUT : rhs is empty
+ *     COST   : O(1)
+ ******************************************/
+template <typename T>
+void list <T> :: splice(list <T> :: iterator pos, list <T> & rhs)
+{
+   if (&rhs == this || rhs.empty())
+      return;
+   transfer(pos.p, rhs, rhs.pHead, rhs.pTail, rhs.numElements);
+}
+
+/******************************************
+ * LIST :: SPLICE
+ * move one node, it, from rhs in front of pos. rhs
+ * may be this list
+ *     INPUT  : where it goes, the list it comes from and the node
+ *     COST   : O(1)
+ ******************************************/
+template <typename T>
+void list <T> :: splice(list <T> :: iterator pos, list <T> & rhs,
+                        list <T> :: iterator it)
+{
+   assert(it.p != nullptr);
+
+   // already right there
+   if (pos.p == it.p || (&rhs == this && pos.p == it.p->pNext))
+      return;
+   transfer(pos.p, rhs, it.p, it.p, 1);
+}
+
+/******************************************
+ * LIST :: SPLICE
+ * move the nodes [first, last) of rhs in front of pos.
+ * rhs may be this list as long as pos is not in the range
+ *     INPUT  : where they go, the list they come from and the range
+ *     COST   : O(1) within one list, O(last - first) between two
+ *              since the sizes must be kept
+ ******************************************/
+template <typename T>
+void list <T> :: splice(list <T> :: iterator pos, list <T> & rhs,
+                        list <T> :: iterator first, list <T> :: iterator last)
+{
+   // nothing to move, or already right there
+   if (first == last || (&rhs == this && (pos == first || pos == last)))
+      return;
+
+   size_t num = 0;
+   if (&rhs != this)
+      for (Node * p = first.p; p != last.p; p = p->pNext)
+         num++;
+
+   transfer(pos.p, rhs, first.p, (last.p ? last.p->pPrev : rhs.pTail), num);
+}
+
+/******************************************
+ * LIST :: MERGE
+ * move every node of the sorted rhs into this sorted
+ * list, keeping it sorted. Equal elements of this
+ * list stay ahead of those from rhs
+ *     INPUT  : the list to empty into this one and the ordering
+ *     OUTPUT : rhs is empty
+ *     COST   : O(n + m) comparisons, no allocations or copies
+ ******************************************/
+template <typename T>
+template <class Compare>
+void list <T> :: merge(list <T> & rhs, Compare comp)
+{
+   if (&rhs == this || rhs.empty())
+      return;
+
+   adopt(rhs);
+   pHead = mergeChains(pHead, rhs.pHead, comp);
+   numElements += rhs.numElements;
+   relink();
+
+   rhs.pHead = rhs.pTail = nullptr;
+   rhs.numElements = 0;
+}
+
+/******************************************
+ * LIST :: SORT
+ * A stable bottom-up merge sort. Each node is taken off
+ * the front and merged up through a ladder of sorted runs
+ * where run i holds 2^i nodes, the way a binary counter
+ * carries. Only pNext is touched until the end, when one
+ * pass puts pPrev and pTail right
+ *     INPUT  : the ordering
+ *     COST   : O(n log n) comparisons, no allocations or copies
+ ******************************************/
+template <typename T>
+template <class Compare>
+void list <T> :: sort(Compare comp)
+{
+   if (numElements < 2)
+      return;
+
+   // enough runs for 2^64 nodes
+   Node * runs[64] = {};
+   int numRuns = 0;
+
+   Node * pNext;
+   for (Node * p = pHead; p; p = pNext)
+   {
+      pNext = p->pNext;
+      p->pNext = nullptr;
+
+      // carry the new node up the ladder. The run already there is older
+      // so it goes on the left to keep the sort stable
+      Node * pCarry = p;
+      int i = 0;
+      for (; i < numRuns && runs[i]; i++)
+      {
+         pCarry = mergeChains(runs[i], pCarry, comp);
+         runs[i] = nullptr;
+      }
+      runs[i] = pCarry;
+      if (i == numRuns)
+         numRuns++;
+   }
+
+   // the higher the run the older its nodes
+   Node * pSorted = nullptr;
+   for (int i = 0; i < numRuns; i++)
+      if (runs[i])
+         pSorted = (pSorted ? mergeChains(runs[i], pSorted, comp) : runs[i]);
+
+   pHead = pSorted;
+   relink();
+}
+
+/******************************************
+ * LIST :: TRANSFER
+ * unhook pFirst through pLast from rhs and hook them in
+ * front of pPos, which is nullptr for the end. Within one
+ * list num is ignored since the size does not change.
+ * When rhs was compacted, we take on its blocks as well
+ ******************************************/
+template <typename T>
+void list <T> :: transfer(list <T> :: Node * pPos, list <T> & rhs,
+                          list <T> :: Node * pFirst, list <T> :: Node * pLast,
+                          size_t num)
+{
+   assert(pFirst != nullptr && pLast != nullptr);
+   if (&rhs != this)
+      adopt(rhs);
+
+   // out of rhs
+   if (pFirst->pPrev)
+      pFirst->pPrev->pNext = pLast->pNext;
+   else
+      rhs.pHead = pLast->pNext;
+   if (pLast->pNext)
+      pLast->pNext->pPrev = pFirst->pPrev;
+   else
+      rhs.pTail = pFirst->pPrev;
+
+   // into this list
+   linkBefore(pPos, pFirst, pLast);
+
+   if (&rhs != this)
+   {
+      rhs.numElements -= num;
+      numElements += num;
+   }
+}
+
+/******************************************
+ * LIST :: LINK BEFORE
+ * hook a chain already linked from pFirst to pLast in
+ * front of pPos, which is nullptr for the end
+ ******************************************/
+template <typename T>
+void list <T> :: linkBefore(list <T> :: Node * pPos,
+                            list <T> :: Node * pFirst, list <T> :: Node * pLast)
+{
+   Node * pBefore = (pPos ? pPos->pPrev : pTail);
+   pFirst->pPrev = pBefore;
+   pLast->pNext = pPos;
+   if (pBefore)
+      pBefore->pNext = pFirst;
+   else
+      pHead = pFirst;
+   if (pPos)
+      pPos->pPrev = pLast;
+   else
+      pTail = pLast;
+}
+
+/******************************************
+ * LIST :: MERGE CHAINS
+ * merge two sorted chains linked by pNext alone. On a
+ * tie the left one goes first
+ ******************************************/
+template <typename T>
+template <class Compare>
+typename list <T> :: Node * list <T> :: mergeChains(list <T> :: Node * pLeft,
+                                                    list <T> :: Node * pRight,
+                                                    Compare & comp)
+{
+   Node * pMerged = nullptr;
+   Node ** ppEnd = &pMerged;
+   while (pLeft && pRight)
+   {
+      if (comp(pRight->data, pLeft->data))
+      {
+         *ppEnd = pRight;
+         pRight = pRight->pNext;
+      }
+      else
+      {
+         *ppEnd = pLeft;
+         pLeft = pLeft->pNext;
+      }
+      ppEnd = &(*ppEnd)->pNext;
+   }
+   *ppEnd = (pLeft ? pLeft : pRight);
+   return pMerged;
+}
+
+/******************************************
+ * LIST :: RELINK
+ * walk the pNext chain from pHead setting every pPrev
+ * and, at the end, pTail
+ ******************************************/
+template <typename T>
+void list <T> :: relink()
+{
+   Node * pPrev = nullptr;
+   for (Node * p = pHead; p; p = p->pNext)
+   {
+      p->pPrev = pPrev;
+      pPrev = p;
+   }
+   pTail = pPrev;
+}
+
+/******************************************
+ * LIST :: COMPACT
+ * After enough inserts and erases the nodes are all over
+ * the heap and a walk down the list misses the cache, and
+ * the TLB, at every step. Move every element, in list
+ * order, into one new block and link them there. Elements
+ * are moved unless their move might throw, in which case
+ * they are copied so a throw leaves the list as it was.
+ * Every iterator into the list is invalidated
+ *     INPUT  :
+ *     OUTPUT : the list is the same, its nodes side by side
+ *     COST   : O(n), one allocation
+ ******************************************/
+template <typename T>
+void list <T> :: compact()
+{
+   if (empty())
+      return;
+
+   // room to remember the block, so nothing can throw once nodes move
+   blockTable().reserve(numBlocks() + 1);
+
+   // build the new nodes, leaving the old ones untouched until all are made
+   Node * pOld = pHead;
+   Block * pBlock = buildBlock(numElements, [&pOld](Node * pNode)
+   {
+      new (pNode) Node(typename Node::emplace_t(), std::move_if_noexcept(pOld->data));
+      pOld = pOld->pNext;
+   });
+
+   // free the old nodes, emptying the old blocks, and use the new ones
+   Node * pNext;
+   for (Node * p = pHead; p; p = pNext)
+   {
+      pNext = p->pNext;
+      freeNode(p);
+   }
+   pHead = pBlock->pBegin;
+   pTail = pBlock->pEnd - 1;
+   insertBlock(pBlock);
+}
+
+/******************************************
+ * LIST :: INSERT RANGE
+ * one element at a time into a list to the side, which
+ * is spliced in once the range runs out. A throw leaves
+ * this list as it was
+ *     INPUT  : where they go and the range
+ *     OUTPUT : iterator to the first one, or it for none
+ *     COST   : O(n), one allocation per element
+ ******************************************/
+template <typename T>
+template <class Iterator>
+typename list <T> :: iterator list <T> :: insertRange(list <T> :: iterator it,
+                                                     Iterator first, Iterator last,
+                                                     std::input_iterator_tag)
+{
+   list <T> chain;
+   for (; first != last; ++first)
+      chain.emplace_back(*first);
+   if (chain.empty())
+      return it;
+
+   Node * pFirst = chain.pHead;
+   splice(it, chain);
+   return iterator(pFirst);
+}
+
+/******************************************
+ * LIST :: INSERT RANGE
+ * the range can be counted, so every node is built and
+ * linked in one block before any of them is hooked in
+ * front of it. A throw leaves this list as it was
+ *     INPUT  : where they go and the range
+ *     OUTPUT : iterator to the first one, or it for none
+ *     COST   : O(n), one allocation
+ ******************************************/
+template <typename T>
+template <class Iterator>
+typename list <T> :: iterator list <T> :: insertRange(list <T> :: iterator it,
+                                                     Iterator first, Iterator last,
+                                                     std::forward_iterator_tag)
+{
+   INSTRUMENT(INSTRUMENT_LIST, INSTRUMENT_INSERT);
+   size_t num = (size_t)std::distance(first, last);
+   if (num == 0)
+      return it;
+   if (num == 1)
+      return emplace(it, *first);
+
+   // room to remember the block, so nothing can throw once it is built
+   blockTable().reserve(numBlocks() + 1);
+   Block * pBlock = buildBlock(num, [&first](Node * pNode)
+   {
+      new (pNode) Node(typename Node::emplace_t(), *first);
+      ++first;
+   });
+
+   linkBefore(it.p, pBlock->pBegin, pBlock->pEnd - 1);
+   insertBlock(pBlock);
+   numElements += num;
+   return iterator(pBlock->pBegin);
+}
+
+/******************************************
+ * LIST :: ASSIGN
+ * replace everything with a copy of the range. The new
+ * list is built to the side first, so a throw leaves
+ * this one as it was. The range may be in this list
+ *     INPUT  : the range
+ *     COST   : O(n + m), one allocation from forward iterators
+ ******************************************/
+template <typename T>
+template <class Iterator, class Category>
+void list <T> :: assign(Iterator first, Iterator last)
+{
+   list <T> replacement;
+   replacement.insertRange(replacement.end(), first, last, Category());
+   swap(*this, replacement);
+}
+
+/******************************************
+ * LIST :: BUILD BLOCK
+ * one allocation for the block header, padded so what
+ * follows is aligned, and num nodes. make(pNode) builds
+ * each in order and it is linked to the one before. A
+ * throw destroys what was built and frees the block
+ ******************************************/
+template <typename T>
+template <class Make>
+typename list <T> :: Block * list <T> :: buildBlock(size_t num, Make make)
+{
+   assert(num > 0);
+   const size_t sizeHeader = (sizeof(Block) + alignof(Node) - 1) / alignof(Node) * alignof(Node);
+   char * pMemory;
+   try
+   {
+      pMemory = static_cast<char *>(::operator new(sizeHeader + num * sizeof(Node)));
+   }
+   catch (...)
+   {
+      throw "ERROR: unable to allocate a new node for a list";
+   }
+   Block * pBlock = new (pMemory) Block;
+   pBlock->pBegin = reinterpret_cast<Node *>(pMemory + sizeHeader);
+   pBlock->pEnd = pBlock->pBegin + num;
+   pBlock->numLive = num;
+   pBlock->numLists = 1;
+
+   Node * pNodes = pBlock->pBegin;
+   size_t i = 0;
+   try
+   {
+      for (; i < num; i++)
+      {
+         make(pNodes + i);
+         if (i > 0)
+         {
+            pNodes[i].pPrev = pNodes + i - 1;
+            pNodes[i - 1].pNext = pNodes + i;
+         }
+      }
+   }
+   catch (...)
+   {
+      while (i-- > 0)
+         pNodes[i].~Node();
+      pBlock->~Block();
+      ::operator delete(pMemory);
+      throw;
+   }
+   return pBlock;
+}
+
+/******************************************
+ * LIST :: BLOCK TABLE
+ * a list that never compacts or inserts a range never
+ * pays for the table, so it is made on first use
+ ******************************************/
+template <typename T>
+typename list <T> :: BlockTable & list <T> :: blockTable()
+{
+   if (!pBlocks)
+   {
+      try
+      {
+         pBlocks = new BlockTable;
+      }
+      catch (...)
+      {
+         throw "ERROR: unable to allocate a block table for a list";
+      }
+   }
+   return *pBlocks;
+}
+
+/******************************************
+ * LIST :: FIND BLOCK
+ * the table is kept in address order, so the only block
+ * that might hold p is the last to start at or before it
+ ******************************************/
+template <typename T>
+typename list <T> :: BlockTable::iterator
+list <T> :: findBlock(const list <T> :: Node * p)
+{
+   assert(pBlocks != nullptr);
+   BlockTable & blocks = *pBlocks;
+   auto it = std::upper_bound(blocks.begin(), blocks.end(), p,
+      [](const Node * p, const Block * pBlock)
+      {
+         return std::less<const Node *>()(p, pBlock->pBegin);
+      });
+   if (it == blocks.begin() || !(*(it - 1))->owns(p))
+      return blocks.end();
+   return it - 1;
+}
+
+/******************************************
+ * LIST :: INSERT BLOCK
+ * into the table, in address order. The caller reserved
+ * the room so this cannot throw
+ ******************************************/
+template <typename T>
+void list <T> :: insertBlock(list <T> :: Block * pBlock)
+{
+   assert(pBlocks != nullptr);
+   BlockTable & blocks = *pBlocks;
+   assert(blocks.size() < blocks.capacity());
+   auto it = std::lower_bound(blocks.begin(), blocks.end(), pBlock,
+      [](const Block * pLeft, const Block * pRight)
+      {
+         return std::less<const Node *>()(pLeft->pBegin, pRight->pBegin);
+      });
+   blocks.insert(it, pBlock);
+}
+
+/******************************************
+ * LIST :: FREE NODE
+ * a node in one of our blocks is destroyed where it is;
+ * the block goes when its last node does. Any other
+ * node came from new. With no blocks this is just delete
+ ******************************************/
+template <typename T>
+void list <T> :: freeNode(list <T> :: Node * p)
+{
+   if (numBlocks())
+   {
+      auto it = findBlock(p);
+      if (it != pBlocks->end())
+      {
+         Block * pBlock = *it;
+         p->~Node();
+         if (pBlock->numLive.fetch_sub(1, std::memory_order_acq_rel) == 1)
+         {
+            pBlocks->erase(it);
+            releaseBlock(pBlock);
+         }
+         return;
+      }
+   }
+   delete p;
+}
+
+/******************************************
+ * LIST :: ADOPT
+ * nodes are coming over from rhs, so any block of rhs
+ * may hold some of ours from now on
+ ******************************************/
+template <typename T>
+void list <T> :: adopt(list <T> & rhs)
+{
+   if (!rhs.numBlocks())
+      return;
+
+   // reserve first, so a throw leaves both lists alone
+   blockTable().reserve(numBlocks() + rhs.numBlocks());
+   for (Block * pBlock : *rhs.pBlocks)
+      if (findBlock(pBlock->pBegin) == pBlocks->end())
+      {
+         insertBlock(pBlock);
+         pBlock->numLists.fetch_add(1, std::memory_order_relaxed);
+      }
+}
+
+/******************************************
+ * LIST :: RELEASE BLOCK
+ * one less list refers to pBlock. Only once no list does
+ * and no node is left in it can it be freed: until then a
+ * list could still range check a node against it. The list
+ * that frees the last node releases the block after, so
+ * whichever list releases it last sees no node left
+ ******************************************/
+template <typename T>
+void list <T> :: releaseBlock(list <T> :: Block * pBlock)
+{
+   assert(pBlock->numLists.load(std::memory_order_relaxed) > 0);
+   if (pBlock->numLists.fetch_sub(1, std::memory_order_acq_rel) == 1 &&
+       pBlock->numLive.load(std::memory_order_acquire) == 0)
+   {
+      pBlock->~Block();
+      ::operator delete(pBlock);
+   }
+}
+
 /**********************************************
  * LIST :: assignment operator - MOVE
  * Copy one list onto another
@@ -927,6 +1716,11 @@ void swap(list <T> & lhs, list <T> & rhs)
    auto numTemp = lhs.numElements;
    lhs.numElements = rhs.numElements;
    rhs.numElements = numTemp;
+
+   // and the blocks the nodes may be in
+   auto pBlocksTemp = lhs.pBlocks;
+   lhs.pBlocks = rhs.pBlocks;
+   rhs.pBlocks = pBlocksTemp;
 }
 
 
@@ -0,0 +1,307 @@
+/***********************************************************************
+ * Header:
+ *    LOCK FREE LIST
+ * Summary:
+ *    A sorted set as a singly linked list that any number of threads
+ *    may insert into, erase from and search at once without a lock:
+ *    the Harris-Michael list, the usual building block for lock-free
+ *    hash buckets.
+ *
+ *    Every link is an atomic word whose low bit marks the node it
+ *    belongs to as erased. Erasing is two steps: set the mark on the
+ *    node's own next link, which no one can then change, and then
+ *    swing the link before it past the node. Anyone who finds a
+ *    marked node on the way finishes the second step for it. Only the
+ *    thread whose compare-and-swap takes a node out retires it to the
+ *    Reclaimer, which frees it once no thread can still be reading it.
+ *
+ *    This will contain the class definition of:
+ *        lock_free_list : A sorted set safe for concurrent use
+ ************************************************************************/
+
+#pragma once
+
+#include <atomic>      // for std::atomic
+#include <cstddef>     // for size_t
+#include <cstdint>     // for std::uintptr_t
+#include <functional>  // for std::less
+#include "reclaim.h"   // for reclaimable and epoch_reclaimer
+
+namespace custom
+{
+
+/**************************************************
+ * LOCK FREE LIST
+ * Each element at most once, in Compare order. Every
+ * member but the destructor may be called from any
+ * thread at any time
+ **************************************************/
+template <typename T,
+          class Compare = std::less<T>,
+          class Reclaimer = epoch_reclaimer>
+class lock_free_list
+{
+public:
+   //
+   // Construct
+   //
+
+   lock_free_list() : head(0), numElements(0) {}
+  ~lock_free_list();
+   lock_free_list(const lock_free_list &) = delete;
+   lock_free_list & operator = (const lock_free_list &) = delete;
+
+   //
+   // Operations: each is linearizable
+   //
+
+   bool insert(const T & t);        // false when t was already there
+   bool erase(const T & t);         // false when t was not there
+   bool contains(const T & t);
+
+   // visit every element not erased, in order. Not a snapshot: what
+   // other threads do meanwhile may or may not be seen
+   template <class Function>
+   void for_each(Function f);
+
+   //
+   // Status: exact only when no one is changing the list
+   //
+
+   size_t size()  const { return numElements.load(std::memory_order_relaxed); }
+   bool   empty() const { return size() == 0; }
+   Reclaimer & reclaimer() { return reclaim; }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   class Node;
+
+   // a link: a pointer to the next node, the low bit set once the node
+   // holding the link is erased
+   typedef std::atomic<std::uintptr_t> Link;
+   static Node * pointer(std::uintptr_t link) { return reinterpret_cast<Node *>(link & ~std::uintptr_t(1)); }
+   static bool   marked (std::uintptr_t link) { return (link & 1) != 0;                                   }
+   static std::uintptr_t word(Node * p)       { return reinterpret_cast<std::uintptr_t>(p);               }
+
+   // where t is or would go: the link to pCurr, pCurr the first node not
+   // less than t (or nullptr) and pNext the node after it
+   struct Position
+   {
+      Link * pPrev;
+      Node * pCurr;
+      Node * pNext;
+   };
+   bool find(const T & t, Position & pos);
+
+   Link head;                        // the first node
+   std::atomic<size_t> numElements;  // elements not erased
+   Compare compare;
+   Reclaimer reclaim;
+};
+
+/*************************************************
+ * NODE
+ * An element and the marked link to the next one
+ *************************************************/
+template <typename T, class Compare, class Reclaimer>
+class lock_free_list <T, Compare, Reclaimer> :: Node : public reclaimable
+{
+public:
+   Node(const T & data) : reclaimable(&destroyNode), data(data), next(0) {}
+
+   static void destroyNode(reclaimable * p) { delete static_cast<Node *>(p); }
+
+   T data;
+   Link next;
+};
+
+/*****************************************
+ * LOCK FREE LIST :: DESTRUCTOR
+ * No other thread may be using the list. Whatever is
+ * still linked, erased or not, is ours to delete; the
+ * reclaimer frees what was retired
+ ****************************************/
+template <typename T, class Compare, class Reclaimer>
+lock_free_list <T, Compare, Reclaimer> :: ~lock_free_list()
+{
+   Node * p = pointer(head.load(std::memory_order_acquire));
+   while (p)
+   {
+      Node * pNext = pointer(p->next.load(std::memory_order_relaxed));
+      delete p;
+      p = pNext;
+   }
+}
+
+/******************************************
+ * LOCK FREE LIST :: FIND
+ * Walk to the first node not less than t, taking out
+ * every erased node on the way. Start over whenever
+ * the link we came through changes under us
+ *     INPUT  : what to look for
+ *     OUTPUT : whether it is there, and where it is or would go
+ ******************************************/
+template <typename T, class Compare, class Reclaimer>
+bool lock_free_list <T, Compare, Reclaimer> :: find(const T & t, Position & pos)
+{
+start:
+   pos.pPrev = &head;
+   pos.pCurr = pointer(head.load(std::memory_order_acquire));
+   while (true)
+   {
+      if (pos.pCurr == nullptr)
+         return false;
+
+      std::uintptr_t next = pos.pCurr->next.load(std::memory_order_acquire);
+      pos.pNext = pointer(next);
+
+      // the node before was erased, or pCurr was taken out meanwhile
+      if (pos.pPrev->load(std::memory_order_acquire) != word(pos.pCurr))
+         goto start;
+
+      if (!marked(next))
+      {
+         if (!compare(pos.pCurr->data, t))
+            return !compare(t, pos.pCurr->data);
+         pos.pPrev = &pos.pCurr->next;
+      }
+      else
+      {
+         // pCurr is erased: take it out, and retire it if we did
+         std::uintptr_t expected = word(pos.pCurr);
+         if (!pos.pPrev->compare_exchange_strong(expected, word(pos.pNext),
+                                                 std::memory_order_acq_rel,
+                                                 std::memory_order_relaxed))
+            goto start;
+         reclaim.retire(pos.pCurr);
+      }
+      pos.pCurr = pos.pNext;
+   }
+}
+
+/******************************************
+ * LOCK FREE LIST :: INSERT
+ * link a new node in front of the first node not less
+ * than t, unless t is already there
+ *     INPUT  : the element
+ *     OUTPUT : whether it went in
+ *     COST   : O(n), lock-free
+ ******************************************/
+template <typename T, class Compare, class Reclaimer>
+bool lock_free_list <T, Compare, Reclaimer> :: insert(const T & t)
+{
+   typename Reclaimer::guard guard(reclaim);
+   Node * pNew = nullptr;
+   Position pos;
+   while (true)
+   {
+      if (find(t, pos))
+      {
+         delete pNew;
+         return false;
+      }
+
+      if (pNew == nullptr)
+      {
+         try
+         {
+            pNew = new Node(t);
+         }
+         catch (...)
+         {
+            throw "ERROR: unable to allocate a new node for a lock free list";
+         }
+      }
+
+      // the new node is complete before the release that links it in
+      pNew->next.store(word(pos.pCurr), std::memory_order_relaxed);
+      std::uintptr_t expected = word(pos.pCurr);
+      if (pos.pPrev->compare_exchange_strong(expected, word(pNew),
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed))
+      {
+         numElements.fetch_add(1, std::memory_order_relaxed);
+         return true;
+      }
+   }
+}
+
+/******************************************
+ * LOCK FREE LIST :: ERASE
+ * mark the node holding t, which is the moment it is
+ * erased, then try once to take it out. If that fails
+ * someone changed the link before it, so walk past it
+ * again and let find() take it out
+ *     INPUT  : the element
+ *     OUTPUT : whether it was there to erase
+ *     COST   : O(n), lock-free
+ ******************************************/
+template <typename T, class Compare, class Reclaimer>
+bool lock_free_list <T, Compare, Reclaimer> :: erase(const T & t)
+{
+   typename Reclaimer::guard guard(reclaim);
+   Position pos;
+   while (true)
+   {
+      if (!find(t, pos))
+         return false;
+
+      // whoever marks it erases it
+      std::uintptr_t next = word(pos.pNext);
+      if (!pos.pCurr->next.compare_exchange_strong(next, next | 1,
+                                                   std::memory_order_acq_rel,
+                                                   std::memory_order_relaxed))
+         continue;
+      numElements.fetch_sub(1, std::memory_order_relaxed);
+
+      std::uintptr_t expected = word(pos.pCurr);
+      if (pos.pPrev->compare_exchange_strong(expected, next,
+                                             std::memory_order_acq_rel,
+                                             std::memory_order_relaxed))
+         reclaim.retire(pos.pCurr);
+      else
+         find(t, pos);
+      return true;
+   }
+}
+
+/******************************************
+ * LOCK FREE LIST :: CONTAINS
+ * walk without changing anything. Erased nodes on the
+ * way are still safe to read under the guard
+ *     INPUT  : the element
+ *     OUTPUT : whether it is there and not erased
+ *     COST   : O(n), wait-free
+ ******************************************/
+template <typename T, class Compare, class Reclaimer>
+bool lock_free_list <T, Compare, Reclaimer> :: contains(const T & t)
+{
+   typename Reclaimer::guard guard(reclaim);
+   Node * p = pointer(head.load(std::memory_order_acquire));
+   while (p && compare(p->data, t))
+      p = pointer(p->next.load(std::memory_order_acquire));
+   return p && !compare(t, p->data) && !marked(p->next.load(std::memory_order_acquire));
+}
+
+/******************************************
+ * LOCK FREE LIST :: FOR EACH
+ * call f on every element not erased when we pass it
+ ******************************************/
+template <typename T, class Compare, class Reclaimer>
+template <class Function>
+void lock_free_list <T, Compare, Reclaimer> :: for_each(Function f)
+{
+   typename Reclaimer::guard guard(reclaim);
+   for (Node * p = pointer(head.load(std::memory_order_acquire)); p; )
+   {
+      std::uintptr_t next = p->next.load(std::memory_order_acquire);
+      if (!marked(next))
+         f(static_cast<const T &>(p->data));
+      p = pointer(next);
+   }
+}
+
+} // namespace custom
@@ -0,0 +1,183 @@
+/***********************************************************************
+ * Header:
+ *    MPSC QUEUE
+ * Summary:
+ *    A lock-free queue from any number of producer threads to one
+ *    consumer, built out of list nodes so that what the consumer
+ *    takes is already a list.
+ *
+ *    A producer builds its node and links it back to the node pushed
+ *    before it through pPrev, then publishes it with one
+ *    compare-and-swap on the newest node. The link is written before
+ *    the node can be seen, so the consumer never meets a half-linked
+ *    chain. The consumer takes every node at once by swapping the
+ *    newest node for nullptr, walks the chain once to fill in pNext
+ *    and count it, and splices it onto the end of a list. Nothing is
+ *    allocated or copied after the push, and there is no ABA since
+ *    nodes are never popped from the shared end one at a time.
+ *
+ *    This will contain the class definition of:
+ *        mpsc_queue : A multiple producer, single consumer queue
+ ************************************************************************/
+
+#pragma once
+
+#include <atomic>      // for std::atomic
+#include <cstddef>     // for size_t
+#include <utility>     // for std::move and std::forward
+#include "list.h"
+
+namespace custom
+{
+
+/**************************************************
+ * MPSC QUEUE
+ * push() and emplace() from any thread; try_pop(),
+ * pop_all() and empty() from the one consumer only
+ **************************************************/
+template <typename T>
+class mpsc_queue
+{
+public:
+   //
+   // Construct
+   //
+
+   mpsc_queue() : pNewest(nullptr) {}
+  ~mpsc_queue()
+   {
+      list <T> rest;
+      take(rest);
+   }
+   mpsc_queue(const mpsc_queue &) = delete;
+   mpsc_queue & operator = (const mpsc_queue &) = delete;
+
+   //
+   // Push: any thread
+   //
+
+   void push(const T &  t) { emplace(t);            }
+   void push(      T && t) { emplace(std::move(t)); }
+   template <class ... Args>
+   void emplace(Args && ... args);
+
+   //
+   // Pop: the consumer
+   //
+
+   bool try_pop(T & t);
+   size_t pop_all(list <T> & l);
+   bool empty() const
+   {
+      return pending.empty() && pNewest.load(std::memory_order_acquire) == nullptr;
+   }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   typedef typename list <T> :: Node Node;
+
+   // take every node pushed so far onto the end of l
+   size_t take(list <T> & l);
+
+   // the producers' end, the newest node, alone on its cache line
+   alignas(64) std::atomic<Node *> pNewest;
+
+   // taken by try_pop() but not yet popped. The consumer's alone,
+   // so it starts a line of its own
+   alignas(64) list <T> pending;
+};
+
+/*****************************************
+ * MPSC QUEUE :: EMPLACE
+ * build the node, then link it to the newest and make
+ * it the newest in one step
+ *     INPUT  : whatever T's constructor takes
+ *     COST   : O(1), one allocation, lock-free
+ ****************************************/
+template <typename T>
+template <class ... Args>
+void mpsc_queue <T> :: emplace(Args && ... args)
+{
+   Node * pNode;
+   try
+   {
+      pNode = new Node(typename Node::emplace_t(), std::forward<Args>(args)...);
+   }
+   catch (...)
+   {
+      throw "ERROR: unable to allocate a new node for a list";
+   }
+
+   // pPrev is written before the release that publishes the node
+   Node * pPrev = pNewest.load(std::memory_order_relaxed);
+   do
+      pNode->pPrev = pPrev;
+   while (!pNewest.compare_exchange_weak(pPrev, pNode,
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed));
+}
+
+/*****************************************
+ * MPSC QUEUE :: TRY POP
+ * the oldest element, if there is one
+ *     INPUT  : where to move it
+ *     OUTPUT : whether there was one
+ *     COST   : O(1) amortized over the nodes taken at once
+ ****************************************/
+template <typename T>
+bool mpsc_queue <T> :: try_pop(T & t)
+{
+   if (pending.empty() && take(pending) == 0)
+      return false;
+   t = std::move(pending.front());
+   pending.pop_front();
+   return true;
+}
+
+/*****************************************
+ * MPSC QUEUE :: POP ALL
+ * everything in the queue, oldest first, onto the end of
+ * l. The nodes themselves move: no allocation or copy
+ *     INPUT  : the list to append to
+ *     OUTPUT : how many were appended
+ *     COST   : O(n) to link the chain, one atomic exchange
+ ****************************************/
+template <typename T>
+size_t mpsc_queue <T> :: pop_all(list <T> & l)
+{
+   size_t num = pending.size();
+   l.splice(l.end(), pending);
+   return num + take(l);
+}
+
+/*****************************************
+ * MPSC QUEUE :: TAKE
+ * swap out the newest node, walk back to the oldest
+ * setting pNext, and hook the chain onto l
+ ****************************************/
+template <typename T>
+size_t mpsc_queue <T> :: take(list <T> & l)
+{
+   // the acquire sees every pPrev written before a push was published
+   Node * pLast = pNewest.exchange(nullptr, std::memory_order_acquire);
+   if (pLast == nullptr)
+      return 0;
+
+   size_t num = 0;
+   Node * pFirst = nullptr;
+   for (Node * p = pLast; p; p = p->pPrev)
+   {
+      p->pNext = pFirst;
+      pFirst = p;
+      num++;
+   }
+
+   l.linkBefore(nullptr, pFirst, pLast);
+   l.numElements += num;
+   return num;
+}
+
+} // namespace custom
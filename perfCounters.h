@@ -0,0 +1,220 @@
+/***********************************************************************
+ * Header:
+ *    PERF COUNTERS
+ * Summary:
+ *    Hardware performance counters around a piece of code, through
+ *    Linux's perf_event_open. Containers and virtual machines often
+ *    hide some or all of the counters: whatever cannot be opened is
+ *    simply not reported, and on other systems nothing is.
+ *
+ *    This will contain the class definition of:
+ *        PerfReading  : What the counters saw, event by event
+ *        PerfCounters : Opens the counters, starts and stops them
+ ************************************************************************/
+
+#pragma once
+
+#include <cstdint>    // for std::uint64_t
+#include <cstring>    // for std::strerror
+#include <string>     // for std::string
+
+#ifdef __linux__
+#include <cerrno>              // for errno
+#include <linux/perf_event.h>  // for perf_event_attr
+#include <sys/ioctl.h>         // for ioctl
+#include <sys/syscall.h>       // for SYS_perf_event_open
+#include <unistd.h>            // for syscall
+#endif // __linux__
+
+/*************************************************************
+ * PERF EVENT
+ *************************************************************/
+enum PerfEvent
+{
+   PERF_CYCLES,
+   PERF_INSTRUCTIONS,
+   PERF_BRANCH_MISSES,
+   PERF_L1D_MISSES,
+   PERF_LLC_MISSES,
+   PERF_DTLB_MISSES,
+   PERF_NUM_EVENTS
+};
+
+/*************************************************************
+ * PERF READING
+ * How many of each event happened, scaled up when the kernel
+ * had to share the hardware between more counters than it has
+ *************************************************************/
+struct PerfReading
+{
+   PerfReading()
+   {
+      for (int i = 0; i < PERF_NUM_EVENTS; i++)
+      {
+         valid[i] = false;
+         count[i] = 0.0;
+      }
+   }
+
+   bool any() const
+   {
+      for (int i = 0; i < PERF_NUM_EVENTS; i++)
+         if (valid[i])
+            return true;
+      return false;
+   }
+
+   bool   valid[PERF_NUM_EVENTS];   // was this event counted?
+   double count[PERF_NUM_EVENTS];   // how many times it happened
+};
+
+/*************************************************************
+ * PERF COUNTERS
+ * One counter per event for the calling thread and any thread
+ * it starts while counting. Only user space is counted
+ *************************************************************/
+class PerfCounters
+{
+public:
+   PerfCounters();
+  ~PerfCounters();
+   PerfCounters(const PerfCounters &) = delete;
+   PerfCounters & operator = (const PerfCounters &) = delete;
+
+   void start();
+   PerfReading stop();
+
+   bool available() const;                       // can anything be counted?
+   const std::string & error() const { return why; } // if not, why not
+
+   // short names for reports and JSON
+   static const char * name(int event)
+   {
+      static const char * names[PERF_NUM_EVENTS] =
+         { "cycles", "instructions", "branch_misses", "l1d_misses", "llc_misses", "dtlb_misses" };
+      return (event >= 0 && event < PERF_NUM_EVENTS ? names[event] : "unknown");
+   }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   int fds[PERF_NUM_EVENTS];   // -1 when the event could not be opened
+   std::string why;            // the first reason an event could not be opened
+};
+
+#ifdef __linux__
+
+/*****************************************
+ * PERF COUNTERS :: CONSTRUCTOR
+ * Open every counter we can
+ ****************************************/
+inline PerfCounters::PerfCounters()
+{
+   // hardware cache events are cache | operation << 8 | result << 16
+   auto cache = [](std::uint64_t id) -> std::uint64_t
+   {
+      return id | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+   };
+   const std::uint32_t types[PERF_NUM_EVENTS] =
+   {
+      PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+      PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE
+   };
+   const std::uint64_t configs[PERF_NUM_EVENTS] =
+   {
+      PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES,
+      cache(PERF_COUNT_HW_CACHE_L1D), cache(PERF_COUNT_HW_CACHE_LL), cache(PERF_COUNT_HW_CACHE_DTLB)
+   };
+
+   for (int i = 0; i < PERF_NUM_EVENTS; i++)
+   {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size           = sizeof(attr);
+      attr.type           = types[i];
+      attr.config         = configs[i];
+      attr.disabled       = 1;
+      attr.inherit        = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv     = 1;
+      attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+      fds[i] = (int)syscall(SYS_perf_event_open, &attr, 0 /*this thread*/, -1 /*any cpu*/,
+                            -1 /*no group*/, 0);
+      if (fds[i] < 0 && why.empty())
+         why = std::string(name(i)) + ": " + std::strerror(errno);
+   }
+}
+
+/*****************************************
+ * PERF COUNTERS :: DESTRUCTOR
+ ****************************************/
+inline PerfCounters::~PerfCounters()
+{
+   for (int i = 0; i < PERF_NUM_EVENTS; i++)
+      if (fds[i] >= 0)
+         close(fds[i]);
+}
+
+/*****************************************
+ * PERF COUNTERS :: START
+ * Zero every counter and let it run
+ ****************************************/
+inline void PerfCounters::start()
+{
+   for (int i = 0; i < PERF_NUM_EVENTS; i++)
+      if (fds[i] >= 0)
+      {
+         ioctl(fds[i], PERF_EVENT_IOC_RESET, 0);
+         ioctl(fds[i], PERF_EVENT_IOC_ENABLE, 0);
+      }
+}
+
+/*****************************************
+ * PERF COUNTERS :: STOP
+ * Stop every counter and read what it saw
+ ****************************************/
+inline PerfReading PerfCounters::stop()
+{
+   for (int i = 0; i < PERF_NUM_EVENTS; i++)
+      if (fds[i] >= 0)
+         ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+
+   PerfReading reading;
+   for (int i = 0; i < PERF_NUM_EVENTS; i++)
+   {
+      // the count, how long it was enabled, and how long it really ran
+      std::uint64_t values[3];
+      if (fds[i] < 0 || read(fds[i], values, sizeof(values)) != (ssize_t)sizeof(values))
+         continue;
+      if (values[2] == 0)
+         continue;   // never got a turn on the hardware
+      reading.valid[i] = true;
+      reading.count[i] = (double)values[0] * ((double)values[1] / (double)values[2]);
+   }
+   return reading;
+}
+
+inline bool PerfCounters::available() const
+{
+   for (int i = 0; i < PERF_NUM_EVENTS; i++)
+      if (fds[i] >= 0)
+         return true;
+   return false;
+}
+
+#else // !__linux__
+
+inline PerfCounters::PerfCounters() : why("only available on Linux")
+{
+   for (int i = 0; i < PERF_NUM_EVENTS; i++)
+      fds[i] = -1;
+}
+inline PerfCounters::~PerfCounters()       {}
+inline void PerfCounters::start()          {}
+inline PerfReading PerfCounters::stop()    { return PerfReading(); }
+inline bool PerfCounters::available() const { return false; }
+
+#endif // __linux__
@@ -0,0 +1,544 @@
+/***********************************************************************
+ * Header:
+ *    RECLAIM
+ * Summary:
+ *    Safe memory reclamation for the lock-free containers. A node
+ *    taken out of a lock-free structure may still be being read by
+ *    another thread that reached it a moment earlier, so it cannot be
+ *    deleted right away. It is retired instead, and a reclaimer
+ *    deletes it once no thread can still be looking at it.
+ *
+ *    Every reclaimer has the same shape, so a container takes one as a
+ *    policy:
+ *        Reclaimer::guard g(reclaimer);  // around each operation
+ *        reclaimer.retire(pNode);        // once pNode is unlinked
+ *    Nodes derive from reclaimable, so retiring never allocates. A
+ *    concurrent hash bucket or list gets safe freeing by deriving its
+ *    Node from reclaimable and taking a Reclaimer the same way.
+ *
+ *    This will contain the class definition of:
+ *        reclaimable        : The base of anything that can be retired
+ *        deferred_reclaimer : Frees nothing until told no one is looking
+ *        epoch_reclaimer    : Frees in batches two epochs after retiring
+ ************************************************************************/
+
+#pragma once
+
+#include <atomic>      // for std::atomic
+#include <cstddef>     // for size_t
+#include <cstdint>     // for std::uint64_t
+
+namespace custom
+{
+
+/**************************************************
+ * RECLAIMABLE
+ * The link a reclaimer threads its retired nodes on,
+ * and how to delete one once it is safe
+ **************************************************/
+struct reclaimable
+{
+   reclaimable(void (*destroy)(reclaimable *)) : pNextRetired(nullptr), destroy(destroy) {}
+
+   reclaimable * pNextRetired;         // the next retired node
+   void (*destroy)(reclaimable *);     // delete the whole node
+};
+
+/**************************************************
+ * DEFERRED RECLAIMER
+ * The simplest safe policy: keep every retired node
+ * until reclaim() is called, which must be when no
+ * thread is inside a guard, or until the reclaimer
+ * itself goes. Memory grows with the erases, so this
+ * suits structures that are torn down or quiesced
+ * often
+ **************************************************/
+class deferred_reclaimer
+{
+public:
+   // nothing to pin: nothing is freed while anyone could be looking
+   class guard
+   {
+   public:
+      explicit guard(deferred_reclaimer &) noexcept {}
+      guard(const guard &) = delete;
+      guard & operator = (const guard &) = delete;
+   };
+
+   deferred_reclaimer() : pRetired(nullptr) {}
+  ~deferred_reclaimer() { reclaim(); }
+   deferred_reclaimer(const deferred_reclaimer &) = delete;
+   deferred_reclaimer & operator = (const deferred_reclaimer &) = delete;
+
+   // from any thread: p is unlinked and will be freed later
+   void retire(reclaimable * p) noexcept
+   {
+      reclaimable * pHead = pRetired.load(std::memory_order_relaxed);
+      do
+         p->pNextRetired = pHead;
+      while (!pRetired.compare_exchange_weak(pHead, p,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed));
+   }
+
+   // free everything retired so far. No thread may be inside a guard
+   void reclaim() noexcept
+   {
+      reclaimable * p = pRetired.exchange(nullptr, std::memory_order_acquire);
+      while (p)
+      {
+         reclaimable * pNext = p->pNextRetired;
+         p->destroy(p);
+         p = pNext;
+      }
+   }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   std::atomic<reclaimable *> pRetired;   // every retired node, newest first
+};
+
+/**************************************************
+ * EPOCH RECLAIMER
+ * Epoch-based reclamation. A global epoch counts up;
+ * a guard announces the epoch its thread saw, and the
+ * epoch can only move on once every thread inside a
+ * guard has seen the current one. A node retired in
+ * epoch e was unlinked before anyone who enters in
+ * e + 1 looks, so once the epoch reaches e + 2 no
+ * thread can still hold it.
+ *
+ * Each thread retires into a bag of its own, so
+ * retiring takes no shared write. Every batch retires,
+ * and every so many guards so that a thread retiring
+ * rarely is not left holding a part-full bag, the bag
+ * is sealed with the current epoch, an advance is
+ * tried, and the sealed bags two epochs old are freed.
+ * While every guard ends, a thread holds at most the
+ * bag it is filling plus what it sealed in the last
+ * two epochs. A guard held open stops the epoch, and
+ * with it all freeing
+ **************************************************/
+class epoch_reclaimer
+{
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   struct Participant;
+   struct ThreadCache;
+
+public:
+   // pin this thread to the epoch it sees. Guards may nest
+   class guard
+   {
+   public:
+      explicit guard(epoch_reclaimer & reclaimer);
+     ~guard();
+      guard(const guard &) = delete;
+      guard & operator = (const guard &) = delete;
+   private:
+      epoch_reclaimer & reclaimer;
+      Participant * p;
+   };
+
+   explicit epoch_reclaimer(size_t batch = 64);
+  ~epoch_reclaimer();
+   epoch_reclaimer(const epoch_reclaimer &) = delete;
+   epoch_reclaimer & operator = (const epoch_reclaimer &) = delete;
+
+   // from any thread: p is unlinked and will be freed once it is safe.
+   // Throws only the first time a thread uses this reclaimer, and not
+   // at all inside a guard
+   void retire(reclaimable * p);
+
+   // free everything retired so far. No thread may be inside a guard
+   void reclaim() noexcept;
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   // one per thread using the reclaimer. Only state is shared; the rest
+   // belongs to the thread that owns it, and goes to the next owner
+   // along with any garbage when that thread exits
+   struct Participant
+   {
+      Participant();
+
+      std::atomic<std::uint64_t> state;       // 2 * epoch + 1 while pinned, else 0
+      char padding[64 - sizeof(std::atomic<std::uint64_t>)];
+      std::atomic<bool> owned;                // some thread has it
+      std::atomic<bool> orphaned;             // the reclaimer is gone
+      std::atomic<int>  numRefs;              // the reclaimer and the thread cache
+      Participant * pNext;                    // the next in the registry
+      size_t nesting;                         // guards open on this thread
+      size_t numPins;                         // outermost guards so far
+      reclaimable * pBag;                     // retired, not yet sealed
+      reclaimable * pBagTail;
+      size_t numBag;
+      reclaimable * pLimbo[3];                // sealed, by epoch % 3
+      std::uint64_t epochLimbo[3];            // the epoch each was sealed in
+   };
+
+   // which participant this thread has in each reclaimer it has used lately
+   struct ThreadCache
+   {
+      enum { SIZE = 8 };
+      struct Entry
+      {
+         std::uint64_t id;
+         Participant * p;
+      };
+
+      ThreadCache() : num(0) {}
+     ~ThreadCache();
+      void drop(size_t i);
+
+      Entry entries[SIZE];
+      size_t num;
+   };
+
+   static ThreadCache & threadCache() { static thread_local ThreadCache cache; return cache; }
+   static std::uint64_t newId()       { static std::atomic<std::uint64_t> next(1); return next++; }
+   static void release(Participant * p) noexcept;
+   static void destroyAll(reclaimable * p) noexcept;
+
+   Participant * participant();
+   Participant * join(ThreadCache & cache);
+   void pin(Participant * p) noexcept;
+   void unpin(Participant * p) noexcept;
+   void seal(Participant * p) noexcept;
+   void collect(Participant * p) noexcept;
+   void tryAdvance(std::uint64_t e) noexcept;
+
+   std::atomic<std::uint64_t> epoch;                        // the global epoch
+   char padding[64 - sizeof(std::atomic<std::uint64_t>)];
+   std::atomic<Participant *> pParticipants;                // every participant ever made
+   std::uint64_t id;                                        // never reused, unlike this
+   size_t batch;                                            // retires per seal
+
+   enum { PINS_PER_COLLECT = 128 };                         // guards per seal, at most
+};
+
+/*****************************************
+ * EPOCH RECLAIMER :: PARTICIPANT
+ * Made on a thread's first use, owned by it
+ ****************************************/
+inline epoch_reclaimer::Participant::Participant()
+   : state(0), owned(true), orphaned(false), numRefs(2), pNext(nullptr), nesting(0),
+     numPins(0), pBag(nullptr), pBagTail(nullptr), numBag(0)
+{
+   for (int i = 0; i < 3; i++)
+   {
+      pLimbo[i] = nullptr;
+      epochLimbo[i] = 0;
+   }
+}
+
+/*****************************************
+ * EPOCH RECLAIMER :: GUARD
+ * Only the outermost guard on a thread pins it
+ ****************************************/
+inline epoch_reclaimer::guard::guard(epoch_reclaimer & reclaimer)
+   : reclaimer(reclaimer), p(reclaimer.participant())
+{
+   if (p->nesting++ == 0)
+      reclaimer.pin(p);
+}
+
+inline epoch_reclaimer::guard::~guard()
+{
+   if (--p->nesting == 0)
+      reclaimer.unpin(p);
+}
+
+/*****************************************
+ * EPOCH RECLAIMER :: CONSTRUCTOR
+ ****************************************/
+inline epoch_reclaimer::epoch_reclaimer(size_t batch)
+   : epoch(0), pParticipants(nullptr), id(newId()), batch(batch ? batch : 1)
+{
+}
+
+/*****************************************
+ * EPOCH RECLAIMER :: DESTRUCTOR
+ * No other thread may be using it. Free all the garbage,
+ * then let go of the participants: a thread that still
+ * has one cached lets go of it when it exits or next
+ * looks through its cache
+ ****************************************/
+inline epoch_reclaimer::~epoch_reclaimer()
+{
+   reclaim();
+
+   ThreadCache & cache = threadCache();
+   for (size_t i = cache.num; i-- > 0; )
+      if (cache.entries[i].id == id)
+         cache.drop(i);
+
+   Participant * p = pParticipants.load(std::memory_order_acquire);
+   while (p)
+   {
+      Participant * pNext = p->pNext;
+      p->orphaned.store(true, std::memory_order_relaxed);
+      release(p);
+      p = pNext;
+   }
+}
+
+/*****************************************
+ * EPOCH RECLAIMER :: THREAD CACHE
+ * A thread going away gives up what it owns; the next
+ * thread to join takes its participant, garbage and all
+ ****************************************/
+inline epoch_reclaimer::ThreadCache::~ThreadCache()
+{
+   while (num)
+      drop(num - 1);
+}
+
+inline void epoch_reclaimer::ThreadCache::drop(size_t i)
+{
+   Participant * p = entries[i].p;
+   entries[i] = entries[--num];
+   p->owned.store(false, std::memory_order_release);
+   release(p);
+}
+
+/*****************************************
+ * EPOCH RECLAIMER :: RELEASE
+ * One fewer reference. The last one out deletes it,
+ * by which time the reclaimer has freed its garbage
+ ****************************************/
+inline void epoch_reclaimer::release(Participant * p) noexcept
+{
+   if (p->numRefs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      delete p;
+}
+
+/*****************************************
+ * EPOCH RECLAIMER :: DESTROY ALL
+ * Free a chain of retired nodes
+ ****************************************/
+inline void epoch_reclaimer::destroyAll(reclaimable * p) noexcept
+{
+   while (p)
+   {
+      reclaimable * pNext = p->pNextRetired;
+      p->destroy(p);
+      p = pNext;
+   }
+}
+
+/*****************************************
+ * EPOCH RECLAIMER :: PARTICIPANT
+ * This thread's participant: nearly always in its cache
+ ****************************************/
+inline epoch_reclaimer::Participant * epoch_reclaimer::participant()
+{
+   ThreadCache & cache = threadCache();
+   for (size_t i = 0; i < cache.num; i++)
+      if (cache.entries[i].id == id)
+         return cache.entries[i].p;
+   return join(cache);
+}
+
+/*****************************************
+ * EPOCH RECLAIMER :: JOIN
+ * Make room in the cache, then take a participant no
+ * thread owns, or make a new one
+ ****************************************/
+inline epoch_reclaimer::Participant * epoch_reclaimer::join(ThreadCache & cache)
+{
+   // entries for reclaimers that are gone
+   for (size_t i = cache.num; i-- > 0; )
+      if (cache.entries[i].p->orphaned.load(std::memory_order_relaxed))
+         cache.drop(i);
+
+   // still full: give up one this thread is not inside a guard of
+   for (size_t i = cache.num; cache.num == ThreadCache::SIZE && i-- > 0; )
+      if (cache.entries[i].p->nesting == 0)
+         cache.drop(i);
+   if (cache.num == ThreadCache::SIZE)
+      throw "ERROR: too many epoch reclaimers in use at once on one thread";
+
+   Participant * p = pParticipants.load(std::memory_order_acquire);
+   for (; p; p = p->pNext)
+   {
+      bool expected = false;
+      if (!p->owned.load(std::memory_order_relaxed) &&
+          p->owned.compare_exchange_strong(expected, true,
+                                           std::memory_order_acquire,
+                                           std::memory_order_relaxed))
+      {
+         p->numRefs.fetch_add(1, std::memory_order_relaxed);
+         break;
+      }
+   }
+
+   if (p == nullptr)
+   {
+      try
+      {
+         p = new Participant;
+      }
+      catch (...)
+      {
+         throw "ERROR: unable to allocate a participant for an epoch reclaimer";
+      }
+      p->pNext = pParticipants.load(std::memory_order_relaxed);
+      while (!pParticipants.compare_exchange_weak(p->pNext, p,
+                                                  std::memory_order_release,
+                                                  std::memory_order_relaxed))
+         ;
+   }
+
+   cache.entries[cache.num].id = id;
+   cache.entries[cache.num].p = p;
+   cache.num++;
+   return p;
+}
+
+/*****************************************
+ * EPOCH RECLAIMER :: PIN
+ * Announce the epoch, then make sure the announcement
+ * is seen before anything this thread reads under it.
+ * Being a read-modify-write, it also carries on from
+ * the release that ended the last guard, so whoever
+ * reads it has seen every read made under that guard
+ ****************************************/
+inline void epoch_reclaimer::pin(Participant * p) noexcept
+{
+   std::uint64_t e = epoch.load(std::memory_order_relaxed);
+   p->state.exchange(e * 2 + 1, std::memory_order_seq_cst);
+#if !(defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86))
+   // x86 locks the exchange, which is already a full fence and half
+   // the price of another one. Elsewhere that takes a real fence
+   std::atomic_thread_fence(std::memory_order_seq_cst);
+#endif
+}
+
+/*****************************************
+ * EPOCH RECLAIMER :: UNPIN
+ * Done reading. Now and then, seal whatever has been
+ * retired, or at least try to move the epoch along and
+ * free what is ready
+ ****************************************/
+inline void epoch_reclaimer::unpin(Participant * p) noexcept
+{
+   p->state.store(0, std::memory_order_release);
+   if (++p->numPins % PINS_PER_COLLECT == 0)
+   {
+      if (p->pBag)
+         seal(p);
+      else
+      {
+         tryAdvance(epoch.load(std::memory_order_relaxed));
+         collect(p);
+      }
+   }
+}
+
+/*****************************************
+ * EPOCH RECLAIMER :: RETIRE
+ * Into this thread's bag, sealed every batch
+ ****************************************/
+inline void epoch_reclaimer::retire(reclaimable * pRetire)
+{
+   Participant * p = participant();
+   pRetire->pNextRetired = p->pBag;
+   if (p->pBag == nullptr)
+      p->pBagTail = pRetire;
+   p->pBag = pRetire;
+   if (++p->numBag >= batch)
+      seal(p);
+}
+
+/*****************************************
+ * EPOCH RECLAIMER :: SEAL
+ * Stamp the bag with the epoch now, which is no earlier
+ * than when any of it was unlinked. A sealed bag in the
+ * same slot is at least three epochs old and goes now;
+ * after trying to advance, so does any two epochs old
+ ****************************************/
+inline void epoch_reclaimer::seal(Participant * p) noexcept
+{
+   std::atomic_thread_fence(std::memory_order_seq_cst);
+   std::uint64_t e = epoch.load(std::memory_order_relaxed);
+
+   int i = (int)(e % 3);
+   if (p->epochLimbo[i] != e)
+   {
+      destroyAll(p->pLimbo[i]);
+      p->pLimbo[i] = nullptr;
+   }
+   p->pBagTail->pNextRetired = p->pLimbo[i];
+   p->pLimbo[i] = p->pBag;
+   p->epochLimbo[i] = e;
+   p->pBag = p->pBagTail = nullptr;
+   p->numBag = 0;
+
+   tryAdvance(e);
+   collect(p);
+}
+
+/*****************************************
+ * EPOCH RECLAIMER :: COLLECT
+ * Free the sealed bags two or more epochs old
+ ****************************************/
+inline void epoch_reclaimer::collect(Participant * p) noexcept
+{
+   std::uint64_t e = epoch.load(std::memory_order_acquire);
+   for (int i = 0; i < 3; i++)
+      if (p->pLimbo[i] && p->epochLimbo[i] + 2 <= e)
+      {
+         destroyAll(p->pLimbo[i]);
+         p->pLimbo[i] = nullptr;
+      }
+}
+
+/*****************************************
+ * EPOCH RECLAIMER :: TRY ADVANCE
+ * Move the epoch from e to e + 1 if every pinned
+ * thread has seen e. Someone else may beat us to it
+ ****************************************/
+inline void epoch_reclaimer::tryAdvance(std::uint64_t e) noexcept
+{
+   std::atomic_thread_fence(std::memory_order_seq_cst);
+   for (Participant * p = pParticipants.load(std::memory_order_acquire); p; p = p->pNext)
+   {
+      std::uint64_t state = p->state.load(std::memory_order_acquire);
+      if ((state & 1) && (state >> 1) != e)
+         return;
+   }
+   epoch.compare_exchange_strong(e, e + 1,
+                                 std::memory_order_release,
+                                 std::memory_order_relaxed);
+}
+
+/*****************************************
+ * EPOCH RECLAIMER :: RECLAIM
+ * Everything in every bag, sealed or not
+ ****************************************/
+inline void epoch_reclaimer::reclaim() noexcept
+{
+   for (Participant * p = pParticipants.load(std::memory_order_acquire); p; p = p->pNext)
+   {
+      destroyAll(p->pBag);
+      p->pBag = p->pBagTail = nullptr;
+      p->numBag = 0;
+      for (int i = 0; i < 3; i++)
+      {
+         destroyAll(p->pLimbo[i]);
+         p->pLimbo[i] = nullptr;
+      }
+   }
+}
+
+} // namespace custom
@@ -0,0 +1,481 @@
+/***********************************************************************
+ * Header:
+ *    REGRESSION
+ * Summary:
+ *    A gate that compares a benchmark run against a baseline run saved
+ *    with --json. Every case is run several times and summarized by its
+ *    median, after setting aside the runs that stray too far from the
+ *    rest, so one hiccup on a shared machine does not fail the gate.
+ *
+ *    A case fails when its time per operation grows by more than the
+ *    tolerance plus the noise both runs saw, or when it makes more
+ *    allocations per operation than it used to, again allowing for the
+ *    noise, since threads make the allocations wander. The noise may
+ *    never add more than a fraction of the baseline itself, so a noisy
+ *    case is still caught when it gets several times slower.
+ *
+ *    The std:: containers are only there to compare ours against, so
+ *    their time never fails the gate. Instead they tell how much slower
+ *    the whole machine is than it was for the baseline, and every case
+ *    is judged against the baseline scaled by that drift. Our own code
+ *    getting slower can then never pass for a slow machine. Nor is a
+ *    case timed when it runs more threads than the machine has cores:
+ *    then it measures the scheduler. Allocations are checked for every
+ *    case.
+ *
+ *    This will contain the class definition of:
+ *        RegressionOptions : How much worse is too much worse
+ *        RegressionGate    : The baseline and the comparison
+ ************************************************************************/
+
+#pragma once
+
+#include "benchmark.h"  // for Benchmark::Result
+
+#include <algorithm>    // for std::sort
+#include <cmath>        // for std::fabs
+#include <cstdlib>      // for std::strtod
+#include <iomanip>      // for std::setw
+#include <istream>      // for std::istream
+#include <iterator>     // for std::istreambuf_iterator
+#include <map>          // for std::map
+#include <ostream>      // for std::ostream
+#include <string>       // for std::string
+#include <thread>       // for std::thread::hardware_concurrency
+#include <vector>       // for std::vector
+
+/*************************************************************
+ * MEDIAN
+ * The middle of the samples, or the mean of the middle two
+ *************************************************************/
+inline double median(std::vector<double> samples)
+{
+   if (samples.empty())
+      return 0.0;
+   std::sort(samples.begin(), samples.end());
+   size_t middle = samples.size() / 2;
+   return (samples.size() % 2 ? samples[middle]
+                              : (samples[middle - 1] + samples[middle]) / 2.0);
+}
+
+/*************************************************************
+ * MEDIAN ABSOLUTE DEVIATION
+ * How far the samples typically are from their median. Unlike
+ * the standard deviation, one wild sample barely moves it
+ *************************************************************/
+inline double medianDeviation(const std::vector<double> & samples)
+{
+   double middle = median(samples);
+   std::vector<double> deviations;
+   for (double sample : samples)
+      deviations.push_back(std::fabs(sample - middle));
+   return median(deviations);
+}
+
+/*************************************************************
+ * REJECT OUTLIERS
+ * Drop the samples more than three scaled median absolute
+ * deviations from the median. 1.4826 makes the deviation
+ * comparable to a standard deviation for normal noise
+ *************************************************************/
+inline std::vector<double> rejectOutliers(const std::vector<double> & samples)
+{
+   double middle = median(samples);
+   double limit  = 3.0 * 1.4826 * medianDeviation(samples);
+   std::vector<double> kept;
+   for (double sample : samples)
+      if (std::fabs(sample - middle) <= limit)
+         kept.push_back(sample);
+   return kept;
+}
+
+/*************************************************************
+ * CASE ID
+ * Everything that makes two results the same case
+ *************************************************************/
+inline std::string caseId(const Benchmark::Result & result)
+{
+   return result.suite + "/" + result.name + "/" + result.container + "/" + result.key +
+          (result.workload.empty() ? "" : "/" + result.workload) +
+          "/size:" + std::to_string(result.size) + "/thr:" + std::to_string(result.numThreads);
+}
+
+/*************************************************************
+ * SUMMARIZE
+ * Collapse every run of the same case into one result, in the
+ * order the cases first ran. Its time is the median time per
+ * operation of the runs left after outliers are rejected, its
+ * allocations the median of all of them. Both keep how far
+ * the runs wandered
+ *************************************************************/
+inline std::vector<Benchmark::Result> summarize(const std::vector<Benchmark::Result> & results)
+{
+   std::vector<std::string> order;
+   std::map<std::string, std::vector<const Benchmark::Result *>> runs;
+   for (auto & result : results)
+   {
+      std::string id = caseId(result);
+      if (runs[id].empty())
+         order.push_back(id);
+      runs[id].push_back(&result);
+   }
+
+   std::vector<Benchmark::Result> summary;
+   for (auto & id : order)
+   {
+      std::vector<double> nsPerOp;
+      std::vector<double> allocsPerOp;
+      for (auto pRun : runs[id])
+      {
+         nsPerOp.push_back(pRun->ns / (double)pRun->numOps);
+         allocsPerOp.push_back(pRun->allocs / (double)pRun->numOps);
+      }
+      std::vector<double> kept = rejectOutliers(nsPerOp);
+
+      Benchmark::Result result = *runs[id].front();
+      result.ns      = median(kept) * (double)result.numOps;
+      result.nsMad   = medianDeviation(kept) * (double)result.numOps;
+      result.allocs  = median(allocsPerOp) * (double)result.numOps;
+      result.allocsMad = medianDeviation(allocsPerOp) * (double)result.numOps;
+      result.numRuns = runs[id].size();
+      summary.push_back(result);
+   }
+   return summary;
+}
+
+/*************************************************************
+ * REGRESSION OPTIONS
+ *************************************************************/
+struct RegressionOptions
+{
+   RegressionOptions()
+      : tolerance(0.10), noise(3.0), minNs(1.0), minRunNs(250.0), allocTolerance(0.01),
+        maxSlack(1.0), minDriftCases(20), normalize(true), minTimedNs(100.0),
+        reference("std::"), numCores(std::thread::hardware_concurrency()) {}
+
+   double tolerance;       // fraction slower allowed before counting noise
+   double noise;           // how many deviations of both runs to forgive on top
+   double minNs;           // never fail a case for less than this many ns/op
+   double minRunNs;        // nor for less than this over the whole run, which
+                           //    is about what reading the clock costs
+   double allocTolerance;  // allocations per op allowed on top, for thread noise
+   double maxSlack;        // but the slack is never more than this fraction
+                           //    of the baseline ns/op
+   size_t minDriftCases;   // reference cases needed before trusting the drift
+   bool   normalize;       // allow for the drift at all
+   double minTimedNs;      // a baseline run shorter than this is not timed
+   std::string reference;  // containers only there to compare against
+   size_t numCores;        // more threads than this are not timed. 0 if unknown
+};
+
+/*************************************************************
+ * REGRESSION GATE
+ * The baseline is whatever Benchmark::json() wrote. Cases only
+ * in one of the two runs are listed, but never fail the gate
+ *************************************************************/
+class RegressionGate
+{
+public:
+   RegressionGate(const RegressionOptions & options = RegressionOptions())
+      : options(options) {}
+
+   void read(std::istream & in);
+   bool compare(const std::vector<Benchmark::Result> & current, std::ostream & out) const;
+
+   size_t size() const { return baseline.size(); }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   // the JSON is an array of flat objects of strings and numbers
+   typedef std::map<std::string, std::string> Object;
+   static std::vector<Object> parse(const std::string & json);
+   static Benchmark::Result toResult(const Object & object);
+   double drift(const std::vector<Benchmark::Result> & current) const;
+   double limit(const Benchmark::Result & base, const Benchmark::Result & now,
+                double drift) const;
+   bool isReference(const Benchmark::Result & result) const;
+   const char * untimed(const Benchmark::Result & base) const;
+
+   RegressionOptions options;
+   std::vector<Benchmark::Result> baseline;
+};
+
+/*****************************************
+ * REGRESSION GATE :: READ
+ * Load the baseline. Throws a const char * if it is not what
+ * Benchmark::json() writes
+ ****************************************/
+inline void RegressionGate::read(std::istream & in)
+{
+   std::string json((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+   baseline.clear();
+   for (auto & object : parse(json))
+      baseline.push_back(toResult(object));
+}
+
+/*****************************************
+ * REGRESSION GATE :: PARSE
+ * Just enough JSON for our own output: no nesting, no escapes
+ ****************************************/
+inline std::vector<RegressionGate::Object> RegressionGate::parse(const std::string & json)
+{
+   std::vector<Object> objects;
+   size_t i = 0;
+   auto skip = [&]()
+   {
+      while (i < json.size() && (json[i] == ' ' || json[i] == '\n' ||
+                                 json[i] == '\r' || json[i] == '\t'))
+         i++;
+   };
+   auto expect = [&](char c)
+   {
+      skip();
+      if (i >= json.size() || json[i] != c)
+         throw "ERROR: malformed benchmark baseline";
+      i++;
+   };
+   auto quoted = [&]() -> std::string
+   {
+      expect('"');
+      size_t end = json.find('"', i);
+      if (end == std::string::npos)
+         throw "ERROR: unterminated string in benchmark baseline";
+      std::string s = json.substr(i, end - i);
+      i = end + 1;
+      return s;
+   };
+   // another element follows when there is a comma
+   auto more = [&]() -> bool
+   {
+      skip();
+      if (i >= json.size() || json[i] != ',')
+         return false;
+      i++;
+      return true;
+   };
+
+   expect('[');
+   skip();
+   if (i < json.size() && json[i] == ']')
+      return objects;
+   do
+   {
+      Object object;
+      expect('{');
+      do
+      {
+         std::string key = quoted();
+         expect(':');
+         skip();
+         if (i < json.size() && json[i] == '"')
+            object[key] = quoted();
+         else
+         {
+            size_t end = json.find_first_of(",}", i);
+            if (end == std::string::npos || end == i)
+               throw "ERROR: missing value in benchmark baseline";
+            object[key] = json.substr(i, end - i);
+            i = end;
+         }
+      }
+      while (more());
+      expect('}');
+      objects.push_back(object);
+   }
+   while (more());
+   expect(']');
+   return objects;
+}
+
+/*****************************************
+ * REGRESSION GATE :: TO RESULT
+ * Back from the per-operation figures to a Result
+ ****************************************/
+inline Benchmark::Result RegressionGate::toResult(const Object & object)
+{
+   auto text = [&](const char * key) -> std::string
+   {
+      auto it = object.find(key);
+      if (it == object.end())
+         throw "ERROR: benchmark baseline is missing a field";
+      return it->second;
+   };
+   auto number = [&](const char * key, double otherwise) -> double
+   {
+      auto it = object.find(key);
+      return (it == object.end() ? otherwise : std::strtod(it->second.c_str(), nullptr));
+   };
+
+   Benchmark::Result result;
+   result.suite      = text("suite");
+   result.name       = text("name");
+   result.container  = text("container");
+   result.key        = text("key");
+   result.workload   = text("workload");
+   result.size       = (size_t)number("size", 0.0);
+   result.numThreads = (size_t)number("threads", 1.0);
+   result.numOps     = (size_t)number("ops", 1.0);
+   if (result.numOps == 0)
+      result.numOps = 1;
+   result.ns         = number("ns_per_op", 0.0)     * (double)result.numOps;
+   result.nsMad      = number("mad_ns_per_op", 0.0) * (double)result.numOps;
+   result.allocs     = number("allocs_per_op", 0.0) * (double)result.numOps;
+   result.allocsMad  = number("mad_allocs_per_op", 0.0) * (double)result.numOps;
+   result.bytes      = number("bytes_per_element", 0.0);
+   result.numRuns    = (size_t)number("runs", 1.0);
+   return result;
+}
+
+/*****************************************
+ * REGRESSION GATE :: DRIFT
+ * How much slower the machine is now than for the baseline: the
+ * median, over the reference cases in both, of how much slower
+ * they got. Our own cases are what is being judged, so they have
+ * no say. One when there are too few reference cases to tell,
+ * and never below one
+ ****************************************/
+inline double RegressionGate::drift(const std::vector<Benchmark::Result> & current) const
+{
+   if (!options.normalize)
+      return 1.0;
+
+   std::map<std::string, const Benchmark::Result *> base;
+   for (auto & result : baseline)
+      base[caseId(result)] = &result;
+   std::vector<double> ratios;
+   for (auto & now : current)
+   {
+      if (!isReference(now))
+         continue;
+      auto it = base.find(caseId(now));
+      if (it != base.end() && it->second->ns > 0.0)
+         ratios.push_back((now.ns / (double)now.numOps) /
+                          (it->second->ns / (double)it->second->numOps));
+   }
+   if (ratios.size() < options.minDriftCases)
+      return 1.0;
+   double ratio = median(ratios);
+   return ratio > 1.0 ? ratio : 1.0;
+}
+
+/*****************************************
+ * REGRESSION GATE :: LIMIT
+ * The slowest ns/op that is not a regression: the tolerance on
+ * top of the baseline, plus the noise both runs saw. Very short
+ * runs are mostly the clock, so they get more slack, but never
+ * more than maxSlack of the baseline
+ ****************************************/
+inline double RegressionGate::limit(const Benchmark::Result & base,
+                                    const Benchmark::Result & now, double drift) const
+{
+   double nsBase = drift * base.ns / (double)base.numOps;
+   double slack  = options.noise * (base.nsMad / (double)base.numOps +
+                                    now.nsMad  / (double)now.numOps);
+   if (slack < options.minNs)
+      slack = options.minNs;
+   if (slack < options.minRunNs / (double)now.numOps)
+      slack = options.minRunNs / (double)now.numOps;
+   if (slack > options.maxSlack * nsBase)
+      slack = options.maxSlack * nsBase;
+   if (slack < options.minNs)
+      slack = options.minNs;
+   return nsBase * (1.0 + options.tolerance) + slack;
+}
+
+/*****************************************
+ * REGRESSION GATE :: IS REFERENCE
+ * Is this one of the containers ours are compared against?
+ ****************************************/
+inline bool RegressionGate::isReference(const Benchmark::Result & result) const
+{
+   return !options.reference.empty() &&
+          result.container.compare(0, options.reference.size(), options.reference) == 0;
+}
+
+/*****************************************
+ * REGRESSION GATE :: UNTIMED
+ * Why the time of this case cannot fail the gate, or nullptr
+ * when it can. Only the baseline and the machine decide, so
+ * every run against the same baseline on the same machine times
+ * the same cases. Allocations are checked either way
+ ****************************************/
+inline const char * RegressionGate::untimed(const Benchmark::Result & base) const
+{
+   if (isReference(base))
+      return "ref      ";
+   if (base.ns < options.minTimedNs)
+      return "short    ";
+   if (options.numCores && base.numThreads > options.numCores)
+      return "threads  ";
+   return nullptr;
+}
+
+/*****************************************
+ * REGRESSION GATE :: COMPARE
+ * One line per case, then a summary. True when nothing regressed
+ ****************************************/
+inline bool RegressionGate::compare(const std::vector<Benchmark::Result> & current,
+                                    std::ostream & out) const
+{
+   std::map<std::string, const Benchmark::Result *> base;
+   for (auto & result : baseline)
+      base[caseId(result)] = &result;
+
+   size_t numCompared = 0;
+   size_t numUntimed  = 0;
+   size_t numSlower   = 0;
+   size_t numAllocs   = 0;
+   std::map<std::string, bool> seen;
+   out.setf(std::ios::fixed | std::ios::showpoint);
+   out.precision(2);
+   double machine = drift(current);
+   for (auto & now : current)
+   {
+      std::string id = caseId(now);
+      seen[id] = true;
+      auto it = base.find(id);
+      if (it == base.end())
+      {
+         out << "\tnew      " << id << "\n";
+         continue;
+      }
+      const Benchmark::Result & was = *it->second;
+      numCompared++;
+
+      double nsWas     = was.ns / (double)was.numOps;
+      double nsNow     = now.ns / (double)now.numOps;
+      double allocsWas = was.allocs / (double)was.numOps;
+      double allocsNow = now.allocs / (double)now.numOps;
+      const char * why = untimed(was);
+      bool slower = !why && nsNow > limit(was, now, machine);
+      double allocsSlack = options.noise * (was.allocsMad / (double)was.numOps +
+                                            now.allocsMad / (double)now.numOps);
+      bool allocs = allocsNow > allocsWas * (1.0 + options.allocTolerance) +
+                                allocsSlack + 1e-9;
+      numUntimed += (why != nullptr);
+      numSlower  += slower;
+      numAllocs  += allocs;
+
+      out << "\t" << (slower && allocs ? "BOTH     " : slower ? "SLOWER   " : allocs ? "ALLOCS   " : why ? why : "ok       ")
+          << std::setw(60) << std::left << id << std::right
+          << " ns/op:" << std::setw(10) << nsWas << " -> " << std::setw(10) << nsNow
+          << " (" << std::showpos << (nsWas > 0.0 ? 100.0 * (nsNow / nsWas - 1.0) : 0.0)
+          << std::noshowpos << "%, limit " << limit(was, now, machine) << ")"
+          << " allocs/op:" << allocsWas << " -> " << allocsNow << "\n";
+   }
+   for (auto & result : baseline)
+      if (!seen[caseId(result)])
+         out << "\tmissing  " << caseId(result) << "\n";
+
+   if (machine > 1.0)
+      out << "The machine is " << 100.0 * (machine - 1.0)
+          << "% slower than for the baseline, which the limits allow for\n";
+   out << "Regression gate: " << numCompared << " cases compared, "
+       << numUntimed << " of them not timed, "
+       << numSlower << " slower, " << numAllocs << " allocating more: "
+       << (numSlower + numAllocs ? "FAIL" : "PASS") << "\n";
+   return numSlower + numAllocs == 0;
+}
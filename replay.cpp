@@ -0,0 +1,123 @@
+/***********************************************************************
+ * Program:
+ *    Replay
+ * Summary:
+ *    Run a trace recorded from an unordered_set built with HASH_TRACE
+ *    against each set we have and report how fast each one was.
+ *    Build it with "make replay".
+ *    Usage:
+ *       replay [--backend custom|std] [--repeat N] TRACE
+ ************************************************************************/
+
+#include "hash.h"          // for custom::unordered_set
+#include "trace.h"         // for read_trace and replay
+
+#include <cstdint>         // for std::uint64_t
+#include <cstdlib>         // for std::strtoul
+#include <cstring>         // for std::strcmp
+#include <fstream>         // for std::ifstream
+#include <iomanip>         // for std::setw
+#include <iostream>        // for std::cout
+#include <string>          // for std::string
+#include <unordered_set>   // for std::unordered_set
+
+/**********************************************************************
+ * REPORT
+ * Throughput, then latency broken down by operation
+ ***********************************************************************/
+void report(const char * backend, const custom::replay_result & result)
+{
+   std::cout.setf(std::ios::fixed | std::ios::showpoint);
+   std::cout.precision(1);
+   std::cout << backend << ": " << result.numOps << " ops in "
+             << result.ns / 1e6 << " ms, "
+             << result.throughput() << " ops/s, "
+             << result.numHits << " finds hit\n";
+   std::cout << "\t" << std::left << std::setw(8) << "op" << std::right
+             << std::setw(10) << "count" << std::setw(10) << "mean"
+             << std::setw(10) << "p50"   << std::setw(10) << "p90"
+             << std::setw(10) << "p99"   << std::setw(10) << "p99.9"
+             << std::setw(12) << "max (ns)" << "\n";
+   for (int op = 0; op < custom::TRACE_NUM_OPS; op++)
+   {
+      const custom::replay_result::latency & latency = result.ops[op];
+      if (latency.numOps == 0)
+         continue;
+      std::cout << "\t" << std::left << std::setw(8)
+                << custom::trace_op_name(static_cast<custom::trace_op>(op))
+                << std::right
+                << std::setw(10) << latency.numOps
+                << std::setw(10) << latency.nsTotal / latency.numOps
+                << std::setw(10) << latency.p50
+                << std::setw(10) << latency.p90
+                << std::setw(10) << latency.p99
+                << std::setw(10) << latency.p999
+                << std::setw(12) << latency.max << "\n";
+   }
+}
+
+/**********************************************************************
+ * RUN
+ * Replay the trace on a fresh set, repeat times
+ ***********************************************************************/
+template <class Set>
+void run(const char * backend, const std::vector<custom::trace_record> & records,
+         unsigned long repeat)
+{
+   for (unsigned long i = 0; i < repeat; i++)
+   {
+      Set set;
+      report(backend, custom::replay(records, set));
+   }
+}
+
+/**********************************************************************
+ * MAIN
+ * Read the options and the trace, then replay it
+ ***********************************************************************/
+int main(int argc, char ** argv)
+{
+   std::string backend;
+   unsigned long repeat = 1;
+   const char * fileName = nullptr;
+   bool valid = true;
+
+   for (int i = 1; i < argc; i++)
+   {
+      if (!std::strcmp(argv[i], "--backend") && i + 1 < argc)
+         backend = argv[++i];
+      else if (!std::strcmp(argv[i], "--repeat") && i + 1 < argc)
+         repeat = std::strtoul(argv[++i], nullptr, 10);
+      else if (argv[i][0] != '-' && !fileName)
+         fileName = argv[i];
+      else
+         valid = false;
+   }
+   if (!valid || !fileName ||
+       (!backend.empty() && backend != "custom" && backend != "std"))
+   {
+      std::cerr << "Usage: " << argv[0]
+                << " [--backend custom|std] [--repeat N] TRACE\n";
+      return 1;
+   }
+
+   std::vector<custom::trace_record> records;
+   try
+   {
+      std::ifstream fin(fileName, std::ios::binary);
+      if (!fin)
+         throw "ERROR: unable to open the trace file";
+      records = custom::read_trace(fin);
+   }
+   catch (const char * error)
+   {
+      std::cerr << fileName << ": " << error << "\n";
+      return 1;
+   }
+
+   if (backend.empty() || backend == "custom")
+      run<custom::unordered_set<std::uint64_t>>("custom::unordered_set", records, repeat);
+   if (backend.empty() || backend == "std")
+      run<std::unordered_set<std::uint64_t>>("std::unordered_set", records, repeat);
+   return 0;
+}
@@ -10,6 +10,9 @@
 #pragma once
 
 #include <cassert>
+#include <atomic>     // for std::atomic
+#include <functional> // for std::hash
+#include <memory>     // for std::shared_ptr
 
 enum { ALLOC,      // 0  allocations, number of times NEW is called
        DELETE,     // 1  deletions, number of times DELETE is called
@@ -23,8 +26,63 @@ enum { ALLOC,      // 0  allocations, number of times NEW is called
        EQUALS,     // 9  Spy::operator==(const Spy &)
        LESSTHAN,   // 10 Spy::operator<(const Spy &)
        SWAP,       // 11 Spy::swap()
+       HASH,       // 12 std::hash<Spy>
        NUM_MARKERS};
 
+/*************************************************************
+ * SPY COUNTERS
+ * A count of each marker. Every thread counts in its own set
+ * unless it joins another's, and every Spy counts in the set
+ * that was current where it, or the Spy it was copied or moved
+ * from, was made. So work a thread pool does on a test's Spys
+ * lands in that test's counts, and test classes running side
+ * by side never see each other's. Every Spy and every Join
+ * shares ownership of its set, so a set outlives the thread
+ * that made it for as long as anything still counts there
+ *************************************************************/
+class SpyCounters
+{
+public:
+   SpyCounters() { reset(); }
+   SpyCounters(const SpyCounters &) = delete;
+   SpyCounters & operator = (const SpyCounters &) = delete;
+
+   // any thread may count here
+   std::atomic<int> & operator [] (int marker) { return count[marker]; }
+
+   void reset() noexcept
+   {
+      for (int i = 0; i < NUM_MARKERS; i++)
+         count[i].store(0, std::memory_order_relaxed);
+   }
+
+   // the set new Spys on this thread count in
+   static std::shared_ptr<SpyCounters> & current()
+   {
+      static thread_local std::shared_ptr<SpyCounters> pCurrent =
+         std::make_shared<SpyCounters>();
+      return pCurrent;
+   }
+
+   // while one is in scope, Spys made on this thread count in pSet
+   class Join
+   {
+   public:
+      explicit Join(std::shared_ptr<SpyCounters> pSet) : pPrevious(current())
+      {
+         current() = std::move(pSet);
+      }
+     ~Join() { current() = std::move(pPrevious); }
+      Join(const Join &) = delete;
+      Join & operator = (const Join &) = delete;
+   private:
+      std::shared_ptr<SpyCounters> pPrevious;
+   };
+
+private:
+   std::atomic<int> count[NUM_MARKERS];
+};
+
 /*************************************************************
  * SPY
  * A mock class that records how it was used
@@ -34,31 +92,34 @@ class Spy
 public:
    // the member variable
    int * p;
+
+   // where this Spy, and every copy of it, is counted
+   std::shared_ptr<SpyCounters> pCounters;
    
    // default constructor: allocate a spot and assign to zero
-   Spy() : p(nullptr) { counters[DEFAULT]++; }
+   Spy() : p(nullptr), pCounters(SpyCounters::current()) { count(DEFAULT); }
    
    // non-default constructor: allocate a spot and assign to the value
-   Spy(int value) : p(nullptr)
+   Spy(int value) : p(nullptr), pCounters(SpyCounters::current())
    {
       allocate();
       *p = value;
-      counters[NONDEFAULT]++;
+      count(NONDEFAULT);
    }
    
    // copy constructor: make a new copy
-   Spy(const Spy & rhs) : p(nullptr)
+   Spy(const Spy & rhs) : p(nullptr), pCounters(rhs.pCounters)
    {
       if (!rhs.empty())
       {
          allocate();
          *p = rhs.get();
       }
-      counters[COPY]++;
+      count(COPY);
    }
    
    // move constructor: steal the data from the RHS
-   Spy(Spy && rhs) noexcept
+   Spy(Spy && rhs) noexcept : pCounters(rhs.pCounters)
    {
       if (!rhs.empty())
       {
@@ -67,7 +128,7 @@ public:
       }
       else
          p = nullptr;
-      counters[COPY_MOVE]++;
+      count(COPY_MOVE);
    }
    
    // delete - remove the instance
@@ -75,7 +136,7 @@ public:
    {
       if (!empty())
          unallocate();
-      counters[DESTRUCTOR]++;
+      count(DESTRUCTOR);
    }
 
    // copy assignment operator
@@ -89,7 +150,7 @@ public:
       }
       else if (!empty())
          unallocate();
-      counters[ASSIGN]++;
+      count(ASSIGN);
       return *this;
    }
    
@@ -100,7 +161,7 @@ public:
          unallocate();
       p = rhs.p;
       rhs.p = nullptr;
-      counters[ASSIGN_MOVE]++;
+      count(ASSIGN_MOVE);
       return *this;
    }
    
@@ -110,7 +171,7 @@ public:
       int * pTemp = rhs.p;
       rhs.p = p;
       p = pTemp;
-      counters[SWAP]++;
+      count(SWAP);
    }
    
    // is this pointer empty?
@@ -136,7 +197,7 @@ public:
    // compare the values
    bool operator==(const Spy & rhs) const noexcept
    {
-      counters[EQUALS]++;
+      count(EQUALS);
       if (rhs.empty() && empty())
          return true;
       if (!rhs.empty() && !empty())
@@ -147,7 +208,7 @@ public:
    // a null value is assumed to be the smallest value
    bool operator<(const Spy & rhs) const noexcept
    {
-      counters[LESSTHAN]++;
+      count(LESSTHAN);
       if (rhs.empty() && empty())
          return false;
       if (!rhs.empty() && !empty())
@@ -158,28 +219,33 @@ public:
          return false;
    }
    
-   // reset the counters for a new test
+   // reset this thread's counters for a new test, along with what
+   // every thread working on this thread's Spys, or joined to its
+   // counters, counted here
    static void reset() noexcept
    {
-      for (int i = 0; i < NUM_MARKERS; i++)
-         counters[i] = 0;
-   }
-   
-   static int numAlloc()       { return counters[ALLOC];      }
-   static int numDelete()      { return counters[DELETE];     }
-   static int numDefault()     { return counters[DEFAULT];    }
-   static int numNondefault()  { return counters[NONDEFAULT]; }
-   static int numCopy()        { return counters[COPY];       }
-   static int numCopyMove()    { return counters[COPY_MOVE];  }
-   static int numDestructor()  { return counters[DESTRUCTOR]; }
-   static int numAssign()      { return counters[ASSIGN];     }
-   static int numAssignMove()  { return counters[ASSIGN_MOVE];}
-   static int numEquals()      { return counters[EQUALS];     }
-   static int numLessthan()    { return counters[LESSTHAN];   }
-   static int numSwap()        { return counters[SWAP];       }
-
-   // keep track of how it is used
-   static int counters[NUM_MARKERS];
+      counters().reset();
+   }
+   
+   static int numAlloc()       { return counters()[ALLOC];      }
+   static int numDelete()      { return counters()[DELETE];     }
+   static int numDefault()     { return counters()[DEFAULT];    }
+   static int numNondefault()  { return counters()[NONDEFAULT]; }
+   static int numCopy()        { return counters()[COPY];       }
+   static int numCopyMove()    { return counters()[COPY_MOVE];  }
+   static int numDestructor()  { return counters()[DESTRUCTOR]; }
+   static int numAssign()      { return counters()[ASSIGN];     }
+   static int numAssignMove()  { return counters()[ASSIGN_MOVE];}
+   static int numEquals()      { return counters()[EQUALS];     }
+   static int numLessthan()    { return counters()[LESSTHAN];   }
+   static int numSwap()        { return counters()[SWAP];       }
+   static int numHash()        { return counters()[HASH];       }
+
+   // the counters this thread reads
+   static SpyCounters & counters() { return *SpyCounters::current(); }
+
+   // one more use of this Spy
+   void count(int marker) const noexcept { (*pCounters)[marker]++; }
 private:
    
    // allocate a new buffer
@@ -187,7 +253,7 @@ private:
    {
       assert(p == nullptr);
       p = new int;
-      counters[ALLOC]++;
+      count(ALLOC);
    }
    
    // free the buffer
@@ -196,7 +262,7 @@ private:
       assert(p != nullptr);
       delete p;
       p = nullptr;
-      counters[DELETE]++;
+      count(DELETE);
    }
    
 };
@@ -206,3 +272,21 @@ inline void swap(Spy & s1, Spy & s2)
 {
    s1.swap(s2);
 }
+
+/*************************************************************
+ * HASH
+ * Lets a Spy go in a hash, counting every time it is hashed.
+ * An empty Spy hashes to zero
+ *************************************************************/
+namespace std
+{
+   template <>
+   struct hash<Spy>
+   {
+      size_t operator()(const Spy & s) const noexcept
+      {
+         s.count(HASH);
+         return s.empty() ? 0 : std::hash<int>()(s.get());
+      }
+   };
+}
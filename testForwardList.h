@@ -0,0 +1,472 @@
+/***********************************************************************
+ * Header:
+ *    TEST FORWARD LIST
+ * Summary:
+ *    Unit tests for forward_list
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "forwardList.h"
+#include "list.h"
+#include "unitTest.h"
+
+#include <string>
+#include <vector>
+
+// the elements of the list, front to back
+#define assertForward(l, ...)    assertForwardParameters(l, { __VA_ARGS__ }, __LINE__, __FUNCTION__)
+
+class TestForwardList : public UnitTest
+{
+public:
+   typedef custom::forward_list<int> List;
+
+   void run()
+   {
+      reset();
+
+      // Construct
+      runUnit(test_nodeSize);
+      runUnit(test_construct_default);
+      runUnit(test_construct_init);
+      runUnit(test_constructCopy_standard);
+      runUnit(test_constructMove_standard);
+      runUnit(test_assign_copy);
+      runUnit(test_assign_move);
+
+      // Iterator
+      runUnit(test_beforeBegin_empty);
+      runUnit(test_beforeBegin_standard);
+
+      // Access
+      runUnit(test_front_empty);
+      runUnit(test_front_standard);
+
+      // Insert
+      runUnit(test_pushFront_empty);
+      runUnit(test_pushFront_standard);
+      runUnit(test_emplaceFront_string);
+      runUnit(test_insertAfter_beforeBegin);
+      runUnit(test_insertAfter_middle);
+      runUnit(test_insertAfter_last);
+
+      // Remove
+      runUnit(test_popFront_standard);
+      runUnit(test_popFront_empty);
+      runUnit(test_eraseAfter_middle);
+      runUnit(test_eraseAfter_last);
+      runUnit(test_eraseAfter_range);
+
+      // Splice
+      runUnit(test_spliceAfter_allMiddle);
+      runUnit(test_spliceAfter_allToEmpty);
+      runUnit(test_spliceAfter_oneOtherList);
+      runUnit(test_spliceAfter_oneSameList);
+      runUnit(test_spliceAfter_rangeOtherList);
+
+      // Allocations
+      runUnit(test_allocations_pushFront);
+      runUnit(test_allocations_splice);
+
+      report("ForwardList");
+   }
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // one pointer less than a list node
+   void test_nodeSize()
+   {  // exercise and verify
+      assertUnit(custom::forward_list<size_t>::node_size() == 2 * sizeof(void *));
+      assertUnit(custom::forward_list<size_t>::node_size() + sizeof(void *) ==
+                 custom::list<size_t>::node_size());
+   }
+
+   void test_construct_default()
+   {  // exercise
+      List l;
+      // verify
+      assertUnit(l.empty());
+      assertUnit(l.size() == 0);
+      assertUnit(l.head.pNext == nullptr);
+      assertUnit(l.begin() == l.end());
+   }  // teardown
+
+   // the same order they were given in
+   void test_construct_init()
+   {  // exercise
+      List l{ 11, 26, 31 };
+      // verify
+      assertForward(l, 11, 26, 31);
+   }  // teardown
+
+   void test_constructCopy_standard()
+   {  // setup
+      List lSrc{ 11, 26, 31 };
+      // exercise
+      List lDest(lSrc);
+      // verify
+      assertForward(lDest, 11, 26, 31);
+      assertForward(lSrc, 11, 26, 31);
+      assertUnit(lDest.head.pNext != lSrc.head.pNext);
+   }  // teardown
+
+   void test_constructMove_standard()
+   {  // setup
+      List lSrc{ 11, 26, 31 };
+      List::Link * pFirst = lSrc.head.pNext;
+      // exercise
+      List lDest(std::move(lSrc));
+      // verify
+      assertForward(lDest, 11, 26, 31);
+      assertUnit(lDest.head.pNext == pFirst);
+      assertForward(lSrc);
+   }  // teardown
+
+   void test_assign_copy()
+   {  // setup
+      List lSrc{ 11, 26, 31 };
+      List lDest{ 99 };
+      // exercise
+      lDest = lSrc;
+      // verify
+      assertForward(lDest, 11, 26, 31);
+      assertForward(lSrc, 11, 26, 31);
+   }  // teardown
+
+   void test_assign_move()
+   {  // setup
+      List lSrc{ 11, 26, 31 };
+      List lDest{ 99 };
+      // exercise
+      lDest = std::move(lSrc);
+      // verify
+      assertForward(lDest, 11, 26, 31);
+      assertForward(lSrc);
+   }  // teardown
+
+   /***************************************
+    * ITERATOR
+    ***************************************/
+
+   // one step past before_begin() is begin(), which is end()
+   void test_beforeBegin_empty()
+   {  // setup
+      List l;
+      // exercise
+      List::iterator it = l.before_begin();
+      ++it;
+      // verify
+      assertUnit(it == l.begin());
+      assertUnit(it == l.end());
+   }  // teardown
+
+   void test_beforeBegin_standard()
+   {  // setup
+      List l{ 11, 26, 31 };
+      // exercise
+      List::iterator it = l.before_begin();
+      it++;
+      // verify
+      assertUnit(it == l.begin());
+      assertUnit(*it == 11);
+   }  // teardown
+
+   /***************************************
+    * ACCESS
+    ***************************************/
+
+   void test_front_empty()
+   {  // setup
+      List l;
+      bool thrown = false;
+      // exercise
+      try
+      {
+         l.front();
+      }
+      catch (const char * error)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+   }  // teardown
+
+   void test_front_standard()
+   {  // setup
+      List l{ 11, 26, 31 };
+      // exercise
+      l.front() = 99;
+      // verify
+      assertForward(l, 99, 26, 31);
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   void test_pushFront_empty()
+   {  // setup
+      List l;
+      // exercise
+      l.push_front(99);
+      // verify
+      assertForward(l, 99);
+   }  // teardown
+
+   void test_pushFront_standard()
+   {  // setup
+      List l{ 11, 26, 31 };
+      int value = 99;
+      // exercise
+      l.push_front(value);
+      l.push_front(std::move(value));
+      // verify
+      assertForward(l, 99, 99, 11, 26, 31);
+   }  // teardown
+
+   // built in place from any constructor
+   void test_emplaceFront_string()
+   {  // setup
+      custom::forward_list<std::string> l;
+      // exercise
+      l.emplace_front(3, 'x');
+      l.emplace_after(l.begin(), "abc", 2);
+      // verify
+      assertUnit(l.size() == 2);
+      assertUnit(l.front() == "xxx");
+      assertUnit(*(++l.begin()) == "ab");
+   }  // teardown
+
+   // after before_begin() is the front
+   void test_insertAfter_beforeBegin()
+   {  // setup
+      List l;
+      // exercise
+      List::iterator itReturn = l.insert_after(l.before_begin(), 99);
+      // verify
+      assertForward(l, 99);
+      assertUnit(itReturn == l.begin());
+   }  // teardown
+
+   void test_insertAfter_middle()
+   {  // setup
+      //       +----+   +----+   +----+
+      //       | 11 | - | 26 | - | 31 |
+      //       +----+   +----+   +----+
+      //         it
+      List l{ 11, 26, 31 };
+      // exercise
+      List::iterator itReturn = l.insert_after(l.begin(), 99);
+      // verify
+      //       +----+   +----+   +----+   +----+
+      //       | 11 | - | 99 | - | 26 | - | 31 |
+      //       +----+   +----+   +----+   +----+
+      //                itReturn
+      assertForward(l, 11, 99, 26, 31);
+      assertUnit(itReturn.p == l.head.pNext->pNext);
+   }  // teardown
+
+   void test_insertAfter_last()
+   {  // setup
+      List l{ 11, 26, 31 };
+      List::iterator it(l.head.pNext->pNext->pNext);
+      // exercise
+      List::iterator itReturn = l.insert_after(it, 99);
+      // verify
+      assertForward(l, 11, 26, 31, 99);
+      assertUnit(*itReturn == 99);
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    ***************************************/
+
+   void test_popFront_standard()
+   {  // setup
+      List l{ 11, 26, 31 };
+      // exercise
+      l.pop_front();
+      // verify
+      assertForward(l, 26, 31);
+   }  // teardown
+
+   void test_popFront_empty()
+   {  // setup
+      List l;
+      // exercise
+      l.pop_front();
+      // verify
+      assertForward(l);
+   }  // teardown
+
+   void test_eraseAfter_middle()
+   {  // setup
+      List l{ 11, 26, 31 };
+      // exercise
+      List::iterator itReturn = l.erase_after(l.begin());
+      // verify
+      assertForward(l, 11, 31);
+      assertUnit(*itReturn == 31);
+   }  // teardown
+
+   // nothing after the last one
+   void test_eraseAfter_last()
+   {  // setup
+      List l{ 11, 26, 31 };
+      List::iterator it(l.head.pNext->pNext);
+      // exercise
+      List::iterator itReturn = l.erase_after(it);
+      List::iterator itNothing = l.erase_after(it);
+      // verify
+      assertForward(l, 11, 26);
+      assertUnit(itReturn == l.end());
+      assertUnit(itNothing == l.end());
+   }  // teardown
+
+   // everything between, but not including, the two
+   void test_eraseAfter_range()
+   {  // setup
+      List l{ 1, 2, 3, 4, 5 };
+      List::iterator last(l.head.pNext->pNext->pNext->pNext->pNext);
+      // exercise
+      List::iterator itReturn = l.erase_after(l.begin(), last);
+      // verify
+      assertForward(l, 1, 5);
+      assertUnit(itReturn == last);
+      // and everything after the front
+      l.erase_after(l.before_begin(), l.end());
+      assertForward(l);
+   }  // teardown
+
+   /***************************************
+    * SPLICE
+    ***************************************/
+
+   // all of one list after 11
+   void test_spliceAfter_allMiddle()
+   {  // setup
+      List l{ 11, 26, 31 };
+      List lSrc{ 1, 2 };
+      List::Link * pFirst = lSrc.head.pNext;
+      // exercise
+      l.splice_after(l.begin(), lSrc);
+      // verify
+      assertForward(l, 11, 1, 2, 26, 31);
+      assertUnit(l.head.pNext->pNext == pFirst);
+      assertForward(lSrc);
+   }  // teardown
+
+   void test_spliceAfter_allToEmpty()
+   {  // setup
+      List l;
+      List lSrc{ 11, 26, 31 };
+      // exercise
+      l.splice_after(l.before_begin(), lSrc);
+      // verify
+      assertForward(l, 11, 26, 31);
+      assertForward(lSrc);
+   }  // teardown
+
+   // the 26 after another list's before_begin()
+   void test_spliceAfter_oneOtherList()
+   {  // setup
+      List l{ 11, 31 };
+      List lSrc{ 1, 26, 2 };
+      // exercise
+      l.splice_after(l.before_begin(), lSrc, lSrc.begin());
+      // verify
+      assertForward(l, 26, 11, 31);
+      assertForward(lSrc, 1, 2);
+   }  // teardown
+
+   // the 31 from the back to the front, and moves in place do nothing
+   void test_spliceAfter_oneSameList()
+   {  // setup
+      List l{ 11, 26, 31 };
+      List::iterator it26(l.head.pNext->pNext);
+      // exercise
+      l.splice_after(l.before_begin(), l, it26);
+      l.splice_after(it26, l, it26);
+      // verify
+      assertForward(l, 31, 11, 26);
+   }  // teardown
+
+   // the 2 and 3 of another list after the 31
+   void test_spliceAfter_rangeOtherList()
+   {  // setup
+      List l{ 11, 26, 31 };
+      List lSrc{ 1, 2, 3, 4 };
+      List::iterator last(lSrc.head.pNext->pNext->pNext->pNext);
+      List::iterator pos(l.head.pNext->pNext->pNext);
+      // exercise
+      l.splice_after(pos, lSrc, lSrc.begin(), last);
+      // verify
+      assertForward(l, 11, 26, 31, 2, 3);
+      assertForward(lSrc, 1, 4);
+   }  // teardown
+
+   /***************************************
+    * ALLOCATIONS
+    ***************************************/
+
+   // one node per element and nothing else
+   void test_allocations_pushFront()
+   {  // setup
+      List l;
+      trackAllocations();
+      size_t numAlloc = AllocationCounters::current().numAlloc;
+      // exercise
+      for (int i = 0; i < 3; i++)
+         l.push_front(i);
+      numAlloc = AllocationCounters::current().numAlloc - numAlloc;
+      // verify
+      assertAllocations(3);
+#ifdef UNIT_TEST_ALLOCATIONS
+      assertUnit(numAlloc == 3);
+#endif // UNIT_TEST_ALLOCATIONS
+      assertForward(l, 2, 1, 0);
+   }  // teardown
+
+   // splicing relinks nodes
+   void test_allocations_splice()
+   {  // setup
+      List l{ 11, 26, 31 };
+      List lSrc{ 1, 2, 3 };
+      trackAllocations();
+      // exercise
+      l.splice_after(l.before_begin(), lSrc, lSrc.begin());
+      l.splice_after(l.before_begin(), lSrc);
+      // verify
+      assertNoAllocations();
+      assertForward(l, 1, 3, 2, 11, 26, 31);
+   }  // teardown
+
+   /****************************************************************
+    * Verify Forward
+    * Walk the list checking every value, that it ends where it
+    * should, and that the size agrees
+    ****************************************************************/
+   void assertForwardParameters(const List & l, const std::vector<int> & values,
+                                int line, const char * function)
+   {
+      assertIndirect(l.numElements == values.size());
+      const List::Link * p = l.head.pNext;
+      for (size_t i = 0; i < values.size(); i++)
+      {
+         assertIndirect(p != nullptr);
+         if (!p)
+            return;
+         assertIndirect(static_cast<const List::Node *>(p)->data == values[i]);
+         p = p->pNext;
+      }
+      assertIndirect(p == nullptr);
+   }
+};
+
+#endif // DEBUG
@@ -11,24 +11,134 @@
 #define DEBUG   // Remove this to skip the unit tests
 #endif // DEBUG
 
+#ifndef UNIT_TEST_ALLOCATIONS
+#define UNIT_TEST_ALLOCATIONS   // count every new and delete in the unit tests
+#endif // UNIT_TEST_ALLOCATIONS
+
 #include "testSpy.h"       // for the pair unit tests
 #include "testPair.h"       // for the pair unit tests
 #include "testHash.h"       // for the hash unit tests
 #include "testList.h"       // for the list unit tests
-int Spy::counters[] = {};
+#include "testUnrolledList.h" // for the unrolled list unit tests
+#include "testForwardList.h" // for the forward list unit tests
+#include "testIndexList.h"   // for the index list unit tests
+#include "testMpscQueue.h"   // for the mpsc queue unit tests
+#include "testReclaim.h"     // for the reclaimer unit tests
+#include "testLockFreeList.h" // for the lock free list unit tests
+#include "testThreadPool.h" // for the thread pool unit tests
+#include "testTrace.h"      // for the trace unit tests
+#include "testLatencyHistogram.h" // for the latency histogram unit tests
+#include "testRegression.h" // for the regression gate unit tests
+
+#include <cstddef>          // for std::max_align_t
+#include <cstdint>          // for std::uintptr_t
+#include <cstdlib>          // for std::strtoul and std::malloc
+#include <cstring>          // for std::strcmp and std::memcpy
+#include <new>              // for std::bad_alloc and std::nothrow_t
+
+#ifdef UNIT_TEST_ALLOCATIONS
+/*************************************************************
+ * OPERATOR NEW and DELETE
+ * Count every allocation in AllocationCounters for the tests.
+ * The size hides in front of the block so delete can tell how
+ * many bytes are no longer live
+ *************************************************************/
+static const size_t ALLOCATION_HEADER = alignof(max_align_t);
+
+void * operator new(size_t size)
+{
+   char * p = static_cast<char *>(std::malloc(size + ALLOCATION_HEADER));
+   if (!p)
+      throw std::bad_alloc();
+   std::memcpy(p, &size, sizeof(size));
+
+   AllocationCounters & counters = AllocationCounters::current();
+   counters.numAlloc++;
+   counters.bytesAlloc += size;
+   counters.bytesLive  += (long long)size;
+   if (counters.bytesLive > counters.bytesPeak)
+      counters.bytesPeak = counters.bytesLive;
+   return p + ALLOCATION_HEADER;
+}
+
+void operator delete(void * p) noexcept
+{
+   if (!p)
+      return;
+   // step back through an integer: the compiler only sees the block
+   // it handed out, so it takes the header for out of bounds
+   char * pBlock = reinterpret_cast<char *>(reinterpret_cast<std::uintptr_t>(p) - ALLOCATION_HEADER);
+   AllocationCounters & counters = AllocationCounters::current();
+   counters.numFree++;
+   size_t size;
+   std::memcpy(&size, pBlock, sizeof(size));
+   counters.bytesLive -= (long long)size;
+   std::free(pBlock);
+}
+
+void * operator new[](size_t size)                  { return operator new(size); }
+void   operator delete[](void * p) noexcept         { operator delete(p);        }
+void   operator delete(void * p, size_t) noexcept   { operator delete(p);        }
+void   operator delete[](void * p, size_t) noexcept { operator delete(p);        }
+
+// std::stable_sort borrows its buffer through the nothrow form
+void * operator new(size_t size, const std::nothrow_t &) noexcept
+{
+   try
+   {
+      return operator new(size);
+   }
+   catch (...)
+   {
+      return nullptr;
+   }
+}
+void * operator new[](size_t size, const std::nothrow_t & tag) noexcept { return operator new(size, tag); }
+void   operator delete(void * p, const std::nothrow_t &) noexcept       { operator delete(p);              }
+void   operator delete[](void * p, const std::nothrow_t &) noexcept     { operator delete(p);              }
+#endif // UNIT_TEST_ALLOCATIONS
 
 /**********************************************************************
  * MAIN
  * This is just a simple menu to launch a collection of tests
+ *    testHash [--parallel] [--slowest N]
  ***********************************************************************/
-int main()
+int main(int argc, char ** argv)
 {
 #ifdef DEBUG
+   UnitTestRunner runner;
+   size_t numSlowest = 0;
+   for (int i = 1; i < argc; i++)
+   {
+      if (!std::strcmp(argv[i], "--parallel"))
+         runner.setParallel(true);
+      else if (!std::strcmp(argv[i], "--slowest") && i + 1 < argc)
+         numSlowest = std::strtoul(argv[++i], nullptr, 10);
+      else
+      {
+         std::cerr << "Usage: " << argv[0] << " [--parallel] [--slowest N]\n";
+         return 1;
+      }
+   }
+
    // unit tests
-   TestSpy().run();
-   TestPair().run();
-   TestList().run();
-   TestHash().run();
+   runner.add<TestSpy>();
+   runner.add<TestPair>();
+   runner.add<TestList>();
+   runner.add<TestUnrolledList>();
+   runner.add<TestForwardList>();
+   runner.add<TestIndexList>();
+   runner.add<TestMpscQueue>();
+   runner.add<TestReclaim>();
+   runner.add<TestLockFreeList>();
+   runner.add<TestThreadPool>();
+   runner.add<TestHash>();
+   runner.add<TestTrace>();
+   runner.add<TestLatencyHistogram>(false);   // shares the containers' histograms
+   runner.add<TestRegression>();
+   runner.run();
+   if (numSlowest)
+      UnitTestRunner::reportSlowest(numSlowest);
 #endif // DEBUG
    
    // driver
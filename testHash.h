@@ -12,6 +12,7 @@
 #ifdef DEBUG
 
 #include "hash.h"
+#include "spy.h"
 #include "unitTest.h"
 
 #include <cassert>
@@ -19,12 +20,14 @@
 #include <unordered_set>
 #include <functional>
 #include <vector>
+#include <atomic>
 
 using std::cout;
 using std::endl;
 
-// Keep our hash simple without any fancy stuff
-#ifndef __APPLE__
+// Keep our hash simple without any fancy stuff. libstdc++ already
+// defines std::hash<std::size_t> this way and will not let us redefine it
+#if !defined(__APPLE__) && !defined(__GLIBCXX__)
 namespace std
 {
    template <> struct hash<std::size_t>
@@ -36,7 +39,32 @@ namespace std
       }
    };
 }
-#endif // __APPLE__
+#endif // !__APPLE__ && !__GLIBCXX__
+
+// copies any int but a negative one
+struct Fragile
+{
+   Fragile(int value) : value(value) {}
+   Fragile(const Fragile & rhs) : value(rhs.value)
+   {
+      if (value < 0)
+         throw "ERROR: not positive";
+   }
+   Fragile(Fragile && rhs) noexcept : value(rhs.value) {}
+   bool operator == (const Fragile & rhs) const { return value == rhs.value; }
+   int value;
+};
+
+namespace std
+{
+   template <> struct hash<Fragile>
+   {
+      std::size_t operator()(const Fragile & f) const noexcept
+      {
+         return (std::size_t)f.value;
+      }
+   };
+}
 
 class TestHash : public UnitTest
 {
@@ -47,77 +75,110 @@ public:
       reset();
 
       // Construct
-      test_construct_default();
-      test_constructIterator_standard();
-      test_constructCopy_empty();
-      test_constructCopy_standard();
+      runUnit(test_construct_default);
+      runUnit(test_constructIterator_standard);
+      runUnit(test_constructCopy_empty);
+      runUnit(test_constructCopy_standard);
 
       // Assign
-      test_assign_emptyEmpty();
-      test_assign_emptyStandard();
-      test_assign_standardEmpty();
-      test_assignMove_emptyEmpty();
-      test_assignMove_emptyStandard();
-      test_assignMove_standardEmpty();
-      test_swapMember_emptyEmpty();
-      test_swapMember_standardEmpty();
-      test_swapMember_standardOther();
-      test_swapNonMember_emptyEmpty();
-      test_swapNonMember_standardEmpty();
-      test_swapNonMember_standardOther();
+      runUnit(test_assign_emptyEmpty);
+      runUnit(test_assign_emptyStandard);
+      runUnit(test_assign_standardEmpty);
+      runUnit(test_assignMove_emptyEmpty);
+      runUnit(test_assignMove_emptyStandard);
+      runUnit(test_assignMove_standardEmpty);
+      runUnit(test_swapMember_emptyEmpty);
+      runUnit(test_swapMember_standardEmpty);
+      runUnit(test_swapMember_standardOther);
+      runUnit(test_swapNonMember_emptyEmpty);
+      runUnit(test_swapNonMember_standardEmpty);
+      runUnit(test_swapNonMember_standardOther);
 
       // Iterator
-      test_iterator_begin_empty();
-      test_iterator_begin_standard();
-      test_iterator_end_empty();
-      test_iterator_end_standard();
-      test_iterator_increment_empty();
-      test_iterator_increment_moreInBucket();
-      test_iterator_increment_nextBucket();
-      test_iterator_increment_toEnd();
-      test_iterator_dereference();
-      test_localIterator_begin_single();
-      test_localIterator_begin_multiple();
-      test_localIterator_begin_empty();
-      test_localIterator_increment_single();
-      test_localIterator_increment_multiple();
+      runUnit(test_iterator_begin_empty);
+      runUnit(test_iterator_begin_standard);
+      runUnit(test_iterator_end_empty);
+      runUnit(test_iterator_end_standard);
+      runUnit(test_iterator_increment_empty);
+      runUnit(test_iterator_increment_moreInBucket);
+      runUnit(test_iterator_increment_nextBucket);
+      runUnit(test_iterator_increment_toEnd);
+      runUnit(test_iterator_dereference);
+      runUnit(test_localIterator_begin_single);
+      runUnit(test_localIterator_begin_multiple);
+      runUnit(test_localIterator_begin_empty);
+      runUnit(test_localIterator_increment_single);
+      runUnit(test_localIterator_increment_multiple);
+      runUnit(test_bucketRange_standard);
+      runUnit(test_bucketRange_split);
 
       // Access
-      test_bucket_empty0();
-      test_bucket_empty7();
-      test_bucket_empty58();
-      test_find_empty();
-      test_find_standardFront();
-      test_find_standardBack();
-      test_find_standardMissingEmptyList();
-      test_find_standardMissingFilledList();
+      runUnit(test_bucket_empty0);
+      runUnit(test_bucket_empty7);
+      runUnit(test_bucket_empty58);
+      runUnit(test_find_empty);
+      runUnit(test_find_standardFront);
+      runUnit(test_find_standardBack);
+      runUnit(test_find_standardMissingEmptyList);
+      runUnit(test_find_standardMissingFilledList);
 
       // Insert
-      test_insert_empty0();
-      test_insert_empty58();
-      test_insert_standard3();
-      test_insert_standard77();
-      test_insert_standardDuplicate();
+      runUnit(test_insert_empty0);
+      runUnit(test_insert_empty58);
+      runUnit(test_insert_standard3);
+      runUnit(test_insert_standard77);
+      runUnit(test_insert_standardDuplicate);
+      runUnit(test_insertParallel_empty);
+      runUnit(test_insertParallel_standard);
+      runUnit(test_insertParallel_duplicates);
+      runUnit(test_insertParallel_large);
+      runUnit(test_insertParallel_throw);
+      runUnit(test_insert_spyHashedOnce);
+      runUnit(test_insertParallel_spyHashedOnce);
+      runUnit(test_insertParallel_spyDuplicates);
 
       // Remove
-      test_clear_empty();
-      test_clear_standard();
-      test_erase_empty();
-      test_erase_standardMissing();
-      test_erase_standardAlone();
-      test_erase_standardFront();
-      test_erase_standardBack();
-      test_erase_standardLast();
+      runUnit(test_clear_empty);
+      runUnit(test_clear_standard);
+      runUnit(test_clearAsync_empty);
+      runUnit(test_clearAsync_standard);
+      runUnit(test_erase_empty);
+      runUnit(test_erase_standardMissing);
+      runUnit(test_erase_standardAlone);
+      runUnit(test_erase_standardFront);
+      runUnit(test_erase_standardBack);
+      runUnit(test_erase_standardLast);
       
       // Status
-      test_size_empty();
-      test_size_standard();
-      test_empty_empty();
-      test_empty_standard();
-      test_bucketSize_empty();
-      test_bucketSize_standardEmpty();
-      test_bucketSize_standardOne();
-      test_bucketSize_standardTwo();
+      runUnit(test_size_empty);
+      runUnit(test_size_standard);
+      runUnit(test_empty_empty);
+      runUnit(test_empty_standard);
+      runUnit(test_bucketSize_empty);
+      runUnit(test_bucketSize_standardEmpty);
+      runUnit(test_bucketSize_standardOne);
+      runUnit(test_bucketSize_standardTwo);
+      runUnit(test_stats_empty);
+      runUnit(test_stats_standard);
+      runUnit(test_stats_json);
+      runUnit(test_stats_prometheus);
+#ifdef HASH_COUNTERS
+      runUnit(test_stats_counters);
+#endif // HASH_COUNTERS
+
+      // Parallel
+      runUnit(test_parallelForEach_empty);
+      runUnit(test_parallelForEach_standard);
+      runUnit(test_parallelReduce_empty);
+      runUnit(test_parallelReduce_standard);
+
+      // Allocations
+      runUnit(test_allocations_moveConstruct);
+      runUnit(test_allocations_moveAssign);
+      runUnit(test_allocations_swapMember);
+      runUnit(test_allocations_swapNonMember);
+      runUnit(test_allocations_find);
+      runUnit(test_allocations_iterate);
 
       report("Hash");
    }
@@ -1271,6 +1332,58 @@ public:
       assertStandardFixture(us);
    }
 
+   // view the second half of the buckets
+   void test_bucketRange_standard()
+   {  // setup
+      //      h[0] -->
+      //      h[1] --> 31
+      //      h[2] -->
+      //      h[3] -->
+      //      h[4] -->
+      //      h[5] -->
+      //      h[6] -->
+      //      h[7] --> 67
+      //      h[8] -->
+      //      h[9] --> 59 49
+      custom::unordered_set<std::size_t> us;
+      setupStandardFixture(us);
+      std::vector<std::size_t> v;
+      // exercise
+      custom::unordered_set<std::size_t>::range r = us.bucket_range(5, 10);
+      r.for_each([&](std::size_t& t) { v.push_back(t); });
+      // verify
+      assertUnit(r.begin_bucket() == 5);
+      assertUnit(r.end_bucket() == 10);
+      assertUnit(r.bucket_count() == 5);
+      assertUnit(r.begin(7) == us.begin(7));
+      assertUnit(v.size() == 3);
+      if (v.size() == 3)
+      {
+         assertUnit(v[0] == 67);
+         assertUnit(v[1] == 59);
+         assertUnit(v[2] == 49);
+      }
+      assertStandardFixture(us);
+   }  // teardown
+
+   // split all the buckets into two halves
+   void test_bucketRange_split()
+   {  // setup
+      custom::unordered_set<std::size_t> us;
+      setupStandardFixture(us);
+      custom::unordered_set<std::size_t>::range r = us.bucket_range(0, 10);
+      // exercise
+      custom::unordered_set<std::size_t>::range rhs = r.split();
+      // verify
+      assertUnit(r.begin_bucket() == 0);
+      assertUnit(r.end_bucket() == 5);
+      assertUnit(rhs.begin_bucket() == 5);
+      assertUnit(rhs.end_bucket() == 10);
+      assertUnit(r.pSet == &us);
+      assertUnit(rhs.pSet == &us);
+      assertStandardFixture(us);
+   }  // teardown
+
 
    /***************************************
     * ACCESS
@@ -1726,6 +1839,174 @@ public:
       assertUnit(p.second == false);
    }
    
+   // bulk load nothing with several threads
+   void test_insertParallel_empty()
+   {  // setup
+      std::vector<std::size_t> v;
+      custom::unordered_set<std::size_t> us;
+      // exercise
+      us.insert_parallel(v.begin(), v.end(), 4);
+      // verify
+      //      h[0] -->
+      //      h[1] -->
+      //      h[2] -->
+      //      h[3] -->
+      //      h[4] -->
+      //      h[5] -->
+      //      h[6] -->
+      //      h[7] -->
+      //      h[8] -->
+      //      h[9] -->
+      assertEmptyFixture(us);
+   }  // teardown
+
+   // bulk load the standard fixture with more threads than elements
+   void test_insertParallel_standard()
+   {  // setup
+      std::vector<std::size_t> v{59, 67, 31, 49};
+      custom::unordered_set<std::size_t> us;
+      // exercise
+      us.insert_parallel(v.begin(), v.end(), 8);
+      // verify
+      //      h[0] -->
+      //      h[1] --> 31
+      //      h[2] -->
+      //      h[3] -->
+      //      h[4] -->
+      //      h[5] -->
+      //      h[6] -->
+      //      h[7] --> 67
+      //      h[8] -->
+      //      h[9] --> 59 49
+      assertStandardFixture(us);
+   }  // teardown
+
+   // bulk load duplicates, some of which are already in the hash
+   void test_insertParallel_duplicates()
+   {  // setup
+      //      h[0] -->
+      //      h[1] --> 31
+      //      h[2] -->
+      //      h[3] -->
+      //      h[4] -->
+      //      h[5] -->
+      //      h[6] -->
+      //      h[7] --> 67
+      //      h[8] -->
+      //      h[9] --> 59 49
+      std::vector<std::size_t> v{67, 59, 67, 49, 31, 59, 31, 49};
+      custom::unordered_set<std::size_t> us;
+      setupStandardFixture(us);
+      // exercise
+      us.insert_parallel(v.begin(), v.end(), 3);
+      // verify
+      assertStandardFixture(us);
+   }  // teardown
+
+   // many keys in few buckets, half of them repeated
+   void test_insertParallel_large()
+   {  // setup
+      std::vector<std::size_t> v;
+      for (std::size_t i = 0; i < 20000; i++)
+         v.push_back(i % 10000);
+      custom::unordered_set<std::size_t> us;
+      us.insert(9999);
+      // exercise
+      us.insert_parallel(v.begin(), v.end(), 4);
+      // verify
+      assertUnit(us.size() == 10000);
+      assertUnit(us.bucket_count() == 10);
+      std::size_t numFound = 0;
+      for (std::size_t i = 0; i < 10000; i++)
+         numFound += (us.find(i) != us.end());
+      assertUnit(numFound == 10000);
+   }  // teardown
+
+   // when a key will not copy, what got in before the throw is counted
+   void test_insertParallel_throw()
+   {  // setup
+      std::vector<Fragile> v;
+      for (int i = 0; i < 100; i++)
+         v.push_back(Fragile(i == 50 ? -1 : i));
+      custom::unordered_set<Fragile> us;
+      bool thrown = false;
+      // exercise
+      try
+      {
+         us.insert_parallel(v.begin(), v.end(), 4);
+      }
+      catch (const char *)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      std::size_t numInBuckets = 0;
+      for (std::size_t i = 0; i < us.bucket_count(); i++)
+         numInBuckets += us.bucket_size(i);
+      std::size_t numIterated = 0;
+      for (auto it = us.begin(); it != us.end(); ++it)
+         numIterated++;
+      assertUnit(us.size() == numInBuckets);
+      assertUnit(us.size() == numIterated);
+      assertUnit(us.size() < 100);
+      assertUnit(us.find(Fragile(-1)) == us.end());
+   }  // teardown
+
+   // each key is hashed once and copied once, into its node
+   void test_insert_spyHashedOnce()
+   {  // setup
+      std::vector<Spy> v;
+      for (int i = 0; i < 100; i++)
+         v.push_back(Spy(i));
+      custom::unordered_set<Spy> us;
+      Spy::reset();
+      // exercise
+      for (auto & s : v)
+         us.insert(s);
+      // verify
+      assertUnit(us.size() == 100);
+      assertUnit(Spy::numHash() == 100);
+      assertUnit(Spy::numCopy() == 100);
+      assertUnit(Spy::numAssign() == 0);
+   }  // teardown
+
+   // the same holds on four threads: partitioning and merging the
+   // buckets moves pointers around, never keys
+   void test_insertParallel_spyHashedOnce()
+   {  // setup
+      std::vector<Spy> v;
+      for (int i = 0; i < 1000; i++)
+         v.push_back(Spy(i));
+      custom::unordered_set<Spy> us;
+      Spy::reset();
+      // exercise
+      us.insert_parallel(v.begin(), v.end(), 4);
+      // verify
+      assertUnit(us.size() == 1000);
+      assertUnit(Spy::numHash() == 1000);
+      assertUnit(Spy::numCopy() == 1000);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+   }  // teardown
+
+   // duplicates are hashed but never copied
+   void test_insertParallel_spyDuplicates()
+   {  // setup
+      std::vector<Spy> v;
+      for (int i = 0; i < 1000; i++)
+         v.push_back(Spy(i % 250));
+      custom::unordered_set<Spy> us;
+      Spy::reset();
+      // exercise
+      us.insert_parallel(v.begin(), v.end(), 4);
+      // verify
+      assertUnit(us.size() == 250);
+      assertUnit(Spy::numHash() == 1000);
+      assertUnit(Spy::numCopy() == 250);
+   }  // teardown
+
    /***************************************
     * REMOVE
     ***************************************/
@@ -1791,6 +2072,56 @@ public:
       assertEmptyFixture(us);
       // teardown
    }
+
+   // hand an empty hash to the reclaimer
+   void test_clearAsync_empty()
+   {  // setup
+      custom::unordered_set<std::size_t> us;
+      {
+         custom::thread_pool pool(2);
+         // exercise
+         us.clear_async(pool);
+         // verify
+         assertEmptyFixture(us);
+      }  // the pool finishes the reclaim
+      assertEmptyFixture(us);
+   }  // teardown
+
+   // hand the standard fixture to the reclaimer and keep using the hash
+   void test_clearAsync_standard()
+   {  // setup
+      //      h[0] -->
+      //      h[1] --> 31
+      //      h[2] -->
+      //      h[3] -->
+      //      h[4] -->
+      //      h[5] -->
+      //      h[6] -->
+      //      h[7] --> 67
+      //      h[8] -->
+      //      h[9] --> 59 49
+      custom::unordered_set<std::size_t> us;
+      setupStandardFixture(us);
+      {
+         custom::thread_pool pool(2);
+         // exercise
+         us.clear_async(pool);
+         // verify
+         //      h[0] -->
+         //      h[1] -->
+         //      h[2] -->
+         //      h[3] -->
+         //      h[4] -->
+         //      h[5] -->
+         //      h[6] -->
+         //      h[7] -->
+         //      h[8] -->
+         //      h[9] -->
+         assertEmptyFixture(us);
+         setupStandardFixture(us);
+      }  // the pool finishes the reclaim
+      assertStandardFixture(us);
+   }  // teardown
    
    // erase an empty hash
    void test_erase_empty()
@@ -2294,6 +2625,292 @@ public:
       // teardown
    }
 
+   // the shape of an empty hash
+   void test_stats_empty()
+   {  // setup
+      custom::unordered_set<std::size_t> us;
+      custom::hash_stats stats;
+      // exercise
+      stats = us.stats();
+      // verify
+      assertUnit(stats.numElements == 0);
+      assertUnit(stats.numBuckets == 10);
+      assertUnit(stats.loadFactor == 0.0);
+      assertUnit(stats.maxChain == 0);
+      assertUnit(stats.meanChain == 0.0);
+      assertUnit(stats.emptyBucketRatio == 1.0);
+      assertUnit(stats.histogram[0] == 10);
+      assertUnit(stats.histogram[1] == 0);
+      assertUnit(stats.bytesBuckets == sizeof(us.buckets));
+      assertUnit(stats.bytesNodes == 0);
+      assertUnit(stats.numRehash == 0);
+      assertEmptyFixture(us);
+   }  // teardown
+
+   // the shape of the standard hash
+   void test_stats_standard()
+   {  // setup
+      //      h[0] -->
+      //      h[1] --> 31
+      //      h[2] -->
+      //      h[3] -->
+      //      h[4] -->
+      //      h[5] -->
+      //      h[6] -->
+      //      h[7] --> 67
+      //      h[8] -->
+      //      h[9] --> 59 49
+      custom::unordered_set<std::size_t> us;
+      setupStandardFixture(us);
+      custom::hash_stats stats;
+      // exercise
+      stats = us.stats();
+      // verify
+      assertUnit(stats.numElements == 4);
+      assertUnit(stats.numBuckets == 10);
+      assertUnit(stats.loadFactor == 0.4);
+      assertUnit(stats.maxChain == 2);
+      assertUnit(stats.meanChain == 4.0 / 3.0);
+      assertUnit(stats.emptyBucketRatio == 0.7);
+      assertUnit(stats.histogram[0] == 7);
+      assertUnit(stats.histogram[1] == 2);
+      assertUnit(stats.histogram[2] == 1);
+      assertUnit(stats.histogram[3] == 0);
+      assertUnit(stats.bytesNodes == 4 * custom::list<std::size_t>::node_size());
+      assertStandardFixture(us);
+   }  // teardown
+
+   // the standard hash as JSON
+   void test_stats_json()
+   {  // setup
+      custom::unordered_set<std::size_t> us;
+      setupStandardFixture(us);
+      std::string json;
+      // exercise
+      json = custom::to_json(us.stats());
+      // verify
+      assertUnit(json.front() == '{');
+      assertUnit(json.back() == '}');
+      assertUnit(json.find("\"elements\":4,") != std::string::npos);
+      assertUnit(json.find("\"max_chain\":2,") != std::string::npos);
+      assertUnit(json.find("\"histogram\":[7,2,1,0,") != std::string::npos);
+      assertStandardFixture(us);
+   }  // teardown
+
+   // the standard hash as Prometheus text
+   void test_stats_prometheus()
+   {  // setup
+      custom::unordered_set<std::size_t> us;
+      setupStandardFixture(us);
+      std::string text;
+      // exercise
+      text = custom::to_prometheus(us.stats(), "us");
+      // verify
+      assertUnit(text.find("# TYPE us_elements gauge\nus_elements 4\n") != std::string::npos);
+      assertUnit(text.find("us_chain_length_bucket{le=\"0\"} 7\n") != std::string::npos);
+      assertUnit(text.find("us_chain_length_bucket{le=\"1\"} 9\n") != std::string::npos);
+      assertUnit(text.find("us_chain_length_bucket{le=\"+Inf\"} 10\n") != std::string::npos);
+      assertUnit(text.find("us_chain_length_count 10\n") != std::string::npos);
+      assertStandardFixture(us);
+   }  // teardown
+
+#ifdef HASH_COUNTERS
+   // the counters see one hash and every comparison of a find
+   void test_stats_counters()
+   {  // setup
+      //      h[9] --> 59 49
+      custom::unordered_set<std::size_t> us;
+      setupStandardFixture(us);
+      custom::hash_stats stats;
+      // exercise
+      us.find(49);
+      stats = us.stats();
+      // verify
+      assertUnit(stats.hasCounters);
+      assertUnit(stats.numFind == 1);
+      assertUnit(stats.numHash == 1);
+      assertUnit(stats.numEquals == 2);
+      assertStandardFixture(us);
+   }  // teardown
+#endif // HASH_COUNTERS
+
+
+
+   /***************************************
+    * PARALLEL
+    ***************************************/
+
+   // visit every element of an empty hash
+   void test_parallelForEach_empty()
+   {  // setup
+      custom::unordered_set<std::size_t> us;
+      std::atomic<int> count(0);
+      // exercise
+      us.parallel_for_each([&](std::size_t&) { count++; }, 4);
+      // verify
+      assertUnit(count == 0);
+      assertEmptyFixture(us);
+   }  // teardown
+
+   // visit every element of the standard hash
+   void test_parallelForEach_standard()
+   {  // setup
+      //      h[0] -->
+      //      h[1] --> 31
+      //      h[2] -->
+      //      h[3] -->
+      //      h[4] -->
+      //      h[5] -->
+      //      h[6] -->
+      //      h[7] --> 67
+      //      h[8] -->
+      //      h[9] --> 59 49
+      custom::unordered_set<std::size_t> us;
+      setupStandardFixture(us);
+      std::atomic<std::size_t> sum(0);
+      std::atomic<int> count(0);
+      // exercise
+      us.parallel_for_each([&](std::size_t& t) { sum += t; count++; }, 3);
+      // verify
+      assertUnit(count == 4);
+      assertUnit(sum == 31 + 67 + 59 + 49);
+      assertStandardFixture(us);
+   }  // teardown
+
+   // reduce an empty hash to the initial value
+   void test_parallelReduce_empty()
+   {  // setup
+      custom::unordered_set<std::size_t> us;
+      std::size_t sum = 99;
+      // exercise
+      sum = us.parallel_reduce(std::size_t(0),
+                               [](std::size_t& t) { return t; },
+                               [](std::size_t a, std::size_t b) { return a + b; },
+                               4);
+      // verify
+      assertUnit(sum == 0);
+      assertEmptyFixture(us);
+   }  // teardown
+
+   // find the largest element in the standard hash
+   void test_parallelReduce_standard()
+   {  // setup
+      //      h[0] -->
+      //      h[1] --> 31
+      //      h[2] -->
+      //      h[3] -->
+      //      h[4] -->
+      //      h[5] -->
+      //      h[6] -->
+      //      h[7] --> 67
+      //      h[8] -->
+      //      h[9] --> 59 49
+      custom::unordered_set<std::size_t> us;
+      setupStandardFixture(us);
+      std::size_t largest = 99;
+      // exercise
+      largest = us.parallel_reduce(std::size_t(0),
+                                   [](std::size_t& t) { return t; },
+                                   [](std::size_t a, std::size_t b) { return a < b ? b : a; },
+                                   4);
+      // verify
+      assertUnit(largest == 67);
+      assertStandardFixture(us);
+   }  // teardown
+
+   /***************************************
+    * ALLOCATIONS
+    ***************************************/
+
+   // moving a hash moves every bucket's nodes
+   void test_allocations_moveConstruct()
+   {  // setup
+      custom::unordered_set<std::size_t> usSrc;
+      setupStandardFixture(usSrc);
+      trackAllocations();
+      // exercise
+      custom::unordered_set<std::size_t> usDes(std::move(usSrc));
+      // verify
+      assertNoAllocations();
+      assertStandardFixture(usDes);
+   }  // teardown
+
+   // move-assignment does not copy the buckets
+   void test_allocations_moveAssign()
+   {  // setup
+      custom::unordered_set<std::size_t> usSrc;
+      custom::unordered_set<std::size_t> usDes;
+      setupStandardFixture(usSrc);
+      trackAllocations();
+      // exercise
+      usDes = std::move(usSrc);
+      // verify
+      assertNoAllocations();
+      assertEmptyFixture(usSrc);
+      assertStandardFixture(usDes);
+   }  // teardown
+
+   // the member swap trades the buckets in place
+   void test_allocations_swapMember()
+   {  // setup
+      custom::unordered_set<std::size_t> us1;
+      custom::unordered_set<std::size_t> us2;
+      setupStandardFixture(us1);
+      trackAllocations();
+      // exercise
+      us1.swap(us2);
+      // verify
+      assertNoAllocations();
+      assertEmptyFixture(us1);
+      assertStandardFixture(us2);
+   }  // teardown
+
+   // and so does the stand-alone one
+   void test_allocations_swapNonMember()
+   {  // setup
+      custom::unordered_set<std::size_t> us1;
+      custom::unordered_set<std::size_t> us2;
+      setupStandardFixture(us1);
+      trackAllocations();
+      // exercise
+      swap(us1, us2);
+      // verify
+      assertNoAllocations();
+      assertEmptyFixture(us1);
+      assertStandardFixture(us2);
+   }  // teardown
+
+   // a lookup, hit or miss, never allocates
+   void test_allocations_find()
+   {  // setup
+      custom::unordered_set<std::size_t> us;
+      setupStandardFixture(us);
+      trackAllocations();
+      // exercise
+      bool hit  = us.find(49) != us.end();
+      bool miss = us.find(39) != us.end();
+      // verify
+      assertNoAllocations();
+      assertUnit(hit);
+      assertUnit(!miss);
+      assertStandardFixture(us);
+   }  // teardown
+
+   // neither does walking every bucket
+   void test_allocations_iterate()
+   {  // setup
+      custom::unordered_set<std::size_t> us;
+      setupStandardFixture(us);
+      std::size_t sum = 0;
+      trackAllocations();
+      // exercise
+      for (auto it = us.begin(); it != us.end(); ++it)
+         sum += *it;
+      // verify
+      assertNoAllocations();
+      assertUnit(sum == 31 + 67 + 59 + 49);
+      assertStandardFixture(us);
+   }  // teardown
 
    /*************************************************************
     * SETUP STANDARD FIXTURE
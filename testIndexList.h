@@ -0,0 +1,479 @@
+/***********************************************************************
+ * Header:
+ *    TEST INDEX LIST
+ * Summary:
+ *    Unit tests for index_list
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "indexList.h"
+#include "list.h"
+#include "unitTest.h"
+
+#include <cstring>
+#include <list>
+#include <string>
+#include <vector>
+
+// the elements of the list, front to back
+#define assertIndexed(l, ...)    assertIndexedParameters(l, { __VA_ARGS__ }, __LINE__, __FUNCTION__)
+
+class TestIndexList : public UnitTest
+{
+public:
+   typedef custom::index_list<int> List;
+
+   void run()
+   {
+      reset();
+
+      // Construct
+      runUnit(test_nodeSize);
+      runUnit(test_construct_default);
+      runUnit(test_construct_init);
+      runUnit(test_constructCopy_sameSlots);
+      runUnit(test_constructCopy_string);
+      runUnit(test_constructMove_standard);
+      runUnit(test_assign_copy);
+
+      // Iterator
+      runUnit(test_iterator_backward);
+      runUnit(test_iterator_survivesGrowth);
+
+      // Insert
+      runUnit(test_pushBack_grow);
+      runUnit(test_pushBack_ownElement);
+      runUnit(test_pushFront_standard);
+      runUnit(test_insert_middle);
+      runUnit(test_emplace_throwGrow);
+      runUnit(test_reserve_throw);
+
+      // Remove
+      runUnit(test_erase_middle);
+      runUnit(test_erase_reuseSlot);
+      runUnit(test_popBack_popFront);
+      runUnit(test_clear_keepsCapacity);
+
+      // Against std::list
+      runUnit(test_random_operations);
+
+      // Allocations
+      runUnit(test_allocations_reserve);
+      runUnit(test_allocations_reuse);
+
+      report("IndexList");
+   }
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // an int and two 32-bit links, where a list node has two pointers
+   void test_nodeSize()
+   {  // exercise and verify
+      assertUnit(List::node_size() == 3 * sizeof(std::uint32_t));
+      assertUnit(List::node_size() < custom::list<int>::node_size());
+      assertUnit((custom::index_list<int, std::uint16_t>::node_size() == 8));
+   }
+
+   // no array until something goes in
+   void test_construct_default()
+   {  // exercise
+      List l;
+      // verify
+      assertUnit(l.empty());
+      assertUnit(l.capacity() == 0);
+      assertUnit(l.slots == nullptr);
+      assertUnit(l.begin() == l.end());
+   }  // teardown
+
+   // in order, in consecutive slots
+   void test_construct_init()
+   {  // exercise
+      List l{ 11, 26, 31 };
+      // verify
+      assertIndexed(l, 11, 26, 31);
+      assertUnit(l.iHead == 0);
+      assertUnit(l.iTail == 2);
+   }  // teardown
+
+   // a copy of a trivially copyable list is byte for byte the same,
+   // free list and all
+   void test_constructCopy_sameSlots()
+   {  // setup
+      List lSrc{ 11, 26, 31, 45 };
+      lSrc.erase(++lSrc.begin());
+      // exercise
+      List lDest(lSrc);
+      // verify
+      assertIndexed(lDest, 11, 31, 45);
+      assertUnit(lDest.slots != lSrc.slots);
+      assertUnit(lDest.iFree == 1);
+      assertUnit(std::memcmp(lDest.slots, lSrc.slots, lSrc.numSlots * sizeof(List::Slot)) == 0);
+   }  // teardown
+
+   // anything else is copied an element at a time into the same slots
+   void test_constructCopy_string()
+   {  // setup
+      custom::index_list<std::string> lSrc{ "eleven", "twenty six", "thirty one" };
+      lSrc.erase(lSrc.begin());
+      // exercise
+      custom::index_list<std::string> lDest(lSrc);
+      // verify
+      assertUnit(lDest.size() == 2);
+      assertUnit(lDest.iHead == lSrc.iHead);
+      assertUnit(lDest.iFree == lSrc.iFree);
+      assertUnit(lDest.front() == "twenty six");
+      assertUnit(lDest.back() == "thirty one");
+      assertUnit(&lDest.front() != &lSrc.front());
+   }  // teardown
+
+   // the array changes hands
+   void test_constructMove_standard()
+   {  // setup
+      List lSrc{ 11, 26, 31 };
+      List::Slot * slots = lSrc.slots;
+      // exercise
+      List lDest(std::move(lSrc));
+      // verify
+      assertIndexed(lDest, 11, 26, 31);
+      assertUnit(lDest.slots == slots);
+      assertUnit(lSrc.empty());
+      assertUnit(lSrc.slots == nullptr);
+   }  // teardown
+
+   void test_assign_copy()
+   {  // setup
+      List lSrc{ 11, 26, 31 };
+      List lDest{ 99 };
+      // exercise
+      lDest = lSrc;
+      // verify
+      assertIndexed(lDest, 11, 26, 31);
+      assertIndexed(lSrc, 11, 26, 31);
+   }  // teardown
+
+   /***************************************
+    * ITERATOR
+    ***************************************/
+
+   // back from the end to the front
+   void test_iterator_backward()
+   {  // setup
+      List l{ 11, 26, 31 };
+      std::vector<int> seen;
+      List::iterator it = l.end();
+      // exercise
+      for (--it; it != l.end(); --it)
+         seen.push_back(*it);
+      // verify
+      assertUnit(seen == std::vector<int>({ 31, 26, 11 }));
+   }  // teardown
+
+   // an iterator is an index, which a bigger array keeps
+   void test_iterator_survivesGrowth()
+   {  // setup
+      List l{ 11, 26, 31 };
+      List::iterator it = ++l.begin();
+      List::Slot * slots = l.slots;
+      // exercise
+      for (int i = 0; i < 100; i++)
+         l.push_back(i);
+      // verify
+      assertUnit(l.slots != slots);
+      assertUnit(*it == 26);
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // 16 slots, then doubling
+   void test_pushBack_grow()
+   {  // setup
+      List l;
+      // exercise
+      for (int i = 0; i < 17; i++)
+         l.push_back(i);
+      // verify
+      assertUnit(l.size() == 17);
+      assertUnit(l.capacity() == 32);
+      assertUnit(l.front() == 0);
+      assertUnit(l.back() == 16);
+   }  // teardown
+
+   // what is being pushed may be in the array being replaced
+   void test_pushBack_ownElement()
+   {  // setup
+      custom::index_list<std::string> l;
+      for (int i = 0; i < 16; i++)
+         l.push_back(std::string(40, 'a' + i));
+      assertUnit(l.numSlots == l.capacity());
+      // exercise
+      l.push_back(l.front());
+      // verify
+      assertUnit(l.size() == 17);
+      assertUnit(l.back() == std::string(40, 'a'));
+   }  // teardown
+
+   void test_pushFront_standard()
+   {  // setup
+      List l{ 11, 26, 31 };
+      // exercise
+      l.push_front(99);
+      // verify
+      assertIndexed(l, 99, 11, 26, 31);
+      assertUnit(l.iHead == 3);
+   }  // teardown
+
+   // in front of the 26
+   void test_insert_middle()
+   {  // setup
+      List l{ 11, 26, 31 };
+      // exercise
+      List::iterator itReturn = l.insert(++l.begin(), 99);
+      // verify
+      assertIndexed(l, 11, 99, 26, 31);
+      assertUnit(*itReturn == 99);
+      assertUnit(itReturn.i == 3);
+   }  // teardown
+
+   // will not copy or move a negative number
+   struct Brittle
+   {
+      Brittle(int value) : value(value) {}
+      Brittle(const Brittle & rhs) : value(rhs.value) { check(); }
+      Brittle(Brittle && rhs) : value(rhs.value)      { check(); }
+      void check() const
+      {
+         if (value < 0)
+            throw "ERROR: not positive";
+      }
+      int value;
+   };
+
+   // growing to make room keeps the old array when an element will not move
+   void test_emplace_throwGrow()
+   {  // setup
+      custom::index_list<Brittle> l;
+      l.reserve(2);
+      l.emplace_back(1);
+      l.emplace_back(-2);
+      long long bytesLive = AllocationCounters::current().bytesLive;
+      bool thrown = false;
+      // exercise
+      try
+      {
+         l.emplace_back(3);
+      }
+      catch (const char *)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(AllocationCounters::current().bytesLive == bytesLive);
+      assertUnit(thrown);
+      assertUnit(l.size() == 2);
+      assertUnit(l.capacity() == 2);
+      assertUnit(l.front().value == 1);
+      assertUnit(l.back().value == -2);
+   }  // teardown
+
+   // so does reserving more
+   void test_reserve_throw()
+   {  // setup
+      custom::index_list<Brittle> l;
+      l.emplace_back(1);
+      l.emplace_back(-2);
+      size_t capacity = l.capacity();
+      long long bytesLive = AllocationCounters::current().bytesLive;
+      bool thrown = false;
+      // exercise
+      try
+      {
+         l.reserve(capacity + 10);
+      }
+      catch (const char *)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(AllocationCounters::current().bytesLive == bytesLive);
+      assertUnit(thrown);
+      assertUnit(l.size() == 2);
+      assertUnit(l.capacity() == capacity);
+      assertUnit(l.front().value == 1);
+      assertUnit(l.back().value == -2);
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    ***************************************/
+
+   void test_erase_middle()
+   {  // setup
+      List l{ 11, 26, 31 };
+      // exercise
+      List::iterator itReturn = l.erase(++l.begin());
+      // verify
+      assertIndexed(l, 11, 31);
+      assertUnit(*itReturn == 31);
+      assertUnit(l.iFree == 1);
+   }  // teardown
+
+   // the last slot freed is the first reused, before any new one
+   void test_erase_reuseSlot()
+   {  // setup
+      List l{ 11, 26, 31, 45 };
+      l.erase(++l.begin());           // slot 1
+      l.erase(--l.end());             // slot 3
+      // exercise
+      l.push_back(99);
+      l.push_back(98);
+      l.push_back(97);
+      // verify
+      assertIndexed(l, 11, 31, 99, 98, 97);
+      assertUnit(l.slots[3].data() == 99);
+      assertUnit(l.slots[1].data() == 98);
+      assertUnit(l.slots[4].data() == 97);
+      assertUnit(l.iFree == List::NIL);
+   }  // teardown
+
+   // from either end, and nothing from nothing
+   void test_popBack_popFront()
+   {  // setup
+      List l{ 11, 26, 31 };
+      List lEmpty;
+      // exercise
+      l.pop_back();
+      l.pop_front();
+      lEmpty.pop_back();
+      lEmpty.pop_front();
+      // verify
+      assertIndexed(l, 26);
+      assertUnit(lEmpty.empty());
+   }  // teardown
+
+   // the array stays for next time
+   void test_clear_keepsCapacity()
+   {  // setup
+      custom::index_list<std::string> l{ "eleven", "twenty six", "thirty one" };
+      size_t capacity = l.capacity();
+      // exercise
+      l.clear();
+      // verify
+      assertUnit(l.empty());
+      assertUnit(l.capacity() == capacity);
+      assertUnit(l.begin() == l.end());
+      l.push_back("again");
+      assertUnit(l.front() == "again");
+      assertUnit(l.iHead == 0);
+   }  // teardown
+
+   /***************************************
+    * AGAINST STD::LIST
+    ***************************************/
+
+   // thousands of inserts and erases anywhere give what std::list gives
+   void test_random_operations()
+   {  // setup
+      List l;
+      std::list<int> expected;
+      unsigned seed = 54321;
+      auto random = [&seed](size_t max) -> size_t
+      {
+         seed = seed * 1103515245 + 12345;
+         return max ? (seed >> 8) % max : 0;
+      };
+      // exercise
+      for (int i = 0; i < 3000; i++)
+      {
+         size_t pos = random(expected.size() + 1);
+         List::iterator it = l.begin();
+         std::list<int>::iterator itExpected = expected.begin();
+         for (size_t j = 0; j < pos; j++, ++it, ++itExpected)
+            ;
+         if (random(3) != 0 || it == l.end())
+         {
+            l.insert(it, i);
+            expected.insert(itExpected, i);
+         }
+         else
+         {
+            l.erase(it);
+            expected.erase(itExpected);
+         }
+      }
+      // verify
+      assertIndexedParameters(l, std::vector<int>(expected.begin(), expected.end()),
+                              __LINE__, __FUNCTION__);
+      assertUnit(l.numSlots <= 3000);
+   }  // teardown
+
+   /***************************************
+    * ALLOCATIONS
+    ***************************************/
+
+   // with room made ahead of time, nothing more is allocated
+   void test_allocations_reserve()
+   {  // setup
+      List l;
+      l.reserve(1000);
+      trackAllocations();
+      // exercise
+      for (int i = 0; i < 1000; i++)
+         l.push_back(i);
+      // verify
+      assertNoAllocations();
+      assertUnit(l.size() == 1000);
+   }  // teardown
+
+   // erasing and inserting again reuses slots
+   void test_allocations_reuse()
+   {  // setup
+      List l{ 11, 26, 31 };
+      trackAllocations();
+      // exercise
+      for (int i = 0; i < 1000; i++)
+      {
+         l.pop_front();
+         l.push_back(i);
+      }
+      // verify
+      assertNoAllocations();
+      assertUnit(l.size() == 3);
+      assertUnit(l.numSlots == 3);
+   }  // teardown
+
+   /****************************************************************
+    * Verify Indexed
+    * Walk the list both ways, checking every link and every value
+    ****************************************************************/
+   void assertIndexedParameters(const List & l, const std::vector<int> & values,
+                                int line, const char * function)
+   {
+      assertIndirect(l.numElements == values.size());
+      assertIndirect(values.empty() == (l.iHead == List::NIL));
+      assertIndirect(values.empty() == (l.iTail == List::NIL));
+
+      std::uint32_t iPrev = List::NIL;
+      std::uint32_t i = l.iHead;
+      for (size_t n = 0; n < values.size() && i != List::NIL; n++)
+      {
+         assertIndirect(i < l.numSlots);
+         if (i >= l.numSlots)
+            return;
+         assertIndirect(l.slots[i].data() == values[n]);
+         assertIndirect(l.slots[i].iPrev == iPrev);
+         iPrev = i;
+         i = l.slots[i].iNext;
+      }
+      assertIndirect(i == List::NIL);
+      assertIndirect(l.iTail == iPrev);
+   }
+};
+
+#endif // DEBUG
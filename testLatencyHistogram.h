@@ -0,0 +1,309 @@
+/***********************************************************************
+ * Header:
+ *    TEST LATENCY HISTOGRAM
+ * Summary:
+ *    Unit tests for the latency histogram and the latency policy
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "latencyHistogram.h"
+#include "list.h"
+#include "hash.h"
+#include "unitTest.h"
+
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+class TestLatencyHistogram : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Index
+      runUnit(test_index_exact);
+      runUnit(test_index_powersOfTwo);
+      runUnit(test_index_tooBig);
+
+      // Record
+      runUnit(test_record_empty);
+      runUnit(test_record_one);
+      runUnit(test_record_uniform);
+      runUnit(test_record_spike);
+      runUnit(test_record_threads);
+
+      // Merge
+      runUnit(test_merge_standard);
+      runUnit(test_merge_empty);
+
+      // Export
+      runUnit(test_toText);
+      runUnit(test_toJson);
+
+      // Policy
+      runUnit(test_policy_scope);
+#ifdef CUSTOM_INSTRUMENTATION
+      runUnit(test_policy_containers);
+#endif // CUSTOM_INSTRUMENTATION
+
+      report("LatencyHistogram");
+   }
+
+   /***************************************
+    * INDEX
+    ***************************************/
+
+   // below 128 every value has its own counter
+   void test_index_exact()
+   {  // exercise and verify
+      for (std::uint64_t ns = 0; ns < 128; ns++)
+      {
+         assertUnit(custom::latency_histogram::index(ns) == ns);
+         assertUnit(custom::latency_histogram::highest(ns) == ns);
+      }
+   }
+
+   // every value lands in a counter whose range holds it, within 1.6%
+   void test_index_powersOfTwo()
+   {  // exercise and verify
+      for (int log = 7; log < 40; log++)
+         for (std::uint64_t ns : { std::uint64_t(1) << log,
+                                   (std::uint64_t(3) << log) / 2,
+                                   (std::uint64_t(2) << log) - 1 })
+         {
+            size_t i = custom::latency_histogram::index(ns);
+            assertUnit(i < custom::latency_histogram::NUM_COUNTS);
+            assertUnit(custom::latency_histogram::highest(i) >= ns);
+            assertUnit(custom::latency_histogram::highest(i) - ns <= ns / 64);
+            assertUnit(custom::latency_histogram::highest(i - 1) < ns);
+         }
+   }
+
+   // eighteen minutes or more all go in the last counter
+   void test_index_tooBig()
+   {  // exercise and verify
+      assertUnit(custom::latency_histogram::index(std::uint64_t(1) << 40) ==
+                 custom::latency_histogram::NUM_COUNTS - 1);
+      assertUnit(custom::latency_histogram::index(~std::uint64_t(0)) ==
+                 custom::latency_histogram::NUM_COUNTS - 1);
+   }
+
+   /***************************************
+    * RECORD
+    ***************************************/
+
+   // nothing recorded means zeros everywhere
+   void test_record_empty()
+   {  // exercise
+      custom::latency_histogram h;
+      // verify
+      assertUnit(h.count() == 0);
+      assertUnit(h.max() == 0);
+      assertUnit(h.min() == 0);
+      assertUnit(h.mean() == 0.0);
+      assertUnit(h.percentile(0.5) == 0);
+   }  // teardown
+
+   // one value is every percentile
+   void test_record_one()
+   {  // setup
+      custom::latency_histogram h;
+      // exercise
+      h.record(1000);
+      // verify
+      assertUnit(h.count() == 1);
+      assertUnit(h.max() == 1000);
+      assertUnit(h.min() == 1000);
+      assertUnit(h.mean() == 1000.0);
+      assertUnit(h.percentile(0.0) == 1000);
+      assertUnit(h.percentile(0.5) == 1000);
+      assertUnit(h.percentile(1.0) == 1000);
+   }  // teardown
+
+   // 1..100 exactly, since they all have their own counter
+   void test_record_uniform()
+   {  // setup
+      custom::latency_histogram h;
+      // exercise
+      for (std::uint64_t ns = 1; ns <= 100; ns++)
+         h.record(ns);
+      // verify
+      assertUnit(h.count() == 100);
+      assertUnit(h.min() == 1);
+      assertUnit(h.max() == 100);
+      assertUnit(h.mean() == 50.5);
+      assertUnit(h.percentile(0.50) == 50);
+      assertUnit(h.percentile(0.99) == 99);
+      assertUnit(h.percentile(1.00) == 100);
+   }  // teardown
+
+   // one slow call in a thousand shows up at p99.9 but not p99
+   void test_record_spike()
+   {  // setup
+      custom::latency_histogram h;
+      // exercise
+      for (int i = 0; i < 998; i++)
+         h.record(100);
+      h.record(5000000);
+      h.record(5000000);
+      // verify
+      assertUnit(h.percentile(0.50) == 100);
+      assertUnit(h.percentile(0.99) == 100);
+      assertUnit(h.percentile(0.999) >= 5000000);
+      assertUnit(h.percentile(0.999) <= 5000000 + 5000000 / 64);
+      assertUnit(h.max() == 5000000);
+   }  // teardown
+
+   // many threads recording into one histogram lose nothing
+   void test_record_threads()
+   {  // setup
+      custom::latency_histogram h;
+      std::vector<std::thread> threads;
+      // exercise
+      for (int t = 0; t < 4; t++)
+         threads.push_back(std::thread([&h, t]()
+         {
+            for (int i = 0; i < 10000; i++)
+               h.record(t * 1000 + i % 7);
+         }));
+      for (auto & thread : threads)
+         thread.join();
+      // verify
+      assertUnit(h.count() == 40000);
+      assertUnit(h.min() == 0);
+      assertUnit(h.max() == 3006);
+   }  // teardown
+
+   /***************************************
+    * MERGE
+    ***************************************/
+
+   // two threads' histograms become one
+   void test_merge_standard()
+   {  // setup
+      custom::latency_histogram h1;
+      custom::latency_histogram h2;
+      h1.record(10);
+      h1.record(20);
+      h2.record(5);
+      h2.record(40000);
+      // exercise
+      h1.merge(h2);
+      // verify
+      assertUnit(h1.count() == 4);
+      assertUnit(h1.min() == 5);
+      assertUnit(h1.max() == 40000);
+      assertUnit(h1.percentile(0.5) == 10);
+      assertUnit(h2.count() == 2);
+   }  // teardown
+
+   // merging nothing changes nothing
+   void test_merge_empty()
+   {  // setup
+      custom::latency_histogram h1;
+      custom::latency_histogram h2;
+      h1.record(10);
+      // exercise
+      h1.merge(h2);
+      // verify
+      assertUnit(h1.count() == 1);
+      assertUnit(h1.min() == 10);
+      assertUnit(h1.max() == 10);
+   }  // teardown
+
+   /***************************************
+    * EXPORT
+    ***************************************/
+
+   // one line with the name first
+   void test_toText()
+   {  // setup
+      custom::latency_histogram h;
+      h.record(10);
+      std::string text;
+      // exercise
+      text = h.to_text("find");
+      // verify
+      assertUnit(text == "find count:1 mean:10.0 p50:10 p99:10 p99.9:10 max:10 ns");
+   }  // teardown
+
+   // one object
+   void test_toJson()
+   {  // setup
+      custom::latency_histogram h;
+      h.record(10);
+      std::string json;
+      // exercise
+      json = h.to_json();
+      // verify
+      assertUnit(json == "{\"count\":1,\"mean\":10,\"min\":10,\"p50\":10,\"p90\":10,"
+                         "\"p99\":10,\"p999\":10,\"max\":10}");
+   }  // teardown
+
+   /***************************************
+    * POLICY
+    ***************************************/
+
+   // a scope records once, when it ends, into its own histogram
+   void test_policy_scope()
+   {  // setup
+      custom::latency_histogram & h =
+         custom::latency_policy::histogram(custom::INSTRUMENT_LIST, custom::INSTRUMENT_FIND);
+      h.reset();
+      // exercise
+      {
+         custom::latency_policy::scope scope(custom::INSTRUMENT_LIST, custom::INSTRUMENT_FIND);
+         assertUnit(h.count() == 0);
+      }
+      // verify
+      assertUnit(h.count() == 1);
+      assertUnit(custom::latency_policy::to_json().find("\"list\":{\"insert\"") != std::string::npos);
+      // teardown
+      h.reset();
+   }
+
+#ifdef CUSTOM_INSTRUMENTATION
+   // the containers time their own inserts, finds, erases and clears
+   void test_policy_containers()
+   {  // setup
+      custom::latency_policy::reset();
+      custom::list<int> l;
+      custom::unordered_set<int> us;
+      // exercise
+      l.push_back(1);
+      l.erase(l.begin());
+      us.insert(1);
+      us.find(1);
+      us.find(2);
+      us.erase(1);
+      us.clear();
+      {
+         custom::thread_pool pool(2);
+         us.clear_async(pool);
+      }
+      // verify
+      assertUnit(custom::latency_policy::histogram(custom::INSTRUMENT_UNORDERED_SET,
+                                                   custom::INSTRUMENT_INSERT).count() == 1);
+      assertUnit(custom::latency_policy::histogram(custom::INSTRUMENT_UNORDERED_SET,
+                                                   custom::INSTRUMENT_FIND).count() == 2);
+      assertUnit(custom::latency_policy::histogram(custom::INSTRUMENT_UNORDERED_SET,
+                                                   custom::INSTRUMENT_ERASE).count() == 1);
+      assertUnit(custom::latency_policy::histogram(custom::INSTRUMENT_UNORDERED_SET,
+                                                   custom::INSTRUMENT_CLEAR).count() == 2);
+      assertUnit(custom::latency_policy::histogram(custom::INSTRUMENT_LIST,
+                                                   custom::INSTRUMENT_INSERT).count() == 2);
+      assertUnit(custom::latency_policy::histogram(custom::INSTRUMENT_LIST,
+                                                   custom::INSTRUMENT_ERASE).count() == 2);
+      // teardown
+      custom::latency_policy::reset();
+   }
+#endif // CUSTOM_INSTRUMENTATION
+};
+
+#endif // DEBUG
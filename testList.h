@@ -14,11 +14,22 @@
 #include "list.h"
 #include <list>
 #include "unitTest.h"
+#include "spy.h"
 
+#include <string>
 #include <vector>
+#include <algorithm>
+#include <functional>
+#include <utility>
 #include <cassert>
 #include <memory>
 #include <iostream>
+#include <iterator>
+#include <sstream>
+#include <thread>
+
+// the elements of the list, front to back
+#define assertOrder(l, ...)       assertOrderParameters(l, { __VA_ARGS__ }, __LINE__, __FUNCTION__)
 
 class TestList : public UnitTest
 {
@@ -28,82 +39,142 @@ public:
       reset();
 
       // Construct
-      test_construct_default();
-      test_construct_sizeZero();
-      test_construct_sizeThree();
-      test_construct_sizeThreeFill();
-      test_constructCopy_empty();
-      test_constructCopy_standard();
-      test_constructMove_empty();
-      test_constructMove_standard();
-      test_constructInit_empty();
-      test_constructInit_standard();
-      test_constructRange_empty();
-      test_constructRange_standard();
-      test_destructor_empty();
-      test_destructor_standard();
+      runUnit(test_construct_default);
+      runUnit(test_construct_sizeZero);
+      runUnit(test_construct_sizeThree);
+      runUnit(test_construct_sizeThreeFill);
+      runUnit(test_constructCopy_empty);
+      runUnit(test_constructCopy_standard);
+      runUnit(test_constructMove_empty);
+      runUnit(test_constructMove_standard);
+      runUnit(test_constructInit_empty);
+      runUnit(test_constructInit_standard);
+      runUnit(test_constructRange_empty);
+      runUnit(test_constructRange_standard);
+      runUnit(test_destructor_empty);
+      runUnit(test_destructor_standard);
 
       // Assign
-      test_assign_emptyToEmpty();
-      test_assign_standardToEmpty();
-      test_assign_emptyToStandard();
-      test_assign_smallToBig();
-      test_assign_bigToSmall();
-      test_assignInit_empty();
-      test_assignInit_sameSize();
-      test_assignInit_rightBigger();
-      test_assignInit_leftBigger();
+      runUnit(test_assign_emptyToEmpty);
+      runUnit(test_assign_standardToEmpty);
+      runUnit(test_assign_emptyToStandard);
+      runUnit(test_assign_smallToBig);
+      runUnit(test_assign_bigToSmall);
+      runUnit(test_assignInit_empty);
+      runUnit(test_assignInit_sameSize);
+      runUnit(test_assignInit_rightBigger);
+      runUnit(test_assignInit_leftBigger);
 
       // Iterator
-      test_iterator_begin_empty();
-      test_iterator_begin_standard();
-      test_iterator_end_standard();
-      test_iterator_increment_standardMiddle();
-      test_iterator_dereference_read();
-      test_iterator_dereference_update();
+      runUnit(test_iterator_begin_empty);
+      runUnit(test_iterator_begin_standard);
+      runUnit(test_iterator_end_standard);
+      runUnit(test_iterator_increment_standardMiddle);
+      runUnit(test_iterator_dereference_read);
+      runUnit(test_iterator_dereference_update);
 
       // Access
-      test_front_empty();
-      test_front_standardRead();
-      test_front_standardWrite();
-      test_back_empty();
-      test_back_standardRead();
-      test_back_standardWrite();
+      runUnit(test_front_empty);
+      runUnit(test_front_standardRead);
+      runUnit(test_front_standardWrite);
+      runUnit(test_back_empty);
+      runUnit(test_back_standardRead);
+      runUnit(test_back_standardWrite);
 
       // Insert
-      test_pushback_empty();
-      test_pushback_standard();
-      test_pushback_moveEmpty();
-      test_pushback_moveStandard();
-      test_pushfront_empty();
-      test_pushfront_standard();
-      test_pushfront_moveEmpty();
-      test_pushfront_moveStandard();
-      test_insert_empty();
-      test_insert_standardFront();
-      test_insert_standardMiddle();
-      test_insert_standardEnd();
-      test_insertMove_empty();
-      test_insertMove_standardFront();
-      test_insertMove_standardMiddle();
+      runUnit(test_pushback_empty);
+      runUnit(test_pushback_standard);
+      runUnit(test_pushback_moveEmpty);
+      runUnit(test_pushback_moveStandard);
+      runUnit(test_pushfront_empty);
+      runUnit(test_pushfront_standard);
+      runUnit(test_pushfront_moveEmpty);
+      runUnit(test_pushfront_moveStandard);
+      runUnit(test_insert_empty);
+      runUnit(test_insert_standardFront);
+      runUnit(test_insert_standardMiddle);
+      runUnit(test_insert_standardEnd);
+      runUnit(test_insertMove_empty);
+      runUnit(test_insertMove_standardFront);
+      runUnit(test_insertMove_standardMiddle);
+      runUnit(test_emplace_empty);
+      runUnit(test_emplace_standardFront);
+      runUnit(test_emplace_standardMiddle);
+      runUnit(test_emplace_standardEnd);
+      runUnit(test_emplace_arguments);
+      runUnit(test_emplaceBack_spy);
+      runUnit(test_emplaceFront_spy);
+      runUnit(test_insertRange_empty);
+      runUnit(test_insertRange_one);
+      runUnit(test_insertRange_standardMiddle);
+      runUnit(test_insertRange_fromList);
+      runUnit(test_insertRange_input);
+      runUnit(test_insertRange_throw);
+      runUnit(test_assign_range);
+      runUnit(test_assign_rangeSelf);
+      runUnit(test_assign_rangeThrow);
+      runUnit(test_append_standard);
 
       // Remove
-      test_clear_empty();
-      test_clear_standard();
-      test_popback_empty();
-      test_popback_standard();
-      test_popfront_empty();
-      test_popfront_standard();
-      test_erase_empty();
-      test_erase_standardFront();
-      test_erase_standardMiddle();
-      test_erase_standardEnd();
+      runUnit(test_clear_empty);
+      runUnit(test_clear_standard);
+      runUnit(test_popback_empty);
+      runUnit(test_popback_standard);
+      runUnit(test_popfront_empty);
+      runUnit(test_popfront_standard);
+      runUnit(test_erase_empty);
+      runUnit(test_erase_standardFront);
+      runUnit(test_erase_standardMiddle);
+      runUnit(test_erase_standardEnd);
+
+      // Operations
+      runUnit(test_splice_allToEmpty);
+      runUnit(test_splice_allMiddle);
+      runUnit(test_splice_allSelf);
+      runUnit(test_splice_oneOtherList);
+      runUnit(test_splice_oneSameList);
+      runUnit(test_splice_oneInPlace);
+      runUnit(test_splice_rangeOtherList);
+      runUnit(test_splice_rangeSameList);
+      runUnit(test_merge_standard);
+      runUnit(test_merge_empty);
+      runUnit(test_merge_compare);
+      runUnit(test_sort_empty);
+      runUnit(test_sort_reverse);
+      runUnit(test_sort_many);
+      runUnit(test_sort_stable);
+      runUnit(test_sort_spy);
+
+      // Locality
+      runUnit(test_compact_empty);
+      runUnit(test_compact_noTable);
+      runUnit(test_compact_standard);
+      runUnit(test_compact_spy);
+      runUnit(test_compact_twice);
+      runUnit(test_compact_churn);
+      runUnit(test_compact_spliceOut);
+      runUnit(test_compact_mergeIn);
+      runUnit(test_compact_swap);
+      runUnit(test_compact_threads);
 
       // Status
-      test_size_empty();
-      test_size_three();
-      test_empty_empty();
-      test_empty_three();
+      runUnit(test_size_empty);
+      runUnit(test_size_three);
+      runUnit(test_empty_empty);
+      runUnit(test_empty_three);
+
+      // Allocations
+      runUnit(test_allocations_copy);
+      runUnit(test_allocations_moveConstruct);
+      runUnit(test_allocations_moveAssign);
+      runUnit(test_allocations_swap);
+      runUnit(test_allocations_iterate);
+      runUnit(test_allocations_splice);
+      runUnit(test_allocations_merge);
+      runUnit(test_allocations_sort);
+      runUnit(test_allocations_compact);
+      runUnit(test_allocations_compactShared);
+      runUnit(test_allocations_insertRange);
 
       report("List");
    }
@@ -1577,6 +1648,172 @@ public:
       teardownStandardFixture(l);
    }
 
+   /***************************************
+    * EMPLACE
+    ***************************************/
+
+   // emplace into an empty list
+   void test_emplace_empty()
+   {  // setup
+      custom::list<int> l;
+      custom::list<int>::iterator itReturn;
+      // exercise
+      itReturn = l.emplace(l.end(), 99);
+      // verify
+      //       +----+
+      //       | 99 |
+      //       +----+
+      //      itReturn
+      assertUnit(l.numElements == 1);
+      assertUnit(l.pHead != nullptr);
+      assertUnit(l.pHead == l.pTail);
+      assertUnit(itReturn.p == l.pHead);
+      if (l.pHead)
+      {
+         assertUnit(l.pHead->data == int(99));
+         assertUnit(l.pHead->pNext == nullptr);
+         assertUnit(l.pHead->pPrev == nullptr);
+      }
+      // teardown
+      teardownStandardFixture(l);
+   }
+
+   // emplace in front of the first element
+   void test_emplace_standardFront()
+   {  // setup
+      //       +----+   +----+   +----+
+      //       | 11 | - | 26 | - | 31 |
+      //       +----+   +----+   +----+
+      //         it
+      custom::list<int> l;
+      setupStandardFixture(l);
+      custom::list<int>::iterator itReturn;
+      // exercise
+      itReturn = l.emplace(l.begin(), 99);
+      // verify
+      //       +----+   +----+   +----+   +----+
+      //       | 99 | - | 11 | - | 26 | - | 31 |
+      //       +----+   +----+   +----+   +----+
+      //      itReturn
+      assertUnit(l.numElements == 4);
+      assertUnit(itReturn.p == l.pHead);
+      assertOrder(l, 99, 11, 26, 31);
+      // teardown
+      teardownStandardFixture(l);
+   }
+
+   // emplace in front of the middle element
+   void test_emplace_standardMiddle()
+   {  // setup
+      //       +----+   +----+   +----+
+      //       | 11 | - | 26 | - | 31 |
+      //       +----+   +----+   +----+
+      //                  it
+      custom::list<int> l;
+      setupStandardFixture(l);
+      custom::list<int>::iterator it;
+      custom::list<int>::iterator itReturn;
+      it.p = l.pHead->pNext;
+      // exercise
+      itReturn = l.emplace(it, 99);
+      // verify
+      //       +----+   +----+   +----+   +----+
+      //       | 11 | - | 99 | - | 26 | - | 31 |
+      //       +----+   +----+   +----+   +----+
+      //               itReturn    it
+      assertUnit(l.numElements == 4);
+      assertUnit(itReturn.p == l.pHead->pNext);
+      assertUnit(it.p == itReturn.p->pNext);
+      assertOrder(l, 11, 99, 26, 31);
+      // teardown
+      teardownStandardFixture(l);
+   }
+
+   // emplace at the end
+   void test_emplace_standardEnd()
+   {  // setup
+      //       +----+   +----+   +----+
+      //       | 11 | - | 26 | - | 31 |
+      //       +----+   +----+   +----+
+      //                                  it
+      custom::list<int> l;
+      setupStandardFixture(l);
+      custom::list<int>::iterator itReturn;
+      // exercise
+      itReturn = l.emplace(l.end(), 99);
+      // verify
+      //       +----+   +----+   +----+   +----+
+      //       | 11 | - | 26 | - | 31 | - | 99 |
+      //       +----+   +----+   +----+   +----+
+      //                                 itReturn
+      assertUnit(l.numElements == 4);
+      assertUnit(itReturn.p == l.pTail);
+      assertOrder(l, 11, 26, 31, 99);
+      // teardown
+      teardownStandardFixture(l);
+   }
+
+   // any of the element's constructors may be used, not just copy and move
+   void test_emplace_arguments()
+   {  // setup
+      custom::list<std::string> l;
+      // exercise
+      l.emplace_back(3, 'x');
+      l.emplace_front("abc", 2);
+      l.emplace(++l.begin());
+      // verify
+      assertUnit(l.size() == 3);
+      if (l.size() == 3)
+      {
+         assertUnit(l.front() == std::string("ab"));
+         assertUnit(*(++l.begin()) == std::string(""));
+         assertUnit(l.back() == std::string("xxx"));
+      }
+   }  // teardown
+
+   // the Spy is built in the node: nothing to move and nothing to destroy
+   void test_emplaceBack_spy()
+   {  // setup
+      custom::list<Spy> l;
+      l.emplace_back(11);
+      Spy::reset();
+      // exercise
+      l.emplace_back(26);
+      // verify
+      assertUnit(Spy::numNondefault() == 1);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(l.size() == 2);
+      assertUnit(l.back().get() == 26);
+      // unlike push_back, which moves a temporary in and then destroys it
+      Spy::reset();
+      l.push_back(Spy(31));
+      assertUnit(Spy::numNondefault() == 1);
+      assertUnit(Spy::numCopyMove() == 1);
+      assertUnit(Spy::numDestructor() == 1);
+   }  // teardown
+
+   // same at the front
+   void test_emplaceFront_spy()
+   {  // setup
+      custom::list<Spy> l;
+      l.emplace_back(26);
+      Spy::reset();
+      // exercise
+      l.emplace_front(11);
+      // verify
+      assertUnit(Spy::numNondefault() == 1);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(l.size() == 2);
+      assertUnit(l.front().get() == 11);
+      assertUnit(l.back().get() == 26);
+   }  // teardown
+
 
    /***************************************
     * ERASE
@@ -1887,6 +2124,850 @@ public:
       teardownStandardFixture(l);
    }
 
+   /***************************************
+    * SPLICE
+    ***************************************/
+
+   // all of the standard fixture into an empty list
+   void test_splice_allToEmpty()
+   {  // setup
+      custom::list<int> l;
+      custom::list<int> lSrc;
+      setupStandardFixture(lSrc);
+      // exercise
+      l.splice(l.end(), lSrc);
+      // verify
+      assertStandardFixture(l);
+      assertEmptyFixture(lSrc);
+      // teardown
+      teardownStandardFixture(l);
+   }
+
+   // all of one list between 11 and 26
+   void test_splice_allMiddle()
+   {  // setup
+      //       +----+   +----+   +----+
+      //       | 11 | - | 26 | - | 31 |
+      //       +----+   +----+   +----+
+      //                  pos
+      custom::list<int> l;
+      setupStandardFixture(l);
+      custom::list<int> lSrc{ 1, 2 };
+      custom::list<int>::Node* p1 = lSrc.pHead;
+      custom::list<int>::iterator pos(l.pHead->pNext);
+      // exercise
+      l.splice(pos, lSrc);
+      // verify
+      //       +----+   +----+   +----+   +----+   +----+
+      //       | 11 | - |  1 | - |  2 | - | 26 | - | 31 |
+      //       +----+   +----+   +----+   +----+   +----+
+      assertOrder(l, 11, 1, 2, 26, 31);
+      assertUnit(l.pHead->pNext == p1);
+      assertEmptyFixture(lSrc);
+   }  // teardown
+
+   // a list into itself is nothing
+   void test_splice_allSelf()
+   {  // setup
+      custom::list<int> l;
+      setupStandardFixture(l);
+      // exercise
+      l.splice(l.begin(), l);
+      // verify
+      assertStandardFixture(l);
+      // teardown
+      teardownStandardFixture(l);
+   }
+
+   // the 26 from another list onto the front
+   void test_splice_oneOtherList()
+   {  // setup
+      custom::list<int> l{ 11, 31 };
+      custom::list<int> lSrc{ 1, 26, 2 };
+      custom::list<int>::iterator it(lSrc.pHead->pNext);
+      // exercise
+      l.splice(l.begin(), lSrc, it);
+      // verify
+      assertOrder(l, 26, 11, 31);
+      assertOrder(lSrc, 1, 2);
+      assertUnit(it.p == l.pHead);
+   }  // teardown
+
+   // the 31 from the back of the list to the front
+   void test_splice_oneSameList()
+   {  // setup
+      custom::list<int> l;
+      setupStandardFixture(l);
+      custom::list<int>::iterator it(l.pTail);
+      // exercise
+      l.splice(l.begin(), l, it);
+      // verify
+      assertOrder(l, 31, 11, 26);
+      assertUnit(*it == 31);
+   }  // teardown
+
+   // in front of itself, or of the one after it, means no change
+   void test_splice_oneInPlace()
+   {  // setup
+      custom::list<int> l;
+      setupStandardFixture(l);
+      custom::list<int>::iterator it(l.pHead->pNext);
+      custom::list<int>::iterator itNext(l.pTail);
+      // exercise
+      l.splice(it, l, it);
+      l.splice(itNext, l, it);
+      // verify
+      assertStandardFixture(l);
+      // teardown
+      teardownStandardFixture(l);
+   }
+
+   // the 2 and 3 of another list onto the end
+   void test_splice_rangeOtherList()
+   {  // setup
+      custom::list<int> l;
+      setupStandardFixture(l);
+      custom::list<int> lSrc{ 1, 2, 3, 4 };
+      custom::list<int>::iterator first(lSrc.pHead->pNext);
+      custom::list<int>::iterator last(lSrc.pTail);
+      // exercise
+      l.splice(l.end(), lSrc, first, last);
+      // verify
+      assertOrder(l, 11, 26, 31, 2, 3);
+      assertOrder(lSrc, 1, 4);
+   }  // teardown
+
+   // rotate: everything from 26 on to the front
+   void test_splice_rangeSameList()
+   {  // setup
+      custom::list<int> l;
+      setupStandardFixture(l);
+      custom::list<int>::iterator first(l.pHead->pNext);
+      // exercise
+      l.splice(l.begin(), l, first, l.end());
+      // verify
+      assertOrder(l, 26, 31, 11);
+   }  // teardown
+
+   /***************************************
+    * MERGE
+    ***************************************/
+
+   // the two 26s keep their order: ours first
+   void test_merge_standard()
+   {  // setup
+      custom::list<int> l;
+      setupStandardFixture(l);
+      custom::list<int>::Node* p26 = l.pHead->pNext;
+      custom::list<int> lSrc{ 5, 26, 40 };
+      // exercise
+      l.merge(lSrc);
+      // verify
+      assertOrder(l, 5, 11, 26, 26, 31, 40);
+      assertUnit(l.pHead->pNext->pNext == p26);
+      assertEmptyFixture(lSrc);
+   }  // teardown
+
+   // merging nothing, or into nothing
+   void test_merge_empty()
+   {  // setup
+      custom::list<int> l;
+      custom::list<int> lEmpty;
+      custom::list<int> lSrc;
+      setupStandardFixture(lSrc);
+      // exercise
+      lSrc.merge(lEmpty);
+      l.merge(lSrc);
+      // verify
+      assertStandardFixture(l);
+      assertEmptyFixture(lSrc);
+      assertEmptyFixture(lEmpty);
+      // teardown
+      teardownStandardFixture(l);
+   }
+
+   // two lists sorted largest first
+   void test_merge_compare()
+   {  // setup
+      custom::list<int> l{ 31, 26, 11 };
+      custom::list<int> lSrc{ 40, 20, 1 };
+      // exercise
+      l.merge(lSrc, std::greater<int>());
+      // verify
+      assertOrder(l, 40, 31, 26, 20, 11, 1);
+      assertEmptyFixture(lSrc);
+   }  // teardown
+
+   /***************************************
+    * SORT
+    ***************************************/
+
+   // nothing and one thing are already sorted
+   void test_sort_empty()
+   {  // setup
+      custom::list<int> l;
+      custom::list<int> lOne{ 99 };
+      // exercise
+      l.sort();
+      lOne.sort();
+      // verify
+      assertEmptyFixture(l);
+      assertOrder(lOne, 99);
+   }  // teardown
+
+   // backwards to forwards
+   void test_sort_reverse()
+   {  // setup
+      custom::list<int> l{ 31, 26, 11 };
+      // exercise
+      l.sort();
+      // verify
+      assertStandardFixture(l);
+   }  // teardown
+
+   // a thousand scrambled numbers, with repeats, come out like std::sort
+   void test_sort_many()
+   {  // setup
+      std::vector<int> v;
+      for (int i = 0; i < 1000; i++)
+         v.push_back((i * 7919) % 613);
+      custom::list<int> l(v.begin(), v.end());
+      std::sort(v.begin(), v.end());
+      // exercise
+      l.sort();
+      // verify
+      assertOrderParameters(l, v, __LINE__, __FUNCTION__);
+   }  // teardown
+
+   // equal keys stay in the order they were in
+   void test_sort_stable()
+   {  // setup
+      custom::list<std::pair<int, int>> l;
+      for (int i = 0; i < 100; i++)
+         l.push_back(std::make_pair(i % 3, i));
+      // exercise
+      l.sort([](const std::pair<int, int> & lhs, const std::pair<int, int> & rhs)
+             {
+                return lhs.first < rhs.first;
+             });
+      // verify
+      std::pair<int, int> prev(-1, -1);
+      bool stable = true;
+      for (auto it = l.begin(); it != l.end(); ++it)
+      {
+         if ((*it).first < prev.first ||
+             ((*it).first == prev.first && (*it).second < prev.second))
+            stable = false;
+         prev = *it;
+      }
+      assertUnit(stable);
+      assertUnit(l.size() == 100);
+   }  // teardown
+
+   // the elements are compared, never copied, moved, swapped or destroyed
+   void test_sort_spy()
+   {  // setup
+      custom::list<Spy> l;
+      for (int i = 0; i < 100; i++)
+         l.emplace_back((i * 37) % 100);
+      Spy::reset();
+      // exercise
+      l.sort();
+      // verify
+      assertUnit(Spy::numLessthan() > 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      assertUnit(Spy::numSwap() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      int expected = 0;
+      bool sorted = true;
+      for (auto it = l.begin(); it != l.end(); ++it)
+         if ((*it).get() != expected++)
+            sorted = false;
+      assertUnit(sorted);
+      assertUnit(l.rbegin() == custom::list<Spy>::iterator(l.pTail));
+   }  // teardown
+
+   /***************************************
+    * INSERT RANGE
+    ***************************************/
+
+   // builds from any int but a negative one
+   struct Positive
+   {
+      Positive(int value) : value(value)
+      {
+         if (value < 0)
+            throw "ERROR: not positive";
+      }
+      int value;
+   };
+
+   // nothing to insert, nothing allocated
+   void test_insertRange_empty()
+   {  // setup
+      custom::list<int> l{ 11, 26, 31 };
+      std::vector<int> v;
+      trackAllocations();
+      // exercise
+      custom::list<int>::iterator itReturn = l.insert(++l.begin(), v.begin(), v.end());
+      // verify
+      assertNoAllocations();
+      assertUnit(itReturn == ++l.begin());
+      assertOrder(l, 11, 26, 31);
+   }  // teardown
+
+   // a single node needs no block
+   void test_insertRange_one()
+   {  // setup
+      custom::list<int> l{ 11, 26, 31 };
+      std::vector<int> v{ 99 };
+      // exercise
+      custom::list<int>::iterator itReturn = l.insert(l.end(), v.begin(), v.end());
+      // verify
+      assertOrder(l, 11, 26, 31, 99);
+      assertUnit(itReturn.p == l.pTail);
+      assertUnit(l.pBlocks == nullptr);
+   }  // teardown
+
+   // in front of the 26, side by side in one block
+   //      +----+   +----+   +----+   +----+   +----+   +----+
+   //      | 11 | - | 97 | - | 98 | - | 99 | - | 26 | - | 31 |
+   //      +----+   +----+   +----+   +----+   +----+   +----+
+   //              itReturn
+   void test_insertRange_standardMiddle()
+   {  // setup
+      custom::list<int> l{ 11, 26, 31 };
+      std::vector<int> v{ 97, 98, 99 };
+      // exercise
+      custom::list<int>::iterator itReturn = l.insert(++l.begin(), v.begin(), v.end());
+      // verify
+      assertOrder(l, 11, 97, 98, 99, 26, 31);
+      assertUnit(itReturn.p == l.pHead->pNext);
+      assertUnit(itReturn.p->pNext == itReturn.p + 1);
+      assertUnit(itReturn.p->pNext->pNext == itReturn.p + 2);
+      assertUnit(l.numBlocks() == 1 && (*l.pBlocks)[0]->pBegin == itReturn.p);
+   }  // teardown
+
+   // our own iterators count as forward iterators too
+   void test_insertRange_fromList()
+   {  // setup
+      custom::list<int> l{ 11, 31 };
+      custom::list<int> lSrc{ 20, 26 };
+      // exercise
+      l.insert(l.rbegin(), lSrc.begin(), lSrc.end());
+      // verify
+      assertOrder(l, 11, 20, 26, 31);
+      assertOrder(lSrc, 20, 26);
+      assertUnit(l.numBlocks() == 1);
+   }  // teardown
+
+   // a stream can only be read once, so the nodes come one at a time
+   void test_insertRange_input()
+   {  // setup
+      custom::list<int> l{ 11, 31 };
+      std::istringstream in("20 26");
+      // exercise
+      custom::list<int>::iterator itReturn = l.insert(l.rbegin(),
+         std::istream_iterator<int>(in), std::istream_iterator<int>());
+      // verify
+      assertOrder(l, 11, 20, 26, 31);
+      assertUnit(*itReturn == 20);
+      assertUnit(l.pBlocks == nullptr);
+   }  // teardown
+
+   // when one element will not build, none go in
+   void test_insertRange_throw()
+   {  // setup
+      custom::list<Positive> l{ 11, 26 };
+      std::vector<int> v{ 97, 98, -1, 99 };
+      long long bytesLive = AllocationCounters::current().bytesLive;
+      bool thrown = false;
+      // exercise
+      try
+      {
+         l.insert(++l.begin(), v.begin(), v.end());
+      }
+      catch (const char *)
+      {
+         thrown = true;
+      }
+      // verify
+#ifdef UNIT_TEST_ALLOCATIONS
+      // all that is left is the table with room for the block that never was
+      assertUnit(AllocationCounters::current().bytesLive ==
+                 bytesLive + (long long)(sizeof(*l.pBlocks) +
+                                         l.pBlocks->capacity() * sizeof(void *)));
+#endif // UNIT_TEST_ALLOCATIONS
+      assertUnit(thrown);
+      assertUnit(l.size() == 2);
+      assertUnit(l.front().value == 11);
+      assertUnit(l.back().value == 26);
+      assertUnit(l.numBlocks() == 0);
+   }  // teardown
+
+   // the old elements go and the new ones share a block
+   void test_assign_range()
+   {  // setup
+      custom::list<int> l{ 11, 26, 31 };
+      std::vector<int> v{ 97, 98, 99, 100 };
+      // exercise
+      l.assign(v.begin(), v.end());
+      // verify
+      assertOrder(l, 97, 98, 99, 100);
+      assertUnit(l.numBlocks() == 1);
+   }  // teardown
+
+   // the range may be part of the list being replaced
+   void test_assign_rangeSelf()
+   {  // setup
+      custom::list<int> l{ 11, 26, 31, 45 };
+      // exercise
+      l.assign(++l.begin(), l.rbegin());
+      // verify
+      assertOrder(l, 26, 31);
+   }  // teardown
+
+   // a failed assign leaves the list alone
+   void test_assign_rangeThrow()
+   {  // setup
+      custom::list<Positive> l{ 11, 26 };
+      std::vector<int> v{ 97, -1 };
+      // exercise
+      try
+      {
+         l.assign(v.begin(), v.end());
+      }
+      catch (const char *)
+      {
+      }
+      // verify
+      assertUnit(l.size() == 2);
+      assertUnit(l.front().value == 11);
+      assertUnit(l.back().value == 26);
+   }  // teardown
+
+   // appending a list takes its nodes as they are
+   void test_append_standard()
+   {  // setup
+      custom::list<int> l{ 11, 26 };
+      custom::list<int> lSrc{ 31, 45 };
+      custom::list<int>::Node * pNode = lSrc.pHead;
+      trackAllocations();
+      // exercise
+      l.append(std::move(lSrc));
+      // verify
+      assertNoAllocations();
+      assertOrder(l, 11, 26, 31, 45);
+      assertUnit(l.pHead->pNext->pNext == pNode);
+      assertUnit(lSrc.empty());
+   }  // teardown
+
+   /***************************************
+    * LOCALITY
+    ***************************************/
+
+   // nothing to move, so no block
+   void test_compact_empty()
+   {  // setup
+      custom::list<int> l;
+      trackAllocations();
+      // exercise
+      l.compact();
+      // verify
+      assertNoAllocations();
+      assertEmptyFixture(l);
+      assertUnit(l.pBlocks == nullptr);
+   }  // teardown
+
+   // a list that never uses blocks carries one pointer for them, no table
+   void test_compact_noTable()
+   {  // setup
+      custom::list<int> l{ 11, 26, 31 };
+      // exercise
+      l.push_back(45);
+      l.erase(l.begin());
+      // verify
+      assertUnit(l.pBlocks == nullptr);
+      assertUnit(sizeof(l) == sizeof(size_t) + 3 * sizeof(void *));
+      assertOrder(l, 26, 31, 45);
+   }  // teardown
+
+   // the nodes end up side by side in list order
+   //      +----+   +----+   +----+   +----+   +----+
+   //      | 11 | - | 99 | - | 26 | - | 31 | - | 45 |
+   //      +----+   +----+   +----+   +----+   +----+
+   void test_compact_standard()
+   {  // setup
+      custom::list<int> l{ 26, 31 };
+      l.push_front(11);
+      l.push_back(45);
+      l.insert(++l.begin(), 99);
+      // exercise
+      l.compact();
+      // verify
+      assertOrder(l, 11, 99, 26, 31, 45);
+      assertUnit(l.numBlocks() == 1);
+      bool together = true;
+      for (custom::list<int>::Node * p = l.pHead; p->pNext; p = p->pNext)
+         if (p->pNext != p + 1)
+            together = false;
+      assertUnit(together);
+      assertUnit(l.numBlocks() == 1 && (*l.pBlocks)[0]->pBegin == l.pHead);
+      assertUnit(l.numBlocks() == 1 && (*l.pBlocks)[0]->numLive == 5);
+   }  // teardown
+
+   // elements are moved into the block, never copied
+   void test_compact_spy()
+   {  // setup
+      custom::list<Spy> l;
+      for (int i = 0; i < 100; i++)
+         l.emplace_back(i);
+      Spy::reset();
+      // exercise
+      l.compact();
+      // verify
+      assertUnit(Spy::numCopyMove() == 100);
+      assertUnit(Spy::numDestructor() == 100);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(l.size() == 100);
+      assertUnit(l.front().get() == 0);
+      assertUnit(l.back().get() == 99);
+   }  // teardown
+
+   // compacting a compacted list frees the old block
+   void test_compact_twice()
+   {  // setup
+      custom::list<int> l{ 11, 26, 31 };
+      l.compact();
+      l.push_back(45);
+      l.compact();
+      long long bytesLive = AllocationCounters::current().bytesLive;
+      // exercise
+      for (int i = 0; i < 10; i++)
+         l.compact();
+      // verify
+      assertUnit(AllocationCounters::current().bytesLive == bytesLive);
+      assertUnit(l.numBlocks() == 1);
+      assertOrder(l, 11, 26, 31, 45);
+   }  // teardown
+
+   // a compacted list takes inserts and erases anywhere like any other
+   void test_compact_churn()
+   {  // setup
+      custom::list<std::string> l{ "eleven", "twenty six", "thirty one" };
+      l.compact();
+      // exercise
+      l.push_front("ninety nine");
+      l.erase(++l.begin());
+      l.insert(l.rbegin(), std::string(100, 'x'));
+      l.pop_back();
+      l.pop_front();
+      // verify
+      assertUnit(l.size() == 2);
+      assertUnit(l.front() == "twenty six");
+      assertUnit(l.back() == std::string(100, 'x'));
+      assertUnit(l.numBlocks() == 1 && (*l.pBlocks)[0]->numLive == 1);
+      l.erase(l.begin());
+      assertUnit(l.numBlocks() == 0);
+   }  // teardown
+
+   // nodes spliced out of a block keep it alive after their list is gone
+   void test_compact_spliceOut()
+   {  // setup
+      custom::list<int> l{ 1, 2 };
+      {
+         custom::list<int> lSrc{ 11, 26, 31, 45 };
+         lSrc.compact();
+         // exercise
+         l.splice(++l.begin(), lSrc, ++lSrc.begin(), lSrc.rbegin());
+         assertUnit(l.numBlocks() == 1 && (*l.pBlocks)[0]->numLists == 2);
+      }
+      // verify
+      assertOrder(l, 1, 26, 31, 2);
+      assertUnit(l.numBlocks() == 1 && (*l.pBlocks)[0]->numLists == 1);
+      assertUnit(l.numBlocks() == 1 && (*l.pBlocks)[0]->numLive == 2);
+      l.pop_back();
+      l.erase(++l.begin());
+      assertOrder(l, 1, 31);
+   }  // teardown
+
+   // merging both brings the block along
+   void test_compact_mergeIn()
+   {  // setup
+      custom::list<int> l{ 1, 20, 40 };
+      custom::list<int> lSrc{ 11, 26, 31 };
+      l.compact();
+      lSrc.compact();
+      // exercise
+      l.merge(lSrc);
+      // verify
+      assertOrder(l, 1, 11, 20, 26, 31, 40);
+      assertUnit(l.numBlocks() == 2);
+      lSrc.push_back(99);
+      lSrc.clear();
+      assertUnit(l.numBlocks() == 2 && (*l.pBlocks)[0]->numLists == 1);
+      assertUnit(l.numBlocks() == 2 && (*l.pBlocks)[1]->numLists == 1);
+      l.compact();
+      assertUnit(l.numBlocks() == 1);
+      assertOrder(l, 1, 11, 20, 26, 31, 40);
+   }  // teardown
+
+   // the blocks go with the nodes
+   void test_compact_swap()
+   {  // setup
+      custom::list<int> lLeft{ 11, 26, 31 };
+      custom::list<int> lRight{ 99 };
+      lLeft.compact();
+      // exercise
+      swap(lLeft, lRight);
+      // verify
+      assertOrder(lRight, 11, 26, 31);
+      assertOrder(lLeft, 99);
+      assertUnit(lRight.numBlocks() == 1);
+      assertUnit(lLeft.pBlocks == nullptr);
+      custom::list<int> lMoved(std::move(lRight));
+      assertUnit(lMoved.numBlocks() == 1);
+      assertUnit(lRight.pBlocks == nullptr);
+      lLeft = std::move(lMoved);
+      assertOrder(lLeft, 11, 26, 31);
+   }  // teardown
+
+   // two lists sharing a block can be cleared on two threads at once,
+   // and whichever is last frees the block, once
+   void test_compact_threads()
+   {  // setup
+      long long bytesHeld = 0;
+      long long bytesFreed = 0;
+      for (int i = 0; i < 200; i++)
+      {
+         long long bytes = AllocationCounters::current().bytesLive;
+         custom::list<std::string> lLeft;
+         for (int j = 0; j < 10; j++)
+            lLeft.push_back(std::string(40, (char)('a' + j)));
+         lLeft.compact();
+         custom::list<std::string> lRight;
+         auto itMiddle = lLeft.begin();
+         std::advance(itMiddle, 5);
+         lRight.splice(lRight.end(), lLeft, itMiddle, lLeft.end());
+         bytesHeld += AllocationCounters::current().bytesLive - bytes;
+         long long bytesLeft = 0;
+         long long bytesRight = 0;
+         // exercise
+         std::thread left([&lLeft, &bytesLeft]()
+         {
+            long long bytes = AllocationCounters::current().bytesLive;
+            lLeft.clear();
+            bytesLeft = bytes - AllocationCounters::current().bytesLive;
+         });
+         std::thread right([&lRight, &bytesRight]()
+         {
+            long long bytes = AllocationCounters::current().bytesLive;
+            lRight.clear();
+            bytesRight = bytes - AllocationCounters::current().bytesLive;
+         });
+         left.join();
+         right.join();
+         bytesFreed += bytesLeft + bytesRight;
+      }
+      // verify
+#ifdef UNIT_TEST_ALLOCATIONS
+      // the two threads freed everything the two lists held
+      assertUnit(bytesFreed == bytesHeld);
+#endif // UNIT_TEST_ALLOCATIONS
+   }  // teardown
+
+   /***************************************
+    * ALLOCATIONS
+    ***************************************/
+
+   // a copy allocates one node per element and nothing else
+   void test_allocations_copy()
+   {  // setup
+      custom::list<int> lSrc;
+      setupStandardFixture(lSrc);
+      trackAllocations();
+      size_t numAlloc = AllocationCounters::current().numAlloc;
+      // exercise
+      custom::list<int> lDest(lSrc);
+      numAlloc = AllocationCounters::current().numAlloc - numAlloc;
+      // verify
+      assertAllocations(3);
+#ifdef UNIT_TEST_ALLOCATIONS
+      assertUnit(numAlloc == 3);
+#endif // UNIT_TEST_ALLOCATIONS
+      assertStandardFixture(lDest);
+      // teardown
+      teardownStandardFixture(lSrc);
+   }
+
+   // moving a list hands over its nodes
+   void test_allocations_moveConstruct()
+   {  // setup
+      custom::list<int> lSrc;
+      setupStandardFixture(lSrc);
+      trackAllocations();
+      // exercise
+      custom::list<int> lDest(std::move(lSrc));
+      // verify
+      assertNoAllocations();
+      assertStandardFixture(lDest);
+      // teardown
+      teardownStandardFixture(lDest);
+   }
+
+   // move-assignment frees the old nodes but never allocates
+   void test_allocations_moveAssign()
+   {  // setup
+      custom::list<int> lSrc;
+      custom::list<int> lDest{ 99, 98 };
+      setupStandardFixture(lSrc);
+      trackAllocations();
+      // exercise
+      lDest = std::move(lSrc);
+      // verify
+      assertNoAllocations();
+      assertEmptyFixture(lSrc);
+      assertStandardFixture(lDest);
+      // teardown
+      teardownStandardFixture(lDest);
+   }
+
+   // swap trades pointers
+   void test_allocations_swap()
+   {  // setup
+      custom::list<int> l1;
+      custom::list<int> l2{ 99 };
+      setupStandardFixture(l1);
+      trackAllocations();
+      // exercise
+      swap(l1, l2);
+      // verify
+      assertNoAllocations();
+      assertStandardFixture(l2);
+      assertUnit(l1.size() == 1);
+      // teardown
+      teardownStandardFixture(l2);
+   }
+
+   // walking the list touches no memory but the nodes
+   void test_allocations_iterate()
+   {  // setup
+      custom::list<int> l;
+      setupStandardFixture(l);
+      int sum = 0;
+      trackAllocations();
+      // exercise
+      for (auto it = l.begin(); it != l.end(); ++it)
+         sum += *it;
+      // verify
+      assertNoAllocations();
+      assertUnit(sum == 11 + 26 + 31);
+      // teardown
+      teardownStandardFixture(l);
+   }
+
+   // splicing relinks nodes
+   void test_allocations_splice()
+   {  // setup
+      custom::list<int> l;
+      custom::list<int> lSrc{ 1, 2, 3 };
+      setupStandardFixture(l);
+      trackAllocations();
+      // exercise
+      l.splice(l.begin(), lSrc, lSrc.begin());
+      l.splice(l.end(), lSrc);
+      l.splice(l.end(), l, l.begin(), ++l.begin());
+      // verify
+      assertNoAllocations();
+      assertOrder(l, 11, 26, 31, 2, 3, 1);
+   }  // teardown
+
+   // so does merging
+   void test_allocations_merge()
+   {  // setup
+      custom::list<int> l;
+      custom::list<int> lSrc{ 1, 20, 40 };
+      setupStandardFixture(l);
+      trackAllocations();
+      // exercise
+      l.merge(lSrc);
+      // verify
+      assertNoAllocations();
+      assertOrder(l, 1, 11, 20, 26, 31, 40);
+   }  // teardown
+
+   // and sorting, however long the list
+   void test_allocations_sort()
+   {  // setup
+      custom::list<int> l;
+      for (int i = 0; i < 5000; i++)
+         l.push_back((i * 7919) % 5000);
+      trackAllocations();
+      // exercise
+      l.sort();
+      // verify
+      assertNoAllocations();
+      assertUnit(l.front() == 0);
+      assertUnit(l.back() == 4999);
+   }  // teardown
+
+   // compacting is one block for all the nodes, and the first time
+   // a table with a slot to remember it
+   void test_allocations_compact()
+   {  // setup
+      custom::list<int> l;
+      for (int i = 0; i < 1000; i++)
+         l.push_back(i);
+      trackAllocations();
+      // exercise
+      l.compact();
+      // verify
+      assertAllocations(3);
+      assertUnit(l.size() == 1000);
+      assertUnit(l.back() == 999);
+   }  // teardown
+
+   // a block shared by two lists is freed with the last of its nodes
+   void test_allocations_compactShared()
+   {  // setup
+      long long bytesLive = AllocationCounters::current().bytesLive;
+      {
+         custom::list<std::string> l{ "one", "two" };
+         {
+            custom::list<std::string> lSrc{ "eleven", "twenty six", "thirty one" };
+            lSrc.compact();
+            // exercise
+            l.splice(l.end(), lSrc, ++lSrc.begin(), lSrc.end());
+            l.compact();
+            lSrc.push_back(std::string(100, 'x'));
+            l.splice(l.begin(), lSrc);
+         }
+         l.pop_back();
+         l.merge(l);
+      }
+      // verify
+      assertUnit(AllocationCounters::current().bytesLive == bytesLive);
+   }  // teardown
+
+   // a range from forward iterators is one block, and the first time
+   // a table with a slot to remember it
+   void test_allocations_insertRange()
+   {  // setup
+      custom::list<int> l{ 11, 26, 31 };
+      std::vector<int> v(1000, 99);
+      trackAllocations();
+      // exercise
+      l.insert(++l.begin(), v.begin(), v.end());
+      // verify
+      assertAllocations(3);
+      assertUnit(l.size() == 1003);
+   }  // teardown
+
    /****************************************************************
     * Setup Standard Fixture
     *        pHead             pTail
@@ -1990,7 +3071,30 @@ public:
       }
    }
 
-
+   /****************************************************************
+    * Verify Order
+    * Walk the list both ways, checking every link and every value
+    ****************************************************************/
+   void assertOrderParameters(const custom::list<int>& l, const std::vector<int> & values,
+                              int line, const char* function)
+   {
+      assertIndirect(l.numElements == values.size());
+      assertIndirect(values.empty() == (l.pHead == nullptr));
+      assertIndirect(values.empty() == (l.pTail == nullptr));
+
+      // forward
+      const custom::list<int>::Node* pPrev = nullptr;
+      const custom::list<int>::Node* p = l.pHead;
+      for (size_t i = 0; i < values.size() && p; i++)
+      {
+         assertIndirect(p->data == values[i]);
+         assertIndirect(p->pPrev == pPrev);
+         pPrev = p;
+         p = p->pNext;
+      }
+      assertIndirect(p == nullptr);
+      assertIndirect(pPrev == l.pTail);
+   }
 };
 
 #endif // DEBUG
@@ -0,0 +1,427 @@
+/***********************************************************************
+ * Header:
+ *    TEST LOCK FREE LIST
+ * Summary:
+ *    Unit tests for lock_free_list, alone and under many threads
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "lockFreeList.h"
+#include "unitTest.h"
+
+#include <atomic>
+#include <functional>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// the elements of the list, front to back
+#define assertSorted(l, ...)    assertSortedParameters(l, { __VA_ARGS__ }, __LINE__, __FUNCTION__)
+
+class TestLockFreeList : public UnitTest
+{
+public:
+   // deferred, so what was retired stays where the tests can see it
+   typedef custom::lock_free_list<int, std::less<int>, custom::deferred_reclaimer> List;
+
+   void run()
+   {
+      reset();
+
+      // Construct
+      runUnit(test_construct_default);
+      runUnit(test_destructor_frees);
+
+      // Insert
+      runUnit(test_insert_order);
+      runUnit(test_insert_duplicate);
+      runUnit(test_insert_compare);
+
+      // Erase
+      runUnit(test_erase_missing);
+      runUnit(test_erase_marksThenRetires);
+      runUnit(test_erase_helped);
+
+      // Contains
+      runUnit(test_contains_standard);
+      runUnit(test_contains_markedNode);
+
+      // For each
+      runUnit(test_forEach_skipsMarked);
+
+      // Threads
+      runUnit(test_threads_disjoint);
+      runUnit(test_threads_sameKeys);
+      runUnit(test_threads_mixed);
+      runUnit(test_threads_epoch);
+
+      report("LockFreeList");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   void test_construct_default()
+   {  // exercise
+      List l;
+      // verify
+      assertUnit(l.empty());
+      assertUnit(l.head.load() == 0);
+      assertUnit(!l.contains(0));
+   }  // teardown
+
+   // linked nodes go with the list, retired ones with the reclaimer
+   void test_destructor_frees()
+   {  // setup
+      long long bytesLive = AllocationCounters::current().bytesLive;
+      {
+         custom::lock_free_list<std::string> l;
+         for (int i = 0; i < 10; i++)
+            l.insert(std::string(100, 'a' + i));
+         l.erase(std::string(100, 'c'));
+         l.erase(std::string(100, 'a'));
+      }  // exercise
+      // verify
+      assertUnit(AllocationCounters::current().bytesLive == bytesLive);
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // whatever order they come in, they are kept sorted
+   void test_insert_order()
+   {  // setup
+      List l;
+      // exercise
+      bool inserted = l.insert(26);
+      inserted = l.insert(11) && inserted;
+      inserted = l.insert(31) && inserted;
+      // verify
+      assertUnit(inserted);
+      assertSorted(l, 11, 26, 31);
+      assertUnit(l.size() == 3);
+   }  // teardown
+
+   // a set: the second 26 is turned away
+   void test_insert_duplicate()
+   {  // setup
+      List l;
+      l.insert(11);
+      l.insert(26);
+      // exercise
+      bool inserted = l.insert(26);
+      // verify
+      assertUnit(!inserted);
+      assertSorted(l, 11, 26);
+      assertUnit(l.size() == 2);
+   }  // teardown
+
+   // the order is whatever Compare says
+   void test_insert_compare()
+   {  // setup
+      custom::lock_free_list<int, std::greater<int>> l;
+      // exercise
+      l.insert(11);
+      l.insert(31);
+      l.insert(26);
+      // verify
+      std::vector<int> values;
+      l.for_each([&values](int value) { values.push_back(value); });
+      assertUnit(values == std::vector<int>({ 31, 26, 11 }));
+   }  // teardown
+
+   /***************************************
+    * ERASE
+    ***************************************/
+
+   void test_erase_missing()
+   {  // setup
+      List l;
+      l.insert(11);
+      l.insert(31);
+      // exercise
+      bool erased = l.erase(26);
+      // verify
+      assertUnit(!erased);
+      assertSorted(l, 11, 31);
+      assertUnit(l.reclaimer().pRetired.load() == nullptr);
+   }  // teardown
+
+   // out of the chain and handed to the reclaimer, not deleted
+   void test_erase_marksThenRetires()
+   {  // setup
+      List l;
+      l.insert(11);
+      l.insert(26);
+      l.insert(31);
+      List::Node * pNode = List::pointer(List::pointer(l.head.load())->next.load());
+      // exercise
+      bool erased = l.erase(26);
+      // verify
+      assertUnit(erased);
+      assertSorted(l, 11, 31);
+      assertUnit(l.size() == 2);
+      assertUnit(l.reclaimer().pRetired.load() == pNode);
+      assertUnit(List::marked(pNode->next.load()));
+      assertUnit(pNode->data == 26);
+   }  // teardown
+
+   // a node marked but still linked is taken out by the next one past it
+   void test_erase_helped()
+   {  // setup
+      List l;
+      l.insert(11);
+      l.insert(26);
+      l.insert(31);
+      List::Node * pNode = List::pointer(List::pointer(l.head.load())->next.load());
+      pNode->next.fetch_or(1);      // as if its eraser stalled after marking
+      l.numElements--;
+      // exercise
+      l.insert(45);
+      // verify
+      assertSorted(l, 11, 31, 45);
+      assertUnit(l.reclaimer().pRetired.load() == pNode);
+   }  // teardown
+
+   /***************************************
+    * CONTAINS
+    ***************************************/
+
+   void test_contains_standard()
+   {  // setup
+      List l;
+      l.insert(11);
+      l.insert(26);
+      l.insert(31);
+      // exercise and verify
+      assertUnit(l.contains(11));
+      assertUnit(l.contains(26));
+      assertUnit(l.contains(31));
+      assertUnit(!l.contains(0));
+      assertUnit(!l.contains(27));
+      assertUnit(!l.contains(99));
+   }  // teardown
+
+   // marked is erased, linked or not, and contains() changes nothing
+   void test_contains_markedNode()
+   {  // setup
+      List l;
+      l.insert(11);
+      l.insert(26);
+      List::Node * pNode = List::pointer(List::pointer(l.head.load())->next.load());
+      pNode->next.fetch_or(1);
+      // exercise
+      bool found = l.contains(26);
+      // verify
+      assertUnit(!found);
+      assertUnit(List::pointer(List::pointer(l.head.load())->next.load()) == pNode);
+      assertUnit(l.reclaimer().pRetired.load() == nullptr);
+      l.erase(26);
+   }  // teardown
+
+   /***************************************
+    * FOR EACH
+    ***************************************/
+
+   void test_forEach_skipsMarked()
+   {  // setup
+      List l;
+      l.insert(11);
+      l.insert(26);
+      l.insert(31);
+      List::pointer(List::pointer(l.head.load())->next.load())->next.fetch_or(1);
+      std::vector<int> values;
+      // exercise
+      l.for_each([&values](int value) { values.push_back(value); });
+      // verify
+      assertUnit(values == std::vector<int>({ 11, 31 }));
+      l.erase(26);
+   }  // teardown
+
+   /***************************************
+    * THREADS
+    ***************************************/
+
+   // each thread owns its own keys: it inserts them all and erases the
+   // even ones, so the odd keys are all that is left
+   void test_threads_disjoint()
+   {  // setup
+      const int numThreads = 8;
+      const int numKeys = 2000;
+      List l;
+      // exercise
+      runThreads(numThreads, [&](int iThread)
+      {
+         for (int key = iThread; key < numKeys; key += numThreads)
+            l.insert(key);
+         for (int key = iThread; key < numKeys; key += numThreads)
+            if (key % 2 == 0)
+               l.erase(key);
+      });
+      // verify
+      std::vector<int> expected;
+      for (int key = 1; key < numKeys; key += 2)
+         expected.push_back(key);
+      assertSortedParameters(l, expected, __LINE__, __FUNCTION__);
+   }  // teardown
+
+   // everyone inserts, then erases, the same keys: each key goes in once
+   // and comes out once, whoever wins
+   void test_threads_sameKeys()
+   {  // setup
+      const int numThreads = 8;
+      const int numKeys = 1000;
+      List l;
+      std::atomic<int> numInserted(0);
+      std::atomic<int> numErased(0);
+      std::atomic<int> numReady(0);
+      // exercise
+      runThreads(numThreads, [&](int iThread)
+      {
+         for (int key = 0; key < numKeys; key++)
+            if (l.insert((key * 7 + iThread) % numKeys))
+               numInserted++;
+         numReady++;
+         while (numReady.load() < numThreads)
+            std::this_thread::yield();
+         for (int key = 0; key < numKeys; key++)
+            if (l.erase((key * 13 + iThread) % numKeys))
+               numErased++;
+      });
+      // verify
+      assertUnit(numInserted == numKeys);
+      assertUnit(numErased == numKeys);
+      assertUnit(l.empty());
+      assertUnit(l.head.load() == 0);
+   }  // teardown
+
+   // random inserts, erases and searches over a small range. Each thread
+   // counts what its own calls did, and the sums must add up to what is left
+   void test_threads_mixed()
+   {  // setup
+      const int numThreads = 8;
+      const int numOperations = 20000;
+      const int numKeys = 64;
+      List l;
+      std::atomic<long> numNet(0);
+      // exercise
+      runThreads(numThreads, [&](int iThread)
+      {
+         std::mt19937 random(iThread);
+         long net = 0;
+         for (int i = 0; i < numOperations; i++)
+         {
+            int key = (int)(random() % numKeys);
+            switch (random() % 3)
+            {
+               case 0:
+                  net += l.insert(key) ? 1 : 0;
+                  break;
+               case 1:
+                  net -= l.erase(key) ? 1 : 0;
+                  break;
+               default:
+                  l.contains(key);
+            }
+         }
+         numNet += net;
+      });
+      // verify
+      size_t numLeft = 0;
+      bool ordered = true;
+      int previous = -1;
+      for (List::Node * p = List::pointer(l.head.load()); p; p = List::pointer(p->next.load()))
+      {
+         if (List::marked(p->next.load()) || p->data <= previous)
+            ordered = false;
+         previous = p->data;
+         numLeft++;
+      }
+      assertUnit(ordered);
+      assertUnit((long)numLeft == numNet.load());
+      assertUnit(l.size() == numLeft);
+   }  // teardown
+
+   // the same with the default reclaimer freeing nodes as it goes:
+   // nothing read after it is freed, nothing leaked at the end
+   void test_threads_epoch()
+   {  // setup
+      const int numThreads = 8;
+      const int numOperations = 20000;
+      const int numKeys = 64;
+      std::atomic<long> numNet(0);
+      std::atomic<long> numSeen(0);
+      {
+         custom::lock_free_list<std::string> l;
+         // exercise
+         runThreads(numThreads, [&](int iThread)
+         {
+            std::mt19937 random(iThread);
+            long net = 0;
+            for (int i = 0; i < numOperations; i++)
+            {
+               std::string key(40, (char)('0' + random() % numKeys));
+               switch (random() % 4)
+               {
+                  case 0:
+                     net += l.insert(key) ? 1 : 0;
+                     break;
+                  case 1:
+                     net -= l.erase(key) ? 1 : 0;
+                     break;
+                  case 2:
+                     l.contains(key);
+                     break;
+                  default:
+                     l.for_each([](const std::string & s) { (void)s.size(); });
+               }
+            }
+            numNet += net;
+         });
+         l.for_each([&numSeen](const std::string &) { numSeen++; });
+         // verify
+         assertUnit(l.size() == (size_t)numNet.load());
+      }
+      assertUnit(numSeen.load() == numNet.load());
+   }  // teardown
+
+   /****************************************************************
+    * Run Threads
+    * numThreads threads, each calling f with its index, all joined
+    ****************************************************************/
+   template <class Function>
+   static void runThreads(int numThreads, Function f)
+   {
+      std::vector<std::thread> threads;
+      for (int iThread = 0; iThread < numThreads; iThread++)
+         threads.push_back(std::thread(f, iThread));
+      for (auto & thread : threads)
+         thread.join();
+   }
+
+   /****************************************************************
+    * Assert Sorted
+    * The nodes still linked, none of them marked, hold values
+    ****************************************************************/
+   void assertSortedParameters(const List & l, const std::vector<int> & values,
+                               int line, const char * function)
+   {
+      assertIndirect(l.size() == values.size());
+      const List::Node * p = List::pointer(l.head.load());
+      for (size_t i = 0; i < values.size() && p; i++)
+      {
+         assertIndirect(p->data == values[i]);
+         assertIndirect(!List::marked(p->next.load()));
+         p = List::pointer(p->next.load());
+      }
+      assertIndirect(p == nullptr);
+   }
+};
+
+#endif // DEBUG
@@ -0,0 +1,305 @@
+/***********************************************************************
+ * Header:
+ *    TEST MPSC QUEUE
+ * Summary:
+ *    Unit tests for mpsc_queue
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "mpscQueue.h"
+#include "unitTest.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+// the elements of the list, front to back
+#define assertChain(l, ...)    assertChainParameters(l, { __VA_ARGS__ }, __LINE__, __FUNCTION__)
+
+class TestMpscQueue : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      runUnit(test_construct_default);
+      runUnit(test_destructor_frees);
+
+      // Push
+      runUnit(test_push_chain);
+      runUnit(test_emplace_arguments);
+
+      // Pop
+      runUnit(test_tryPop_empty);
+      runUnit(test_tryPop_order);
+      runUnit(test_tryPop_interleaved);
+      runUnit(test_popAll_empty);
+      runUnit(test_popAll_appends);
+      runUnit(test_popAll_afterTryPop);
+      runUnit(test_popAll_sameNodes);
+
+      // Threads
+      runUnit(test_threads_everyPushOnce);
+
+      report("MpscQueue");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   void test_construct_default()
+   {  // exercise
+      custom::mpsc_queue<int> q;
+      // verify
+      assertUnit(q.empty());
+      assertUnit(q.pNewest.load() == nullptr);
+      assertUnit(q.pending.empty());
+      assertUnit(reinterpret_cast<std::uintptr_t>(&q.pNewest) % 64 == 0);
+      assertUnit(reinterpret_cast<std::uintptr_t>(&q.pending) % 64 == 0);
+      assertUnit(reinterpret_cast<char *>(&q.pending) - reinterpret_cast<char *>(&q.pNewest) >= 64);
+   }  // teardown
+
+   // whatever was never popped goes with the queue
+   void test_destructor_frees()
+   {  // setup
+      long long bytesLive = AllocationCounters::current().bytesLive;
+      {
+         custom::mpsc_queue<std::string> q;
+         for (int i = 0; i < 10; i++)
+            q.push(std::string(100, 'a' + i));
+         std::string s;
+         q.try_pop(s);
+         q.push(std::string(100, 'z'));
+      }  // exercise
+      // verify
+      assertUnit(AllocationCounters::current().bytesLive == bytesLive);
+   }  // teardown
+
+   /***************************************
+    * PUSH
+    ***************************************/
+
+   // newest first, each node linked back to the one before it
+   //      +----+   +----+   +----+
+   //      | 11 | - | 26 | - | 31 |
+   //      +----+   +----+   +----+
+   //                          pNewest
+   void test_push_chain()
+   {  // setup
+      custom::mpsc_queue<int> q;
+      // exercise
+      q.push(11);
+      q.push(26);
+      q.push(31);
+      // verify
+      custom::mpsc_queue<int>::Node * p = q.pNewest.load();
+      assertUnit(p != nullptr && p->data == 31);
+      assertUnit(p != nullptr && p->pPrev && p->pPrev->data == 26);
+      assertUnit(p != nullptr && p->pPrev && p->pPrev->pPrev && p->pPrev->pPrev->data == 11);
+      assertUnit(p != nullptr && p->pPrev && p->pPrev->pPrev && p->pPrev->pPrev->pPrev == nullptr);
+      assertUnit(!q.empty());
+   }  // teardown
+
+   // the element is built in its node
+   void test_emplace_arguments()
+   {  // setup
+      custom::mpsc_queue<std::string> q;
+      std::string s;
+      // exercise
+      q.emplace(3, 'x');
+      // verify
+      assertUnit(q.try_pop(s));
+      assertUnit(s == "xxx");
+   }  // teardown
+
+   /***************************************
+    * POP
+    ***************************************/
+
+   void test_tryPop_empty()
+   {  // setup
+      custom::mpsc_queue<int> q;
+      int value = 99;
+      // exercise
+      bool popped = q.try_pop(value);
+      // verify
+      assertUnit(!popped);
+      assertUnit(value == 99);
+   }  // teardown
+
+   // first in, first out
+   void test_tryPop_order()
+   {  // setup
+      custom::mpsc_queue<int> q;
+      q.push(11);
+      q.push(26);
+      q.push(31);
+      int a = 0;
+      int b = 0;
+      int c = 0;
+      // exercise
+      q.try_pop(a);
+      q.try_pop(b);
+      q.try_pop(c);
+      // verify
+      assertUnit(a == 11);
+      assertUnit(b == 26);
+      assertUnit(c == 31);
+      assertUnit(q.empty());
+   }  // teardown
+
+   // pushes after a pop come after what was already taken
+   void test_tryPop_interleaved()
+   {  // setup
+      custom::mpsc_queue<int> q;
+      q.push(11);
+      q.push(26);
+      int value = 0;
+      q.try_pop(value);
+      // exercise
+      q.push(31);
+      // verify
+      assertUnit(q.try_pop(value) && value == 26);
+      assertUnit(q.try_pop(value) && value == 31);
+      assertUnit(!q.try_pop(value));
+   }  // teardown
+
+   void test_popAll_empty()
+   {  // setup
+      custom::mpsc_queue<int> q;
+      custom::list<int> l{ 1, 2 };
+      // exercise
+      size_t num = q.pop_all(l);
+      // verify
+      assertUnit(num == 0);
+      assertUnit(l.size() == 2);
+      assertUnit(l.back() == 2);
+   }  // teardown
+
+   // onto the end of what is there, fully linked both ways
+   void test_popAll_appends()
+   {  // setup
+      custom::mpsc_queue<int> q;
+      custom::list<int> l{ 1, 2 };
+      q.push(11);
+      q.push(26);
+      q.push(31);
+      // exercise
+      size_t num = q.pop_all(l);
+      // verify
+      assertUnit(num == 3);
+      assertUnit(q.empty());
+      assertChain(l, 1, 2, 11, 26, 31);
+   }  // teardown
+
+   // what try_pop took but left behind comes first
+   void test_popAll_afterTryPop()
+   {  // setup
+      custom::mpsc_queue<int> q;
+      custom::list<int> l;
+      q.push(11);
+      q.push(26);
+      q.push(31);
+      int value = 0;
+      q.try_pop(value);
+      q.push(45);
+      // exercise
+      size_t num = q.pop_all(l);
+      // verify
+      assertUnit(num == 3);
+      assertChain(l, 26, 31, 45);
+   }  // teardown
+
+   // the nodes pushed are the nodes in the list, nothing new
+   void test_popAll_sameNodes()
+   {  // setup
+      custom::mpsc_queue<int> q;
+      custom::list<int> l;
+      q.push(11);
+      q.push(26);
+      custom::mpsc_queue<int>::Node * pNode = q.pNewest.load();
+      trackAllocations();
+      // exercise
+      q.pop_all(l);
+      // verify
+      assertNoAllocations();
+      assertUnit(l.pTail == pNode);
+   }  // teardown
+
+   /***************************************
+    * THREADS
+    ***************************************/
+
+   // every push from every producer arrives once, each producer's in order
+   void test_threads_everyPushOnce()
+   {  // setup
+      const int numProducers = 4;
+      const int numPushes = 20000;
+      custom::mpsc_queue<int> q;
+      std::atomic<int> numReady(0);
+      std::vector<std::thread> producers;
+      for (int iProducer = 0; iProducer < numProducers; iProducer++)
+         producers.push_back(std::thread([&, iProducer]()
+         {
+            numReady++;
+            while (numReady.load() < numProducers)
+               std::this_thread::yield();
+            for (int i = 0; i < numPushes; i++)
+               q.push(iProducer * numPushes + i);
+         }));
+      // exercise
+      std::vector<int> last(numProducers, -1);
+      int numPopped = 0;
+      bool inOrder = true;
+      while (numPopped < numProducers * numPushes)
+      {
+         custom::list<int> l;
+         q.pop_all(l);
+         for (auto it = l.begin(); it != l.end(); ++it)
+         {
+            int iProducer = *it / numPushes;
+            if (*it % numPushes != last[iProducer] + 1)
+               inOrder = false;
+            last[iProducer] = *it % numPushes;
+            numPopped++;
+         }
+      }
+      for (auto & producer : producers)
+         producer.join();
+      // verify
+      assertUnit(inOrder);
+      assertUnit(numPopped == numProducers * numPushes);
+      assertUnit(q.empty());
+   }  // teardown
+
+   /****************************************************************
+    * Assert Chain
+    * Walk the list both ways, checking every link and every value
+    ****************************************************************/
+   void assertChainParameters(const custom::list<int> & l, const std::vector<int> & values,
+                              int line, const char * function)
+   {
+      assertIndirect(l.numElements == values.size());
+      const custom::list<int>::Node * pPrev = nullptr;
+      const custom::list<int>::Node * p = l.pHead;
+      for (size_t i = 0; i < values.size() && p; i++)
+      {
+         assertIndirect(p->data == values[i]);
+         assertIndirect(p->pPrev == pPrev);
+         pPrev = p;
+         p = p->pNext;
+      }
+      assertIndirect(p == nullptr);
+      assertIndirect(pPrev == l.pTail);
+   }
+};
+
+#endif // DEBUG
@@ -27,59 +27,59 @@ public:
       reset();
       
       // Create
-      test_create_default();
-      test_create_nondefault();
-      test_create_nondefaultMove();
+      runUnit(test_create_default);
+      runUnit(test_create_nondefault);
+      runUnit(test_create_nondefaultMove);
       
       // Make Pair
-      test_makePair_default();
-      test_makePair_nondefault();
+      runUnit(test_makePair_default);
+      runUnit(test_makePair_nondefault);
       
       // Delete
-      test_delete_default();
-      test_delete_standard();
+      runUnit(test_delete_default);
+      runUnit(test_delete_standard);
             
       // Copy
-      test_copy_default();
-      test_copy_standard();
+      runUnit(test_copy_default);
+      runUnit(test_copy_standard);
 
       // Copy move
-      test_copyMove_default();
-      test_copyMove_standard();
+      runUnit(test_copyMove_default);
+      runUnit(test_copyMove_standard);
       
       // Assign
-      test_assign_defaultToDefault();
-      test_assign_standardToDefault();
-      test_assign_defaultToStandard();
-      test_assign_standardToStandard();
+      runUnit(test_assign_defaultToDefault);
+      runUnit(test_assign_standardToDefault);
+      runUnit(test_assign_defaultToStandard);
+      runUnit(test_assign_standardToStandard);
       
       // Assign Move
-      test_assignMove_defaultToDefault();
-      test_assignMove_standardToDefault();
-      test_assignMove_defaultToStandard();
-      test_assignMove_standardToStandard();
+      runUnit(test_assignMove_defaultToDefault);
+      runUnit(test_assignMove_standardToDefault);
+      runUnit(test_assignMove_defaultToStandard);
+      runUnit(test_assignMove_standardToStandard);
 
       // Direct Access
-      test_directAccess_namedRead();
-      test_directAccess_namedWrite();
+      runUnit(test_directAccess_namedRead);
+      runUnit(test_directAccess_namedWrite);
 
       // Equivalence
-      test_equivalence_same();
-      test_equivalence_firstSmaller();
-      test_equivalence_firstLarger();
+      runUnit(test_equivalence_same);
+      runUnit(test_equivalence_firstSmaller);
+      runUnit(test_equivalence_firstLarger);
       
       // Swap
-      test_swap_defaultToDefault();
-      test_swap_standardToDefault();
-      test_swap_defaultToStandard();
-      test_swap_standardToStandard();
-      test_swapStandalone_defaultToDefault();
-      test_swapStandalone_standardToDefault();
-      test_swapStandalone_defaultToStandard();
-      test_swapStandalone_standardToStandard();
+      runUnit(test_swap_defaultToDefault);
+      runUnit(test_swap_standardToDefault);
+      runUnit(test_swap_defaultToStandard);
+      runUnit(test_swap_standardToStandard);
+      runUnit(test_swapStandalone_defaultToDefault);
+      runUnit(test_swapStandalone_standardToDefault);
+      runUnit(test_swapStandalone_defaultToStandard);
+      runUnit(test_swapStandalone_standardToStandard);
   
       // Get
-      test_get_firstRead();
+      runUnit(test_get_firstRead);
       
       report("Pair");
    }
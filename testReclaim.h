@@ -0,0 +1,357 @@
+/***********************************************************************
+ * Header:
+ *    TEST RECLAIM
+ * Summary:
+ *    Unit tests for deferred_reclaimer and epoch_reclaimer
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "reclaim.h"
+#include "unitTest.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+class TestReclaim : public UnitTest
+{
+public:
+   // a node that counts how many of its kind are alive, and wipes its
+   // magic number on the way out so a late reader can tell
+   struct Counted : public custom::reclaimable
+   {
+      enum { MAGIC = 0x5eed };
+      Counted(int value = 0) : reclaimable(&destroy), value(value), magic(MAGIC) { numLive()++; }
+      static void destroy(custom::reclaimable * p)
+      {
+         Counted * pCounted = static_cast<Counted *>(p);
+         pCounted->magic = 0;
+         numLive()--;
+         delete pCounted;
+      }
+      static std::atomic<int> & numLive() { static std::atomic<int> n(0); return n; }
+
+      int value;
+      volatile int magic;
+   };
+
+   void run()
+   {
+      reset();
+
+      // Deferred
+      runUnit(test_deferred_retireKeeps);
+      runUnit(test_deferred_reclaim);
+
+      // Epoch: guards
+      runUnit(test_epoch_construct);
+      runUnit(test_epoch_guardPins);
+      runUnit(test_epoch_guardNests);
+
+      // Epoch: retire
+      runUnit(test_epoch_sealAdvances);
+      runUnit(test_epoch_guardBlocks);
+      runUnit(test_epoch_otherThreadBlocks);
+      runUnit(test_epoch_bounded);
+      runUnit(test_epoch_guardsSeal);
+      runUnit(test_epoch_reclaim);
+      runUnit(test_epoch_destructor);
+
+      // Epoch: threads
+      runUnit(test_epoch_participantReused);
+      runUnit(test_epoch_threads);
+
+      report("Reclaim");
+   }
+
+   /***************************************
+    * DEFERRED
+    ***************************************/
+
+   // newest first, none freed
+   void test_deferred_retireKeeps()
+   {  // setup
+      int numLive = Counted::numLive();
+      custom::deferred_reclaimer r;
+      Counted * p1 = new Counted(1);
+      Counted * p2 = new Counted(2);
+      // exercise
+      r.retire(p1);
+      r.retire(p2);
+      // verify
+      assertUnit(Counted::numLive() == numLive + 2);
+      assertUnit(r.pRetired.load() == p2);
+      assertUnit(p2->pNextRetired == p1);
+      assertUnit(p1->pNextRetired == nullptr);
+   }  // teardown
+
+   void test_deferred_reclaim()
+   {  // setup
+      int numLive = Counted::numLive();
+      custom::deferred_reclaimer r;
+      for (int i = 0; i < 10; i++)
+         r.retire(new Counted(i));
+      // exercise
+      r.reclaim();
+      // verify
+      assertUnit(Counted::numLive() == numLive);
+      assertUnit(r.pRetired.load() == nullptr);
+   }  // teardown
+
+   /***************************************
+    * EPOCH: GUARDS
+    ***************************************/
+
+   // no participants until a thread uses it
+   void test_epoch_construct()
+   {  // exercise
+      custom::epoch_reclaimer r;
+      // verify
+      assertUnit(r.epoch.load() == 0);
+      assertUnit(r.pParticipants.load() == nullptr);
+      assertUnit(r.batch == 64);
+   }  // teardown
+
+   // pinned to epoch 0 inside, unpinned after
+   void test_epoch_guardPins()
+   {  // setup
+      custom::epoch_reclaimer r;
+      std::uint64_t inside = 99;
+      // exercise
+      {
+         custom::epoch_reclaimer::guard g(r);
+         inside = r.pParticipants.load()->state.load();
+      }
+      // verify
+      custom::epoch_reclaimer::Participant * p = r.pParticipants.load();
+      assertUnit(inside == 1);
+      assertUnit(p->state.load() == 0);
+      assertUnit(p->owned.load());
+      assertUnit(p->pNext == nullptr);
+   }  // teardown
+
+   // only the outermost guard unpins
+   void test_epoch_guardNests()
+   {  // setup
+      custom::epoch_reclaimer r;
+      custom::epoch_reclaimer::guard gOuter(r);
+      // exercise
+      {
+         custom::epoch_reclaimer::guard gInner(r);
+      }
+      // verify
+      assertUnit(r.pParticipants.load()->state.load() == 1);
+      assertUnit(r.pParticipants.load()->nesting == 1);
+   }  // teardown
+
+   /***************************************
+    * EPOCH: RETIRE
+    ***************************************/
+
+   // a full bag is sealed and the epoch moves on. The bag goes once the
+   // epoch is two past the one it was sealed in
+   void test_epoch_sealAdvances()
+   {  // setup
+      int numLive = Counted::numLive();
+      custom::epoch_reclaimer r(4);
+      for (int i = 0; i < 4; i++)
+         r.retire(new Counted(i));
+      int numAfterOne = Counted::numLive() - numLive;
+      std::uint64_t epochAfterOne = r.epoch.load();
+      // exercise
+      for (int i = 0; i < 4; i++)
+         r.retire(new Counted(i));
+      // verify
+      assertUnit(numAfterOne == 4);
+      assertUnit(epochAfterOne == 1);
+      assertUnit(r.epoch.load() == 2);
+      assertUnit(Counted::numLive() - numLive == 4);
+   }  // teardown
+
+   // nothing retired while a guard is open is freed before it closes
+   void test_epoch_guardBlocks()
+   {  // setup
+      int numLive = Counted::numLive();
+      custom::epoch_reclaimer r(4);
+      {
+         custom::epoch_reclaimer::guard g(r);
+         // exercise
+         for (int i = 0; i < 40; i++)
+            r.retire(new Counted(i));
+         // verify
+         assertUnit(Counted::numLive() - numLive == 40);
+         assertUnit(r.epoch.load() == 1);
+      }
+      for (int i = 0; i < 8; i++)
+         r.retire(new Counted(i));
+      assertUnit(Counted::numLive() - numLive < 48);
+   }  // teardown
+
+   // the same when the guard is on another thread
+   void test_epoch_otherThreadBlocks()
+   {  // setup
+      int numLive = Counted::numLive();
+      custom::epoch_reclaimer r(4);
+      std::atomic<int> step(0);
+      std::thread reader([&]()
+      {
+         custom::epoch_reclaimer::guard g(r);
+         step = 1;
+         while (step.load() != 2)
+            std::this_thread::yield();
+      });
+      while (step.load() != 1)
+         std::this_thread::yield();
+      // exercise
+      for (int i = 0; i < 40; i++)
+         r.retire(new Counted(i));
+      int numBlocked = Counted::numLive() - numLive;
+      step = 2;
+      reader.join();
+      for (int i = 0; i < 8; i++)
+         r.retire(new Counted(i));
+      // verify
+      assertUnit(numBlocked == 40);
+      assertUnit(Counted::numLive() - numLive < 48);
+   }  // teardown
+
+   // with no guard in the way, a thread never holds more than the bag it
+   // is filling and the one it sealed last
+   void test_epoch_bounded()
+   {  // setup
+      int numLive = Counted::numLive();
+      custom::epoch_reclaimer r(16);
+      int mostLive = 0;
+      // exercise
+      for (int i = 0; i < 1600; i++)
+      {
+         {
+            custom::epoch_reclaimer::guard g(r);
+            r.retire(new Counted(i));
+         }
+         if (Counted::numLive() - numLive > mostLive)
+            mostLive = Counted::numLive() - numLive;
+      }
+      // verify
+      assertUnit(mostLive <= 2 * 16);
+      assertUnit(r.epoch.load() >= 100);
+   }  // teardown
+
+   // a thread that retires one node and then only reads still frees it:
+   // every PINS_PER_COLLECT guards seal the bag or move the epoch on
+   void test_epoch_guardsSeal()
+   {  // setup
+      int numLive = Counted::numLive();
+      custom::epoch_reclaimer r;
+      r.retire(new Counted());
+      int numBefore = Counted::numLive() - numLive;
+      // exercise
+      for (int i = 0; i < 3 * custom::epoch_reclaimer::PINS_PER_COLLECT; i++)
+         custom::epoch_reclaimer::guard g(r);
+      // verify
+      assertUnit(numBefore == 1);
+      assertUnit(Counted::numLive() == numLive);
+      assertUnit(r.epoch.load() == 3);
+   }  // teardown
+
+   // everything, sealed or not
+   void test_epoch_reclaim()
+   {  // setup
+      int numLive = Counted::numLive();
+      custom::epoch_reclaimer r(4);
+      for (int i = 0; i < 10; i++)
+         r.retire(new Counted(i));
+      // exercise
+      r.reclaim();
+      // verify
+      assertUnit(Counted::numLive() == numLive);
+      assertUnit(r.pParticipants.load()->pBag == nullptr);
+   }  // teardown
+
+   // the garbage and the participant go with the reclaimer
+   void test_epoch_destructor()
+   {  // setup
+      long long bytesLive = AllocationCounters::current().bytesLive;
+      {
+         custom::epoch_reclaimer r(4);
+         for (int i = 0; i < 10; i++)
+            r.retire(new Counted(i));
+      }  // exercise
+      // verify
+      assertUnit(AllocationCounters::current().bytesLive == bytesLive);
+   }  // teardown
+
+   /***************************************
+    * EPOCH: THREADS
+    ***************************************/
+
+   // a thread that exits gives its participant, garbage and all, to the
+   // next one to come along
+   void test_epoch_participantReused()
+   {  // setup
+      int numLive = Counted::numLive();
+      custom::epoch_reclaimer r(4);
+      // exercise
+      for (int i = 0; i < 3; i++)
+         std::thread([&r]()
+         {
+            custom::epoch_reclaimer::guard g(r);
+            r.retire(new Counted());
+         }).join();
+      // verify
+      custom::epoch_reclaimer::Participant * p = r.pParticipants.load();
+      assertUnit(p != nullptr && p->pNext == nullptr);
+      assertUnit(p != nullptr && !p->owned.load());
+      assertUnit(p != nullptr && p->numBag == 3);
+      assertUnit(Counted::numLive() - numLive == 3);
+   }  // teardown
+
+   // readers follow a shared pointer that writers keep replacing and
+   // retiring. No reader sees a freed node, and nothing is left over
+   void test_epoch_threads()
+   {  // setup
+      const int numReaders = 6;
+      const int numWriters = 2;
+      const int numReplaces = 5000;
+      int numLive = Counted::numLive();
+      std::atomic<bool> sawFreed(false);
+      {
+         custom::epoch_reclaimer r(8);
+         std::atomic<Counted *> pShared(new Counted(0));
+         std::atomic<int> numWritersDone(0);
+         std::vector<std::thread> threads;
+         // exercise
+         for (int i = 0; i < numReaders; i++)
+            threads.push_back(std::thread([&]()
+            {
+               while (numWritersDone.load() < numWriters)
+               {
+                  custom::epoch_reclaimer::guard g(r);
+                  if (pShared.load(std::memory_order_acquire)->magic != Counted::MAGIC)
+                     sawFreed = true;
+               }
+            }));
+         for (int i = 0; i < numWriters; i++)
+            threads.push_back(std::thread([&]()
+            {
+               for (int j = 0; j < numReplaces; j++)
+               {
+                  custom::epoch_reclaimer::guard g(r);
+                  r.retire(pShared.exchange(new Counted(j), std::memory_order_acq_rel));
+               }
+               numWritersDone++;
+            }));
+         for (auto & thread : threads)
+            thread.join();
+         Counted::destroy(pShared.load());
+      }
+      // verify
+      assertUnit(!sawFreed.load());
+      assertUnit(Counted::numLive() == numLive);
+   }  // teardown
+};
+
+#endif // DEBUG
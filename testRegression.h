@@ -0,0 +1,463 @@
+/***********************************************************************
+ * Header:
+ *    TEST REGRESSION
+ * Summary:
+ *    Unit tests for the benchmark regression gate
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "regression.h"
+#include "unitTest.h"
+
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+
+class TestRegression : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Statistics
+      runUnit(test_median_odd);
+      runUnit(test_median_even);
+      runUnit(test_rejectOutliers_none);
+      runUnit(test_rejectOutliers_spike);
+      runUnit(test_summarize_runs);
+
+      // Baseline
+      runUnit(test_read_roundTrip);
+      runUnit(test_read_empty);
+      runUnit(test_read_malformed);
+
+      // Compare
+      runUnit(test_compare_same);
+      runUnit(test_compare_noise);
+      runUnit(test_compare_slower);
+      runUnit(test_compare_allocations);
+      runUnit(test_compare_allocationNoise);
+      runUnit(test_compare_newAndMissing);
+      runUnit(test_compare_drift);
+      runUnit(test_compare_driftOwnCases);
+      runUnit(test_compare_driftFewReferences);
+      runUnit(test_compare_maxSlack);
+      runUnit(test_compare_reference);
+      runUnit(test_compare_referenceAllocations);
+      runUnit(test_compare_short);
+      runUnit(test_compare_shortAllocations);
+      runUnit(test_compare_oversubscribed);
+
+      report("Regression");
+   }
+
+   /***************************************
+    * STATISTICS
+    ***************************************/
+
+   // the middle one
+   void test_median_odd()
+   {  // exercise and verify
+      assertUnit(median({ 5.0, 1.0, 3.0 }) == 3.0);
+      assertUnit(median({ 7.0 }) == 7.0);
+      assertUnit(median({}) == 0.0);
+   }
+
+   // halfway between the middle two
+   void test_median_even()
+   {  // exercise and verify
+      assertUnit(median({ 4.0, 1.0, 2.0, 3.0 }) == 2.5);
+   }
+
+   // tightly grouped samples all stay
+   void test_rejectOutliers_none()
+   {  // setup
+      std::vector<double> samples{ 10.0, 11.0, 10.5, 9.5, 10.0 };
+      // exercise
+      std::vector<double> kept = rejectOutliers(samples);
+      // verify
+      assertUnit(kept.size() == 5);
+   }  // teardown
+
+   // one run where the machine was busy goes
+   void test_rejectOutliers_spike()
+   {  // setup
+      std::vector<double> samples{ 10.0, 11.0, 95.0, 9.5, 10.0 };
+      // exercise
+      std::vector<double> kept = rejectOutliers(samples);
+      // verify
+      assertUnit(kept.size() == 4);
+      assertUnit(median(kept) == 10.0);
+   }  // teardown
+
+   // three runs of one case and one of another become two results
+   void test_summarize_runs()
+   {  // setup
+      std::vector<Benchmark::Result> results{ result("find", 100.0, 0.0),
+                                              result("erase", 50.0, 10.0),
+                                              result("find", 120.0, 0.0),
+                                              result("find", 900.0, 0.0) };
+      // exercise
+      std::vector<Benchmark::Result> summary = summarize(results);
+      // verify
+      assertUnit(summary.size() == 2);
+      if (summary.size() == 2)
+      {
+         assertUnit(summary[0].name == "find");
+         assertUnit(summary[0].numRuns == 3);
+         // 1.0, 1.2 and 9.0 ns/op: the 9.0 goes, leaving 1.1 +/- 0.1
+         assertUnit(std::fabs(summary[0].ns - 110.0) < 1e-9);
+         assertUnit(std::fabs(summary[0].nsMad - 10.0) < 1e-9);
+         assertUnit(summary[1].name == "erase");
+         assertUnit(summary[1].numRuns == 1);
+         assertUnit(summary[1].allocs == 10.0);
+      }
+   }  // teardown
+
+   /***************************************
+    * BASELINE
+    ***************************************/
+
+   // what json() writes, read() reads
+   void test_read_roundTrip()
+   {  // setup
+      std::vector<Benchmark::Result> saved = Benchmark::all();
+      Benchmark::all() = { result("find", 2500.0, 100.0) };
+      Benchmark::all()[0].nsMad   = 300.0;
+      Benchmark::all()[0].allocsMad = 4.0;
+      Benchmark::all()[0].numRuns = 5;
+      std::istringstream in(Benchmark::json());
+      RegressionGate gate;
+      // exercise
+      gate.read(in);
+      // verify
+      assertUnit(gate.size() == 1);
+      if (gate.size() == 1)
+      {
+         assertUnit(gate.baseline[0].suite == "Hash");
+         assertUnit(gate.baseline[0].name == "find");
+         assertUnit(gate.baseline[0].workload == "zipf(0.99)/r90");
+         assertUnit(gate.baseline[0].size == 1000);
+         assertUnit(gate.baseline[0].numOps == 100);
+         assertUnit(gate.baseline[0].ns == 2500.0);
+         assertUnit(gate.baseline[0].nsMad == 300.0);
+         assertUnit(gate.baseline[0].allocs == 100.0);
+         assertUnit(gate.baseline[0].allocsMad == 4.0);
+         assertUnit(gate.baseline[0].numRuns == 5);
+      }
+      // teardown
+      Benchmark::all() = saved;
+   }
+
+   // an empty run is an empty baseline
+   void test_read_empty()
+   {  // setup
+      std::istringstream in("[\n]\n");
+      RegressionGate gate;
+      // exercise
+      gate.read(in);
+      // verify
+      assertUnit(gate.size() == 0);
+   }  // teardown
+
+   // anything else is an error
+   void test_read_malformed()
+   {  // setup
+      RegressionGate gate;
+      // exercise and verify
+      for (const char * json : { "", "{}", "[{\"name\":}]", "[{\"name\":\"find\"", "[{\"size\":10}]" })
+      {
+         std::istringstream in(json);
+         bool thrown = false;
+         try
+         {
+            gate.read(in);
+         }
+         catch (const char * error)
+         {
+            thrown = true;
+         }
+         assertUnit(thrown);
+      }
+   }  // teardown
+
+   /***************************************
+    * COMPARE
+    ***************************************/
+
+   // a run passes against itself
+   void test_compare_same()
+   {  // setup
+      RegressionGate gate;
+      gate.baseline = { result("find", 1000.0, 0.0) };
+      std::ostringstream out;
+      // exercise
+      bool pass = gate.compare({ result("find", 1000.0, 0.0) }, out);
+      // verify
+      assertUnit(pass);
+      assertUnit(out.str().find("PASS") != std::string::npos);
+   }  // teardown
+
+   // slower, but within what the runs themselves wandered
+   void test_compare_noise()
+   {  // setup
+      RegressionGate gate;
+      gate.baseline = { result("find", 1000.0, 0.0) };
+      gate.baseline[0].nsMad = 100.0;         // 1 ns/op
+      std::ostringstream out;
+      // exercise: 10 ns/op -> 13.5 ns/op, limit 10 * 1.1 + 3 * (1 + 0)
+      bool pass = gate.compare({ result("find", 1350.0, 0.0) }, out);
+      // verify
+      assertUnit(pass);
+   }  // teardown
+
+   // slower than the tolerance and the noise put together
+   void test_compare_slower()
+   {  // setup
+      RegressionGate gate;
+      gate.baseline = { result("find", 1000.0, 0.0) };
+      std::ostringstream out;
+      // exercise: 10 ns/op -> 14 ns/op, limit 10 * 1.1 + 250 ns / 100 ops
+      bool pass = gate.compare({ result("find", 1400.0, 0.0) }, out);
+      // verify
+      assertUnit(!pass);
+      assertUnit(out.str().find("SLOWER") != std::string::npos);
+      assertUnit(out.str().find("FAIL") != std::string::npos);
+   }  // teardown
+
+   // twice the copies, even at the same speed
+   void test_compare_allocations()
+   {  // setup
+      RegressionGate gate;
+      gate.baseline = { result("copy_assign", 1000.0, 100.0) };
+      std::ostringstream out;
+      // exercise
+      bool pass = gate.compare({ result("copy_assign", 1000.0, 200.0) }, out);
+      // verify
+      assertUnit(!pass);
+      assertUnit(out.str().find("ALLOCS") != std::string::npos);
+   }  // teardown
+
+   // threads make a few more allocations on some runs than on others
+   void test_compare_allocationNoise()
+   {  // setup
+      RegressionGate gate;
+      gate.baseline = { result("read_mostly", 1000.0, 270.0) };
+      gate.baseline[0].allocsMad = 5.0;
+      std::ostringstream out;
+      // exercise: 2.70 -> 2.83 allocs/op, limit 2.70 * 1.01 + 3 * (0.05 + 0)
+      bool pass = gate.compare({ result("read_mostly", 1000.0, 283.0) }, out);
+      // verify
+      assertUnit(pass);
+   }  // teardown
+
+   // cases in only one of the runs are listed but do not fail
+   void test_compare_newAndMissing()
+   {  // setup
+      RegressionGate gate;
+      gate.baseline = { result("find", 1000.0, 0.0) };
+      std::ostringstream out;
+      // exercise
+      bool pass = gate.compare({ result("erase", 1000.0, 0.0) }, out);
+      // verify
+      assertUnit(pass);
+      assertUnit(out.str().find("new") != std::string::npos);
+      assertUnit(out.str().find("missing") != std::string::npos);
+   }  // teardown
+
+   // the std:: containers 50% slower is the machine, so ours 50% slower
+   // is too, but ours 100% slower is the code
+   void test_compare_drift()
+   {  // setup
+      RegressionGate gate;
+      std::vector<Benchmark::Result> current;
+      for (int i = 0; i < 30; i++)
+      {
+         std::string name = "case" + std::to_string(i);
+         gate.baseline.push_back(reference(name.c_str(), 10000.0, 0.0));
+         current.push_back(reference(name.c_str(), 15000.0, 0.0));
+      }
+      gate.baseline.push_back(result("find", 10000.0, 0.0));
+      gate.baseline.push_back(result("erase", 10000.0, 0.0));
+      current.push_back(result("find", 15000.0, 0.0));
+      current.push_back(result("erase", 20000.0, 0.0));
+      std::ostringstream out;
+      // exercise
+      bool pass = gate.compare(current, out);
+      // verify
+      assertUnit(gate.drift(current) == 1.5);
+      assertUnit(!pass);
+      assertUnit(out.str().find("1 slower") != std::string::npos);
+      assertUnit(out.str().find("50.00% slower than for the baseline") != std::string::npos);
+   }  // teardown
+
+   // our own cases all getting slower is no excuse for any of them
+   void test_compare_driftOwnCases()
+   {  // setup
+      RegressionGate gate;
+      std::vector<Benchmark::Result> current;
+      for (int i = 0; i < 30; i++)
+      {
+         std::string name = "case" + std::to_string(i);
+         gate.baseline.push_back(result(name.c_str(), 10000.0, 0.0));
+         current.push_back(result(name.c_str(), 20000.0, 0.0));
+      }
+      std::ostringstream out;
+      // exercise
+      bool pass = gate.compare(current, out);
+      // verify
+      assertUnit(gate.drift(current) == 1.0);
+      assertUnit(!pass);
+      assertUnit(out.str().find("30 slower") != std::string::npos);
+   }  // teardown
+
+   // too few reference cases to trust, so no drift at all
+   void test_compare_driftFewReferences()
+   {  // setup
+      RegressionGate gate;
+      std::vector<Benchmark::Result> current;
+      for (int i = 0; i < 5; i++)
+      {
+         std::string name = "case" + std::to_string(i);
+         gate.baseline.push_back(reference(name.c_str(), 10000.0, 0.0));
+         current.push_back(reference(name.c_str(), 30000.0, 0.0));
+      }
+      gate.baseline.push_back(result("find", 10000.0, 0.0));
+      current.push_back(result("find", 20000.0, 0.0));
+      std::ostringstream out;
+      // exercise
+      bool pass = gate.compare(current, out);
+      // verify
+      assertUnit(gate.drift(current) == 1.0);
+      assertUnit(!pass);
+      assertUnit(out.str().find("1 slower") != std::string::npos);
+   }  // teardown
+
+   // a very noisy case still fails when it gets several times slower
+   void test_compare_maxSlack()
+   {  // setup
+      RegressionGate gate;
+      gate.baseline = { result("find", 1000.0, 0.0) };
+      gate.baseline[0].nsMad = 1000.0;        // 10 ns/op
+      std::ostringstream out;
+      // exercise: 10 ns/op -> 25 ns/op, limit 10 * 1.1 + min(3 * 10, 10 * 1.0)
+      bool pass = gate.compare({ result("find", 2500.0, 0.0) }, out);
+      // verify
+      assertUnit(!pass);
+      assertUnit(out.str().find("SLOWER") != std::string::npos);
+   }  // teardown
+
+   // the time of a std:: container never fails
+   void test_compare_reference()
+   {  // setup
+      RegressionGate gate;
+      gate.baseline = { reference("find", 1000.0, 100.0) };
+      std::ostringstream out;
+      // exercise
+      bool pass = gate.compare({ reference("find", 3000.0, 100.0) }, out);
+      // verify
+      assertUnit(pass);
+      assertUnit(out.str().find("ref") != std::string::npos);
+      assertUnit(out.str().find("1 of them not timed") != std::string::npos);
+   }  // teardown
+
+   // but its allocations still do
+   void test_compare_referenceAllocations()
+   {  // setup
+      RegressionGate gate;
+      gate.baseline = { reference("copy_assign", 1000.0, 100.0) };
+      std::ostringstream out;
+      // exercise
+      bool pass = gate.compare({ reference("copy_assign", 1000.0, 200.0) }, out);
+      // verify
+      assertUnit(!pass);
+      assertUnit(out.str().find("ALLOCS") != std::string::npos);
+   }  // teardown
+
+   // a baseline run under 100 ns is only a few reads of the clock, but
+   // one of a few hundred ns is timed, with slack for the clock
+   void test_compare_short()
+   {  // setup
+      RegressionGate gate;
+      gate.baseline = { result("find", 50.0, 0.0), result("erase", 300.0, 0.0) };
+      std::ostringstream out;
+      // exercise: both three times slower, but only erase is long enough
+      bool pass = gate.compare({ result("find", 150.0, 0.0),
+                                 result("erase", 900.0, 0.0) }, out);
+      // verify
+      assertUnit(!pass);
+      assertUnit(out.str().find("short") != std::string::npos);
+      assertUnit(out.str().find("1 slower") != std::string::npos);
+   }  // teardown
+
+   // however short the run, more allocations fail
+   void test_compare_shortAllocations()
+   {  // setup
+      RegressionGate gate;
+      gate.baseline = { result("find", 50.0, 100.0) };
+      std::ostringstream out;
+      // exercise
+      bool pass = gate.compare({ result("find", 50.0, 200.0) }, out);
+      // verify
+      assertUnit(!pass);
+      assertUnit(out.str().find("ALLOCS") != std::string::npos);
+   }  // teardown
+
+   // more threads than cores is timing the scheduler, not the code
+   void test_compare_oversubscribed()
+   {  // setup
+      RegressionOptions options;
+      options.numCores = 2;
+      RegressionGate gate(options);
+      gate.baseline = { result("find", 1000.0, 0.0), result("erase", 1000.0, 0.0) };
+      gate.baseline[0].numThreads = 4;
+      gate.baseline[1].numThreads = 2;
+      Benchmark::Result find  = result("find",  3000.0, 0.0);
+      Benchmark::Result erase = result("erase", 3000.0, 0.0);
+      find.numThreads  = 4;
+      erase.numThreads = 2;
+      std::ostringstream out;
+      // exercise
+      bool pass = gate.compare({ find, erase }, out);
+      // verify
+      assertUnit(!pass);
+      assertUnit(out.str().find("threads") != std::string::npos);
+      assertUnit(out.str().find("1 slower") != std::string::npos);
+   }  // teardown
+
+   /****************************************************************
+    * RESULT
+    * One run of 100 operations on a hash of 1000
+    ****************************************************************/
+   Benchmark::Result result(const char * name, double ns, double allocs)
+   {
+      Benchmark::Result result;
+      result.suite      = "Hash";
+      result.name       = name;
+      result.container  = "custom::unordered_set";
+      result.key        = "size_t";
+      result.workload   = "zipf(0.99)/r90";
+      result.size       = 1000;
+      result.numThreads = 1;
+      result.numOps     = 100;
+      result.ns         = ns;
+      result.bytes      = 0.0;
+      result.allocs     = allocs;
+      return result;
+   }
+
+   // the same, on the std:: container ours is compared against
+   Benchmark::Result reference(const char * name, double ns, double allocs)
+   {
+      Benchmark::Result result = this->result(name, ns, allocs);
+      result.container = "std::unordered_set";
+      return result;
+   }
+};
+
+#endif // DEBUG
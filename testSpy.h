@@ -13,6 +13,11 @@
 #include "spy.h"        // class under test
 #include "unitTest.h"   // unit test baseclass
 
+#include <functional>   // for std::hash
+#include <memory>       // for std::shared_ptr and std::unique_ptr
+#include <thread>       // for std::thread
+#include <vector>       // for std::vector
+
 /***********************************************
  * TEST SPY
  * Unit tests for the Spy class
@@ -26,54 +31,66 @@ public:
       reset();
       
       // Constructor
-      test_constructorDefault();
-      test_constructorNondefault();
+      runUnit(test_constructorDefault);
+      runUnit(test_constructorNondefault);
       
       // Destructor
-      test_destructor_empty();
-      test_destructor_full();
+      runUnit(test_destructor_empty);
+      runUnit(test_destructor_full);
       
       // Copy Constructor
-      test_constructorCopy_empty();
-      test_constructorCopy_full();
+      runUnit(test_constructorCopy_empty);
+      runUnit(test_constructorCopy_full);
       
       // Move Constructor
-      test_constructorMove_empty();
-      test_constructorMove_full();
+      runUnit(test_constructorMove_empty);
+      runUnit(test_constructorMove_full);
       
       // Copy Assignment Operator
-      test_assignCopy_emptyToEmpty();
-      test_assignCopy_fullToEmpty();
-      test_assignCopy_emptyToFull();
-      test_assignCopy_fullToFull();
+      runUnit(test_assignCopy_emptyToEmpty);
+      runUnit(test_assignCopy_fullToEmpty);
+      runUnit(test_assignCopy_emptyToFull);
+      runUnit(test_assignCopy_fullToFull);
 
       // Assign Move
-      test_assignMove_emptyToEmpty();
-      test_assignMove_fullToEmpty();
-      test_assignMove_emptyToFull();
-      test_assignMove_fullToFull();
+      runUnit(test_assignMove_emptyToEmpty);
+      runUnit(test_assignMove_fullToEmpty);
+      runUnit(test_assignMove_emptyToFull);
+      runUnit(test_assignMove_fullToFull);
       
       // Equivalence
-      test_equivalence_emptyToEmpty();
-      test_equivalence_fullToEmpty();
-      test_equivalence_emptyToFull();
-      test_equivalence_same();
-      test_equivalence_firstSmaller();
-      test_equivalence_firstLarger();
+      runUnit(test_equivalence_emptyToEmpty);
+      runUnit(test_equivalence_fullToEmpty);
+      runUnit(test_equivalence_emptyToFull);
+      runUnit(test_equivalence_same);
+      runUnit(test_equivalence_firstSmaller);
+      runUnit(test_equivalence_firstLarger);
       
       // Less Than
-      test_lessthan_emptyToEmpty();
-      test_lessthan_fullToEmpty();
-      test_lessthan_emptyToFull();
-      test_lessthan_same();
-      test_lessthan_firstSmaller();
-      test_lessthan_firstLarger();
+      runUnit(test_lessthan_emptyToEmpty);
+      runUnit(test_lessthan_fullToEmpty);
+      runUnit(test_lessthan_emptyToFull);
+      runUnit(test_lessthan_same);
+      runUnit(test_lessthan_firstSmaller);
+      runUnit(test_lessthan_firstLarger);
   
       // Swap
-      test_swap_emptyToEmpty();
-      test_swap_fullToEmpty();
-      test_swap_emptyToFull();
-      test_swap_fullToFull();
+      runUnit(test_swap_emptyToEmpty);
+      runUnit(test_swap_fullToEmpty);
+      runUnit(test_swap_emptyToFull);
+      runUnit(test_swap_fullToFull);
+
+      // Hash
+      runUnit(test_hash_full);
+      runUnit(test_hash_empty);
+
+      // Threads
+      runUnit(test_threads_separate);
+      runUnit(test_threads_carried);
+      runUnit(test_threads_total);
+      runUnit(test_threads_reset);
+      runUnit(test_threads_joinEnds);
+      runUnit(test_threads_outlived);
       
       report("Spy");
    }
@@ -772,6 +789,156 @@ public:
       assertUnit(2 == *(s1.p));
       assertUnit(1 == *(s2.p));
    }  // teardown
+
+   /***************************************
+    * HASH
+    *    std::hash<Spy>
+    ***************************************/
+
+   // a full spy hashes like its value, and counts it
+   void test_hash_full()
+   {  // setup
+      Spy s(99);
+      Spy::reset();
+      // exercise
+      size_t h = std::hash<Spy>()(s);
+      // verify
+      assertUnit(h == std::hash<int>()(99));
+      assertUnit(Spy::numHash() == 1);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numCopy() == 0);
+   }  // teardown
+
+   // an empty spy hashes to zero
+   void test_hash_empty()
+   {  // setup
+      Spy s;
+      Spy::reset();
+      // exercise
+      size_t h = std::hash<Spy>()(s);
+      // verify
+      assertUnit(h == 0);
+      assertUnit(Spy::numHash() == 1);
+   }  // teardown
+
+   /***************************************
+    * THREADS
+    *    Spy::reset()
+    *    SpyCounters::Join
+    ***************************************/
+
+   // what another thread does with its own Spys does not show up here
+   void test_threads_separate()
+   {  // setup
+      Spy::reset();
+      // exercise
+      std::thread([]() { Spy s(1); }).join();
+      // verify
+      assertUnit(Spy::numNondefault() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+   }  // teardown
+
+   // but what it does to ours does, as a pool worker would
+   void test_threads_carried()
+   {  // setup
+      Spy s(1);
+      Spy::reset();
+      // exercise
+      std::thread([&s]()
+      {
+         Spy copy(s);
+         std::hash<Spy>()(copy);
+      }).join();
+      // verify
+      assertUnit(Spy::numCopy() == 1);
+      assertUnit(Spy::numHash() == 1);
+      assertUnit(Spy::numDestructor() == 1);
+      assertUnit(Spy::numAlloc() == 1);
+   }  // teardown
+
+   // threads that join our counters add up with us, even once they are done
+   void test_threads_total()
+   {  // setup
+      Spy::reset();
+      std::shared_ptr<SpyCounters> pCounters = SpyCounters::current();
+      std::vector<std::thread> threads;
+      // exercise
+      for (int t = 0; t < 4; t++)
+         threads.push_back(std::thread([t, pCounters]()
+         {
+            SpyCounters::Join join(pCounters);
+            for (int i = 0; i < 100; i++)
+            {
+               Spy s(t * 100 + i);
+               std::hash<Spy>()(s);
+            }
+         }));
+      for (auto & thread : threads)
+         thread.join();
+      Spy s(99);
+      // verify
+      assertUnit(Spy::numNondefault() == 401);
+      assertUnit(Spy::numHash() == 400);
+      assertUnit(Spy::numDestructor() == 400);
+      assertUnit(Spy::numAlloc() == 401);
+   }  // teardown
+
+   // start everybody counting here over
+   void test_threads_reset()
+   {  // setup
+      std::shared_ptr<SpyCounters> pCounters = SpyCounters::current();
+      std::thread([pCounters]()
+      {
+         SpyCounters::Join join(pCounters);
+         Spy s(1);
+      }).join();
+      Spy s(2);
+      // exercise
+      Spy::reset();
+      // verify
+      assertUnit(Spy::numNondefault() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numNondefault() == 0);
+   }  // teardown
+
+   // a joined thread goes back to its own counters afterwards
+   void test_threads_joinEnds()
+   {  // setup
+      Spy::reset();
+      std::shared_ptr<SpyCounters> pCounters = SpyCounters::current();
+      int numOwn = -1;
+      // exercise
+      std::thread([pCounters, &numOwn]()
+      {
+         {
+            SpyCounters::Join join(pCounters);
+            Spy s(1);
+         }
+         Spy s(2);
+         numOwn = Spy::numNondefault();
+      }).join();
+      // verify
+      assertUnit(Spy::numNondefault() == 1);
+      assertUnit(numOwn == 1);
+   }  // teardown
+
+   // a Spy still counts in the set of the thread that made it, after
+   // that thread is gone
+   void test_threads_outlived()
+   {  // setup
+      Spy::reset();
+      std::unique_ptr<Spy> pSpy;
+      std::thread([&pSpy]() { pSpy.reset(new Spy(7)); }).join();
+      // exercise
+      Spy copy(*pSpy);
+      pSpy.reset();
+      // verify
+      assertUnit(copy.get() == 7);
+      assertUnit((*copy.pCounters)[NONDEFAULT] == 1);
+      assertUnit((*copy.pCounters)[COPY] == 1);
+      assertUnit((*copy.pCounters)[DESTRUCTOR] == 1);
+      assertUnit(Spy::numCopy() == 0);
+   }  // teardown
 };
 
 #endif // DEBUG
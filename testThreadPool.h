@@ -0,0 +1,223 @@
+/***********************************************************************
+ * Header:
+ *    TEST THREAD POOL
+ * Summary:
+ *    Unit tests for the thread pool
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "threadPool.h"
+#include "unitTest.h"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include <stdexcept>
+
+class TestThreadPool : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      runUnit(test_construct_zero);
+      runUnit(test_construct_four);
+      runUnit(test_construct_cacheLines);
+
+      // Execute
+      runUnit(test_submit_one);
+      runUnit(test_submit_many);
+      runUnit(test_parallelFor_empty);
+      runUnit(test_parallelFor_everyIndexOnce);
+      runUnit(test_parallelFor_grain);
+      runUnit(test_parallelFor_nested);
+      runUnit(test_parallelFor_cancelled);
+      runUnit(test_parallelFor_exception);
+
+      report("ThreadPool");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // asking for no threads still gives us one
+   void test_construct_zero()
+   {  // exercise
+      custom::thread_pool pool(0);
+      // verify
+      assertUnit(pool.size() == 1);
+      assertUnit(pool.workers.size() == 1);
+      assertUnit(pool.threads.size() == 1);
+      assertUnit(pool.numQueued == 0);
+   }  // teardown
+
+   // one deque per worker
+   void test_construct_four()
+   {  // exercise
+      custom::thread_pool pool(4);
+      // verify
+      assertUnit(pool.size() == 4);
+      assertUnit(pool.workers.size() == 4);
+      assertUnit(pool.threads.size() == 4);
+      assertUnit(pool.numQueued == 0);
+      assertUnit(pool.done == false);
+   }  // teardown
+
+   // no two deques, nor the shared counts, share a cache line
+   void test_construct_cacheLines()
+   {  // exercise
+      custom::thread_pool pool(4);
+      // verify
+      bool aligned = true;
+      for (auto & pWorker : pool.workers)
+         aligned = aligned && reinterpret_cast<std::uintptr_t>(pWorker.get()) % 64 == 0;
+      assertUnit(aligned);
+      assertUnit(reinterpret_cast<std::uintptr_t>(&pool.numQueued) % 64 == 0);
+      assertUnit(reinterpret_cast<std::uintptr_t>(&pool.iNext) % 64 == 0);
+   }  // teardown
+
+   /***************************************
+    * EXECUTE
+    ***************************************/
+
+   // a submitted task runs before the pool is destroyed
+   void test_submit_one()
+   {  // setup
+      std::atomic<int> count(0);
+      {
+         custom::thread_pool pool(2);
+         // exercise
+         pool.submit([&]() { count++; });
+      }  // teardown waits for the task
+      // verify
+      assertUnit(count == 1);
+   }
+
+   // every one of many tasks runs exactly once
+   void test_submit_many()
+   {  // setup
+      std::atomic<int> count(0);
+      {
+         custom::thread_pool pool(3);
+         // exercise
+         for (int i = 0; i < 1000; i++)
+            pool.submit([&]() { count++; });
+      }  // teardown waits for the tasks
+      // verify
+      assertUnit(count == 1000);
+   }
+
+   // an empty range never calls the function
+   void test_parallelFor_empty()
+   {  // setup
+      custom::thread_pool pool(2);
+      std::atomic<int> count(0);
+      // exercise
+      pool.parallel_for(5, 5, 1, [&](size_t, size_t) { count++; });
+      // verify
+      assertUnit(count == 0);
+      assertUnit(pool.numQueued == 0);
+   }  // teardown
+
+   // every index is visited exactly once
+   void test_parallelFor_everyIndexOnce()
+   {  // setup
+      custom::thread_pool pool(4);
+      std::vector<std::atomic<int>> visits(1000);
+      for (auto & visit : visits)
+         visit = 0;
+      // exercise
+      pool.parallel_for(0, visits.size(), 7, [&](size_t iBegin, size_t iEnd)
+      {
+         for (size_t i = iBegin; i < iEnd; i++)
+            visits[i]++;
+      });
+      // verify
+      bool allOnce = true;
+      for (auto & visit : visits)
+         allOnce = allOnce && (visit == 1);
+      assertUnit(allOnce);
+      assertUnit(pool.numQueued == 0);
+   }  // teardown
+
+   // no chunk is bigger than the grain
+   void test_parallelFor_grain()
+   {  // setup
+      custom::thread_pool pool(2);
+      std::atomic<size_t> largest(0);
+      std::atomic<size_t> total(0);
+      // exercise
+      pool.parallel_for(0, 100, 8, [&](size_t iBegin, size_t iEnd)
+      {
+         size_t size = iEnd - iBegin;
+         size_t old = largest;
+         while (size > old && !largest.compare_exchange_weak(old, size))
+            ;
+         total += size;
+      });
+      // verify
+      assertUnit(largest <= 8);
+      assertUnit(largest > 0);
+      assertUnit(total == 100);
+   }  // teardown
+
+   // a task may itself run a parallel for without deadlocking
+   void test_parallelFor_nested()
+   {  // setup
+      custom::thread_pool pool(2);
+      std::atomic<int> count(0);
+      // exercise
+      pool.parallel_for(0, 4, 1, [&](size_t, size_t)
+      {
+         pool.parallel_for(0, 10, 1, [&](size_t, size_t) { count++; });
+      });
+      // verify
+      assertUnit(count == 40);
+   }  // teardown
+
+   // a cancelled parallel for does not start any chunks
+   void test_parallelFor_cancelled()
+   {  // setup
+      custom::thread_pool pool(2);
+      custom::cancellation cancel;
+      std::atomic<int> count(0);
+      cancel.cancel();
+      // exercise
+      pool.parallel_for(0, 100, 1, [&](size_t, size_t) { count++; }, &cancel);
+      // verify
+      assertUnit(count == 0);
+      assertUnit(cancel.cancelled());
+      assertUnit(pool.numQueued == 0);
+   }  // teardown
+
+   // an exception in one chunk reaches the caller
+   void test_parallelFor_exception()
+   {  // setup
+      custom::thread_pool pool(2);
+      bool thrown = false;
+      // exercise
+      try
+      {
+         pool.parallel_for(0, 100, 1, [&](size_t iBegin, size_t)
+         {
+            if (iBegin == 42)
+               throw std::runtime_error("42");
+         });
+      }
+      catch (const std::runtime_error &)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(pool.numQueued == 0);
+   }  // teardown
+};
+
+#endif // DEBUG
@@ -0,0 +1,302 @@
+/***********************************************************************
+ * Header:
+ *    TEST TRACE
+ * Summary:
+ *    Unit tests for recording and replaying traces
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "trace.h"
+#include "hash.h"
+#include "unitTest.h"
+
+#include <sstream>
+#include <string>
+#include <unordered_set>
+
+class TestTrace : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Record
+      runUnit(test_record_empty);
+      runUnit(test_record_two);
+      runUnit(test_record_flush);
+
+      // Read
+      runUnit(test_read_roundTrip);
+      runUnit(test_read_notTrace);
+      runUnit(test_read_truncated);
+      runUnit(test_read_badOp);
+
+      // Replay
+      runUnit(test_replay_custom);
+      runUnit(test_replay_std);
+#ifdef HASH_TRACE
+      runUnit(test_unorderedSet_records);
+      runUnit(test_unorderedSet_recordsClearAsync);
+#endif // HASH_TRACE
+
+      report("Trace");
+   }
+
+   /***************************************
+    * RECORD
+    ***************************************/
+
+   // a trace with nothing in it is just the header
+   void test_record_empty()
+   {  // setup
+      std::ostringstream out;
+      // exercise
+      {
+         custom::trace_recorder recorder(out);
+      }
+      // verify
+      assertUnit(out.str() == std::string("HTRACE01"));
+   }  // teardown
+
+   // each record is the operation then the key, low byte first
+   void test_record_two()
+   {  // setup
+      std::ostringstream out;
+      std::string trace;
+      size_t size;
+      // exercise
+      {
+         custom::trace_recorder recorder(out);
+         recorder.record(custom::TRACE_FIND, 0x0102030405060708ULL);
+         recorder.record(custom::TRACE_ERASE, 9);
+         size = recorder.size();
+      }
+      trace = out.str();
+      // verify
+      assertUnit(size == 2);
+      assertUnit(trace.size() == 8 + 2 * 9);
+      assertUnit(trace[8]  == custom::TRACE_FIND);
+      assertUnit(trace[9]  == 0x08);
+      assertUnit(trace[16] == 0x01);
+      assertUnit(trace[17] == custom::TRACE_ERASE);
+      assertUnit(trace[18] == 9);
+      assertUnit(trace[25] == 0);
+   }  // teardown
+
+   // nothing reaches the stream until the buffer is full or flushed
+   void test_record_flush()
+   {  // setup
+      std::ostringstream out;
+      custom::trace_recorder recorder(out);
+      recorder.record(custom::TRACE_INSERT, 1);
+      assertUnit(out.str().size() == 8);
+      assertUnit(recorder.buffer.size() == 9);
+      // exercise
+      recorder.flush();
+      // verify
+      assertUnit(out.str().size() == 8 + 9);
+      assertUnit(recorder.buffer.empty());
+   }  // teardown
+
+   /***************************************
+    * READ
+    ***************************************/
+
+   // what goes in comes back out
+   void test_read_roundTrip()
+   {  // setup
+      std::stringstream stream;
+      {
+         custom::trace_recorder recorder(stream);
+         recorder.record(custom::TRACE_INSERT, 42);
+         recorder.record(custom::TRACE_FIND, 0xffffffffffffffffULL);
+         recorder.record(custom::TRACE_CLEAR, 0);
+      }
+      std::vector<custom::trace_record> records;
+      // exercise
+      records = custom::read_trace(stream);
+      // verify
+      assertUnit(records.size() == 3);
+      assertUnit(records[0].op == custom::TRACE_INSERT);
+      assertUnit(records[0].key == 42);
+      assertUnit(records[1].op == custom::TRACE_FIND);
+      assertUnit(records[1].key == 0xffffffffffffffffULL);
+      assertUnit(records[2].op == custom::TRACE_CLEAR);
+      assertUnit(records[2].key == 0);
+   }  // teardown
+
+   // anything without the header is refused
+   void test_read_notTrace()
+   {  // setup
+      std::istringstream in("not a trace at all");
+      const char * error = nullptr;
+      // exercise
+      try
+      {
+         custom::read_trace(in);
+      }
+      catch (const char * e)
+      {
+         error = e;
+      }
+      // verify
+      assertUnit(error != nullptr);
+   }  // teardown
+
+   // half a record is an error, not a short trace
+   void test_read_truncated()
+   {  // setup
+      std::istringstream in(std::string("HTRACE01") + std::string(5, '\0'));
+      const char * error = nullptr;
+      // exercise
+      try
+      {
+         custom::read_trace(in);
+      }
+      catch (const char * e)
+      {
+         error = e;
+      }
+      // verify
+      assertUnit(error != nullptr);
+   }  // teardown
+
+   // an operation we do not know about is an error
+   void test_read_badOp()
+   {  // setup
+      std::istringstream in(std::string("HTRACE01") + std::string(1, '\x07') + std::string(8, '\0'));
+      const char * error = nullptr;
+      // exercise
+      try
+      {
+         custom::read_trace(in);
+      }
+      catch (const char * e)
+      {
+         error = e;
+      }
+      // verify
+      assertUnit(error != nullptr);
+   }  // teardown
+
+   /***************************************
+    * REPLAY
+    ***************************************/
+
+   // insert 1 2 3, find 2 and 9, erase 2, find 2
+   static std::vector<custom::trace_record> standardTrace()
+   {
+      return std::vector<custom::trace_record>
+      {
+         { custom::TRACE_INSERT, 1 },
+         { custom::TRACE_INSERT, 2 },
+         { custom::TRACE_INSERT, 3 },
+         { custom::TRACE_FIND,   2 },
+         { custom::TRACE_FIND,   9 },
+         { custom::TRACE_ERASE,  2 },
+         { custom::TRACE_FIND,   2 }
+      };
+   }
+
+   // the trace leaves our set the way it would any other
+   void test_replay_custom()
+   {  // setup
+      custom::unordered_set<std::size_t> us;
+      custom::replay_result result;
+      // exercise
+      result = custom::replay(standardTrace(), us);
+      // verify
+      assertUnit(result.numOps == 7);
+      assertUnit(result.numHits == 1);
+      assertUnit(result.ops[custom::TRACE_INSERT].numOps == 3);
+      assertUnit(result.ops[custom::TRACE_FIND].numOps == 3);
+      assertUnit(result.ops[custom::TRACE_ERASE].numOps == 1);
+      assertUnit(result.ops[custom::TRACE_CLEAR].numOps == 0);
+      assertUnit(result.ops[custom::TRACE_FIND].p50 <= result.ops[custom::TRACE_FIND].max);
+      assertUnit(us.size() == 2);
+      assertUnit(us.find(1) != us.end());
+      assertUnit(us.find(2) == us.end());
+      assertUnit(us.find(3) != us.end());
+   }  // teardown
+
+   // any set will do
+   void test_replay_std()
+   {  // setup
+      std::unordered_set<std::size_t> us;
+      custom::replay_result result;
+      // exercise
+      result = custom::replay(standardTrace(), us);
+      // verify
+      assertUnit(result.numOps == 7);
+      assertUnit(result.numHits == 1);
+      assertUnit(us.size() == 2);
+      assertUnit(us.count(2) == 0);
+   }  // teardown
+
+#ifdef HASH_TRACE
+   // the set records what is done to it, and a copy does not
+   void test_unorderedSet_records()
+   {  // setup
+      std::stringstream stream;
+      custom::unordered_set<std::size_t> us;
+      std::vector<custom::trace_record> records;
+      {
+         custom::trace_recorder recorder(stream);
+         us.trace(&recorder);
+         // exercise
+         us.insert(5);
+         us.find(5);
+         us.erase(5);
+         us.clear();
+         custom::unordered_set<std::size_t> usCopy(us);
+         usCopy.insert(6);
+         us.trace(nullptr);
+         us.insert(7);
+      }
+      records = custom::read_trace(stream);
+      // verify
+      assertUnit(records.size() == 4);
+      if (records.size() == 4)
+      {
+         assertUnit(records[0].op == custom::TRACE_INSERT);
+         assertUnit(records[0].key == std::hash<std::size_t>()(5));
+         assertUnit(records[1].op == custom::TRACE_FIND);
+         assertUnit(records[2].op == custom::TRACE_ERASE);
+         assertUnit(records[3].op == custom::TRACE_CLEAR);
+      }
+   }  // teardown
+
+   // a clear on the pool is traced like any other clear
+   void test_unorderedSet_recordsClearAsync()
+   {  // setup
+      std::stringstream stream;
+      custom::unordered_set<std::size_t> us;
+      us.insert(5);
+      us.insert(6);
+      std::vector<custom::trace_record> records;
+      {
+         custom::thread_pool pool(2);
+         custom::trace_recorder recorder(stream);
+         us.trace(&recorder);
+         // exercise
+         us.clear_async(pool);
+         us.trace(nullptr);
+      }
+      records = custom::read_trace(stream);
+      // verify
+      assertUnit(records.size() == 1);
+      if (records.size() == 1)
+      {
+         assertUnit(records[0].op == custom::TRACE_CLEAR);
+         assertUnit(records[0].key == 0);
+      }
+      assertUnit(us.empty());
+   }  // teardown
+#endif // HASH_TRACE
+};
+
+#endif // DEBUG
@@ -0,0 +1,630 @@
+/***********************************************************************
+ * Header:
+ *    TEST UNROLLED LIST
+ * Summary:
+ *    Unit tests for unrolled_list
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "unrolledList.h"
+#include "unitTest.h"
+
+#include <list>
+#include <string>
+#include <vector>
+
+// the elements of each chunk, front to back
+#define assertChunks(l, ...)     assertChunksParameters(l, { __VA_ARGS__ }, __LINE__, __FUNCTION__)
+
+class TestUnrolledList : public UnitTest
+{
+public:
+   // 40 bytes is room for two pointers, a count, and four ints
+   typedef custom::unrolled_list<int, 40> List;
+
+   void run()
+   {
+      reset();
+
+      // Construct
+      runUnit(test_capacity);
+      runUnit(test_construct_default);
+      runUnit(test_construct_init);
+      runUnit(test_constructCopy_standard);
+      runUnit(test_constructMove_standard);
+      runUnit(test_assign_copy);
+      runUnit(test_assign_init);
+
+      // Iterator
+      runUnit(test_iterator_forward);
+      runUnit(test_iterator_backward);
+
+      // Access
+      runUnit(test_front_empty);
+      runUnit(test_back_standard);
+
+      // Insert
+      runUnit(test_pushBack_fillsChunks);
+      runUnit(test_pushFront_newChunk);
+      runUnit(test_insert_roomInChunk);
+      runUnit(test_insert_split);
+      runUnit(test_insert_beforeFullChunk);
+      runUnit(test_emplace_string);
+      runUnit(test_emplace_throwEmpty);
+      runUnit(test_emplace_throwNewChunk);
+      runUnit(test_emplace_throwSplit);
+
+      // Remove
+      runUnit(test_erase_shift);
+      runUnit(test_erase_freeChunk);
+      runUnit(test_erase_merge);
+      runUnit(test_erase_throwMerge);
+      runUnit(test_erase_all);
+      runUnit(test_popBack_popFront);
+
+      // Against std::list
+      runUnit(test_random_operations);
+
+      // Allocations
+      runUnit(test_allocations_pushBack);
+      runUnit(test_allocations_clear);
+
+      report("UnrolledList");
+   }
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // whatever is left of ChunkBytes holds elements
+   void test_capacity()
+   {  // exercise and verify
+      assertUnit(List::capacity() == 4);
+      assertUnit(List::chunk_size() == 40);
+      assertUnit((custom::unrolled_list<int, 8>::capacity() == 1));
+      assertUnit((custom::unrolled_list<char, 256>::capacity() == 256 - List::HEADER));
+   }
+
+   // no chunks at all
+   void test_construct_default()
+   {  // exercise
+      List l;
+      // verify
+      assertUnit(l.empty());
+      assertUnit(l.size() == 0);
+      assertUnit(l.pHead == nullptr);
+      assertUnit(l.pTail == nullptr);
+      assertUnit(l.begin() == l.end());
+   }  // teardown
+
+   // every chunk but the last is full
+   void test_construct_init()
+   {  // exercise
+      List l{ 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+      // verify
+      assertChunks(l, { 1, 2, 3, 4 }, { 5, 6, 7, 8 }, { 9 });
+   }  // teardown
+
+   // a copy has its own chunks
+   void test_constructCopy_standard()
+   {  // setup
+      List lSrc{ 1, 2, 3, 4, 5 };
+      // exercise
+      List lDest(lSrc);
+      // verify
+      assertChunks(lDest, { 1, 2, 3, 4 }, { 5 });
+      assertChunks(lSrc, { 1, 2, 3, 4 }, { 5 });
+      assertUnit(lDest.pHead != lSrc.pHead);
+   }  // teardown
+
+   // a move takes them
+   void test_constructMove_standard()
+   {  // setup
+      List lSrc{ 1, 2, 3, 4, 5 };
+      List::Chunk * pHead = lSrc.pHead;
+      // exercise
+      List lDest(std::move(lSrc));
+      // verify
+      assertChunks(lDest, { 1, 2, 3, 4 }, { 5 });
+      assertUnit(lDest.pHead == pHead);
+      assertUnit(lSrc.empty());
+      assertUnit(lSrc.pHead == nullptr);
+   }  // teardown
+
+   // assignment replaces everything
+   void test_assign_copy()
+   {  // setup
+      List lSrc{ 1, 2, 3, 4, 5 };
+      List lDest{ 99, 98 };
+      // exercise
+      lDest = lSrc;
+      // verify
+      assertChunks(lDest, { 1, 2, 3, 4 }, { 5 });
+      assertChunks(lSrc, { 1, 2, 3, 4 }, { 5 });
+   }  // teardown
+
+   void test_assign_init()
+   {  // setup
+      List l{ 1, 2, 3, 4, 5 };
+      // exercise
+      l = { 7, 8 };
+      // verify
+      assertChunks(l, { 7, 8 });
+   }  // teardown
+
+   /***************************************
+    * ITERATOR
+    ***************************************/
+
+   // across chunk boundaries and off the end
+   void test_iterator_forward()
+   {  // setup
+      List l{ 1, 2, 3, 4, 5, 6 };
+      std::vector<int> seen;
+      // exercise
+      for (List::iterator it = l.begin(); it != l.end(); ++it)
+         seen.push_back(*it);
+      // verify
+      assertUnit(seen == std::vector<int>({ 1, 2, 3, 4, 5, 6 }));
+   }  // teardown
+
+   // from the back of the second chunk to the front of the first
+   void test_iterator_backward()
+   {  // setup
+      List l{ 1, 2, 3, 4, 5, 6 };
+      List::iterator it(l.pTail, 1);
+      std::vector<int> seen;
+      // exercise
+      for (; it != l.end(); --it)
+         seen.push_back(*it);
+      // verify
+      assertUnit(seen == std::vector<int>({ 6, 5, 4, 3, 2, 1 }));
+   }  // teardown
+
+   /***************************************
+    * ACCESS
+    ***************************************/
+
+   // nothing there to get
+   void test_front_empty()
+   {  // setup
+      List l;
+      bool thrown = false;
+      // exercise
+      try
+      {
+         l.front();
+      }
+      catch (const char * error)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+   }  // teardown
+
+   // the last slot used in the last chunk
+   void test_back_standard()
+   {  // setup
+      List l{ 1, 2, 3, 4, 5, 6 };
+      // exercise
+      l.back() = 99;
+      // verify
+      assertUnit(l.front() == 1);
+      assertChunks(l, { 1, 2, 3, 4 }, { 5, 99 });
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // appending never leaves a gap
+   void test_pushBack_fillsChunks()
+   {  // setup
+      List l;
+      // exercise
+      for (int i = 1; i <= 10; i++)
+         l.push_back(i);
+      // verify
+      assertChunks(l, { 1, 2, 3, 4 }, { 5, 6, 7, 8 }, { 9, 10 });
+   }  // teardown
+
+   // a full first chunk gets a new one in front of it
+   void test_pushFront_newChunk()
+   {  // setup
+      List l{ 1, 2, 3, 4 };
+      // exercise
+      l.push_front(0);
+      l.push_front(-1);
+      // verify
+      assertChunks(l, { -1, 0 }, { 1, 2, 3, 4 });
+   }  // teardown
+
+   // the rest of the chunk moves over one
+   void test_insert_roomInChunk()
+   {  // setup
+      List l{ 1, 2, 3 };
+      List::iterator it(l.pHead, 1);
+      // exercise
+      List::iterator itReturn = l.insert(it, 99);
+      // verify
+      assertChunks(l, { 1, 99, 2, 3 });
+      assertUnit(itReturn == List::iterator(l.pHead, 1));
+   }  // teardown
+
+   // a full chunk splits, and the new one lands in the front half
+   void test_insert_split()
+   {  // setup
+      List l{ 1, 2, 3, 4, 5 };
+      List::iterator it(l.pHead, 2);
+      // exercise
+      List::iterator itReturn = l.insert(it, 99);
+      // verify
+      assertChunks(l, { 1, 2, 99 }, { 3, 4 }, { 5 });
+      assertUnit(*itReturn == 99);
+      // and in the back half
+      itReturn = l.insert(List::iterator(l.pHead, 2), 98);
+      itReturn = l.insert(List::iterator(l.pHead, 3), 97);
+      assertChunks(l, { 1, 2 }, { 98, 97, 99 }, { 3, 4 }, { 5 });
+      assertUnit(*itReturn == 97);
+   }  // teardown
+
+   // in front of a full chunk goes on the end of the one before
+   void test_insert_beforeFullChunk()
+   {  // setup
+      List l{ 1, 2, 3, 4, 5, 6, 7, 8 };
+      l.erase(List::iterator(l.pHead, 3));
+      // exercise
+      List::iterator itReturn = l.insert(List::iterator(l.pTail, 0), 99);
+      // verify
+      assertChunks(l, { 1, 2, 3, 99 }, { 5, 6, 7, 8 });
+      assertUnit(itReturn == List::iterator(l.pHead, 3));
+   }  // teardown
+
+   // something with a real constructor and destructor
+   void test_emplace_string()
+   {  // setup
+      custom::unrolled_list<std::string, 128> l;
+      // exercise
+      for (int i = 0; i < 20; i++)
+         l.emplace_back(i + 1, 'x');
+      l.emplace(l.begin(), "first");
+      // verify
+      assertUnit(l.size() == 21);
+      assertUnit(l.front() == "first");
+      assertUnit(l.back() == std::string(20, 'x'));
+   }  // teardown
+
+   // throws from its constructor when handed a negative number
+   struct Positive
+   {
+      Positive(int value) : value(value)
+      {
+         if (value < 0)
+            throw "ERROR: not positive";
+      }
+      int value;
+   };
+
+   // will not copy or move a negative number
+   struct Brittle
+   {
+      Brittle(int value) : value(value) {}
+      Brittle(const Brittle & rhs) : value(rhs.value) { check(); }
+      Brittle(Brittle && rhs) : value(rhs.value)      { check(); }
+      Brittle & operator = (const Brittle & rhs) = default;
+      Brittle & operator = (Brittle && rhs) = default;
+      void check() const
+      {
+         if (value < 0)
+            throw "ERROR: not positive";
+      }
+      int value;
+   };
+
+   // the first chunk is never linked if its first element cannot be built
+   void test_emplace_throwEmpty()
+   {  // setup
+      long long bytesLive = AllocationCounters::current().bytesLive;
+      custom::unrolled_list<Positive, 40> l;
+      bool thrown = false;
+      // exercise
+      try
+      {
+         l.emplace_back(-1);
+      }
+      catch (const char *)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(AllocationCounters::current().bytesLive == bytesLive);
+      assertUnit(thrown);
+      assertUnit(l.empty());
+      assertUnit(l.begin() == l.end());
+      assertUnit(l.pHead == nullptr);
+      assertUnit(l.pTail == nullptr);
+   }  // teardown
+
+   // nor is one past a full chunk, at either end
+   void test_emplace_throwNewChunk()
+   {  // setup
+      custom::unrolled_list<Positive, 40> l;
+      for (int i = 0; i < 4; i++)
+         l.emplace_back(i);
+      assertUnit(l.pHead == l.pTail && l.pHead->full());
+      int numThrown = 0;
+      // exercise
+      try
+      {
+         l.emplace_back(-1);
+      }
+      catch (const char *)
+      {
+         numThrown++;
+      }
+      try
+      {
+         l.emplace(l.begin(), -1);
+      }
+      catch (const char *)
+      {
+         numThrown++;
+      }
+      // verify
+      assertUnit(numThrown == 2);
+      assertUnit(l.size() == 4);
+      assertUnit(l.pHead == l.pTail);
+      assertUnit(l.pHead->pPrev == nullptr && l.pHead->pNext == nullptr);
+      int sum = 0;
+      for (auto it = l.begin(); it != l.end(); ++it)
+         sum += (*it).value;
+      assertUnit(sum == 0 + 1 + 2 + 3);
+   }  // teardown
+
+   // a split that cannot copy the back half leaves the chunk whole
+   void test_emplace_throwSplit()
+   {  // setup
+      custom::unrolled_list<Brittle, 40> l;
+      for (int i : { 1, 2, 3, -4 })
+         l.emplace_back(i);
+      long long bytesLive = AllocationCounters::current().bytesLive;
+      bool thrown = false;
+      // exercise
+      try
+      {
+         auto it = l.begin();
+         ++it;
+         ++it;
+         l.emplace(it, 99);
+      }
+      catch (const char *)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(AllocationCounters::current().bytesLive == bytesLive);
+      assertUnit(thrown);
+      assertUnit(l.size() == 4);
+      assertUnit(l.pHead == l.pTail && l.pHead->numUsed == 4);
+      assertUnit(l.pHead->at(2).value == 3);
+      assertUnit(l.pHead->at(3).value == -4);
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    ***************************************/
+
+   // the rest of the chunk moves back one
+   void test_erase_shift()
+   {  // setup
+      List l{ 1, 2, 3, 4, 5 };
+      // exercise
+      List::iterator itReturn = l.erase(List::iterator(l.pHead, 1));
+      // verify
+      assertChunks(l, { 1, 3, 4 }, { 5 });
+      assertUnit(*itReturn == 3);
+      // the last of a chunk returns the first of the next
+      itReturn = l.erase(List::iterator(l.pHead, 2));
+      assertChunks(l, { 1, 3 }, { 5 });
+      assertUnit(itReturn == List::iterator(l.pTail, 0));
+   }  // teardown
+
+   // erasing the only element of a chunk frees it
+   void test_erase_freeChunk()
+   {  // setup
+      List l{ 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+      // exercise
+      List::iterator itReturn = l.erase(List::iterator(l.pTail, 0));
+      // verify
+      assertChunks(l, { 1, 2, 3, 4 }, { 5, 6, 7, 8 });
+      assertUnit(itReturn == l.end());
+   }  // teardown
+
+   // below half full takes in the next chunk
+   void test_erase_merge()
+   {  // setup
+      List l{ 1, 2, 3, 4, 5, 6 };
+      l.erase(l.begin());
+      l.erase(l.begin());
+      assertChunks(l, { 3, 4 }, { 5, 6 });
+      // exercise
+      List::iterator itReturn = l.erase(l.begin());
+      // verify
+      assertChunks(l, { 4, 5, 6 });
+      assertUnit(itReturn == List::iterator(l.pHead, 0));
+      assertUnit(*itReturn == 4);
+   }  // teardown
+
+   // the erase goes through even when the next chunk cannot be copied in
+   void test_erase_throwMerge()
+   {  // setup
+      custom::unrolled_list<Brittle, 40> l;
+      for (int i : { 1, 2, 3, 4, -5, 6 })
+         l.emplace_back(i);
+      l.erase(l.begin());
+      l.erase(l.begin());
+      // exercise
+      auto itReturn = l.erase(l.begin());
+      // verify
+      assertUnit(l.size() == 3);
+      assertUnit(l.pHead->numUsed == 1 && l.pHead->at(0).value == 4);
+      assertUnit(l.pTail->numUsed == 2 && l.pTail->at(0).value == -5);
+      assertUnit(l.pHead->pNext == l.pTail && l.pTail->pPrev == l.pHead);
+      assertUnit(itReturn == l.begin());
+   }  // teardown
+
+   // down to nothing
+   void test_erase_all()
+   {  // setup
+      List l{ 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+      // exercise
+      List::iterator it = l.begin();
+      while (it != l.end())
+         it = l.erase(it);
+      // verify
+      assertUnit(l.empty());
+      assertUnit(l.pHead == nullptr);
+      assertUnit(l.pTail == nullptr);
+   }  // teardown
+
+   // from either end, and nothing from nothing
+   void test_popBack_popFront()
+   {  // setup
+      List l{ 1, 2, 3, 4, 5 };
+      List lEmpty;
+      // exercise
+      l.pop_back();
+      l.pop_front();
+      lEmpty.pop_back();
+      lEmpty.pop_front();
+      // verify
+      assertChunks(l, { 2, 3, 4 });
+      assertUnit(lEmpty.empty());
+   }  // teardown
+
+   /***************************************
+    * AGAINST STD::LIST
+    ***************************************/
+
+   // thousands of inserts and erases anywhere give what std::list gives
+   void test_random_operations()
+   {  // setup
+      List l;
+      std::list<int> expected;
+      unsigned seed = 12345;
+      auto random = [&seed](size_t max) -> size_t
+      {
+         seed = seed * 1103515245 + 12345;
+         return max ? (seed >> 8) % max : 0;
+      };
+      // exercise
+      for (int i = 0; i < 3000; i++)
+      {
+         size_t pos = random(expected.size() + 1);
+         List::iterator it = l.begin();
+         std::list<int>::iterator itExpected = expected.begin();
+         for (size_t j = 0; j < pos; j++, ++it, ++itExpected)
+            ;
+         if (random(3) != 0 || it == l.end())
+         {
+            l.insert(it, i);
+            expected.insert(itExpected, i);
+         }
+         else
+         {
+            l.erase(it);
+            expected.erase(itExpected);
+         }
+      }
+      // verify
+      assertUnit(l.size() == expected.size());
+      bool same = true;
+      size_t numElements = 0;
+      List::iterator it = l.begin();
+      for (int value : expected)
+      {
+         if (it == l.end() || *it != value)
+            same = false;
+         ++it;
+      }
+      for (List::Chunk * p = l.pHead; p; p = p->pNext)
+      {
+         numElements += p->numUsed;
+         if (p->numUsed == 0)
+            same = false;
+      }
+      assertUnit(same);
+      assertUnit(it == l.end());
+      assertUnit(numElements == l.size());
+   }  // teardown
+
+   /***************************************
+    * ALLOCATIONS
+    ***************************************/
+
+   // one allocation per chunk, not per element
+   void test_allocations_pushBack()
+   {  // setup
+      List l;
+      trackAllocations();
+      size_t numAlloc = AllocationCounters::current().numAlloc;
+      // exercise
+      for (int i = 0; i < 100; i++)
+         l.push_back(i);
+      numAlloc = AllocationCounters::current().numAlloc - numAlloc;
+      // verify
+      assertAllocations(25);
+#ifdef UNIT_TEST_ALLOCATIONS
+      assertUnit(numAlloc == 25);
+#endif // UNIT_TEST_ALLOCATIONS
+      assertUnit(l.size() == 100);
+   }  // teardown
+
+   // every chunk and every string in it goes away
+   void test_allocations_clear()
+   {  // setup
+      long long bytesLive = AllocationCounters::current().bytesLive;
+      custom::unrolled_list<std::string, 128> l;
+      for (int i = 0; i < 100; i++)
+         l.emplace_back(100, 'x');
+      // exercise
+      l.clear();
+      // verify
+      assertUnit(AllocationCounters::current().bytesLive == bytesLive);
+      assertUnit(l.empty());
+   }  // teardown
+
+   /****************************************************************
+    * Verify Chunks
+    * Walk the chunks both ways, checking every link and every value
+    ****************************************************************/
+   void assertChunksParameters(const List & l, const std::vector<std::vector<int>> & chunks,
+                               int line, const char * function)
+   {
+      size_t numElements = 0;
+      const List::Chunk * pPrev = nullptr;
+      const List::Chunk * p = l.pHead;
+      for (size_t i = 0; i < chunks.size(); i++)
+      {
+         assertIndirect(p != nullptr);
+         if (!p)
+            return;
+         assertIndirect(p->pPrev == pPrev);
+         assertIndirect(p->numUsed == chunks[i].size());
+         for (size_t j = 0; j < chunks[i].size() && j < p->numUsed; j++)
+            assertIndirect(const_cast<List::Chunk *>(p)->at(j) == chunks[i][j]);
+         numElements += chunks[i].size();
+         pPrev = p;
+         p = p->pNext;
+      }
+      assertIndirect(p == nullptr);
+      assertIndirect(l.pTail == pPrev);
+      assertIndirect(l.numElements == numElements);
+   }
+};
+
+#endif // DEBUG
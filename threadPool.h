@@ -0,0 +1,338 @@
+/***********************************************************************
+ * Header:
+ *    THREAD POOL
+ * Summary:
+ *    A small work-stealing thread pool shared by the containers
+ *
+ *    This will contain the class definition of:
+ *        thread_pool  : A fixed set of workers, each with its own deque
+ *        cancellation : A flag to stop a parallel_for early
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>            // for ASSERT
+#include <vector>             // for std::vector
+#include <deque>              // for std::deque
+#include <memory>             // for std::unique_ptr
+#include <functional>         // for std::function
+#include <thread>             // for std::thread
+#include <mutex>              // for std::mutex
+#include <condition_variable> // for std::condition_variable
+#include <atomic>             // for std::atomic
+#include <exception>          // for std::exception_ptr
+#include <cstdint>            // for std::uintptr_t
+#include <cstring>            // for std::memcpy
+
+namespace custom
+{
+
+/**************************************************
+ * CANCELLATION
+ * Cooperative cancellation: whoever owns the work calls
+ * cancel(), and the work checks cancelled() when it can
+ **************************************************/
+class cancellation
+{
+public:
+   cancellation() : flag(false) {}
+
+   void cancel()          noexcept { flag.store(true,  std::memory_order_relaxed); }
+   void reset()           noexcept { flag.store(false, std::memory_order_relaxed); }
+   bool cancelled() const noexcept { return flag.load(std::memory_order_relaxed); }
+
+private:
+   std::atomic<bool> flag;
+};
+
+/**************************************************
+ * THREAD POOL
+ * Every worker owns a deque of tasks. A worker pushes and pops
+ * at the back of its own deque (so recently split work stays hot
+ * in its cache) and, when that runs dry, steals from the front
+ * of the other workers' deques.
+ **************************************************/
+class thread_pool
+{
+public:
+   //
+   // Construct
+   //
+
+   thread_pool(size_t numThreads = std::thread::hardware_concurrency());
+  ~thread_pool();
+   thread_pool(const thread_pool &) = delete;
+   thread_pool & operator = (const thread_pool &) = delete;
+
+   // the pool the containers use when they are not handed one
+   static thread_pool & global()
+   {
+      static thread_pool pool;
+      return pool;
+   }
+
+   //
+   // Execute
+   //
+
+   template <class Function>
+   void submit(Function function);   // function must not throw
+   template <class Function>
+   void parallel_for(size_t begin, size_t end, size_t grain, Function function,
+                     cancellation * pCancel = nullptr);
+
+   //
+   // Status
+   //
+
+   size_t size()       const { return workers.size();  }
+   size_t num_steals() const { return numSteals.load(); }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   typedef std::function<void()> Task;
+
+   // one worker's deque of tasks, on cache lines no other worker
+   // touches. Plain new only lines up to alignof(std::max_align_t)
+   // before C++17, so a Worker finds its own line in a bigger block
+   // and keeps the start of that block just in front of itself
+   struct alignas(64) Worker
+   {
+      std::mutex       mutex;
+      std::deque<Task> tasks;
+
+      static void * operator new(size_t size)
+      {
+         char * pBlock = static_cast<char *>(::operator new(size + alignof(Worker)));
+         char * p = pBlock + alignof(Worker) -
+                    reinterpret_cast<std::uintptr_t>(pBlock) % alignof(Worker);
+         std::memcpy(p - sizeof(pBlock), &pBlock, sizeof(pBlock));
+         return p;
+      }
+      static void operator delete(void * p)
+      {
+         char * pBlock;
+         std::memcpy(&pBlock, static_cast<char *>(p) - sizeof(pBlock), sizeof(pBlock));
+         ::operator delete(pBlock);
+      }
+   };
+
+   bool pop(size_t iWorker, Task & task);
+   bool steal(size_t iThief, Task & task);
+   bool runOne();
+   void work(size_t iWorker);
+
+   // which worker of which pool is the current thread, if any
+   static thread_pool *& currentPool()   { static thread_local thread_pool * p = nullptr; return p; }
+   static size_t       & currentWorker() { static thread_local size_t i = 0;              return i; }
+
+   std::vector<std::unique_ptr<Worker>> workers; // one deque per thread
+   std::vector<std::thread> threads;             // the threads themselves
+   alignas(64) std::atomic<size_t> numQueued;    // tasks sitting in some deque
+   alignas(64) std::atomic<size_t> numSteals;    // tasks taken from another deque
+   alignas(64) std::atomic<size_t> iNext;        // round robin for outside submits
+   alignas(64) std::mutex mutexSleep;            // guards sleeping and done
+   std::condition_variable wake;                 // signaled when there is work
+   bool done;                                    // time for the workers to go home
+};
+
+/*****************************************
+ * THREAD POOL :: CONSTRUCTOR
+ * Start the workers
+ ****************************************/
+inline thread_pool::thread_pool(size_t numThreads)
+   : numQueued(0), numSteals(0), iNext(0), done(false)
+{
+   if (numThreads == 0)
+      numThreads = 1;
+   for (size_t i = 0; i < numThreads; i++)
+      workers.push_back(std::unique_ptr<Worker>(new Worker));
+   for (size_t i = 0; i < numThreads; i++)
+      threads.push_back(std::thread(&thread_pool::work, this, i));
+}
+
+/*****************************************
+ * THREAD POOL :: DESTRUCTOR
+ * Let the workers finish whatever is queued, then join them
+ ****************************************/
+inline thread_pool::~thread_pool()
+{
+   {
+      std::lock_guard<std::mutex> lock(mutexSleep);
+      done = true;
+   }
+   wake.notify_all();
+   for (auto & thread : threads)
+      thread.join();
+}
+
+/*****************************************
+ * THREAD POOL :: SUBMIT
+ * Queue one task. From inside a worker it goes on that worker's
+ * own deque, otherwise the deques take turns
+ ****************************************/
+template <class Function>
+void thread_pool::submit(Function function)
+{
+   size_t iWorker = (currentPool() == this ? currentWorker()
+                                           : iNext++ % workers.size());
+   numQueued++;
+   {
+      std::lock_guard<std::mutex> lock(workers[iWorker]->mutex);
+      workers[iWorker]->tasks.push_back(Task(std::move(function)));
+   }
+
+   // take the lock so a worker about to sleep cannot miss this
+   {
+      std::lock_guard<std::mutex> lock(mutexSleep);
+   }
+   wake.notify_one();
+}
+
+/*****************************************
+ * THREAD POOL :: PARALLEL FOR
+ * Call function(iBegin, iEnd) on chunks of [begin, end) no bigger
+ * than grain. The range is split in half recursively, so idle workers
+ * steal big pieces and the owner keeps the small ones. The calling
+ * thread helps out until every chunk is done, so this may be called
+ * from inside a task. Once pCancel is cancelled, chunks that have not
+ * started are skipped. The first exception thrown by function cancels
+ * the rest and is rethrown here.
+ ****************************************/
+template <class Function>
+void thread_pool::parallel_for(size_t begin, size_t end, size_t grain,
+                               Function function, cancellation * pCancel)
+{
+   if (begin >= end)
+      return;
+   if (grain == 0)
+      grain = 1;
+
+   // everything the chunks share
+   struct Group
+   {
+      alignas(64) std::atomic<size_t> numPending;
+      cancellation        cancel;
+      std::mutex          mutexError;
+      std::exception_ptr  error;
+   } group;
+   group.numPending = 1;
+
+   // split [iBegin, iEnd) until it is small enough, then run it
+   std::function<void(size_t, size_t)> split = [&](size_t iBegin, size_t iEnd)
+   {
+      while (iEnd - iBegin > grain)
+      {
+         size_t iMiddle = iBegin + (iEnd - iBegin) / 2;
+         group.numPending++;
+         submit([&split, iMiddle, iEnd]() { split(iMiddle, iEnd); });
+         iEnd = iMiddle;
+      }
+
+      if (!group.cancel.cancelled() && !(pCancel && pCancel->cancelled()))
+      {
+         try
+         {
+            function(iBegin, iEnd);
+         }
+         catch (...)
+         {
+            std::lock_guard<std::mutex> lock(group.mutexError);
+            if (!group.error)
+               group.error = std::current_exception();
+            group.cancel.cancel();
+         }
+      }
+      group.numPending--;
+   };
+
+   // the caller takes the first piece and then helps with the rest
+   split(begin, end);
+   while (group.numPending.load() != 0)
+      if (!runOne())
+         std::this_thread::yield();
+
+   if (group.error)
+      std::rethrow_exception(group.error);
+}
+
+/*****************************************
+ * THREAD POOL :: POP
+ * Take the newest task off our own deque
+ ****************************************/
+inline bool thread_pool::pop(size_t iWorker, Task & task)
+{
+   std::lock_guard<std::mutex> lock(workers[iWorker]->mutex);
+   if (workers[iWorker]->tasks.empty())
+      return false;
+   task = std::move(workers[iWorker]->tasks.back());
+   workers[iWorker]->tasks.pop_back();
+   numQueued--;
+   return true;
+}
+
+/*****************************************
+ * THREAD POOL :: STEAL
+ * Take the oldest task off somebody else's deque
+ ****************************************/
+inline bool thread_pool::steal(size_t iThief, Task & task)
+{
+   for (size_t i = 1; i <= workers.size(); i++)
+   {
+      size_t iVictim = (iThief + i) % workers.size();
+      std::lock_guard<std::mutex> lock(workers[iVictim]->mutex);
+      if (!workers[iVictim]->tasks.empty())
+      {
+         task = std::move(workers[iVictim]->tasks.front());
+         workers[iVictim]->tasks.pop_front();
+         numQueued--;
+         if (iVictim != iThief)
+            numSteals++;
+         return true;
+      }
+   }
+   return false;
+}
+
+/*****************************************
+ * THREAD POOL :: RUN ONE
+ * Run a single queued task on the calling thread, if there is one
+ ****************************************/
+inline bool thread_pool::runOne()
+{
+   Task task;
+   bool isWorker = (currentPool() == this);
+   size_t iWorker = (isWorker ? currentWorker() : 0);
+   if ((isWorker && pop(iWorker, task)) || steal(iWorker, task))
+   {
+      task();
+      return true;
+   }
+   return false;
+}
+
+/*****************************************
+ * THREAD POOL :: WORK
+ * The loop every worker runs until the pool is destroyed
+ ****************************************/
+inline void thread_pool::work(size_t iWorker)
+{
+   currentPool()   = this;
+   currentWorker() = iWorker;
+
+   for (;;)
+   {
+      if (runOne())
+         continue;
+
+      std::unique_lock<std::mutex> lock(mutexSleep);
+      wake.wait(lock, [this]() { return done || numQueued.load() != 0; });
+      if (done && numQueued.load() == 0)
+         return;
+   }
+}
+
+}; // namespace custom
@@ -0,0 +1,237 @@
+/***********************************************************************
+ * Header:
+ *    TRACE
+ * Summary:
+ *    Record the operations made on an unordered_set so the same
+ *    sequence can be replayed later against any set
+ *
+ *    This will contain the class definition of:
+ *        trace_record   : One operation and the hash of its key
+ *        trace_recorder : Writes records to a binary stream
+ *        replay_result  : Throughput and latency of one replay
+ *
+ *    A trace is the eight bytes "HTRACE01" followed by one nine byte
+ *    record per operation: the operation, then the 64 bit key hash
+ *    with the least significant byte first.
+ ************************************************************************/
+
+#pragma once
+
+#include <cstdint>    // for std::uint64_t
+#include <istream>    // for std::istream
+#include <ostream>    // for std::ostream
+#include <vector>     // for std::vector
+#include <algorithm>  // for std::sort
+#include <chrono>     // for std::chrono::steady_clock
+
+namespace custom
+{
+
+/************************************************
+ * TRACE OP
+ * What was done to the set
+ ************************************************/
+enum trace_op : std::uint8_t
+{
+   TRACE_INSERT = 0,
+   TRACE_FIND   = 1,
+   TRACE_ERASE  = 2,
+   TRACE_CLEAR  = 3,   // the key is always zero
+   TRACE_NUM_OPS
+};
+
+inline const char * trace_op_name(trace_op op)
+{
+   static const char * names[TRACE_NUM_OPS] = { "insert", "find", "erase", "clear" };
+   return (op < TRACE_NUM_OPS ? names[op] : "unknown");
+}
+
+/************************************************
+ * TRACE RECORD
+ * One operation. Only the hash of the key is kept, so the
+ * trace holds no production data and every record is the same size
+ ************************************************/
+struct trace_record
+{
+   trace_op      op;
+   std::uint64_t key;
+};
+
+static const char TRACE_MAGIC[8] = { 'H', 'T', 'R', 'A', 'C', 'E', '0', '1' };
+static const size_t TRACE_RECORD_BYTES = 9;
+
+/************************************************
+ * TRACE RECORDER
+ * Buffers records and writes them out in blocks. Like the
+ * set it watches, it is not safe to share between threads
+ ************************************************/
+class trace_recorder
+{
+public:
+   trace_recorder(std::ostream & out) : out(out), numRecords(0)
+   {
+      this->out.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+      buffer.reserve(BUFFER_BYTES);
+   }
+  ~trace_recorder() { flush(); }
+   trace_recorder(const trace_recorder &) = delete;
+   trace_recorder & operator = (const trace_recorder &) = delete;
+
+   void record(trace_op op, std::uint64_t key)
+   {
+      if (buffer.size() + TRACE_RECORD_BYTES > BUFFER_BYTES)
+         flush();
+      buffer.push_back(static_cast<char>(op));
+      for (int i = 0; i < 8; i++)
+         buffer.push_back(static_cast<char>((key >> (8 * i)) & 0xff));
+      numRecords++;
+   }
+
+   void flush()
+   {
+      if (!buffer.empty())
+         out.write(buffer.data(), buffer.size());
+      buffer.clear();
+      out.flush();
+   }
+
+   size_t size() const { return numRecords; }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   enum { BUFFER_BYTES = 64 * 1024 };
+
+   std::ostream & out;        // where the trace goes
+   std::vector<char> buffer;  // records not yet written
+   size_t numRecords;         // records made so far
+};
+
+/*****************************************************
+ * READ TRACE
+ * Every record in a trace. Throws if the stream is not a
+ * trace or ends in the middle of a record
+ ****************************************************/
+inline std::vector<trace_record> read_trace(std::istream & in)
+{
+   char magic[sizeof(TRACE_MAGIC)] = {};
+   if (!in.read(magic, sizeof(magic)) ||
+       !std::equal(magic, magic + sizeof(magic), TRACE_MAGIC))
+      throw "ERROR: not a trace file";
+
+   std::vector<trace_record> records;
+   char bytes[TRACE_RECORD_BYTES];
+   while (in.read(bytes, sizeof(bytes)))
+   {
+      trace_record record;
+      if (static_cast<std::uint8_t>(bytes[0]) >= TRACE_NUM_OPS)
+         throw "ERROR: unknown operation in trace file";
+      record.op  = static_cast<trace_op>(bytes[0]);
+      record.key = 0;
+      for (int i = 8; i >= 1; i--)
+         record.key = (record.key << 8) | static_cast<std::uint8_t>(bytes[i]);
+      records.push_back(record);
+   }
+   if (in.gcount() != 0)
+      throw "ERROR: trace file ends in the middle of a record";
+   return records;
+}
+
+/************************************************
+ * REPLAY RESULT
+ * How fast one set ran a trace, per operation
+ ************************************************/
+struct replay_result
+{
+   struct latency
+   {
+      size_t numOps;     // operations of this kind
+      double nsTotal;    // time spent in them
+      double p50;        // latency percentiles in nanoseconds
+      double p90;
+      double p99;
+      double p999;
+      double max;
+   };
+
+   size_t  numOps;                      // every record
+   double  ns;                          // wall time of the whole replay
+   size_t  numHits;                     // finds that found the key
+   latency ops[TRACE_NUM_OPS];          // broken down by operation
+
+   double throughput() const { return ns > 0.0 ? numOps * 1e9 / ns : 0.0; }
+};
+
+/*****************************************************
+ * REPLAY
+ * Run every record against set, timing each one. The set
+ * needs insert(), find(), end(), erase() and clear(), and its
+ * elements must be constructible from the 64 bit key
+ ****************************************************/
+template <class Set>
+replay_result replay(const std::vector<trace_record> & records, Set & set)
+{
+   typedef typename Set::value_type Key;
+   typedef std::chrono::steady_clock Clock;
+
+   replay_result result = {};
+   std::vector<float> nsOps[TRACE_NUM_OPS];
+
+   Clock::time_point start = Clock::now();
+   for (const trace_record & record : records)
+   {
+      Key key = static_cast<Key>(record.key);
+      Clock::time_point before = Clock::now();
+      switch (record.op)
+      {
+         case TRACE_INSERT:
+            set.insert(key);
+            break;
+         case TRACE_FIND:
+            result.numHits += (set.find(key) != set.end());
+            break;
+         case TRACE_ERASE:
+            set.erase(key);
+            break;
+         case TRACE_CLEAR:
+         default:
+            set.clear();
+            break;
+      }
+      Clock::time_point after = Clock::now();
+      nsOps[record.op].push_back(std::chrono::duration<float, std::nano>(after - before).count());
+   }
+   result.ns     = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+   result.numOps = records.size();
+
+   // nearest rank percentiles of each kind of operation
+   for (int op = 0; op < TRACE_NUM_OPS; op++)
+   {
+      std::vector<float> & ns = nsOps[op];
+      replay_result::latency & latency = result.ops[op];
+      latency.numOps = ns.size();
+      if (ns.empty())
+         continue;
+      std::sort(ns.begin(), ns.end());
+      for (float n : ns)
+         latency.nsTotal += n;
+      auto percentile = [&ns](double p) { return (double)ns[(size_t)(p * (ns.size() - 1))]; };
+      latency.p50  = percentile(0.50);
+      latency.p90  = percentile(0.90);
+      latency.p99  = percentile(0.99);
+      latency.p999 = percentile(0.999);
+      latency.max  = ns.back();
+   }
+   return result;
+}
+
+}; // namespace custom
+
+// unordered_set records its own operations with this when HASH_TRACE is defined
+#ifdef HASH_TRACE
+#define HASH_TRACE_OP(op, t) (pTrace ? pTrace->record(op, std::hash<T>()(t)) : (void)0)
+#else
+#define HASH_TRACE_OP(op, t)
+#endif // HASH_TRACE
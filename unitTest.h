@@ -15,6 +15,9 @@
 #undef assertComplexFixture
 #undef assertStandardFixture
 #undef assertEmptyFixture
+#undef assertAllocations
+#undef assertNoAllocations
+#undef runUnit
 
 
 #define assertUnit(condition)     assertUnitParameters(condition, #condition, __LINE__, __FUNCTION__)
@@ -22,19 +25,80 @@
 #define assertComplexFixture(x)   assertComplexFixtureParameters( x, __LINE__, __FUNCTION__)
 #define assertStandardFixture(x)  assertStandardFixtureParameters(x, __LINE__, __FUNCTION__)
 #define assertEmptyFixture(x)     assertEmptyFixtureParameters(   x, __LINE__, __FUNCTION__)
+#define assertAllocations(max)    assertAllocationsParameters(max, __LINE__, __FUNCTION__)
+#define assertNoAllocations()     assertAllocationsParameters(0,   __LINE__, __FUNCTION__)
+#define runUnit(test)             runUnitParameters([this]() { test(); }, #test)
 
 #include <iostream>  // for std::cerr
 #include <string>    // for std::string
 #include <vector>    // for std::vector
 #include <map>       // for std::map
+#include <algorithm> // for std::sort
+#include <chrono>    // for std::chrono::steady_clock
+#include <functional>// for std::function
+#include <iomanip>   // for std::setw
+#include <mutex>     // for std::mutex
+#include <sstream>   // for std::ostringstream
+#include <thread>    // for std::thread
+
+/*************************************************************
+ * ALLOCATION COUNTERS
+ * Every call to the global operator new and delete on this
+ * thread, when the test driver defines UNIT_TEST_ALLOCATIONS
+ * and replaces them to count here. Otherwise these stay at
+ * zero. Each
+ * thread counts only its own so test classes running side by
+ * side do not see each other's allocations
+ *************************************************************/
+struct AllocationCounters
+{
+   size_t    numAlloc;   // calls to new
+   size_t    numFree;    // calls to delete
+   size_t    bytesAlloc; // every byte ever asked for
+   long long bytesLive;  // asked for here, less what was freed here
+   long long bytesPeak;  // the most bytesLive has been
+
+   static AllocationCounters & current()
+   {
+      static thread_local AllocationCounters counters{};
+      return counters;
+   }
+};
+
 
 
 class UnitTest
 {
 public:
-   UnitTest() { reset(); }
+   UnitTest() : pOut(&std::cerr) { reset(); }
+
+   // report() writes here, std::cerr unless a runner says otherwise
+   void redirect(std::ostream & out) { pOut = &out; }
+
+   // how long one test took
+   struct Timing
+   {
+      std::string suite;
+      std::string test;
+      double      ms;
+   };
+
+   // every test of every class reported so far, slowest first
+   static std::vector<Timing> slowest()
+   {
+      std::lock_guard<std::mutex> lock(timingsMutex());
+      std::vector<Timing> sorted = timings();
+      std::sort(sorted.begin(), sorted.end(),
+                [](const Timing & lhs, const Timing & rhs) { return lhs.ms > rhs.ms; });
+      return sorted;
+   }
    
 private:
+   typedef std::chrono::steady_clock Clock;
+
+   static std::vector<Timing> & timings() { static std::vector<Timing> t; return t; }
+   static std::mutex & timingsMutex()     { static std::mutex m;          return m; }
+
    // a test failure is a failure string and a line number
    struct Failure
    {
@@ -45,6 +109,16 @@ private:
    // each test has a name (the key) and the list of failures(value).
    std::map<std::string, std::vector<Failure>> tests;
 
+   // where the counters stood at the last trackAllocations()
+   size_t    numAllocStart;
+   size_t    bytesAllocStart;
+   long long bytesLiveStart;
+
+   // how long each test took, from its setup through its teardown
+   std::map<std::string, double> durations;
+
+   std::ostream * pOut;
+
 protected:
    /*************************************************************
     * RESET
@@ -53,6 +127,23 @@ protected:
    void reset()
    {
       tests.clear();
+      durations.clear();
+      trackAllocations();
+   }
+
+   /*************************************************************
+    * TRACK ALLOCATIONS
+    * Start counting allocations from here. Call this just before
+    * the exercise, then assertAllocations() right after it: the
+    * other asserts allocate too
+    *************************************************************/
+   void trackAllocations()
+   {
+      AllocationCounters & counters = AllocationCounters::current();
+      numAllocStart   = counters.numAlloc;
+      bytesAllocStart = counters.bytesAlloc;
+      bytesLiveStart  = counters.bytesLive;
+      counters.bytesPeak = bytesLiveStart;
    }
    
    /*************************************************************
@@ -61,23 +152,36 @@ protected:
     *************************************************************/
    void report(const char * name)
    {    
+      std::ostream & out = *pOut;
+
       // enumerate the failures, if there are any
       for (auto & test : tests)
          if (!test.second.empty())
          {
-            std::cerr << "\t" << test.first << "()\n";
+            out << "\t" << test.first << "()\n";
             for (auto & failure : test.second)
-               std::cerr << "\t\tline:"   << failure.lineNumber
-                         << " condition:" << failure.failure << "\n";
+               out << "\t\tline:"   << failure.lineNumber
+                   << " condition:" << failure.failure << "\n";
          }
 
+      // remember how long each test took
+      double msTotal = 0.0;
+      {
+         std::lock_guard<std::mutex> lock(timingsMutex());
+         for (auto & duration : durations)
+         {
+            timings().push_back(Timing{std::string(name), duration.first, duration.second});
+            msTotal += duration.second;
+         }
+      }
+
       // Name the test case
-      std::cerr << name << ":\t";
+      out << name << ":\t";
 
       // handle the no test case
       if (tests.empty())
       {
-         std::cerr << "There were no tests]\n";
+         out << "There were no tests]\n";
          return;
       }
 
@@ -88,15 +192,30 @@ protected:
       double successRate = (double)numSuccess / (double)tests.size();
 
       // display the summary
-      std::cerr.setf(std::ios::fixed | std::ios::showpoint);
-      std::cerr.precision(1);
-      std::cerr << "There were "
+      out.setf(std::ios::fixed | std::ios::showpoint);
+      out.precision(1);
+      out << "There were "
          << tests.size()
          << " tests run for a success rate of: "
-         << (successRate * 100.0) << "%\n";
+         << (successRate * 100.0) << "% in "
+         << msTotal << " ms\n";
 
    }
    
+   /*************************************************************
+    * RUN UNIT PARAMETERS
+    * Call one test and charge it the time the call took. A test
+    * with no asserts still counts as run
+    *************************************************************/
+   void runUnitParameters(const std::function<void()> & test, const char * name)
+   {
+      Clock::time_point start = Clock::now();
+      test();
+      Clock::time_point finish = Clock::now();
+      durations[name] += std::chrono::duration<double, std::milli>(finish - start).count();
+      tests[name];
+   }
+
    /*************************************************************
     * ASSERT UNIT PARAMETERS
     * Custom assert code so we can see all the errors at once
@@ -120,6 +239,27 @@ protected:
    }
    
    
+   /*************************************************************
+    * ASSERT ALLOCATIONS PARAMETERS
+    * No more than max calls to new on this thread since
+    * trackAllocations(). The
+    * failure gives the count, the bytes and the most bytes live at
+    * once. Without UNIT_TEST_ALLOCATIONS nothing is counted, so
+    * this always passes
+    *************************************************************/
+   void assertAllocationsParameters(size_t max, int line, const char* func)
+   {
+      AllocationCounters & counters = AllocationCounters::current();
+      size_t    numAlloc  = counters.numAlloc   - numAllocStart;
+      size_t    bytes     = counters.bytesAlloc - bytesAllocStart;
+      long long bytesPeak = counters.bytesPeak  - bytesLiveStart;
+      std::string condition = "allocations:" + std::to_string(numAlloc) +
+                              " (bytes:" + std::to_string(bytes) +
+                              " peak:" + std::to_string(bytesPeak) +
+                              ") <= " + std::to_string(max);
+      assertUnitParameters(numAlloc <= max, condition.c_str(), line, func);
+   }
+
    /*************************************************************
     * ASSERT UNIT PARAMETERS INDIRECT
     * Custom assert code so we can see all the errors at once from
@@ -130,7 +270,7 @@ protected:
                                      int lineCheck, const char* funcCheck)
    {
       std::string sFunc(funcOriginal);
-      
+
       if (!condition)
       {
          // add a failure to the list of failures
@@ -145,4 +285,89 @@ protected:
    }
 };
 
+/*************************************************************
+ * UNIT TEST RUNNER
+ * Runs every test class it was given and reports how long each
+ * took. Independent classes may run side by side, one thread
+ * each, with their reports held back and shown in the order the
+ * classes were added. Classes that share state with the others
+ * always run alone, afterwards
+ *************************************************************/
+class UnitTestRunner
+{
+public:
+   UnitTestRunner() : parallel(false) {}
+
+   // run independent classes on their own threads?
+   void setParallel(bool parallel) { this->parallel = parallel; }
+
+   template <class Test>
+   void add(bool independent = true)
+   {
+      suites.push_back(Suite{[](std::ostream & out)
+      {
+         Test test;
+         test.redirect(out);
+         test.run();
+      }, independent});
+   }
+
+   /*************************************************************
+    * RUN
+    * Every class, then the total time
+    *************************************************************/
+   void run(std::ostream & out = std::cerr)
+   {
+      auto start = std::chrono::steady_clock::now();
+      if (parallel)
+      {
+         std::vector<std::ostringstream> reports(suites.size());
+         std::vector<std::thread> threads;
+         for (size_t i = 0; i < suites.size(); i++)
+            if (suites[i].independent)
+               threads.push_back(std::thread([this, &reports, i]() { suites[i].run(reports[i]); }));
+         for (auto & thread : threads)
+            thread.join();
+         for (size_t i = 0; i < suites.size(); i++)
+            if (!suites[i].independent)
+               suites[i].run(reports[i]);
+         for (auto & report : reports)
+            out << report.str();
+      }
+      else
+         for (auto & suite : suites)
+            suite.run(out);
+      auto finish = std::chrono::steady_clock::now();
+
+      out.setf(std::ios::fixed | std::ios::showpoint);
+      out.precision(1);
+      out << "All tests" << (parallel ? " in parallel" : "") << ":\t"
+          << std::chrono::duration<double, std::milli>(finish - start).count() << " ms\n";
+   }
+
+   /*************************************************************
+    * REPORT SLOWEST
+    * The num slowest tests of every class run so far
+    *************************************************************/
+   static void reportSlowest(size_t num, std::ostream & out = std::cerr)
+   {
+      std::vector<UnitTest::Timing> slowest = UnitTest::slowest();
+      out << "Slowest tests:\n";
+      out.setf(std::ios::fixed | std::ios::showpoint);
+      out.precision(1);
+      for (size_t i = 0; i < num && i < slowest.size(); i++)
+         out << "\t" << std::setw(8) << slowest[i].ms << " ms  "
+             << slowest[i].suite << "::" << slowest[i].test << "()\n";
+   }
+
+private:
+   struct Suite
+   {
+      std::function<void(std::ostream &)> run;
+      bool independent;   // shares nothing with the other classes
+   };
+   std::vector<Suite> suites;
+   bool parallel;
+};
+
 #endif // DEBUG
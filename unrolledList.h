@@ -0,0 +1,684 @@
+/***********************************************************************
+ * Header:
+ *    UNROLLED LIST
+ * Summary:
+ *    A doubly linked list of fixed-size chunks, each holding several
+ *    elements side by side. Walking it touches one chunk per handful
+ *    of elements rather than one node per element, and appending
+ *    allocates once per chunk rather than once per element.
+ *
+ *    A chunk that fills up is split in two; one that falls below half
+ *    full is topped up from its neighbor when they both fit in one.
+ *    Inserting or erasing only moves the elements of one chunk, so it
+ *    stays O(1) for a fixed ChunkBytes, but it invalidates iterators
+ *    into that chunk and, on a split or merge, into its neighbor.
+ *
+ *    This will contain the class definition of:
+ *        unrolled_list          : A class that represents an unrolled list
+ *        unrolled_list::Chunk   : Up to CAPACITY elements in a row
+ *        unrolled_list::iterator: An iterator through an unrolled list
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>     // for ASSERT
+#include <cstddef>     // for size_t
+#include <initializer_list> // for std::initializer_list
+#include <new>         // for placement new
+#include <type_traits> // for std::aligned_storage
+#include <utility>     // for std::move, std::move_if_noexcept and std::forward
+
+namespace custom
+{
+
+/**************************************************
+ * UNROLLED LIST
+ * Like std::list, but ChunkBytes at a time
+ **************************************************/
+template <typename T, size_t ChunkBytes = 256>
+class unrolled_list
+{
+public:
+   //
+   // Construct
+   //
+
+   unrolled_list() : numElements(0), pHead(nullptr), pTail(nullptr) {}
+   unrolled_list(const unrolled_list & rhs);
+   unrolled_list(unrolled_list && rhs);
+   unrolled_list(const std::initializer_list<T> & il);
+   template <class Iterator>
+   unrolled_list(Iterator first, Iterator last);
+  ~unrolled_list()
+   {
+      clear();
+   }
+
+   //
+   // Assign
+   //
+
+   unrolled_list & operator = (const unrolled_list & rhs);
+   unrolled_list & operator = (unrolled_list && rhs);
+   unrolled_list & operator = (const std::initializer_list<T> & il);
+   void swap(unrolled_list & rhs);
+
+   //
+   // Iterator
+   //
+
+   class iterator;
+   iterator begin() { return iterator(pHead, 0);    }
+   iterator end()   { return iterator(nullptr, 0);  }
+
+   //
+   // Access
+   //
+
+   T & front();
+   T & back();
+
+   //
+   // Insert
+   //
+
+   void push_front(const T &  data) { emplace(begin(), data);            }
+   void push_front(      T && data) { emplace(begin(), std::move(data)); }
+   void push_back (const T &  data) { emplace(end(),   data);            }
+   void push_back (      T && data) { emplace(end(),   std::move(data)); }
+   iterator insert(iterator it, const T &  data) { return emplace(it, data);            }
+   iterator insert(iterator it,       T && data) { return emplace(it, std::move(data)); }
+   template <class ... Args>
+   void emplace_back(Args && ... args) { emplace(end(), std::forward<Args>(args)...); }
+   template <class ... Args>
+   iterator emplace(iterator it, Args && ... args);
+
+   //
+   // Remove
+   //
+
+   void pop_back();
+   void pop_front();
+   void clear();
+   iterator erase(const iterator & it);
+
+   //
+   // Status
+   //
+
+   bool empty()  const { return numElements == 0; }
+   size_t size() const { return numElements; }
+
+   // elements in a chunk, and the bytes a chunk takes
+   struct Chunk;
+   static size_t capacity()   { return CAPACITY; }
+   static size_t chunk_size() { return sizeof(Chunk); }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   // what is left of ChunkBytes after the links and the count, but at least one
+   static constexpr size_t HEADER = 2 * sizeof(void *) + sizeof(size_t);
+   static constexpr size_t CAPACITY =
+      (ChunkBytes >= HEADER + 2 * sizeof(T) ? (ChunkBytes - HEADER) / sizeof(T) : 1);
+
+   // member variables
+   size_t numElements; // number of elements
+   Chunk * pHead;      // the first chunk
+   Chunk * pTail;      // the last chunk
+
+   Chunk * allocate();
+   template <class ... Args>
+   iterator emplaceChunk(Chunk * pPos, Args && ... args);   // alone in a new chunk
+   void linkBefore(Chunk * pPos, Chunk * pNew);   // pPos nullptr means the end
+   void unlink(Chunk * pChunk);                   // and free it
+   Chunk * split(Chunk * pChunk);                 // back half into a new chunk
+   void mergeNext(Chunk * pChunk);                // the next chunk into this one
+};
+
+template <typename T, size_t ChunkBytes>
+constexpr size_t unrolled_list <T, ChunkBytes> :: HEADER;
+template <typename T, size_t ChunkBytes>
+constexpr size_t unrolled_list <T, ChunkBytes> :: CAPACITY;
+
+/*************************************************
+ * CHUNK
+ * Up to CAPACITY elements, always packed into the
+ * front of the slots with no gaps
+ *************************************************/
+template <typename T, size_t ChunkBytes>
+struct unrolled_list <T, ChunkBytes> :: Chunk
+{
+   Chunk() : pNext(nullptr), pPrev(nullptr), numUsed(0) {}
+  ~Chunk()
+   {
+      for (size_t i = 0; i < numUsed; i++)
+         at(i).~T();
+   }
+
+   bool full() const { return numUsed == CAPACITY; }
+
+   T & at(size_t i)
+   {
+      assert(i < CAPACITY);
+      return *reinterpret_cast<T *>(&slots[i]);
+   }
+
+   // build the element in slot i, which must be empty
+   template <class ... Args>
+   void construct(size_t i, Args && ... args)
+   {
+      assert(i < CAPACITY);
+      new (&slots[i]) T(std::forward<Args>(args)...);
+   }
+
+   Chunk * pNext;    // the next chunk
+   Chunk * pPrev;    // the previous chunk
+   size_t numUsed;   // slots [0, numUsed) hold an element
+   typename std::aligned_storage<sizeof(T), alignof(T)>::type slots[CAPACITY];
+};
+
+/*************************************************
+ * UNROLLED LIST ITERATOR
+ * A chunk and a slot in it. end() is no chunk at all
+ *************************************************/
+template <typename T, size_t ChunkBytes>
+class unrolled_list <T, ChunkBytes> :: iterator
+{
+   friend class unrolled_list <T, ChunkBytes>;
+public:
+   // constructors, destructors, and assignment operator
+   iterator() : pChunk(nullptr), index(0) {}
+   iterator(Chunk * pChunk, size_t index) : pChunk(pChunk), index(index) {}
+
+   // equals, not equals operator
+   bool operator == (const iterator & rhs) const
+   {
+      return pChunk == rhs.pChunk && index == rhs.index;
+   }
+   bool operator != (const iterator & rhs) const { return !(*this == rhs); }
+
+   // dereference operator, fetch an element
+   T & operator * ()
+   {
+      if (pChunk)
+         return pChunk->at(index);
+      else
+         throw "ERROR: Trying to dereference a nullptr pointer";
+   }
+
+   // prefix increment: the next slot, or the front of the next chunk
+   iterator & operator ++ ()
+   {
+      if (pChunk && ++index == pChunk->numUsed)
+      {
+         pChunk = pChunk->pNext;
+         index = 0;
+      }
+      return *this;
+   }
+
+   // postfix increment
+   iterator operator ++ (int postfix)
+   {
+      iterator old(*this);
+      ++(*this);
+      return old;
+   }
+
+   // prefix decrement: the previous slot, or the back of the previous chunk
+   iterator & operator -- ()
+   {
+      if (pChunk && index > 0)
+         index--;
+      else if (pChunk)
+      {
+         pChunk = pChunk->pPrev;
+         index = (pChunk ? pChunk->numUsed - 1 : 0);
+      }
+      return *this;
+   }
+
+   // postfix decrement
+   iterator operator -- (int postfix)
+   {
+      iterator old(*this);
+      --(*this);
+      return old;
+   }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   Chunk * pChunk;
+   size_t index;
+};
+
+/*****************************************
+ * UNROLLED LIST :: COPY constructors
+ * Fill every chunk before starting the next
+ ****************************************/
+template <typename T, size_t ChunkBytes>
+unrolled_list <T, ChunkBytes> :: unrolled_list(const unrolled_list & rhs)
+   : numElements(0), pHead(nullptr), pTail(nullptr)
+{
+   try
+   {
+      for (Chunk * p = rhs.pHead; p; p = p->pNext)
+         for (size_t i = 0; i < p->numUsed; i++)
+            push_back(p->at(i));
+   }
+   catch (...)
+   {
+      clear();
+      throw;
+   }
+}
+
+template <typename T, size_t ChunkBytes>
+unrolled_list <T, ChunkBytes> :: unrolled_list(const std::initializer_list<T> & il)
+   : unrolled_list(il.begin(), il.end())
+{
+}
+
+template <typename T, size_t ChunkBytes>
+template <class Iterator>
+unrolled_list <T, ChunkBytes> :: unrolled_list(Iterator first, Iterator last)
+   : numElements(0), pHead(nullptr), pTail(nullptr)
+{
+   try
+   {
+      for (; first != last; ++first)
+         push_back(*first);
+   }
+   catch (...)
+   {
+      clear();
+      throw;
+   }
+}
+
+/*****************************************
+ * UNROLLED LIST :: MOVE constructor
+ * Take the chunks of rhs
+ ****************************************/
+template <typename T, size_t ChunkBytes>
+unrolled_list <T, ChunkBytes> :: unrolled_list(unrolled_list && rhs)
+   : numElements(rhs.numElements), pHead(rhs.pHead), pTail(rhs.pTail)
+{
+   rhs.numElements = 0;
+   rhs.pHead = rhs.pTail = nullptr;
+}
+
+/*****************************************
+ * UNROLLED LIST :: ASSIGNMENT
+ * Copies are made to the side first, so a throwing copy leaves
+ * this list as it was
+ ****************************************/
+template <typename T, size_t ChunkBytes>
+unrolled_list <T, ChunkBytes> & unrolled_list <T, ChunkBytes> :: operator = (const unrolled_list & rhs)
+{
+   if (this != &rhs)
+   {
+      unrolled_list copy(rhs);
+      swap(copy);
+   }
+   return *this;
+}
+
+template <typename T, size_t ChunkBytes>
+unrolled_list <T, ChunkBytes> & unrolled_list <T, ChunkBytes> :: operator = (unrolled_list && rhs)
+{
+   if (this != &rhs)
+   {
+      clear();
+      swap(rhs);
+   }
+   return *this;
+}
+
+template <typename T, size_t ChunkBytes>
+unrolled_list <T, ChunkBytes> & unrolled_list <T, ChunkBytes> :: operator = (const std::initializer_list<T> & il)
+{
+   unrolled_list copy(il);
+   swap(copy);
+   return *this;
+}
+
+/*****************************************
+ * UNROLLED LIST :: SWAP
+ ****************************************/
+template <typename T, size_t ChunkBytes>
+void unrolled_list <T, ChunkBytes> :: swap(unrolled_list & rhs)
+{
+   std::swap(numElements, rhs.numElements);
+   std::swap(pHead, rhs.pHead);
+   std::swap(pTail, rhs.pTail);
+}
+
+template <typename T, size_t ChunkBytes>
+void swap(unrolled_list <T, ChunkBytes> & lhs, unrolled_list <T, ChunkBytes> & rhs)
+{
+   lhs.swap(rhs);
+}
+
+/*****************************************
+ * UNROLLED LIST :: FRONT and BACK
+ ****************************************/
+template <typename T, size_t ChunkBytes>
+T & unrolled_list <T, ChunkBytes> :: front()
+{
+   if (empty())
+      throw "ERROR: unable to access data from an empty list";
+   return pHead->at(0);
+}
+
+template <typename T, size_t ChunkBytes>
+T & unrolled_list <T, ChunkBytes> :: back()
+{
+   if (empty())
+      throw "ERROR: unable to access data from an empty list";
+   return pTail->at(pTail->numUsed - 1);
+}
+
+/******************************************
+ * UNROLLED LIST :: EMPLACE
+ * build an item in front of it.
+ *     INPUT  : an iterator to the location where it is to be inserted
+ *              whatever T's constructor takes
+ *     OUTPUT : iterator to the new item
+ *     COST   : O(CAPACITY) element moves, at most one allocation
+ ******************************************/
+template <typename T, size_t ChunkBytes>
+template <class ... Args>
+typename unrolled_list <T, ChunkBytes> :: iterator
+unrolled_list <T, ChunkBytes> :: emplace(iterator it, Args && ... args)
+{
+   Chunk * pChunk = it.pChunk;
+   size_t index = it.index;
+
+   // the end: onto the last chunk, or a new one when that is full.
+   // Appending this way leaves every chunk but the last one full
+   if (pChunk == nullptr)
+   {
+      if (pTail == nullptr || pTail->full())
+         return emplaceChunk(nullptr, std::forward<Args>(args)...);
+      pChunk = pTail;
+      index = pChunk->numUsed;
+   }
+   // in front of a full chunk: onto the end of the one before it
+   else if (index == 0 && pChunk->full())
+   {
+      if (pChunk->pPrev == nullptr || pChunk->pPrev->full())
+         return emplaceChunk(pChunk, std::forward<Args>(args)...);
+      pChunk = pChunk->pPrev;
+      index = pChunk->numUsed;
+   }
+   // in the middle of a full chunk: split it
+   else if (pChunk->full())
+   {
+      Chunk * pBack = split(pChunk);
+      if (index > pChunk->numUsed)
+      {
+         index -= pChunk->numUsed;
+         pChunk = pBack;
+      }
+   }
+   assert(!pChunk->full() && index <= pChunk->numUsed);
+
+   // at the end of the chunk, nothing moves
+   if (index == pChunk->numUsed)
+      pChunk->construct(index, std::forward<Args>(args)...);
+   // otherwise build it first so a throwing constructor changes nothing
+   else
+   {
+      T data(std::forward<Args>(args)...);
+      pChunk->construct(pChunk->numUsed, std::move(pChunk->at(pChunk->numUsed - 1)));
+      for (size_t i = pChunk->numUsed - 1; i > index; i--)
+         pChunk->at(i) = std::move(pChunk->at(i - 1));
+      pChunk->at(index) = std::move(data);
+   }
+
+   pChunk->numUsed++;
+   numElements++;
+   return iterator(pChunk, index);
+}
+
+/******************************************
+ * UNROLLED LIST :: ERASE
+ * remove the item at it, closing the gap. A chunk left
+ * empty is freed; one left less than half full takes
+ * in the next chunk when they fit together
+ *     INPUT  : the item to erase
+ *     OUTPUT : iterator to the item after it
+ *     COST   : O(CAPACITY) element moves
+ ******************************************/
+template <typename T, size_t ChunkBytes>
+typename unrolled_list <T, ChunkBytes> :: iterator
+unrolled_list <T, ChunkBytes> :: erase(const iterator & it)
+{
+   Chunk * pChunk = it.pChunk;
+   size_t index = it.index;
+   if (pChunk == nullptr)
+      return end();
+   assert(index < pChunk->numUsed);
+
+   for (size_t i = index; i + 1 < pChunk->numUsed; i++)
+      pChunk->at(i) = std::move(pChunk->at(i + 1));
+   pChunk->at(pChunk->numUsed - 1).~T();
+   pChunk->numUsed--;
+   numElements--;
+
+   // nothing left
+   if (pChunk->numUsed == 0)
+   {
+      Chunk * pNext = pChunk->pNext;
+      unlink(pChunk);
+      return iterator(pNext, 0);
+   }
+
+   // too empty. The element is gone either way, so when the next
+   // chunk cannot be copied in the two just stay apart
+   if (pChunk->numUsed < CAPACITY / 2 && pChunk->pNext &&
+       pChunk->numUsed + pChunk->pNext->numUsed <= CAPACITY)
+   {
+      try
+      {
+         mergeNext(pChunk);
+      }
+      catch (...)
+      {
+      }
+   }
+
+   if (index < pChunk->numUsed)
+      return iterator(pChunk, index);
+   return iterator(pChunk->pNext, 0);
+}
+
+/******************************************
+ * UNROLLED LIST :: POP BACK and POP FRONT
+ * nothing happens to an empty list
+ ******************************************/
+template <typename T, size_t ChunkBytes>
+void unrolled_list <T, ChunkBytes> :: pop_back()
+{
+   if (!empty())
+      erase(iterator(pTail, pTail->numUsed - 1));
+}
+
+template <typename T, size_t ChunkBytes>
+void unrolled_list <T, ChunkBytes> :: pop_front()
+{
+   if (!empty())
+      erase(begin());
+}
+
+/******************************************
+ * UNROLLED LIST :: CLEAR
+ * free every chunk, which destroys its elements
+ ******************************************/
+template <typename T, size_t ChunkBytes>
+void unrolled_list <T, ChunkBytes> :: clear()
+{
+   while (pHead)
+   {
+      Chunk * pNext = pHead->pNext;
+      delete pHead;
+      pHead = pNext;
+   }
+   pTail = nullptr;
+   numElements = 0;
+}
+
+/******************************************
+ * UNROLLED LIST :: ALLOCATE
+ * a new, empty, unlinked chunk
+ ******************************************/
+template <typename T, size_t ChunkBytes>
+typename unrolled_list <T, ChunkBytes> :: Chunk * unrolled_list <T, ChunkBytes> :: allocate()
+{
+   try
+   {
+      return new Chunk;
+   }
+   catch (...)
+   {
+      throw "ERROR: unable to allocate a new chunk for an unrolled list";
+   }
+}
+
+/******************************************
+ * UNROLLED LIST :: EMPLACE CHUNK
+ * build the item in a chunk of its own, then hook the
+ * chunk in front of pPos. A throwing constructor frees
+ * the chunk before it is ever linked
+ ******************************************/
+template <typename T, size_t ChunkBytes>
+template <class ... Args>
+typename unrolled_list <T, ChunkBytes> :: iterator
+unrolled_list <T, ChunkBytes> :: emplaceChunk(Chunk * pPos, Args && ... args)
+{
+   Chunk * pNew = allocate();
+   try
+   {
+      pNew->construct(0, std::forward<Args>(args)...);
+   }
+   catch (...)
+   {
+      delete pNew;
+      throw;
+   }
+   pNew->numUsed = 1;
+   linkBefore(pPos, pNew);
+   numElements++;
+   return iterator(pNew, 0);
+}
+
+/******************************************
+ * UNROLLED LIST :: LINK BEFORE
+ * hook pNew in front of pPos, or onto the end
+ ******************************************/
+template <typename T, size_t ChunkBytes>
+void unrolled_list <T, ChunkBytes> :: linkBefore(Chunk * pPos, Chunk * pNew)
+{
+   Chunk * pBefore = (pPos ? pPos->pPrev : pTail);
+   pNew->pPrev = pBefore;
+   pNew->pNext = pPos;
+   if (pBefore)
+      pBefore->pNext = pNew;
+   else
+      pHead = pNew;
+   if (pPos)
+      pPos->pPrev = pNew;
+   else
+      pTail = pNew;
+}
+
+/******************************************
+ * UNROLLED LIST :: UNLINK
+ * take pChunk out of the list and free it
+ ******************************************/
+template <typename T, size_t ChunkBytes>
+void unrolled_list <T, ChunkBytes> :: unlink(Chunk * pChunk)
+{
+   if (pChunk->pPrev)
+      pChunk->pPrev->pNext = pChunk->pNext;
+   else
+      pHead = pChunk->pNext;
+   if (pChunk->pNext)
+      pChunk->pNext->pPrev = pChunk->pPrev;
+   else
+      pTail = pChunk->pPrev;
+   delete pChunk;
+}
+
+/******************************************
+ * UNROLLED LIST :: SPLIT
+ * move the back half of pChunk into a new chunk after it.
+ * An element whose move may throw is copied instead, so
+ * a throw frees the new chunk and leaves pChunk as it was
+ *     OUTPUT : the new chunk
+ ******************************************/
+template <typename T, size_t ChunkBytes>
+typename unrolled_list <T, ChunkBytes> :: Chunk * unrolled_list <T, ChunkBytes> :: split(Chunk * pChunk)
+{
+   Chunk * pBack = allocate();
+   size_t numKeep = pChunk->numUsed - pChunk->numUsed / 2;
+   try
+   {
+      for (size_t i = numKeep; i < pChunk->numUsed; i++)
+      {
+         pBack->construct(pBack->numUsed, std::move_if_noexcept(pChunk->at(i)));
+         pBack->numUsed++;
+      }
+   }
+   catch (...)
+   {
+      delete pBack;
+      throw;
+   }
+
+   while (pChunk->numUsed > numKeep)
+      pChunk->at(--pChunk->numUsed).~T();
+   linkBefore(pChunk->pNext, pBack);
+   return pBack;
+}
+
+/******************************************
+ * UNROLLED LIST :: MERGE NEXT
+ * move every element of the next chunk onto the end
+ * of pChunk and free the next chunk. An element whose
+ * move may throw is copied instead, so a throw takes
+ * back what was added and leaves both chunks as they were
+ ******************************************/
+template <typename T, size_t ChunkBytes>
+void unrolled_list <T, ChunkBytes> :: mergeNext(Chunk * pChunk)
+{
+   Chunk * pNext = pChunk->pNext;
+   assert(pNext && pChunk->numUsed + pNext->numUsed <= CAPACITY);
+   size_t numBefore = pChunk->numUsed;
+   try
+   {
+      for (size_t i = 0; i < pNext->numUsed; i++)
+      {
+         pChunk->construct(pChunk->numUsed, std::move_if_noexcept(pNext->at(i)));
+         pChunk->numUsed++;
+      }
+   }
+   catch (...)
+   {
+      while (pChunk->numUsed > numBefore)
+         pChunk->at(--pChunk->numUsed).~T();
+      throw;
+   }
+
+   // the chunk destroys what is left in it
+   unlink(pNext);
+}
+
+} // namespace custom
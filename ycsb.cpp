@@ -0,0 +1,197 @@
+/***********************************************************************
+ * Program:
+ *    YCSB
+ * Summary:
+ *    Run a YCSB style mixed workload against the sets that can be
+ *    shared between threads, once for each thread count, and report
+ *    the throughput curve and latency percentiles.
+ *    Build it with "make ycsb".
+ *    Usage:
+ *       ycsb [--workload A-F] [--read P] [--insert P] [--update P]
+ *            [--erase P] [--scan P] [--records N] [--scan-length N]
+ *            [--threads 1,2,4,...] [--warmup S] [--duration S]
+ *            [--dist NAME] [--theta X] [--seed N]
+ *            [--backend NAME] [--json FILE]
+ ************************************************************************/
+
+#include "hash.h"          // for custom::unordered_set
+#include "ycsb.h"          // for runYcsb
+
+#include <cstdlib>         // for std::strtoul
+#include <cstring>         // for std::strcmp
+#include <fstream>         // for std::ofstream
+#include <iomanip>         // for std::setw
+#include <iostream>        // for std::cout
+#include <shared_mutex>    // for std::shared_timed_mutex
+#include <sstream>         // for std::ostringstream and std::istringstream
+#include <string>          // for std::string
+#include <unordered_set>   // for std::unordered_set
+#include <vector>          // for std::vector
+
+/**********************************************************************
+ * BACKENDS
+ * Every set the driver knows how to share between threads
+ ***********************************************************************/
+typedef LockedSet<custom::unordered_set<std::size_t>>                          CustomMutex;
+typedef LockedSet<custom::unordered_set<std::size_t>, std::shared_timed_mutex> CustomRwLock;
+typedef LockedSet<std::unordered_set<std::size_t>>                             StdMutex;
+
+static const char * BACKENDS[] = { "custom-mutex", "custom-rwlock", "std-mutex" };
+
+/**********************************************************************
+ * REPORT
+ * One line of the throughput curve, then each operation's latency
+ ***********************************************************************/
+void report(const char * backend, const YcsbResult & result, std::ostringstream & json)
+{
+   std::cout.setf(std::ios::fixed);
+   std::cout.precision(0);
+   std::cout << backend << " threads:" << result.numThreads
+             << " ops:" << result.numOps()
+             << " ops/s:" << result.throughput() << "\n";
+   for (int op = 0; op < YCSB_NUM_OPS; op++)
+   {
+      const custom::latency_histogram & latency = result.ops[op];
+      if (latency.count() == 0)
+         continue;
+      std::cout << "\t" << std::left << std::setw(7) << ycsbOpName(op) << std::right
+                << " count:" << std::setw(10) << latency.count()
+                << " p50:"   << std::setw(8)  << latency.percentile(0.50)
+                << " p99:"   << std::setw(8)  << latency.percentile(0.99)
+                << " p99.9:" << std::setw(8)  << latency.percentile(0.999)
+                << " max:"   << std::setw(10) << latency.max() << " ns\n";
+   }
+   std::cout << "\tper thread:";
+   for (auto numOps : result.perThread)
+      std::cout << " " << numOps;
+   std::cout << "\n";
+
+   json << (json.tellp() > 0 ? ",\n" : "")
+        << "  {\"backend\":\"" << backend
+        << "\",\"threads\":"   << result.numThreads
+        << ",\"seconds\":"     << result.seconds
+        << ",\"ops\":"         << result.numOps()
+        << ",\"ops_per_sec\":" << result.throughput()
+        << ",\"latency\":{";
+   bool first = true;
+   for (int op = 0; op < YCSB_NUM_OPS; op++)
+   {
+      const custom::latency_histogram & latency = result.ops[op];
+      if (latency.count() == 0)
+         continue;
+      json << (first ? "" : ",") << "\"" << ycsbOpName(op) << "\":{"
+           << "\"count\":" << latency.count()
+           << ",\"p50\":"  << latency.percentile(0.50)
+           << ",\"p99\":"  << latency.percentile(0.99)
+           << ",\"p999\":" << latency.percentile(0.999)
+           << ",\"max\":"  << latency.max() << "}";
+      first = false;
+   }
+   json << "}}";
+}
+
+/**********************************************************************
+ * RUN
+ * A fresh set for every thread count
+ ***********************************************************************/
+template <class Set>
+void run(const char * backend, const YcsbWorkload & workload,
+         const std::vector<size_t> & threadCounts, std::ostringstream & json)
+{
+   for (size_t numThreads : threadCounts)
+   {
+      Set set;
+      report(backend, runYcsb<std::size_t>(set, workload, numThreads), json);
+   }
+}
+
+/**********************************************************************
+ * MAIN
+ * Read the options and run every backend asked for
+ ***********************************************************************/
+int main(int argc, char ** argv)
+{
+   YcsbWorkload workload;
+   std::vector<size_t> threadCounts = { 1, 2, 4, 8 };
+   std::string backend;
+   const char * jsonPath = nullptr;
+   bool valid = true;
+
+   for (int i = 1; i < argc && valid; i++)
+   {
+      bool hasValue = (i + 1 < argc);
+      const char * value = (hasValue ? argv[i + 1] : "");
+      int op = -1;
+      for (int o = 0; o < YCSB_NUM_OPS; o++)
+         if (argv[i][0] == '-' && argv[i][1] == '-' && !std::strcmp(argv[i] + 2, ycsbOpName(o)))
+            op = o;
+
+      if (!hasValue)
+         valid = false;
+      else if (op >= 0)
+         workload.percent[op] = (unsigned)std::strtoul(value, nullptr, 10);
+      else if (!std::strcmp(argv[i], "--workload"))
+         valid = (std::strlen(value) == 1 && workload.preset(value[0]));
+      else if (!std::strcmp(argv[i], "--records"))
+         workload.numRecords = std::strtoull(value, nullptr, 10);
+      else if (!std::strcmp(argv[i], "--scan-length"))
+         workload.scanLength = std::strtoull(value, nullptr, 10);
+      else if (!std::strcmp(argv[i], "--warmup"))
+         workload.warmup = std::strtod(value, nullptr);
+      else if (!std::strcmp(argv[i], "--duration"))
+         workload.duration = std::strtod(value, nullptr);
+      else if (!std::strcmp(argv[i], "--dist"))
+         valid = KeyGenerator::parse(value, workload.keys.distribution);
+      else if (!std::strcmp(argv[i], "--theta"))
+         workload.keys.theta = std::strtod(value, nullptr);
+      else if (!std::strcmp(argv[i], "--seed"))
+         workload.keys.seed = std::strtoull(value, nullptr, 10);
+      else if (!std::strcmp(argv[i], "--backend"))
+         backend = value;
+      else if (!std::strcmp(argv[i], "--json"))
+         jsonPath = value;
+      else if (!std::strcmp(argv[i], "--threads"))
+      {
+         // a comma separated list
+         threadCounts.clear();
+         std::istringstream in(value);
+         std::string count;
+         while (std::getline(in, count, ','))
+         {
+            size_t numThreads = std::strtoul(count.c_str(), nullptr, 10);
+            valid = valid && numThreads > 0;
+            threadCounts.push_back(numThreads);
+         }
+      }
+      else
+         valid = false;
+      i++;
+   }
+
+   bool knownBackend = backend.empty();
+   for (const char * name : BACKENDS)
+      knownBackend = knownBackend || backend == name;
+   if (!valid || !knownBackend || !workload.valid() || threadCounts.empty())
+   {
+      std::cerr << "Usage: " << argv[0] << "\n"
+                << "   [--workload A-F] [--read P] [--insert P] [--update P]\n"
+                << "   [--erase P] [--scan P] [--records N] [--scan-length N]\n"
+                << "   [--threads 1,2,4,...] [--warmup S] [--duration S]\n"
+                << "   [--dist NAME] [--theta X] [--seed N]\n"
+                << "   [--backend custom-mutex|custom-rwlock|std-mutex] [--json FILE]\n"
+                << "The percentages must add up to 100.\n";
+      return 1;
+   }
+
+   std::ostringstream json;
+   if (backend.empty() || backend == BACKENDS[0])
+      run<CustomMutex>(BACKENDS[0], workload, threadCounts, json);
+   if (backend.empty() || backend == BACKENDS[1])
+      run<CustomRwLock>(BACKENDS[1], workload, threadCounts, json);
+   if (backend.empty() || backend == BACKENDS[2])
+      run<StdMutex>(BACKENDS[2], workload, threadCounts, json);
+
+   if (jsonPath)
+      std::ofstream(jsonPath) << "[\n" << json.str() << "\n]\n";
+   return 0;
+}
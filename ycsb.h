@@ -0,0 +1,284 @@
+/***********************************************************************
+ * Header:
+ *    YCSB
+ * Summary:
+ *    A multi-threaded mixed workload in the style of the Yahoo! Cloud
+ *    Serving Benchmark. Every thread runs the same mix of reads,
+ *    inserts, updates, erases and scans against one shared set for a
+ *    warm-up period and then for a fixed, measured, duration.
+ *
+ *    This will contain the class definition of:
+ *        YcsbWorkload : The operation mix and how long to run it
+ *        LockedSet    : Any set behind one lock, so threads can share it
+ *        YcsbResult   : Throughput and latency for one run
+ ************************************************************************/
+
+#pragma once
+
+#include "keyGenerator.h"     // for KeyGenerator
+#include "latencyHistogram.h" // for custom::latency_histogram
+
+#include <atomic>             // for std::atomic
+#include <chrono>             // for std::chrono::steady_clock
+#include <cstdint>            // for std::uint64_t
+#include <mutex>              // for std::mutex
+#include <shared_mutex>       // for std::shared_timed_mutex
+#include <string>             // for std::string
+#include <thread>             // for std::thread
+#include <type_traits>        // for std::conditional
+#include <vector>             // for std::vector
+
+/*************************************************************
+ * YCSB OP
+ *************************************************************/
+enum YcsbOp
+{
+   YCSB_READ,      // find an existing key
+   YCSB_INSERT,    // add a key nobody has used yet
+   YCSB_UPDATE,    // erase an existing key and put it right back
+   YCSB_ERASE,     // remove an existing key
+   YCSB_SCAN,      // visit the elements following an existing key
+   YCSB_NUM_OPS
+};
+
+inline const char * ycsbOpName(int op)
+{
+   static const char * names[YCSB_NUM_OPS] = { "read", "insert", "update", "erase", "scan" };
+   return (op >= 0 && op < YCSB_NUM_OPS ? names[op] : "unknown");
+}
+
+/*************************************************************
+ * YCSB WORKLOAD
+ * What every thread does, and for how long
+ *************************************************************/
+struct YcsbWorkload
+{
+   YcsbWorkload()
+      : numRecords(10000), scanLength(10), warmup(1.0), duration(5.0)
+   {
+      percent[YCSB_READ]   = 50;
+      percent[YCSB_INSERT] = 0;
+      percent[YCSB_UPDATE] = 50;
+      percent[YCSB_ERASE]  = 0;
+      percent[YCSB_SCAN]   = 0;
+      keys.distribution = KEYS_ZIPF;
+   }
+
+   /*************************************************************
+    * PRESET
+    * The core YCSB workloads. A is update heavy, B is read mostly,
+    * C is read only, D reads and inserts, E is short scans. F, the
+    * read-modify-write workload, is the same as A here since an
+    * update of a set is already a read and a write
+    *************************************************************/
+   bool preset(char name)
+   {
+      unsigned mixes[6][YCSB_NUM_OPS] =
+      {  // read insert update erase scan
+         {  50,    0,    50,    0,    0 },    // A
+         {  95,    0,     5,    0,    0 },    // B
+         { 100,    0,     0,    0,    0 },    // C
+         {  95,    5,     0,    0,    0 },    // D
+         {   0,    5,     0,    0,   95 },    // E
+         {  50,    0,    50,    0,    0 }     // F
+      };
+      if (name >= 'a' && name <= 'f')
+         name = name - 'a' + 'A';
+      if (name < 'A' || name > 'F')
+         return false;
+      for (int op = 0; op < YCSB_NUM_OPS; op++)
+         percent[op] = mixes[name - 'A'][op];
+      return true;
+   }
+
+   // the mix must add up to 100
+   bool valid() const
+   {
+      unsigned sum = 0;
+      for (int op = 0; op < YCSB_NUM_OPS; op++)
+         sum += percent[op];
+      return sum == 100 && numRecords > 0 && duration > 0.0;
+   }
+
+   unsigned   percent[YCSB_NUM_OPS];   // how often each operation happens
+   size_t     numRecords;              // keys loaded before the run
+   size_t     scanLength;              // elements visited by one scan
+   double     warmup;                  // seconds to run before measuring
+   double     duration;                // seconds to measure
+   KeyOptions keys;                    // which keys, and which ones are popular
+};
+
+/*************************************************************
+ * LOCKED SET
+ * The baseline: one lock around a set that is not thread safe.
+ * With a shared Mutex, reads and scans share the lock
+ *************************************************************/
+template <class Set, class Mutex = std::mutex>
+class LockedSet
+{
+public:
+   typedef typename Set::value_type value_type;
+
+   bool read(const value_type & t)
+   {
+      SharedLock lock(mutex);
+      return set.find(t) != set.end();
+   }
+   void insert(const value_type & t)
+   {
+      std::lock_guard<Mutex> lock(mutex);
+      set.insert(t);
+   }
+   void update(const value_type & t)
+   {
+      std::lock_guard<Mutex> lock(mutex);
+      set.erase(t);
+      set.insert(t);
+   }
+   void erase(const value_type & t)
+   {
+      std::lock_guard<Mutex> lock(mutex);
+      set.erase(t);
+   }
+   size_t scan(const value_type & t, size_t length)
+   {
+      SharedLock lock(mutex);
+      size_t numVisited = 0;
+      for (auto it = set.find(t); numVisited < length && it != set.end(); ++it)
+         numVisited++;
+      return numVisited;
+   }
+   size_t size()
+   {
+      std::lock_guard<Mutex> lock(mutex);
+      return set.size();
+   }
+
+private:
+   // a reader lock when the mutex has one, otherwise the only lock there is
+   typedef typename std::conditional<std::is_same<Mutex, std::shared_timed_mutex>::value,
+                                     std::shared_lock<Mutex>,
+                                     std::unique_lock<Mutex>>::type SharedLock;
+
+   Set   set;
+   Mutex mutex;
+};
+
+/*************************************************************
+ * YCSB RESULT
+ *************************************************************/
+struct YcsbResult
+{
+   size_t                     numThreads;
+   double                     seconds;             // measured time
+   custom::latency_histogram  ops[YCSB_NUM_OPS];   // every thread merged
+   std::vector<std::uint64_t> perThread;           // operations done by each thread
+
+   std::uint64_t numOps() const
+   {
+      std::uint64_t sum = 0;
+      for (int op = 0; op < YCSB_NUM_OPS; op++)
+         sum += ops[op].count();
+      return sum;
+   }
+   double throughput() const { return seconds > 0.0 ? numOps() / seconds : 0.0; }
+};
+
+/*************************************************************
+ * RUN YCSB
+ * Load workload.numRecords keys into set, then let numThreads
+ * threads loose on it
+ *************************************************************/
+template <class Key, class Set>
+YcsbResult runYcsb(Set & set, const YcsbWorkload & workload, size_t numThreads)
+{
+   typedef std::chrono::steady_clock Clock;
+   enum Phase { WAITING, WARMUP, MEASURE, STOP };
+
+   if (numThreads == 0)
+      numThreads = 1;
+
+   // load
+   {
+      KeyGenerator generator(workload.keys, workload.numRecords);
+      for (size_t i = 0; i < workload.numRecords; i++)
+         set.insert(generator.key<Key>(i));
+   }
+
+   YcsbResult result;
+   result.numThreads = numThreads;
+   result.perThread.assign(numThreads, 0);
+   std::vector<std::vector<custom::latency_histogram>> latencies(numThreads,
+                                       std::vector<custom::latency_histogram>(YCSB_NUM_OPS));
+   std::atomic<int> phase(WAITING);
+   std::atomic<size_t> iInsert(workload.numRecords);   // the next key never used
+   std::atomic<size_t> numReady(0);
+   std::atomic<size_t> sink(0);
+
+   std::vector<std::thread> threads;
+   for (size_t iThread = 0; iThread < numThreads; iThread++)
+      threads.push_back(std::thread([&, iThread]()
+      {
+         // every thread gets its own stream of keys from the same population
+         KeyOptions keys = workload.keys;
+         keys.seed = workload.keys.seed + 7919 * (iThread + 1);
+         KeyGenerator generator(keys, workload.numRecords);
+         KeyGenerator inserts(workload.keys, workload.numRecords);
+         std::vector<custom::latency_histogram> & mine = latencies[iThread];
+         size_t sum = 0;
+
+         numReady++;
+         while (phase.load() == WAITING)
+            std::this_thread::yield();
+
+         int now;
+         while ((now = phase.load(std::memory_order_relaxed)) != STOP)
+         {
+            // pick the operation and its key before the clock starts
+            unsigned roll = generator.percent();
+            int op = 0;
+            while (op < YCSB_NUM_OPS - 1 && roll >= workload.percent[op])
+               roll -= workload.percent[op++];
+            Key key = (op == YCSB_INSERT ? inserts.key<Key>(iInsert++)
+                                         : generator.key<Key>(generator.next()));
+
+            Clock::time_point before = Clock::now();
+            switch (op)
+            {
+               case YCSB_READ:   sum += set.read(key);                       break;
+               case YCSB_INSERT: set.insert(key);                            break;
+               case YCSB_UPDATE: set.update(key);                            break;
+               case YCSB_ERASE:  set.erase(key);                             break;
+               default:          sum += set.scan(key, workload.scanLength);  break;
+            }
+            Clock::time_point after = Clock::now();
+
+            if (now == MEASURE)
+            {
+               mine[op].record((std::uint64_t)std::chrono::duration_cast<
+                               std::chrono::nanoseconds>(after - before).count());
+               result.perThread[iThread]++;
+            }
+         }
+         sink += sum;
+      }));
+
+   // wait for everybody, warm up, then measure
+   while (numReady.load() != numThreads)
+      std::this_thread::yield();
+   phase = WARMUP;
+   std::this_thread::sleep_for(std::chrono::duration<double>(workload.warmup));
+   Clock::time_point start = Clock::now();
+   phase = MEASURE;
+   std::this_thread::sleep_for(std::chrono::duration<double>(workload.duration));
+   phase = STOP;
+   Clock::time_point finish = Clock::now();
+   for (auto & thread : threads)
+      thread.join();
+
+   result.seconds = std::chrono::duration<double>(finish - start).count();
+   for (size_t iThread = 0; iThread < numThreads; iThread++)
+      for (int op = 0; op < YCSB_NUM_OPS; op++)
+         result.ops[op].merge(latencies[iThread][op]);
+   return result;
+}